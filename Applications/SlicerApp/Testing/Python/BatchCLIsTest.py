@@ -0,0 +1,95 @@
+import os
+import unittest
+from __main__ import vtk, qt, ctk, slicer
+from slicer.ScriptedLoadableModule import *
+
+#
+# BatchCLIsTest
+#
+
+class BatchCLIsTest(ScriptedLoadableModule):
+  def __init__(self, parent):
+    parent.title = "BatchCLIsTest" # TODO make this more human readable by adding spaces
+    parent.categories = ["Testing.TestCases"]
+    parent.dependencies = ["CLI4Test"]
+    parent.contributors = ["Slicer Community"]
+    parent.helpText = """
+    This is a self test that tests running a batch of CLIs through python
+    """
+    parent.acknowledgementText = """""" # replace with organization, grant and thanks.
+    self.parent = parent
+
+    # Add this test to the SelfTest module's list for discovery when the module
+    # is created.  Since this module may be discovered before SelfTests itself,
+    # create the list if it doesn't already exist.
+    try:
+      slicer.selfTests
+    except AttributeError:
+      slicer.selfTests = {}
+    slicer.selfTests['BatchCLIsTest'] = self.runTest
+
+  def runTest(self):
+    tester = BatchCLIsTestTest()
+    tester.runTest()
+
+#
+# BatchCLIsTestWidget
+#
+
+class BatchCLIsTestWidget(ScriptedLoadableModuleWidget):
+
+  def setup(self):
+    ScriptedLoadableModuleWidget.setup(self)
+
+#
+# BatchCLIsTestTest
+#
+
+class BatchCLIsTestTest(ScriptedLoadableModuleTest):
+
+  def setUp(self):
+    """ Reset the state for testing.
+    """
+    pass
+
+  def runTest(self):
+    """Run as few or as many tests as needed here.
+    """
+    self.setUp()
+    self.test_BatchCLIsTest()
+
+  def test_BatchCLIsTest(self):
+    self.delayDisplay('Running a batch of CLIs Test')
+
+    cliModule = slicer.modules.cli4test
+    numberOfRuns = 4
+
+    tempFiles = []
+    cliNodes = []
+    for run in range(numberOfRuns):
+      tempFile = qt.QTemporaryFile("BatchCLIsTest-outputFile-XXXXXX")
+      self.assertTrue(tempFile.open())
+      tempFiles.append(tempFile)
+
+      parameters = {}
+      parameters["InputValue1"] = run
+      parameters["InputValue2"] = 2
+      parameters["OperationType"] = 'Addition'
+      parameters["OutputFile"] = tempFile.fileName()
+      cliNode = slicer.cli.createNode(cliModule, parameters)
+      cliNode.SetName("CLIModule%d" % run)
+      cliNodes.append(cliNode)
+
+    jobTimes = slicer.cli.runBatch(cliModule, cliNodes, maximum_number_of_jobs=2)
+    self.assertEqual(len(jobTimes), numberOfRuns)
+
+    for run in range(numberOfRuns):
+      self.assertEqual(cliNodes[run].GetStatusString(), 'Completed')
+      self.assertTrue(jobTimes[run] >= 0.)
+      stream = qt.QTextStream(tempFiles[run])
+      self.assertEqual(stream.readAll().strip(), str(run + 2))
+
+    self.assertTrue(cliModule.logic().GetBatchTime() > 0.)
+    self.assertTrue(cliModule.logic().GetBatchThroughput() > 0.)
+
+    self.delayDisplay('Batch of CLIs test passed !')
@@ -35,6 +35,7 @@
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkTransform.h>
 
 static const int ARRAY_INDEX_SCALARS=0;
@@ -54,6 +55,138 @@ vtkTransformVisualizerGlyph3D::vtkTransformVisualizerGlyph3D()
   this->MagnitudeThresholdUpper = 100.0;
 }
 
+//------------------------------------------------------------------------------
+// Computes the points and color scalars of a range of glyphs. Each glyph
+// is written to its own section of the preallocated output arrays, therefore
+// glyphs can be generated in parallel.
+class vtkTransformVisualizerGlyph3D::vtkGenerateGlyphsWorker
+{
+public:
+  vtkGenerateGlyphsWorker(vtkTransformVisualizerGlyph3D* filter, vtkDataSet* input,
+    const std::vector<vtkIdType>& glyphPointIds, vtkDataArray* inVectors, vtkDataArray* inCScalars,
+    vtkPoints* sourcePts, vtkPoints* newPts, vtkDataArray* newScalars)
+    : Filter(filter)
+    , Input(input)
+    , GlyphPointIds(glyphPointIds)
+    , InVectors(inVectors)
+    , InCScalars(inCScalars)
+    , SourcePts(sourcePts)
+    , NewPts(newPts)
+    , NewScalars(newScalars)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType numSourcePts = this->SourcePts->GetNumberOfPoints();
+    double inPt[3] = {0};
+    double v[3] = {0};
+    double sourcePt[3] = {0};
+    double outPt[3] = {0};
+    double glyphMatrix[3][3];
+    for (vtkIdType glyphId = begin; glyphId < end; glyphId++)
+      {
+      vtkIdType inPtId = this->GlyphPointIds[glyphId];
+      this->Input->GetPoint(inPtId, inPt);
+      this->InVectors->GetTuple(inPtId, v);
+      double vMag = vtkMath::Norm(v);
+
+      // Orient the glyph: rotate by 180 degrees around the bisector of the x axis and the vector
+      vtkMath::Identity3x3(glyphMatrix);
+      if (this->Filter->Orient && (vMag > 0.0))
+        {
+        double axis[3] = { 0.0, 0.0, 0.0 };
+        // if there is no y or z component, just flip x if we need to
+        if ( v[1] == 0.0 && v[2] == 0.0 )
+          {
+          if (v[0] < 0)
+            {
+            axis[1] = 1.0;
+            }
+          }
+        else
+          {
+          axis[0] = (v[0]+vMag)/2.0;
+          axis[1] = v[1]/2.0;
+          axis[2] = v[2]/2.0;
+          vtkMath::Normalize(axis);
+          }
+        if (axis[0] != 0.0 || axis[1] != 0.0 || axis[2] != 0.0)
+          {
+          for (int row = 0; row < 3; row++)
+            {
+            for (int col = 0; col < 3; col++)
+              {
+              glyphMatrix[row][col] = 2.0 * axis[row] * axis[col] - (row == col ? 1.0 : 0.0);
+              }
+            }
+          }
+        }
+
+      // Scale data if appropriate
+      if ( this->Filter->Scaling )
+        {
+        double scale[3] = { 1.0, 1.0, 1.0 };
+        if ( this->Filter->ScaleDirectional )
+          {
+          scale[0] = vMag * this->Filter->ScaleFactor;
+          if ( scale[0] == 0.0 )
+            {
+            scale[0] = 1.0e-10;
+            }
+          }
+        else
+          {
+          double uniformScale = this->Filter->ScaleFactor;
+          if (this->Filter->ScaleMode==VTK_SCALE_BY_SCALAR)
+            {
+            uniformScale *= this->InCScalars->GetComponent(inPtId, 0);
+            }
+          else
+            {
+            uniformScale *= vMag;
+            }
+          if ( uniformScale == 0.0 )
+            {
+            uniformScale = 1.0e-10;
+            }
+          scale[0] = scale[1] = scale[2] = uniformScale;
+          }
+        for (int row = 0; row < 3; row++)
+          {
+          for (int col = 0; col < 3; col++)
+            {
+            glyphMatrix[row][col] *= scale[col];
+            }
+          }
+        }
+
+      // Translate the oriented and scaled source points to the input point and copy point data
+      vtkIdType outPtId = glyphId * numSourcePts;
+      for (vtkIdType i=0; i < numSourcePts; i++, outPtId++)
+        {
+        this->SourcePts->GetPoint(i, sourcePt);
+        vtkMath::Multiply3x3(glyphMatrix, sourcePt, outPt);
+        outPt[0] += inPt[0];
+        outPt[1] += inPt[1];
+        outPt[2] += inPt[2];
+        this->NewPts->SetPoint(outPtId, outPt);
+        this->NewScalars->SetTuple(outPtId, inPtId, this->InCScalars);
+        }
+      }
+  }
+
+private:
+  vtkTransformVisualizerGlyph3D* Filter;
+  vtkDataSet* Input;
+  const std::vector<vtkIdType>& GlyphPointIds;
+  vtkDataArray* InVectors;
+  vtkDataArray* InCScalars;
+  vtkPoints* SourcePts;
+  vtkPoints* NewPts;
+  vtkDataArray* NewScalars;
+};
+
 //------------------------------------------------------------------------------
 int vtkTransformVisualizerGlyph3D::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -91,6 +224,20 @@ int vtkTransformVisualizerGlyph3D::RequestData(
     return 1;
     }
 
+  // Select the input points that are represented by a glyph
+  std::vector<vtkIdType> glyphPointIds;
+  glyphPointIds.reserve(numPts);
+  for (vtkIdType inPtId=0; inPtId < numPts; inPtId++)
+    {
+    double scalarValue = inCScalars->GetComponent(inPtId, 0);
+    if (this->MagnitudeThresholding && (scalarValue<this->MagnitudeThresholdLower || scalarValue>this->MagnitudeThresholdUpper))
+      {
+      continue;
+      }
+    glyphPointIds.push_back(inPtId);
+    }
+  vtkIdType numGlyphs = static_cast<vtkIdType>(glyphPointIds.size());
+
   // Allocate storage for output PolyData
   outputPD->CopyVectorsOff();
   outputPD->CopyNormalsOff();
@@ -103,144 +250,74 @@ int vtkTransformVisualizerGlyph3D::RequestData(
 
   // Prepare to copy output.
   vtkPointData *pd = input->GetPointData();
-  outputPD->CopyAllocate(pd,numPts*numSourcePts);
+  outputPD->CopyAllocate(pd,numGlyphs*numSourcePts);
 
   vtkNew<vtkPoints> newPts;
-  newPts->Allocate(numPts*numSourcePts);
+  newPts->SetNumberOfPoints(numGlyphs*numSourcePts);
 
   vtkSmartPointer<vtkDataArray> newScalars=vtkSmartPointer<vtkDataArray>::Take(inCScalars->NewInstance());
   newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
-  newScalars->Allocate(inCScalars->GetNumberOfComponents()*numPts*numSourcePts);
+  newScalars->SetNumberOfTuples(numGlyphs*numSourcePts);
   newScalars->SetName(inCScalars->GetName());
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  output->Allocate(source, 3*numPts*numSourceCells, numPts*numSourceCells);
-
-  vtkSmartPointer<vtkPoints> transformedSourcePts = vtkSmartPointer<vtkPoints>::New();
-  transformedSourcePts->SetDataTypeToDouble();
-  transformedSourcePts->Allocate(numSourcePts);
+  // The source transform is the same for all glyphs, therefore it is applied only once
+  vtkSmartPointer<vtkPoints> glyphSourcePts = sourcePts;
+  if (this->SourceTransform)
+    {
+    glyphSourcePts = vtkSmartPointer<vtkPoints>::New();
+    glyphSourcePts->SetDataTypeToDouble();
+    glyphSourcePts->Allocate(numSourcePts);
+    this->SourceTransform->TransformPoints(sourcePts, glyphSourcePts);
+    }
 
-  vtkNew<vtkTransform> trans;
+  // Copy all topology (transformation independent)
+  std::vector<int> sourceCellTypes(numSourceCells);
+  std::vector< std::vector<vtkIdType> > sourceCellPointIds(numSourceCells);
+  vtkNew<vtkIdList> cellPts;
+  for (vtkIdType cellId=0; cellId < numSourceCells; cellId++)
+    {
+    sourceCellTypes[cellId] = source->GetCellType(cellId);
+    source->GetCellPoints(cellId, cellPts.GetPointer());
+    for (vtkIdType i=0; i < cellPts->GetNumberOfIds(); i++)
+      {
+      sourceCellPointIds[cellId].push_back(cellPts->GetId(i));
+      }
+    }
 
-  vtkNew<vtkIdList> pts;
-  pts->Allocate(VTK_CELL_SIZE);
+  // Setting up for calls to PolyData::InsertNextCell()
+  output->Allocate(source, 3*numGlyphs*numSourceCells, numGlyphs*numSourceCells);
 
-  // Traverse all Input points, transforming Source points and copying
-  // point attributes.
+  std::vector<vtkIdType> pts(VTK_CELL_SIZE);
   vtkIdType ptIncr=0;
-  vtkIdType cellIncr=0;
-  double v[3] = {0};
-  for (vtkIdType inPtId=0; inPtId < numPts; inPtId++)
+  for (vtkIdType glyphId=0; glyphId < numGlyphs; glyphId++)
     {
-    if ( ! (inPtId % 10000) )
+    if ( ! (glyphId % 10000) )
       {
-      this->UpdateProgress(static_cast<double>(inPtId)/numPts);
+      this->UpdateProgress(0.5*glyphId/numGlyphs);
       if (this->GetAbortExecute())
         {
         break;
         }
       }
-
-    // Get the scalar and vector data
-    double scalarValue = inCScalars->GetComponent(inPtId, 0);
-    if (this->MagnitudeThresholding && (scalarValue<this->MagnitudeThresholdLower || scalarValue>this->MagnitudeThresholdUpper))
-      {
-      continue;
-      }
-
-    inVectors->GetTuple(inPtId, v);
-    double vMag = vtkMath::Norm(v);
-
-    // Now begin copying/transforming glyph
-    trans->Identity();
-
-    // Copy all topology (transformation independent)
     for (vtkIdType cellId=0; cellId < numSourceCells; cellId++)
       {
-      vtkCell *cell = source->GetCell(cellId);
-      vtkIdList *cellPts = cell->GetPointIds();
-      int npts = cellPts->GetNumberOfIds();
-      pts->Reset();
+      const std::vector<vtkIdType>& cellPointIds = sourceCellPointIds[cellId];
+      vtkIdType npts = static_cast<vtkIdType>(cellPointIds.size());
+      pts.resize(npts);
       for (vtkIdType i=0; i < npts; i++)
         {
-        pts->InsertId(i,cellPts->GetId(i) + ptIncr);
+        pts[i] = cellPointIds[i] + ptIncr;
         }
-      output->InsertNextCell(cell->GetCellType(),pts.GetPointer());
+      output->InsertNextCell(sourceCellTypes[cellId], npts, npts > 0 ? &pts[0] : NULL);
       }
-
-    // translate Source to Input point
-    trans->Translate(input->GetPoint(inPtId));
-
-    // Orient the glyph
-    if (this->Orient && (vMag > 0.0))
-      {
-      // if there is no y or z component
-      if ( v[1] == 0.0 && v[2] == 0.0 )
-        {
-        if (v[0] < 0) //just flip x if we need to
-          {
-          trans->RotateWXYZ(180.0,0,1,0);
-          }
-        }
-      else
-        {
-        trans->RotateWXYZ(180.0, (v[0]+vMag)/2.0, v[1]/2.0, v[2]/2.0);
-        }
-      }
-
-    // Scale data if appropriate
-    if ( this->Scaling )
-      {
-      if ( this->ScaleDirectional )
-        {
-        double scale = vMag * this->ScaleFactor;
-        if ( scale == 0.0 )
-          {
-          scale = 1.0e-10;
-          }
-        trans->Scale(scale,1.0,1.0);
-        }
-      else
-        {
-        double scale = this->ScaleFactor;
-        if (this->ScaleMode==VTK_SCALE_BY_SCALAR)
-          {
-          scale *= scalarValue;
-          }
-        else
-          {
-          scale *= vMag;
-          }
-        if ( scale == 0.0 )
-          {
-          scale = 1.0e-10;
-          }
-        trans->Scale(scale,scale,scale);
-        }
-      }
-
-    // Multiply points and normals by resulting matrix
-    if (this->SourceTransform)
-      {
-      transformedSourcePts->Reset();
-      this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts);
-      trans->TransformPoints(transformedSourcePts, newPts.GetPointer());
-      }
-    else
-      {
-      trans->TransformPoints(sourcePts,newPts.GetPointer());
-      }
-
-    // Copy point data from source
-    for (vtkIdType i=0; i < numSourcePts; i++)
-      {
-      outputPD->CopyTuple(inCScalars, newScalars, inPtId, ptIncr+i);
-      }
-
     ptIncr += numSourcePts;
-    cellIncr += numSourceCells;
     }
 
+  // Transform source points and copy point attributes for all glyphs
+  vtkGenerateGlyphsWorker worker(this, input, glyphPointIds, inVectors, inCScalars,
+    glyphSourcePts, newPts.GetPointer(), newScalars);
+  vtkSMPTools::For(0, numGlyphs, worker);
+
   // Update ourselves and release memory
   output->SetPoints(newPts.GetPointer());
 
@@ -34,7 +34,8 @@
 ///   is scaled with the vector magnitude
 /// - use a different scalar for scaling and coloring
 /// - generate glyphs only if the corresponding scalar is in specified range
-/// - simplified, optimized generation of glyphs
+/// - simplified, optimized generation of glyphs: the glyph geometry is computed
+///   in parallel for all points
 ///
 /// Supported options:
 /// - Scaling: VTK_SCALE_BY_SCALAR and VTK_SCALE_BY_VECTOR
@@ -90,6 +91,8 @@ protected:
 
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
 
+  class vtkGenerateGlyphsWorker;
+
 private:
   vtkTransformVisualizerGlyph3D(const vtkTransformVisualizerGlyph3D&);  // Not implemented.
   void operator=(const vtkTransformVisualizerGlyph3D&);  // Not implemented.
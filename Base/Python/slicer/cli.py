@@ -88,5 +88,29 @@ def run(module, node = None, parameters = None, wait_for_completion = False, del
   #widget.apply()
   return node
 
+def runBatch(module, nodes, maximum_number_of_jobs=0, number_of_threads_per_job=0, delete_temporary_files=True, update_display=False):
+  """Run a CLI once for each parameter node of a list and wait for all of them
+  to complete. Executable CLIs are run at the same time. Returns the time in
+  seconds taken by each run.
+  nodes: list of parameter nodes, for example clones of a parameter node
+  maximum_number_of_jobs: maximum number of CLIs run at the same time (0 by default: number of processors)
+  number_of_threads_per_job: number of ITK threads of each CLI (0 by default: processors shared among CLIs)
+  delete_temporary_files: remove temp files created during execution (True by default)
+  update_display: show output nodes after completion (False by default)
+  """
+  import vtk
+  collection = vtk.vtkCollection()
+  for node in nodes:
+    collection.AddItem(node)
+
+  logic = module.logic()
+
+  logic.SetDeleteTemporaryFiles(1 if delete_temporary_files else 0)
+  logic.SetMaximumNumberOfBatchJobs(maximum_number_of_jobs)
+  logic.SetNumberOfThreadsPerBatchJob(number_of_threads_per_job)
+
+  logic.ApplyBatch(collection, update_display)
+  return [logic.GetBatchJobTime(job) for job in range(len(nodes))]
+
 def cancel(node):
   print "Not yet implemented"
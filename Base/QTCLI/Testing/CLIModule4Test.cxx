@@ -14,6 +14,7 @@
 #include "CLIModule4TestCLP.h"
 
 // STD includes
+#include <cstdlib>
 #include <fstream>
 
 // Use an anonymous namespace to keep class types and function names
@@ -60,6 +61,11 @@ int main(int argc, char * argv[])
     {
     result = InputValue1 * InputValue2;
     }
+  else if (OperationType == std::string("Crash"))
+    {
+    // terminate abnormally, as a CLI that crashes
+    abort();
+    }
   else
     {
     std::cerr << "Unknown OperationType:" << OperationType << std::endl;
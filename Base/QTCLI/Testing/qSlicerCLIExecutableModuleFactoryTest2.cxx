@@ -0,0 +1,383 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QRegExp>
+#include <QScopedPointer>
+#include <QSettings>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTime>
+
+// SlicerQt includes
+#include "qSlicerApplication.h"
+#include "qSlicerCLIExecutableModuleFactory.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+#ifndef _WIN32
+#include <utime.h>
+#endif
+
+namespace
+{
+
+#ifndef _WIN32
+//-----------------------------------------------------------------------------
+/// Write a CLI executable printing a description titled \a title when run
+/// with "--xml" and logging each run in runs.log next to it.
+bool writeCLI(const QString& directory, const QString& name,
+              const QString& title, bool reportErrors = false)
+{
+  QString fileName = QDir(directory).filePath(name);
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+    return false;
+    }
+  QTextStream stream(&file);
+  stream << "#!/bin/sh\n"
+         << "cat <<EOF\n"
+         << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+         << "<executable>\n"
+         << "  <category>Testing</category>\n"
+         << "  <title>" << title << "</title>\n"
+         << "  <description>Description cache test</description>\n"
+         << "  <version>1.0</version>\n"
+         << "  <parameters>\n"
+         << "    <label>Parameters</label>\n"
+         << "    <description>Parameters</description>\n"
+         << "    <string>\n"
+         << "      <name>value</name>\n"
+         << "      <longflag>value</longflag>\n"
+         << "      <label>Value</label>\n"
+         << "      <description>Value</description>\n"
+         << "      <default>0</default>\n"
+         << "    </string>\n"
+         << "  </parameters>\n"
+         << "</executable>\n"
+         << "EOF\n";
+  if (reportErrors)
+    {
+    stream << "echo \"Failed to load plugins\" >&2\n";
+    }
+  // The CLI is run in its directory. Logging last lets the test know the
+  // process is about to exit.
+  stream << "echo " << name << " >> runs.log\n";
+  stream.flush();
+  file.close();
+  return file.setPermissions(file.permissions() | QFile::ExeOwner);
+}
+
+//-----------------------------------------------------------------------------
+/// Names of the CLIs run with "--xml" since the log was last removed.
+QStringList runs(const QString& directory)
+{
+  QFile file(QDir(directory).filePath("runs.log"));
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+    return QStringList();
+    }
+  return QTextStream(&file).readAll().split('\n', QString::SkipEmptyParts);
+}
+
+//-----------------------------------------------------------------------------
+/// Wait until \a name is logged by its CLI, then give it time to exit.
+bool waitForRun(const QString& directory, const QString& name)
+{
+  QTime timer;
+  timer.start();
+  while (!runs(directory).contains(name))
+    {
+    if (timer.elapsed() > 10000)
+      {
+      return false;
+      }
+    QThread::msleep(10);
+    }
+  QThread::msleep(500);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Factory of the CLIs of a directory, as created at application startup.
+class FactoryTester
+{
+public:
+  FactoryTester(const QString& cliDirectory, const QString& cacheDirectory,
+                const QStringList& names)
+    : Factory(new qSlicerCLIExecutableModuleFactory)
+    {
+    this->Factory->setTempDirectory(cacheDirectory);
+    foreach(const QString& name, names)
+      {
+      this->Factory->registerFileItem(QFileInfo(QDir(cliDirectory).filePath(name)));
+      }
+    }
+  ~FactoryTester()
+    {
+    // The factory may or may not delete the modules it instantiated.
+    this->Factory.reset();
+    foreach(const QPointer<qSlicerAbstractCoreModule>& module, this->Modules)
+      {
+      delete module.data();
+      }
+    }
+
+  /// Instantiate the module of \a name and check its title.
+  bool instantiate(const QString& name, const QString& expectedTitle)
+    {
+    qSlicerAbstractCoreModule* module =
+      this->Factory->instantiate(this->Factory->fileNameToKey(name));
+    if (!module)
+      {
+      std::cerr << "Failed to instantiate " << qPrintable(name) << std::endl;
+      return false;
+      }
+    this->Modules << module;
+    if (module->title() != expectedTitle)
+      {
+      std::cerr << "Wrong description for " << qPrintable(name) << std::endl
+                << "  title: " << qPrintable(module->title()) << std::endl
+                << "  expected: " << qPrintable(expectedTitle) << std::endl;
+      return false;
+      }
+    return true;
+    }
+
+private:
+  QScopedPointer<qSlicerCLIExecutableModuleFactory> Factory;
+  QList<QPointer<qSlicerAbstractCoreModule> > Modules;
+};
+
+//-----------------------------------------------------------------------------
+/// Replace the cached title of the CLI \a fileName.
+bool setCachedTitle(const QString& cacheFileName, const QString& fileName,
+                    const QString& title)
+{
+  QSettings cache(cacheFileName, QSettings::IniFormat);
+  foreach(const QString& group, cache.childGroups())
+    {
+    cache.beginGroup(group);
+    if (cache.value("Path").toString() == QFileInfo(fileName).absoluteFilePath())
+      {
+      QString description = cache.value("Description").toString();
+      description.replace(QRegExp("<title>.*</title>"),
+                          QString("<title>%1</title>").arg(title));
+      cache.setValue("Description", description);
+      cache.endGroup();
+      return true;
+      }
+    cache.endGroup();
+    }
+  return false;
+}
+#endif
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIExecutableModuleFactoryTest2(int argc, char * argv[])
+{
+  qSlicerApplication::setAttribute(qSlicerApplication::AA_DisablePython);
+  qSlicerApplication app(argc, argv);
+
+#ifdef _WIN32
+  std::cout << "Shell script CLIs are not supported on Windows" << std::endl;
+  return EXIT_SUCCESS;
+#else
+  QTemporaryDir temporaryDirectory;
+  if (!temporaryDirectory.isValid()
+      || !QDir(temporaryDirectory.path()).mkdir("cli")
+      || !QDir(temporaryDirectory.path()).mkdir("cache"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create temporary directories" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString cliDirectory = QDir(temporaryDirectory.path()).filePath("cli");
+  QString cacheDirectory = QDir(temporaryDirectory.path()).filePath("cache");
+  QString cacheFileName = QDir(cacheDirectory).filePath("CLIXmlDescriptionCache.ini");
+
+  // More CLIs than can be run ahead, plus one reporting errors which sorts
+  // last.
+  int numberOfProcesses = qMax(QThread::idealThreadCount(), 1);
+  QStringList names;
+  for (int i = 0; i < numberOfProcesses + 3; ++i)
+    {
+    names << QString("DescriptionCacheTest%1").arg(i, 3, 10, QChar('0'));
+    }
+  QString errorName = QString("DescriptionCacheTest%1").arg(names.count(), 3, 10, QChar('0'));
+  foreach(const QString& name, names)
+    {
+    if (!writeCLI(cliDirectory, name, name))
+      {
+      std::cerr << "Line " << __LINE__ << " - Failed to write CLI" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (!writeCLI(cliDirectory, errorName, errorName, true))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write CLI" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QStringList allNames = names;
+  allNames << errorName;
+
+  // First startup: the descriptions are retrieved by running the CLIs with
+  // "--xml", ahead of the instantiation of their module.
+  {
+  FactoryTester startup(cliDirectory, cacheDirectory, allNames);
+
+  // A module instantiated out of order, as a dependency is: the first CLIs
+  // are started ahead.
+  QString lastName = names[names.count() - 1];
+  if (!startup.instantiate(lastName, lastName))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to instantiate module" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int i = 0; i < numberOfProcesses; ++i)
+    {
+    if (!waitForRun(cliDirectory, names[i]))
+      {
+      std::cerr << "Line " << __LINE__ << " - CLI " << qPrintable(names[i])
+                << " is not started ahead" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The CLIs started ahead finished but their module is not instantiated:
+  // their slots are free for the CLIs that are not started yet.
+  QString nextToLastName = names[names.count() - 2];
+  if (!startup.instantiate(nextToLastName, nextToLastName))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to instantiate module" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!waitForRun(cliDirectory, names[numberOfProcesses]))
+    {
+    std::cerr << "Line " << __LINE__ << " - CLI " << qPrintable(names[numberOfProcesses])
+              << " is not started once the CLIs started ahead finished" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The other modules get the description of their own CLI, whatever the
+  // order they are instantiated in.
+  for (int i = allNames.count() - 1; i >= 0; --i)
+    {
+    if (allNames[i] == lastName || allNames[i] == nextToLastName)
+      {
+      continue;
+      }
+    if (!startup.instantiate(allNames[i], allNames[i]))
+      {
+      std::cerr << "Line " << __LINE__ << " - Failed to instantiate module" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  }
+  // Each CLI is run once, even when started ahead
+  QStringList runNames = runs(cliDirectory);
+  foreach(const QString& name, allNames)
+    {
+    if (runNames.count(name) != 1)
+      {
+      std::cerr << "Line " << __LINE__ << " - CLI " << qPrintable(name) << " run "
+                << runNames.count(name) << " times instead of once" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Second startup: the cached descriptions are used, except for the CLI
+  // reporting errors, which is not cached.
+  if (!setCachedTitle(cacheFileName, QDir(cliDirectory).filePath(names[0]), "CachedTitle"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Description of " << qPrintable(names[0])
+              << " is not cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (setCachedTitle(cacheFileName, QDir(cliDirectory).filePath(errorName), "CachedTitle"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Description of a CLI reporting errors is cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QFile::remove(QDir(cliDirectory).filePath("runs.log"));
+  {
+  FactoryTester startup(cliDirectory, cacheDirectory, allNames);
+  foreach(const QString& name, allNames)
+    {
+    if (!startup.instantiate(name, name == names[0] ? QString("CachedTitle") : name))
+      {
+      std::cerr << "Line " << __LINE__ << " - Cached description is not used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  }
+  if (runs(cliDirectory) != QStringList(errorName))
+    {
+    std::cerr << "Line " << __LINE__ << " - CLIs run despite cached descriptions: "
+              << qPrintable(runs(cliDirectory).join(" ")) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Third startup: the CLIs whose size or modification time changed are run
+  // again.
+  if (!writeCLI(cliDirectory, names[0], "ModifiedTitle"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write CLI" << std::endl;
+    return EXIT_FAILURE;
+    }
+  struct utimbuf times;
+  times.actime = 1000000000;
+  times.modtime = 1000000000;
+  if (utime(QDir(cliDirectory).filePath(names[1]).toLatin1().constData(), &times) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to set modification time" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QFile::remove(QDir(cliDirectory).filePath("runs.log"));
+  {
+  FactoryTester startup(cliDirectory, cacheDirectory, allNames);
+  foreach(const QString& name, allNames)
+    {
+    if (!startup.instantiate(name, name == names[0] ? QString("ModifiedTitle") : name))
+      {
+      std::cerr << "Line " << __LINE__ << " - Outdated description is used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  }
+  runNames = runs(cliDirectory);
+  runNames.sort();
+  QStringList expectedRunNames;
+  expectedRunNames << names[0] << names[1] << errorName;
+  if (runNames != expectedRunNames)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected CLIs run: "
+              << qPrintable(runNames.join(" ")) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,326 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// SlicerQt includes
+#include "qSlicerApplication.h"
+#include "qSlicerCLIExecutableModuleFactory.h"
+#include "qSlicerCLIModule.h"
+#include "qSlicerModuleFactoryManager.h"
+#include "qSlicerModuleManager.h"
+
+// MRMLCLI includes
+#include <vtkMRMLCommandLineModuleNode.h>
+#include <vtkSlicerCLIModuleLogic.h>
+
+// ITKSys includes
+#include <itksys/Process.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+#ifndef _WIN32
+//-----------------------------------------------------------------------------
+/// Write the command line of an invocation in the format expected by the
+/// resident process: argument count, then length and characters of each argument.
+bool sendRequest(int requestPipe, const std::vector<std::string>& arguments)
+{
+  std::ostringstream request;
+  request << arguments.size() << "\n";
+  for (size_t i = 0; i < arguments.size(); ++i)
+    {
+    request << arguments[i].size() << "\n" << arguments[i] << "\n";
+    }
+  std::string data = request.str();
+  return write(requestPipe, data.c_str(), data.size()) == static_cast<ssize_t>(data.size());
+}
+
+//-----------------------------------------------------------------------------
+/// Read the output of the resident process until it reports the end of an
+/// invocation. Returns the exit value of the invocation, or -1 on timeout.
+int waitForInvocation(itksysProcess* process, std::string& stdoutBuffer, std::string& stderrBuffer)
+{
+  const std::string endTag = "</slicer-cli-server-exit>";
+  const std::string startTag = "<slicer-cli-server-exit>";
+  double timeout = 30.0;
+  char* data = 0;
+  int length = 0;
+  int pipe = 0;
+  while (stdoutBuffer.find(endTag) == std::string::npos
+         && (pipe = itksysProcess_WaitForData(process, &data, &length, &timeout)) != 0
+         && pipe != itksysProcess_Pipe_Timeout)
+    {
+    (pipe == itksysProcess_Pipe_STDOUT ? stdoutBuffer : stderrBuffer).append(data, length);
+    }
+  std::string::size_type tagEnd = stdoutBuffer.find(endTag);
+  std::string::size_type tagStart = stdoutBuffer.rfind(startTag, tagEnd);
+  if (tagEnd == std::string::npos || tagStart == std::string::npos)
+    {
+    return -1;
+    }
+  int exitValue = atoi(stdoutBuffer.substr(tagStart + startTag.size(), tagEnd - tagStart - startTag.size()).c_str());
+  stdoutBuffer.erase(0, tagEnd + endTag.size());
+  return exitValue;
+}
+
+//-----------------------------------------------------------------------------
+QString readResult(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+    return QString();
+    }
+  QTextStream stream(&file);
+  return stream.readAll().trimmed();
+}
+
+//-----------------------------------------------------------------------------
+/// Run invocations through the request pipe of the executable, as
+/// vtkSlicerCLIModuleLogic does in server mode.
+bool testServerProtocol(const QString& executable, const QString& temporaryDirectory)
+{
+  QString requestPipeName = temporaryDirectory + "/server.fifo";
+  if (mkfifo(requestPipeName.toLatin1().constData(), S_IRUSR | S_IWUSR) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create request pipe" << std::endl;
+    return false;
+    }
+  int requestPipe = open(requestPipeName.toLatin1().constData(), O_RDWR | O_CLOEXEC);
+  if (requestPipe < 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to open request pipe" << std::endl;
+    return false;
+    }
+
+  std::string executableString = executable.toStdString();
+  std::string requestPipeNameString = requestPipeName.toStdString();
+  const char* command[] = { executableString.c_str(), "--slicer-cli-server", requestPipeNameString.c_str(), 0 };
+  itksysProcess* process = itksysProcess_New();
+  itksysProcess_SetCommand(process, command);
+  itksysProcess_Execute(process);
+  bool success = (itksysProcess_GetState(process) == itksysProcess_State_Executing);
+  if (!success)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to start " << executableString << std::endl;
+    }
+
+  // Arguments may contain spaces and line breaks
+  QString outputFileName = temporaryDirectory + "/output file\nwith line break.txt";
+  std::string stdoutBuffer;
+  std::string stderrBuffer;
+  const char* operations[] = { "Addition", "Multiplication", "Fail", "Addition" };
+  const char* expectedResults[] = { "7", "12", "", "7" };
+  for (int i = 0; success && i < 4; ++i)
+    {
+    QFile::remove(outputFileName);
+    std::vector<std::string> arguments;
+    arguments.push_back(executableString);
+    arguments.push_back("--inputvalue1");
+    arguments.push_back("4");
+    arguments.push_back("--inputvalue2");
+    arguments.push_back("3");
+    arguments.push_back("--operationtype");
+    arguments.push_back(operations[i]);
+    arguments.push_back(outputFileName.toStdString());
+    if (!sendRequest(requestPipe, arguments))
+      {
+      std::cerr << "Line " << __LINE__ << " - Failed to send request " << i << std::endl;
+      success = false;
+      break;
+      }
+    int exitValue = waitForInvocation(process, stdoutBuffer, stderrBuffer);
+    bool expectedFailure = (QString(operations[i]) == "Fail");
+    if (exitValue != (expectedFailure ? EXIT_FAILURE : EXIT_SUCCESS))
+      {
+      std::cerr << "Line " << __LINE__ << " - Unexpected exit value of invocation " << i
+                << ": " << exitValue << std::endl << stderrBuffer << std::endl;
+      success = false;
+      break;
+      }
+    if (readResult(outputFileName) != QString(expectedResults[i]))
+      {
+      std::cerr << "Line " << __LINE__ << " - Unexpected result of invocation " << i
+                << ": " << qPrintable(readResult(outputFileName)) << std::endl;
+      success = false;
+      break;
+      }
+    }
+  if (success && stderrBuffer.find("Unknown OperationType:Fail") == std::string::npos)
+    {
+    std::cerr << "Line " << __LINE__ << " - Error output of failed invocation is missing" << std::endl;
+    success = false;
+    }
+
+  // Closing the request pipe makes the process exit
+  close(requestPipe);
+  double timeout = 10.0;
+  itksysProcess_WaitForExit(process, &timeout);
+  if (success && (itksysProcess_GetState(process) != itksysProcess_State_Exited
+                  || itksysProcess_GetExitValue(process) != EXIT_SUCCESS))
+    {
+    std::cerr << "Line " << __LINE__ << " - Process did not exit when the request pipe was closed" << std::endl;
+    success = false;
+    }
+  if (itksysProcess_GetState(process) == itksysProcess_State_Executing)
+    {
+    itksysProcess_Kill(process);
+    itksysProcess_WaitForExit(process, 0);
+    }
+  itksysProcess_Delete(process);
+  QFile::remove(requestPipeName);
+  return success;
+}
+
+//-----------------------------------------------------------------------------
+/// Run the module in server mode and return the result written to the output file
+QString runModule(vtkSlicerCLIModuleLogic* logic, const char* operation,
+                  const QString& outputFileName, int& status, std::string& errorText)
+{
+  QFile::remove(outputFileName);
+  vtkMRMLCommandLineModuleNode* node = logic->CreateNodeInScene();
+  node->SetParameterAsInt("InputValue1", 4);
+  node->SetParameterAsInt("InputValue2", 3);
+  node->SetParameterAsString("OperationType", operation);
+  node->SetParameterAsString("OutputFile", outputFileName.toStdString());
+  logic->ApplyAndWait(node, false);
+  status = node->GetStatus();
+  errorText = node->GetErrorText();
+  return readResult(outputFileName);
+}
+#endif
+
+} // end anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIServerModeTest1(int argc, char * argv[])
+{
+  qSlicerApplication::setAttribute(qSlicerApplication::AA_DisablePython);
+  qSlicerApplication app(argc, argv);
+
+#ifdef _WIN32
+  std::cout << "Server mode is not supported on Windows" << std::endl;
+  return EXIT_SUCCESS;
+#else
+  // The CLIModule4Test module has already been built as an executable CLI
+  // (with SEMCommandLineLibraryWrapper). It can be found in
+  // Slicer-build/lib/Slicer-X.Y/cli-modules[/Debug|Release]
+  QString cliPath = app.slicerHome() + "/" + Slicer_CLIMODULES_BIN_DIR + "/";
+  QString executable = cliPath + "CLIModule4Test";
+  if (!QFileInfo(executable).isExecutable())
+    {
+    executable = cliPath + app.intDir() + "/CLIModule4Test";
+    }
+  if (!QFileInfo(executable).isExecutable())
+    {
+    std::cerr << "Line " << __LINE__ << " - CLIModule4Test executable not found in " << qPrintable(cliPath) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QTemporaryDir temporaryDirectory;
+  if (!temporaryDirectory.isValid())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create temporary directory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Request pipe protocol of the executable
+
+  if (!testServerProtocol(executable, temporaryDirectory.path()))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Server mode of the module logic
+
+  qSlicerModuleFactoryManager* moduleFactoryManager = app.moduleManager()->factoryManager();
+  moduleFactoryManager->registerFactory(new qSlicerCLIExecutableModuleFactory);
+  moduleFactoryManager->addSearchPath(QFileInfo(executable).absolutePath());
+  moduleFactoryManager->registerModules();
+  moduleFactoryManager->instantiateModules();
+  moduleFactoryManager->loadModule("CLI4Test");
+  qSlicerCLIModule* cliModule = qobject_cast<qSlicerCLIModule*>(app.moduleManager()->module("CLI4Test"));
+  if (!cliModule)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to load executable module CLI4Test" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkSlicerCLIModuleLogic* logic = cliModule->cliModuleLogic();
+  logic->SetServerMode(1);
+
+  QString outputFileName = temporaryDirectory.path() + "/output.txt";
+  int status = vtkMRMLCommandLineModuleNode::Idle;
+  std::string errorText;
+
+  QString result = runModule(logic, "Addition", outputFileName, status, errorText);
+  if (result != "7" || (status & vtkMRMLCommandLineModuleNode::ErrorsMask))
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected result in server mode: " << qPrintable(result) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Error output written just before the end of the invocation is reported
+  result = runModule(logic, "Fail", outputFileName, status, errorText);
+  if (!(status & vtkMRMLCommandLineModuleNode::ErrorsMask)
+      || errorText.find("Unknown OperationType:Fail") == std::string::npos)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed invocation is not reported: " << errorText << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Resident process crashes during an invocation
+  result = runModule(logic, "Crash", outputFileName, status, errorText);
+  if (!(status & vtkMRMLCommandLineModuleNode::ErrorsMask))
+    {
+    std::cerr << "Line " << __LINE__ << " - Crash is not reported, status: " << status << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Resident process is restarted for the next invocations
+  for (int i = 0; i < 2; ++i)
+    {
+    result = runModule(logic, "Addition", outputFileName, status, errorText);
+    if (result != "7" || (status & vtkMRMLCommandLineModuleNode::ErrorsMask))
+      {
+      std::cerr << "Line " << __LINE__ << " - Unexpected result after crash: " << qPrintable(result) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  logic->SetServerMode(0);
+  return EXIT_SUCCESS;
+#endif
+}
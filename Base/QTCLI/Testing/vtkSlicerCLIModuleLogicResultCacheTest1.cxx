@@ -0,0 +1,290 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QTemporaryDir>
+
+// MRMLCLI includes
+#include <vtkSlicerCLIModuleLogic.h>
+
+// SlicerExecutionModel includes
+#include <ModuleDescription.h>
+#include <ModuleParameter.h>
+#include <ModuleParameterGroup.h>
+
+// ITKSys includes
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+ModuleParameter createParameter(const std::string& tag, const std::string& name,
+                                const std::string& channel, const std::string& value)
+{
+  ModuleParameter parameter;
+  parameter.SetTag(tag);
+  parameter.SetName(name);
+  parameter.SetLongFlag(name);
+  parameter.SetChannel(channel);
+  parameter.SetValue(value);
+  return parameter;
+}
+
+//-----------------------------------------------------------------------------
+bool writeFile(const std::string& fileName, const std::string& content)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << content;
+  return file.good();
+}
+
+//-----------------------------------------------------------------------------
+/// Command line as built by the logic: point coordinates are resolved from
+/// the fiducial node, nodes are replaced by the files they are written to.
+std::vector<std::string> commandLine(const std::string& seeds,
+                                     const std::string& inputFileName,
+                                     const std::string& outputFileName,
+                                     const std::string& returnParameterFileName)
+{
+  std::vector<std::string> arguments;
+  arguments.push_back("/path/to/ResultCacheTest");
+  arguments.push_back("--seeds");
+  arguments.push_back(seeds);
+  arguments.push_back("--returnparameterfile");
+  arguments.push_back(returnParameterFileName);
+  arguments.push_back(inputFileName);
+  arguments.push_back(outputFileName);
+  return arguments;
+}
+
+//-----------------------------------------------------------------------------
+std::string computeKey(const ModuleDescription& description,
+                       const std::string& seeds,
+                       const std::string& inputFileName,
+                       const std::string& outputFileName,
+                       const std::string& returnParameterFileName,
+                       std::map<std::string, std::string>& cachedOutputs)
+{
+  std::map<std::string, std::string> nodesToWrite;
+  nodesToWrite["vtkMRMLScalarVolumeNode1"] = inputFileName;
+  std::map<std::string, std::string> nodesToReload;
+  nodesToReload["vtkMRMLScalarVolumeNode2"] = outputFileName;
+  nodesToReload["vtkMRMLCommandLineModuleNode1"] = returnParameterFileName;
+  return vtkSlicerCLIModuleLogic::ComputeResultCacheKey(description,
+    commandLine(seeds, inputFileName, outputFileName, returnParameterFileName),
+    "vtkMRMLCommandLineModuleNode1", nodesToWrite, nodesToReload, cachedOutputs);
+}
+
+//-----------------------------------------------------------------------------
+bool setLastUsed(const std::string& entryDirectory, long lastUsed)
+{
+  struct utimbuf times;
+  times.actime = lastUsed;
+  times.modtime = lastUsed;
+  return utime((entryDirectory + "/.lastused").c_str(), &times) == 0;
+}
+
+//-----------------------------------------------------------------------------
+/// Cache entry of \a size bytes last used at \a lastUsed seconds.
+bool createEntry(const std::string& entryDirectory, size_t size, long lastUsed)
+{
+  return itksys::SystemTools::MakeDirectory(entryDirectory.c_str())
+    && writeFile(entryDirectory + "/output.nrrd", std::string(size, 'x'))
+    && writeFile(entryDirectory + "/.lastused", std::string())
+    && setLastUsed(entryDirectory, lastUsed);
+}
+
+//-----------------------------------------------------------------------------
+bool exists(const std::string& entryDirectory)
+{
+  return itksys::SystemTools::FileIsDirectory(entryDirectory.c_str());
+}
+
+//-----------------------------------------------------------------------------
+int testComputeResultCacheKey(const std::string& temporaryPath)
+{
+  ModuleParameterGroup group;
+  group.AddParameter(createParameter("point", "seeds", "input", "vtkMRMLMarkupsFiducialNode1"));
+  group.AddParameter(createParameter("image", "inputVolume", "input", "vtkMRMLScalarVolumeNode1"));
+  group.AddParameter(createParameter("image", "outputVolume", "output", "vtkMRMLScalarVolumeNode2"));
+  ModuleDescription description;
+  description.SetTitle("ResultCacheTest");
+  description.SetVersion("1.0");
+  description.SetTarget("/path/to/ResultCacheTest");
+  description.AddParameterGroup(group);
+
+  std::string input1 = temporaryPath + "/1234_vtkMRMLScalarVolumeNode1.nrrd";
+  std::string input2 = temporaryPath + "/5678_vtkMRMLScalarVolumeNode1.nrrd";
+  if (!writeFile(input1, "image") || !writeFile(input2, "image"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write input files" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::map<std::string, std::string> cachedOutputs;
+  std::string key = computeKey(description, "1,2,3", input1,
+    temporaryPath + "/1234_vtkMRMLScalarVolumeNode2.nrrd",
+    temporaryPath + "/1234_vtkMRMLCommandLineModuleNode1.params", cachedOutputs);
+  if (key.size() != 32)
+    {
+    std::cerr << "Line " << __LINE__ << " - Results are not cacheable: key is \""
+              << key << "\"" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (cachedOutputs.size() != 2
+      || cachedOutputs[temporaryPath + "/1234_vtkMRMLScalarVolumeNode2.nrrd"] != "outputVolume.nrrd"
+      || cachedOutputs[temporaryPath + "/1234_vtkMRMLCommandLineModuleNode1.params"] != "ReturnParameters.params")
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected cached outputs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // same inputs written to other temporary files
+  std::string otherKey = computeKey(description, "1,2,3", input2,
+    temporaryPath + "/5678_vtkMRMLScalarVolumeNode2.nrrd",
+    temporaryPath + "/5678_vtkMRMLCommandLineModuleNode1.params", cachedOutputs);
+  if (otherKey != key)
+    {
+    std::cerr << "Line " << __LINE__ << " - Key depends on temporary file names: "
+              << key << " != " << otherKey << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // moved fiducial: same node, other coordinates
+  std::string movedKey = computeKey(description, "1,2,4", input1,
+    temporaryPath + "/1234_vtkMRMLScalarVolumeNode2.nrrd",
+    temporaryPath + "/1234_vtkMRMLCommandLineModuleNode1.params", cachedOutputs);
+  if (movedKey.empty() || movedKey == key)
+    {
+    std::cerr << "Line " << __LINE__ << " - Key does not depend on point coordinates" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // modified input image
+  if (!writeFile(input2, "modified image"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write input file" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string modifiedKey = computeKey(description, "1,2,3", input2,
+    temporaryPath + "/5678_vtkMRMLScalarVolumeNode2.nrrd",
+    temporaryPath + "/5678_vtkMRMLCommandLineModuleNode1.params", cachedOutputs);
+  if (modifiedKey.empty() || modifiedKey == key)
+    {
+    std::cerr << "Line " << __LINE__ << " - Key does not depend on input files" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // data of header files is not taken into account
+  std::string header = temporaryPath + "/1234_vtkMRMLScalarVolumeNode1.nhdr";
+  if (!writeFile(header, "header"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write input file" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string headerKey = computeKey(description, "1,2,3", header,
+    temporaryPath + "/1234_vtkMRMLScalarVolumeNode2.nrrd",
+    temporaryPath + "/1234_vtkMRMLCommandLineModuleNode1.params", cachedOutputs);
+  if (!headerKey.empty())
+    {
+    std::cerr << "Line " << __LINE__ << " - Results with header input files are cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int testTrimResultCache(const std::string& temporaryPath)
+{
+  std::string cacheDirectory = temporaryPath + "/CLIResultCache";
+  std::string entry1 = cacheDirectory + "/entry1";
+  std::string entry2 = cacheDirectory + "/entry2";
+  std::string entry3 = cacheDirectory + "/entry3";
+  if (!createEntry(entry1, 1000, 1000)
+      || !createEntry(entry2, 1000, 2000)
+      || !createEntry(entry3, 1000, 3000))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create cache entries" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkSlicerCLIModuleLogic::TrimResultCache(cacheDirectory, 10000);
+  if (!exists(entry1) || !exists(entry2) || !exists(entry3))
+    {
+    std::cerr << "Line " << __LINE__ << " - Entries removed below the maximum size" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // least recently used entry
+  vtkSlicerCLIModuleLogic::TrimResultCache(cacheDirectory, 2500);
+  if (exists(entry1) || !exists(entry2) || !exists(entry3))
+    {
+    std::cerr << "Line " << __LINE__ << " - Least recently used entry is not removed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // entry2 used again, entry3 is now the least recently used
+  if (!setLastUsed(entry2, 4000))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to set last use of entry" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkSlicerCLIModuleLogic::TrimResultCache(cacheDirectory, 1500);
+  if (!exists(entry2) || exists(entry3))
+    {
+    std::cerr << "Line " << __LINE__ << " - Least recently used entry is not removed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogicResultCacheTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  QTemporaryDir temporaryDirectory;
+  if (!temporaryDirectory.isValid())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create temporary directory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string temporaryPath = temporaryDirectory.path().toStdString();
+
+  if (testComputeResultCacheKey(temporaryPath) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (testTrimResultCache(temporaryPath) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
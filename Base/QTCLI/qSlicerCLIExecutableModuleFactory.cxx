@@ -19,7 +19,10 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QProcess>
+#include <QThread>
 #if (QT_VERSION > QT_VERSION_CHECK(5, 0, 0))
 #include <QStandardPaths>
 #endif
@@ -55,7 +58,10 @@ QString findPython()
 
 //-----------------------------------------------------------------------------
 qSlicerCLIExecutableModuleFactoryItem::qSlicerCLIExecutableModuleFactoryItem(
-  const QString& newTempDirectory) : TempDirectory(newTempDirectory)
+  const QString& newTempDirectory, const QSharedPointer<QSettings>& xmlDescriptionCache)
+  : TempDirectory(newTempDirectory)
+  , CLIModule(0)
+  , XmlDescriptionCache(xmlDescriptionCache)
 {
 }
 
@@ -120,7 +126,11 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
     }
   else
     {
-    xmlDescription = this->runCLIWithXmlArgument();
+    xmlDescription = this->cachedXmlDescription();
+    if (xmlDescription.isEmpty())
+      {
+      xmlDescription = this->runCLIWithXmlArgument();
+      }
     }
   if (xmlDescription.isEmpty())
     {
@@ -139,17 +149,50 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
 }
 
 //-----------------------------------------------------------------------------
-QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+bool qSlicerCLIExecutableModuleFactoryItem::needsCLIWithXmlArgument()
 {
-  ctkScopedCurrentDir scopedCurrentDir(QFileInfo(this->path()).path());
+  return !QFile::exists(this->xmlModuleDescriptionFilePath())
+    && this->cachedXmlDescription().isEmpty();
+}
 
-  int cliProcessTimeoutInMs = 5000;
-  QProcess cli;
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::startCLIWithXmlArgument()
+{
+  if (!this->XmlProcess.isNull())
+    {
+    return;
+    }
+  this->XmlProcess.reset(new QProcess);
+  // The working directory is set on the process instead of changing the
+  // current directory as several CLIs may be started at the same time.
+  this->XmlProcess->setWorkingDirectory(QFileInfo(this->path()).path());
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("ITK_AUTOLOAD_PATH", "");
-  cli.setProcessEnvironment(env);
-  cli.start(this->path(), QStringList(QString("--xml")));
-  bool res = cli.waitForFinished(cliProcessTimeoutInMs);
+  this->XmlProcess->setProcessEnvironment(env);
+  this->XmlProcess->start(this->path(), QStringList(QString("--xml")));
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIExecutableModuleFactoryItem::isCLIWithXmlArgumentRunning()
+{
+  // Without event loop, the state of the process is only updated when
+  // waiting for it.
+  return !this->XmlProcess.isNull()
+    && this->XmlProcess->state() != QProcess::NotRunning
+    && !this->XmlProcess->waitForFinished(0);
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+{
+  int cliProcessTimeoutInMs = 5000;
+  // The CLI may have been started ahead by the factory.
+  this->startCLIWithXmlArgument();
+  QScopedPointer<QProcess> cliProcess(this->XmlProcess.take());
+  QProcess& cli = *cliProcess;
+  // waitForFinished() returns false if the process has already finished.
+  bool res = cli.state() == QProcess::NotRunning ?
+    cli.error() == QProcess::UnknownError : cli.waitForFinished(cliProcessTimeoutInMs);
   if (!res)
     {
     this->appendInstantiateErrorString(QString("CLI executable: %1").arg(this->path()));
@@ -214,9 +257,58 @@ QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
                                            xmlDescription.mid(0, xmlDescription.indexOf("<?xml"))));
     xmlDescription.remove(0, xmlDescription.indexOf("<?xml"));
     }
+  // Don't cache the description of a CLI reporting errors, it is retrieved
+  // again at the next startup.
+  if (errors.isEmpty())
+    {
+    this->cacheXmlDescription(xmlDescription);
+    }
   return xmlDescription;
 }
 
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryItem::cachedXmlDescription()
+{
+  if (this->XmlDescriptionCache.isNull())
+    {
+    return QString();
+    }
+  QFileInfo executable(this->path());
+  QString group = QString(QCryptographicHash::hash(
+    executable.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex());
+  QSettings& cache = *this->XmlDescriptionCache;
+  cache.beginGroup(group);
+  QString xmlDescription;
+  if (cache.value("Path").toString() == executable.absoluteFilePath()
+      && cache.value("Size").toLongLong() == executable.size()
+      && cache.value("LastModified").toLongLong() ==
+         executable.lastModified().toMSecsSinceEpoch())
+    {
+    xmlDescription = cache.value("Description").toString();
+    }
+  cache.endGroup();
+  return xmlDescription;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::cacheXmlDescription(const QString& xmlDescription)
+{
+  if (this->XmlDescriptionCache.isNull() || xmlDescription.isEmpty())
+    {
+    return;
+    }
+  QFileInfo executable(this->path());
+  QString group = QString(QCryptographicHash::hash(
+    executable.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex());
+  QSettings& cache = *this->XmlDescriptionCache;
+  cache.beginGroup(group);
+  cache.setValue("Path", executable.absoluteFilePath());
+  cache.setValue("Size", executable.size());
+  cache.setValue("LastModified", executable.lastModified().toMSecsSinceEpoch());
+  cache.setValue("Description", xmlDescription);
+  cache.endGroup();
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCLIExecutableModuleFactoryItem::uninstantiate()
 {
@@ -237,8 +329,22 @@ public:
   typedef qSlicerCLIExecutableModuleFactoryPrivate Self;
   qSlicerCLIExecutableModuleFactoryPrivate(qSlicerCLIExecutableModuleFactory& object);
 
-private:
+  /// Return the cache of XML descriptions, created in the temporary
+  /// directory the first time it is needed.
+  QSharedPointer<QSettings> xmlDescriptionCache();
+
+  /// Start the pending CLIs with "--xml" until as many CLIs as processors
+  /// are running.
+  void startPendingCLIsWithXmlArgument();
+
   QString TempDirectory;
+  QSharedPointer<QSettings> XmlDescriptionCache;
+
+  bool CLIsWithXmlArgumentListed;
+  /// Keys of the items to run with "--xml" that are not started yet
+  QStringList PendingItemKeys;
+  /// Keys of the items started with "--xml" that may still be running
+  QStringList StartedItemKeys;
 };
 
 //-----------------------------------------------------------------------------
@@ -246,6 +352,51 @@ qSlicerCLIExecutableModuleFactoryPrivate::qSlicerCLIExecutableModuleFactoryPriva
 :q_ptr(&object)
 {
   this->TempDirectory = QDir::tempPath();
+  this->CLIsWithXmlArgumentListed = false;
+}
+
+//-----------------------------------------------------------------------------
+QSharedPointer<QSettings> qSlicerCLIExecutableModuleFactoryPrivate::xmlDescriptionCache()
+{
+  if (this->XmlDescriptionCache.isNull())
+    {
+    this->XmlDescriptionCache = QSharedPointer<QSettings>(new QSettings(
+      QDir(this->TempDirectory).filePath("CLIXmlDescriptionCache.ini"),
+      QSettings::IniFormat));
+    }
+  return this->XmlDescriptionCache;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryPrivate::startPendingCLIsWithXmlArgument()
+{
+  Q_Q(qSlicerCLIExecutableModuleFactory);
+  // Free the slots of the CLIs that finished, whether or not their module
+  // is instantiated: dependencies are instantiated first, the other modules
+  // may be instantiated much later or not at all.
+  foreach(const QString& itemKey, this->StartedItemKeys)
+    {
+    qSlicerCLIExecutableModuleFactoryItem* item =
+      dynamic_cast<qSlicerCLIExecutableModuleFactoryItem*>(q->item(itemKey));
+    if (!item || !item->isCLIWithXmlArgumentRunning())
+      {
+      this->StartedItemKeys.removeAll(itemKey);
+      }
+    }
+  int maximumNumberOfProcesses = qMax(QThread::idealThreadCount(), 1);
+  while (this->StartedItemKeys.count() < maximumNumberOfProcesses
+         && !this->PendingItemKeys.isEmpty())
+    {
+    QString itemKey = this->PendingItemKeys.takeFirst();
+    qSlicerCLIExecutableModuleFactoryItem* item =
+      dynamic_cast<qSlicerCLIExecutableModuleFactoryItem*>(q->item(itemKey));
+    if (!item)
+      {
+      continue;
+      }
+    item->startCLIWithXmlArgument();
+    this->StartedItemKeys << itemKey;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -291,7 +442,37 @@ ctkAbstractFactoryItem<qSlicerAbstractCoreModule>* qSlicerCLIExecutableModuleFac
 ::createFactoryFileBasedItem()
 {
   Q_D(qSlicerCLIExecutableModuleFactory);
-  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory);
+  return new qSlicerCLIExecutableModuleFactoryItem(
+    d->TempDirectory, d->xmlDescriptionCache());
+}
+
+//-----------------------------------------------------------------------------
+qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactory
+::instantiate(const QString& itemKey)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  if (!d->CLIsWithXmlArgumentListed)
+    {
+    // CLIs are started in the alphabetical order of their names, the order
+    // in which most modules are instantiated. Modules instantiated earlier
+    // (e.g. dependencies) run their CLI when they are instantiated.
+    QStringList itemKeys = this->itemKeys();
+    itemKeys.sort();
+    foreach(const QString& key, itemKeys)
+      {
+      qSlicerCLIExecutableModuleFactoryItem* item =
+        dynamic_cast<qSlicerCLIExecutableModuleFactoryItem*>(this->item(key));
+      if (item && item->needsCLIWithXmlArgument())
+        {
+        d->PendingItemKeys << key;
+        }
+      }
+    d->CLIsWithXmlArgumentListed = true;
+    }
+  d->PendingItemKeys.removeAll(itemKey);
+  d->StartedItemKeys.removeAll(itemKey);
+  d->startPendingCLIsWithXmlArgument();
+  return this->Superclass::instantiate(itemKey);
 }
 
 //-----------------------------------------------------------------------------
@@ -305,4 +486,5 @@ void qSlicerCLIExecutableModuleFactory::setTempDirectory(const QString& newTempD
 {
   Q_D(qSlicerCLIExecutableModuleFactory);
   d->TempDirectory = newTempDirectory;
+  d->XmlDescriptionCache.clear();
 }
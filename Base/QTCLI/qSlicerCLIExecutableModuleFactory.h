@@ -26,6 +26,11 @@
 #include "qSlicerBaseQTCLIExport.h"
 class qSlicerCLIModule;
 
+// Qt includes
+#include <QProcess>
+#include <QSettings>
+#include <QSharedPointer>
+
 // CTK includes
 #include <ctkPimpl.h>
 #include <ctkAbstractPluginFactory.h>
@@ -35,18 +40,40 @@ class qSlicerCLIExecutableModuleFactoryItem
   : public ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>
 {
 public:
-  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory);
+  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory,
+    const QSharedPointer<QSettings>& xmlDescriptionCache = QSharedPointer<QSettings>());
   virtual bool load();
   virtual void uninstantiate();
+
+  /// Return true if the XML description can only be retrieved by running
+  /// the CLI executable with "--xml": there is no XML file next to the
+  /// executable and no valid entry in the description cache.
+  bool needsCLIWithXmlArgument();
+
+  /// Start the CLI executable with "--xml" without waiting for it to finish.
+  /// The output is read when the module is instantiated.
+  /// \sa runCLIWithXmlArgument()
+  void startCLIWithXmlArgument();
+
+  /// Return true if the CLI executable started with "--xml" has not
+  /// finished yet. Its output is kept until the module is instantiated.
+  bool isCLIWithXmlArgumentRunning();
 protected:
   /// Return path of the expected XML file.
   QString xmlModuleDescriptionFilePath();
 
   virtual qSlicerAbstractCoreModule* instanciator();
   QString runCLIWithXmlArgument();
+
+  /// Return the description cached for the executable, or an empty string
+  /// if the executable changed (size or modification time) since then.
+  QString cachedXmlDescription();
+  void cacheXmlDescription(const QString& xmlDescription);
 private:
   QString TempDirectory;
   qSlicerCLIModule* CLIModule;
+  QSharedPointer<QSettings> XmlDescriptionCache;
+  QScopedPointer<QProcess> XmlProcess;
 };
 
 class qSlicerCLIExecutableModuleFactoryPrivate;
@@ -69,8 +96,16 @@ public:
   ///  Threshold -> threshold
   virtual QString fileNameToKey(const QString& fileName)const;
 
+  /// The XML descriptions retrieved by running the CLI executables with
+  /// "--xml" are cached in the temporary directory, keyed by the path, size
+  /// and modification time of the executables.
   void setTempDirectory(const QString& newTempDirectory);
 
+  /// Reimplemented to run ahead the CLI executables that must be called
+  /// with "--xml" to retrieve their description, up to one per processor,
+  /// while the modules are instantiated one after the other.
+  virtual qSlicerAbstractCoreModule* instantiate(const QString& itemKey);
+
 protected:
   virtual bool isValidFile(const QFileInfo& file)const;
 
@@ -107,6 +107,21 @@ vtkMRMLAbstractLogic* qSlicerCLIModule::createLogic()
     logic->SetAllowInMemoryTransfer(0);
     }
 
+  if (d->Desc.GetParameterValue("AllowSharedMemoryTransfer") == "true")
+    {
+    logic->SetAllowSharedMemoryTransfer(1);
+    }
+
+  if (d->Desc.GetParameterValue("ServerMode") == "true")
+    {
+    logic->SetServerMode(1);
+    }
+
+  if (d->Desc.GetParameterValue("ResultCache") == "true")
+    {
+    logic->SetResultCacheEnabled(1);
+    }
+
   return logic;
 }
 
@@ -17,6 +17,10 @@
 // SlicerExecutionModel includes
 #include <ModuleDescription.h>
 
+// MRMLIDImageIO includes
+#include <itkMRMLIDImageIO.h>
+#include <itkMRMLSharedMemoryImageIO.h>
+
 // MRML includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLColorNode.h>
@@ -30,17 +34,25 @@
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
+
+// ITK includes
+#include <itkSimpleFastMutexLock.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
+#include <vtkTimerLog.h>
 #include <vtksys/SystemTools.hxx>
 
 // ITKSYS includes
+#include <itksys/Directory.hxx>
+#include <itksys/MD5.h>
 #include <itksys/Process.h>
 #include <itksys/SystemTools.hxx>
 #include <itksys/RegularExpression.hxx>
@@ -55,11 +67,16 @@
 // STL includes
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <set>
 
 #ifdef _WIN32
 #else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -78,6 +95,246 @@ struct DigitsToCharacters
     }
 };
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// File name used by MRMLIDImageIO to access a node of the scene
+std::string ConstructMRMLIDFileName(vtkMRMLScene* scene, const std::string& nodeID)
+{
+  // Must be large enough to hold slicer:, #, an ascii
+  // representation of the scene pointer and the MRML node ID.
+  char *tname = new char[nodeID.size() + 100];
+  sprintf(tname, "slicer:%p#%s", scene, nodeID.c_str());
+  std::string fname = tname;
+  delete [] tname;
+  return fname;
+}
+
+//----------------------------------------------------------------------------
+// Copy the image information from an ImageIO to another one as a 3D image
+void CopyImageInformation(itk::ImageIOBase* source, itk::ImageIOBase* destination)
+{
+  const unsigned int numberOfDimensions = 3;
+  unsigned int sourceDimensions = source->GetNumberOfDimensions();
+  destination->SetNumberOfDimensions(numberOfDimensions);
+  for (unsigned int i = 0; i < numberOfDimensions; ++i)
+    {
+    std::vector<double> direction(numberOfDimensions, 0.0);
+    if (i < sourceDimensions)
+      {
+      destination->SetDimensions(i, source->GetDimensions(i));
+      destination->SetSpacing(i, source->GetSpacing(i));
+      destination->SetOrigin(i, source->GetOrigin(i));
+      for (unsigned int j = 0; j < sourceDimensions && j < numberOfDimensions; ++j)
+        {
+        direction[j] = source->GetDirection(i)[j];
+        }
+      }
+    else
+      {
+      destination->SetDimensions(i, 1);
+      destination->SetSpacing(i, 1.0);
+      destination->SetOrigin(i, 0.0);
+      direction[i] = 1.0;
+      }
+    destination->SetDirection(i, direction);
+    }
+  destination->SetPixelType(source->GetPixelType());
+  destination->SetComponentType(source->GetComponentType());
+  destination->SetNumberOfComponents(source->GetNumberOfComponents());
+}
+
+//----------------------------------------------------------------------------
+// Returns true if the volume can be passed to an executable CLI through
+// a shared memory segment
+bool CanTransferVolumeThroughSharedMemory(vtkMRMLNode* node)
+{
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (!volumeNode || !volumeNode->GetImageData())
+    {
+    return false;
+    }
+  std::string className = volumeNode->GetClassName();
+  return className == "vtkMRMLScalarVolumeNode"
+    || className == "vtkMRMLLabelMapVolumeNode"
+    || className == "vtkMRMLVectorVolumeNode";
+}
+
+//----------------------------------------------------------------------------
+// Copy the image of a volume node into a new shared memory segment
+bool WriteVolumeToSharedMemory(vtkMRMLNode* node, const std::string& fileName)
+{
+  if (!CanTransferVolumeThroughSharedMemory(node))
+    {
+    return false;
+    }
+  try
+    {
+    itk::MRMLIDImageIO::Pointer nodeIO = itk::MRMLIDImageIO::New();
+    nodeIO->SetFileName(ConstructMRMLIDFileName(node->GetScene(), node->GetID()));
+    nodeIO->ReadImageInformation();
+
+    itk::MRMLSharedMemoryImageIO::Pointer segmentIO = itk::MRMLSharedMemoryImageIO::New();
+    segmentIO->SetFileName(fileName);
+    CopyImageInformation(nodeIO, segmentIO);
+    void* buffer = segmentIO->CreateSegment();
+    if (!buffer)
+      {
+      return false;
+      }
+    // voxels are copied directly from the image data into the segment
+    nodeIO->Read(buffer);
+    segmentIO->CompleteSegment();
+    }
+  catch (itk::ExceptionObject&)
+    {
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Copy the image written by a CLI in a shared memory segment into a volume node
+bool ReadVolumeFromSharedMemory(vtkMRMLNode* node, const std::string& fileName)
+{
+  if (!vtkMRMLVolumeNode::SafeDownCast(node))
+    {
+    return false;
+    }
+  try
+    {
+    itk::MRMLSharedMemoryImageIO::Pointer segmentIO = itk::MRMLSharedMemoryImageIO::New();
+    if (!segmentIO->CanReadFile(fileName.c_str()))
+      {
+      return false;
+      }
+    segmentIO->SetFileName(fileName);
+    segmentIO->ReadImageInformation();
+
+    itk::MRMLIDImageIO::Pointer nodeIO = itk::MRMLIDImageIO::New();
+    nodeIO->SetFileName(ConstructMRMLIDFileName(node->GetScene(), node->GetID()));
+    CopyImageInformation(segmentIO, nodeIO);
+    // voxels are copied directly from the segment into the image data
+    nodeIO->Write(segmentIO->GetSegmentBuffer());
+    }
+  catch (itk::ExceptionObject&)
+    {
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Serializes the modifications of the environment inherited by the CLI
+// processes started from different threads (batch jobs).
+itk::SimpleFastMutexLock ProcessEnvironmentLock;
+
+//----------------------------------------------------------------------------
+// Serializes the accesses to the result cache from different threads
+// (batch jobs).
+itk::SimpleFastMutexLock ResultCacheLock;
+
+//----------------------------------------------------------------------------
+void AppendToDigest(itksysMD5* md5, const std::string& text)
+{
+  // terminated so that consecutive strings cannot be confused
+  itksysMD5_Append(md5, reinterpret_cast<const unsigned char*>(text.c_str()),
+                   static_cast<int>(text.size()) + 1);
+}
+
+//----------------------------------------------------------------------------
+bool AppendFileToDigest(itksysMD5* md5, const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    {
+    return false;
+    }
+  char buffer[65536];
+  while (file)
+    {
+    file.read(buffer, sizeof(buffer));
+    if (file.gcount() > 0)
+      {
+      itksysMD5_Append(md5, reinterpret_cast<const unsigned char*>(buffer),
+                       static_cast<int>(file.gcount()));
+      }
+    }
+  return file.eof();
+}
+
+//----------------------------------------------------------------------------
+// Returns true if the data of the file is stored in other files, which are
+// not taken into account by the result cache.
+bool IsHeaderFileName(const std::string& fileName)
+{
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  return extension == ".nhdr" || extension == ".mhd" || extension == ".hdr";
+}
+
+//----------------------------------------------------------------------------
+// Copy the files of a result cache entry to the output files of the CLI.
+// Returns false if the entry does not exist or is incomplete.
+bool ReadResultCacheEntry(const std::string& entryDirectory,
+                          const std::map<std::string, std::string>& cachedOutputs)
+{
+  if (!itksys::SystemTools::FileIsDirectory(entryDirectory.c_str()))
+    {
+    return false;
+    }
+  for (std::map<std::string, std::string>::const_iterator it = cachedOutputs.begin();
+       it != cachedOutputs.end(); ++it)
+    {
+    if (!itksys::SystemTools::CopyFileAlways(
+          (entryDirectory + "/" + it->second).c_str(), it->first.c_str()))
+      {
+      return false;
+      }
+    }
+  // most recently used
+  itksys::SystemTools::Touch((entryDirectory + "/.lastused").c_str(), true);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Copy the output files of the CLI to a new result cache entry
+bool WriteResultCacheEntry(const std::string& entryDirectory,
+                           const std::map<std::string, std::string>& cachedOutputs)
+{
+  // unique to the process, in case several Slicer share the cache
+  std::ostringstream temporaryEntryDirectory;
+#ifdef _WIN32
+  temporaryEntryDirectory << entryDirectory << ".tmp" << GetCurrentProcessId();
+#else
+  temporaryEntryDirectory << entryDirectory << ".tmp" << getpid();
+#endif
+  std::string temporaryDirectory = temporaryEntryDirectory.str();
+  bool success = itksys::SystemTools::MakeDirectory(temporaryDirectory.c_str());
+  for (std::map<std::string, std::string>::const_iterator it = cachedOutputs.begin();
+       success && it != cachedOutputs.end(); ++it)
+    {
+    // optional outputs may not be written by the CLI
+    if (itksys::SystemTools::FileExists(it->first.c_str(), true))
+      {
+      success = itksys::SystemTools::CopyFileAlways(
+        it->first.c_str(), (temporaryDirectory + "/" + it->second).c_str());
+      }
+    }
+  success = success
+    && itksys::SystemTools::Touch((temporaryDirectory + "/.lastused").c_str(), true)
+    // the entry is only visible once complete
+    && itksys::SystemTools::RenameFile(temporaryDirectory.c_str(), entryDirectory.c_str());
+  if (!success)
+    {
+    itksys::SystemTools::RemoveADirectory(temporaryDirectory.c_str());
+    }
+  return success;
+}
+
+} // end of anonymous namespace
+
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 class MRMLIDMap : public std::map<std::string, std::string> {};
 
@@ -91,8 +348,12 @@ public:
   }
   virtual void Execute(vtkObject* caller, unsigned long eid, void *callData)
   {
-    if (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
-                  vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end())
+    this->ThreadIDsLock.Lock();
+    bool reschedule =
+      std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
+                vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end();
+    this->ThreadIDsLock.Unlock();
+    if (reschedule)
       {
       if (this->CLIModuleLogic)
         {
@@ -128,14 +389,19 @@ public:
       {
       return;
       }
+    // CLIs may run at the same time from different threads (batch jobs)
+    this->ThreadIDsLock.Lock();
     if (reschedule)
       {
       this->ThreadIDs.push_back(id);
       }
     else
       {
-      std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id);
+      this->ThreadIDs.erase(
+        std::remove(this->ThreadIDs.begin(), this->ThreadIDs.end(), id),
+        this->ThreadIDs.end());
       }
+    this->ThreadIDsLock.Unlock();
   }
 protected:
   vtkSlicerCLIRescheduleCallback()
@@ -151,6 +417,7 @@ protected:
   vtkSlicerCLIModuleLogic* CLIModuleLogic;
   int Delay;
   std::vector<vtkMultiThreaderIDType> ThreadIDs;
+  itk::SimpleFastMutexLock ThreadIDsLock;
 };
 
 //---------------------------------------------------------------------------
@@ -198,6 +465,11 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
+  int ServerMode;
+  int ResultCacheEnabled;
+  std::string ResultCacheDirectory;
+  int ResultCacheMaximumSize;
 
   int RedirectModuleStreams;
 
@@ -228,6 +500,7 @@ public:
 
   void SetLastRequest(vtkMRMLCommandLineModuleNode* node, vtkMTimeType requestUID)
   {
+    this->LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     if (it == this->LastRequests.end())
@@ -239,12 +512,32 @@ public:
       assert( it->first < requestUID );
       it->first = requestUID;
       }
+    this->LastRequestsLock.Unlock();
   }
   vtkMTimeType GetLastRequest(vtkMRMLCommandLineModuleNode* node)
   {
+    this->LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
-    return (it != this->LastRequests.end())? it->first : 0;
+    vtkMTimeType requestUID = (it != this->LastRequests.end())? it->first : 0;
+    this->LastRequestsLock.Unlock();
+    return requestUID;
+  }
+  /// Remove the request and return its CLI node, 0 if it is not the last
+  /// request of a CLI node.
+  vtkMRMLCommandLineModuleNode* TakeLastRequest(vtkMTimeType requestUID)
+  {
+    this->LastRequestsLock.Lock();
+    RequestType::iterator it = std::find_if(
+      this->LastRequests.begin(), this->LastRequests.end(), FindRequest(requestUID));
+    vtkMRMLCommandLineModuleNode* node = 0;
+    if (it != this->LastRequests.end())
+      {
+      node = it->second;
+      this->LastRequests.erase(it);
+      }
+    this->LastRequestsLock.Unlock();
+    return node;
   }
 
   /// Install the reschedule callback on a node and its references
@@ -281,9 +574,284 @@ public:
       }
   }
 
+  /// Find the directory of the ITK plugin that reads and writes shared
+  /// memory segments in executable CLIs. The plugin is in the SharedMemory
+  /// sub-directory of the ITK factories directories listed in
+  /// ITK_AUTOLOAD_PATH. Returns an empty string if it is not found.
+  static std::string FindSharedMemoryPluginPath()
+  {
+    std::string autoLoadPath;
+    if (!itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", autoLoadPath))
+      {
+      return std::string();
+      }
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    std::vector<std::string> directories =
+      itksys::SystemTools::SplitString(autoLoadPath, separator);
+    for (std::vector<std::string>::const_iterator it = directories.begin();
+         it != directories.end(); ++it)
+      {
+      std::string pluginPath = *it + "/SharedMemory";
+      if (!it->empty() && itksys::SystemTools::FileIsDirectory(pluginPath.c_str()))
+        {
+        return pluginPath;
+        }
+      }
+    return std::string();
+  }
+
+  /// Returns true if images of the given parameter type can be passed to
+  /// an executable CLI through shared memory segments
+  bool CanUseSharedMemoryTransfer(const std::string& type)
+  {
+    // the result cache computes the digests of the input files
+    return this->AllowSharedMemoryTransfer
+      && !this->ResultCacheEnabled
+      && (type.empty() || type == "scalar" || type == "label" || type == "vector")
+      && itk::MRMLSharedMemoryImageIO::IsSupported()
+      && !this->SharedMemoryPluginPath.empty();
+  }
+
+  /// Returns the resident process of the CLI (server mode). The process is
+  /// started on first use, and restarted if it exited or crashed since the
+  /// last invocation. Returns 0 if the resident process is running another
+  /// invocation or cannot be started: the CLI is then run in a new process.
+  /// \sa ReleaseServerProcess()
+  itksysProcess* AcquireServerProcess(const std::string& target,
+                                      const std::string& temporaryDirectory)
+  {
+#ifdef _WIN32
+    (void)target;
+    (void)temporaryDirectory;
+    return 0;
+#else
+    this->ProcessesKillLock->Lock();
+    if (this->ServerBusy)
+      {
+      this->ProcessesKillLock->Unlock();
+      return 0;
+      }
+    if (this->ServerProcess)
+      {
+      // output left by the previous invocation is discarded
+      double timeout = 0.0;
+      if (this->ServerTarget != target
+          || itksysProcess_WaitForExit(this->ServerProcess, &timeout))
+        {
+        qWarning() << "Resident process of" << this->ServerTarget.c_str()
+                   << "exited since the last invocation, restarting it";
+        this->StopServerProcess();
+        }
+      }
+    if (!this->ServerProcess &&
+        !this->StartServerProcess(target, temporaryDirectory))
+      {
+      this->ProcessesKillLock->Unlock();
+      return 0;
+      }
+    this->ServerBusy = true;
+    this->Processes.push_back(this->ServerProcess);
+    this->ProcessesKillLock->Unlock();
+    return this->ServerProcess;
+#endif
+  }
+
+  /// Send the command line of an invocation to the resident process.
+  /// Arguments are written as their count followed by the length and the
+  /// characters of each argument (see SEMCommandLineLibraryWrapper.cxx.in).
+  bool SendServerRequest(const std::vector<std::string>& arguments)
+  {
+#ifdef _WIN32
+    (void)arguments;
+    return false;
+#else
+    std::ostringstream request;
+    request << arguments.size() << "\n";
+    for (std::vector<std::string>::const_iterator it = arguments.begin();
+         it != arguments.end(); ++it)
+      {
+      request << it->size() << "\n" << *it << "\n";
+      }
+    std::string data = request.str();
+    const char* buffer = data.c_str();
+    size_t remaining = data.size();
+    while (remaining > 0)
+      {
+      ssize_t written = write(this->ServerRequestPipe, buffer, remaining);
+      if (written < 0)
+        {
+        if (errno == EINTR)
+          {
+          continue;
+          }
+        return false;
+        }
+      buffer += written;
+      remaining -= written;
+      }
+    return true;
+#endif
+  }
+
+  /// Make the resident process available for the next invocation. If
+  /// \a keepRunning is false (the invocation was cancelled or the process
+  /// crashed), the process is stopped and restarted on next use.
+  /// \sa AcquireServerProcess()
+  void ReleaseServerProcess(bool keepRunning)
+  {
+    this->ProcessesKillLock->Lock();
+    std::vector<itksysProcess*>::iterator it =
+      std::find(this->Processes.begin(), this->Processes.end(), this->ServerProcess);
+    if (it != this->Processes.end())
+      {
+      this->Processes.erase(it);
+      }
+    this->ServerBusy = false;
+    if (!keepRunning || !this->ServerMode)
+      {
+      this->StopServerProcess();
+      }
+    this->ProcessesKillLock->Unlock();
+  }
+
+  /// Start the resident process. Invocations are received through a named
+  /// pipe given on the command line.
+  bool StartServerProcess(const std::string& target, const std::string& temporaryDirectory)
+  {
+#ifdef _WIN32
+    (void)target;
+    (void)temporaryDirectory;
+    return false;
+#else
+    std::ostringstream pipeName;
+    pipeName << temporaryDirectory << "/" << getpid() << "_" << this << "_server.fifo";
+    std::string requestPipeName = pipeName.str();
+    unlink(requestPipeName.c_str());
+    if (mkfifo(requestPipeName.c_str(), S_IRUSR | S_IWUSR) != 0)
+      {
+      return false;
+      }
+    // Opened for reading and writing so that it does not block until the
+    // process opens the pipe. Not inherited by the CLI processes, so that
+    // closing it makes the resident process exit (the flag is set atomically,
+    // as CLI processes may be started by other threads at the same time).
+    int requestPipe = open(requestPipeName.c_str(), O_RDWR | O_CLOEXEC);
+    if (requestPipe < 0)
+      {
+      unlink(requestPipeName.c_str());
+      return false;
+      }
+
+    const char* command[] =
+      { target.c_str(), "--slicer-cli-server", requestPipeName.c_str(), 0 };
+    itksysProcess* process = itksysProcess_New();
+    itksysProcess_SetCommand(process, command);
+    itksysProcess_SetOption(process, itksysProcess_Option_Detach, 0);
+    itksysProcess_SetOption(process, itksysProcess_Option_HideWindow, 1);
+    itksysProcess_Execute(process);
+    if (itksysProcess_GetState(process) != itksysProcess_State_Executing)
+      {
+      itksysProcess_Delete(process);
+      close(requestPipe);
+      unlink(requestPipeName.c_str());
+      return false;
+      }
+    this->ServerProcess = process;
+    this->ServerTarget = target;
+    this->ServerRequestPipe = requestPipe;
+    this->ServerRequestPipeName = requestPipeName;
+    return true;
+#endif
+  }
+
+  /// Stop the resident process, killing it if it does not exit.
+  void StopServerProcess()
+  {
+#ifndef _WIN32
+    if (!this->ServerProcess)
+      {
+      return;
+      }
+    // closing the request pipe makes the process exit
+    close(this->ServerRequestPipe);
+    double timeout = 1.0;
+    if (!itksysProcess_WaitForExit(this->ServerProcess, &timeout))
+      {
+      itksysProcess_Kill(this->ServerProcess);
+      itksysProcess_WaitForExit(this->ServerProcess, 0);
+      }
+    itksysProcess_Delete(this->ServerProcess);
+    unlink(this->ServerRequestPipeName.c_str());
+    this->ServerProcess = 0;
+    this->ServerTarget.clear();
+    this->ServerRequestPipe = -1;
+    this->ServerRequestPipeName.clear();
+#endif
+  }
+
+  /// Jobs of ApplyBatch() shared by the threads running them
+  struct BatchInformation
+  {
+    vtkSlicerCLIModuleLogic* Logic;
+    std::vector<vtkMRMLCommandLineModuleNode*> Nodes;
+    std::vector<double> JobTimes;
+    size_t NextJob;
+    int NumberOfRunningThreads;
+    itk::SimpleFastMutexLock Lock;
+  };
+
+  /// Run the jobs of a batch until there is none left to run. Each node
+  /// must have been registered, ApplyTask() releases it.
+  static VTK_THREAD_RETURN_TYPE RunBatchJobs(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    BatchInformation* batch = static_cast<BatchInformation*>(info->UserData);
+    while (true)
+      {
+      batch->Lock.Lock();
+      size_t job = batch->NextJob++;
+      batch->Lock.Unlock();
+      if (job >= batch->Nodes.size())
+        {
+        break;
+        }
+      double startTime = vtkTimerLog::GetUniversalTime();
+      batch->Logic->ApplyTask(batch->Nodes[job]);
+      batch->JobTimes[job] = vtkTimerLog::GetUniversalTime() - startTime;
+      }
+    batch->Lock.Lock();
+    --batch->NumberOfRunningThreads;
+    batch->Lock.Unlock();
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  /// Settings and timing of ApplyBatch()
+  int MaximumNumberOfBatchJobs;
+  int NumberOfThreadsPerBatchJob;
+  std::vector<double> BatchJobTimes;
+  double BatchTime;
+
+  /// Resident process of the CLI in server mode
+  itksysProcess* ServerProcess;
+  std::string ServerTarget;
+  int ServerRequestPipe;
+  std::string ServerRequestPipeName;
+  bool ServerBusy;
+
+  /// Directory of the shared memory ImageIO plugin, found when the logic is
+  /// created as ITK_AUTOLOAD_PATH is modified while CLIs are started.
+  std::string SharedMemoryPluginPath;
+
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
   RequestType LastRequests;
+  /// Requests are set from the threads running the CLIs
+  itk::SimpleFastMutexLock LastRequestsLock;
 
   vtkSmartPointer<vtkSlicerCLIRescheduleCallback> RescheduleCallback;
   vtkSmartPointer<vtkSlicerCLIOneShotCallbackCallback>OneShotCallbackCallback;
@@ -300,6 +868,17 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
   this->Internal->ProcessesKillLock = itk::MutexLock::New();
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 0;
+  this->Internal->SharedMemoryPluginPath = vtkInternal::FindSharedMemoryPluginPath();
+  this->Internal->ServerMode = 0;
+  this->Internal->ResultCacheEnabled = 0;
+  this->Internal->ResultCacheMaximumSize = 1024;
+  this->Internal->ServerProcess = 0;
+  this->Internal->ServerRequestPipe = -1;
+  this->Internal->ServerBusy = false;
+  this->Internal->MaximumNumberOfBatchJobs = 0;
+  this->Internal->NumberOfThreadsPerBatchJob = 0;
+  this->Internal->BatchTime = 0.;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -316,6 +895,10 @@ vtkSlicerCLIModuleLogic::~vtkSlicerCLIModuleLogic()
 {
   this->RemoveObserver(this->Internal->OneShotCallbackCallback);
 
+  this->Internal->ProcessesKillLock->Lock();
+  this->Internal->StopServerProcess();
+  this->Internal->ProcessesKillLock->Unlock();
+
   delete this->Internal;
 }
 
@@ -403,6 +986,153 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+    {
+    this->Internal->AllowSharedMemoryTransfer = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetServerMode(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ServerMode to " << value);
+  if (this->Internal->ServerMode != value)
+    {
+    this->Internal->ServerMode = value;
+    if (!value)
+      {
+      this->Internal->ProcessesKillLock->Lock();
+      if (!this->Internal->ServerBusy)
+        {
+        this->Internal->StopServerProcess();
+        }
+      this->Internal->ProcessesKillLock->Unlock();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetServerMode() const
+{
+  return this->Internal->ServerMode;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheEnabled(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ResultCacheEnabled to " << value);
+  if (this->Internal->ResultCacheEnabled != value)
+    {
+    this->Internal->ResultCacheEnabled = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetResultCacheEnabled() const
+{
+  return this->Internal->ResultCacheEnabled;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheDirectory(const std::string& directory)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ResultCacheDirectory to " << directory);
+  if (this->Internal->ResultCacheDirectory != directory)
+    {
+    this->Internal->ResultCacheDirectory = directory;
+    }
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic::GetResultCacheDirectory() const
+{
+  return this->Internal->ResultCacheDirectory;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheMaximumSize(int megabytes)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting ResultCacheMaximumSize to " << megabytes);
+  if (this->Internal->ResultCacheMaximumSize != megabytes)
+    {
+    this->Internal->ResultCacheMaximumSize = megabytes;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetResultCacheMaximumSize() const
+{
+  return this->Internal->ResultCacheMaximumSize;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetMaximumNumberOfBatchJobs(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting MaximumNumberOfBatchJobs to " << value);
+  if (this->Internal->MaximumNumberOfBatchJobs != value)
+    {
+    this->Internal->MaximumNumberOfBatchJobs = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetMaximumNumberOfBatchJobs() const
+{
+  return this->Internal->MaximumNumberOfBatchJobs;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetNumberOfThreadsPerBatchJob(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting NumberOfThreadsPerBatchJob to " << value);
+  if (this->Internal->NumberOfThreadsPerBatchJob != value)
+    {
+    this->Internal->NumberOfThreadsPerBatchJob = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetNumberOfThreadsPerBatchJob() const
+{
+  return this->Internal->NumberOfThreadsPerBatchJob;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetBatchJobTime(int job) const
+{
+  if (job < 0 || job >= static_cast<int>(this->Internal->BatchJobTimes.size()))
+    {
+    return 0.;
+    }
+  return this->Internal->BatchJobTimes[job];
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetBatchTime() const
+{
+  return this->Internal->BatchTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetBatchThroughput() const
+{
+  if (this->Internal->BatchTime <= 0.)
+    {
+    return 0.;
+    }
+  return this->Internal->BatchJobTimes.size() / this->Internal->BatchTime;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -415,6 +1145,157 @@ void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOff()
   this->SetRedirectModuleStreams(static_cast<int>(0));
 }
 
+//----------------------------------------------------------------------------
+// Output nodes contribute only to the key by the format of their file.
+std::string vtkSlicerCLIModuleLogic::ComputeResultCacheKey(const ModuleDescription& description,
+                                  const std::vector<std::string>& commandLine,
+                                  const std::string& cliNodeID,
+                                  const std::map<std::string, std::string>& nodesToWrite,
+                                  const std::map<std::string, std::string>& nodesToReload,
+                                  std::map<std::string, std::string>& cachedOutputs)
+{
+  cachedOutputs.clear();
+  itksysMD5* md5 = itksysMD5_New();
+  itksysMD5_Initialize(md5);
+  AppendToDigest(md5, description.GetTitle());
+  AppendToDigest(md5, description.GetVersion());
+  AppendToDigest(md5, description.GetTarget());
+
+  bool cacheable = true;
+  std::map<std::string, std::string>::const_iterator id2fn;
+  const std::vector<ModuleParameterGroup>& groups = description.GetParameterGroups();
+  for (std::vector<ModuleParameterGroup>::const_iterator git = groups.begin();
+       cacheable && git != groups.end(); ++git)
+    {
+    const std::vector<ModuleParameter>& parameters = git->GetParameters();
+    for (std::vector<ModuleParameter>::const_iterator pit = parameters.begin();
+         cacheable && pit != parameters.end(); ++pit)
+      {
+      AppendToDigest(md5, pit->GetName());
+      if (pit->GetChannel() == "output")
+        {
+        if ((id2fn = nodesToReload.find(pit->GetValue())) != nodesToReload.end())
+          {
+          std::string extension =
+            vtksys::SystemTools::GetFilenameLastExtension(id2fn->second);
+          AppendToDigest(md5, "output" + extension);
+          cachedOutputs[id2fn->second] = pit->GetName() + extension;
+          cacheable = !IsHeaderFileName(id2fn->second);
+          }
+        else if (pit->GetTag() == "file" || pit->GetTag() == "directory")
+          {
+          // written by the CLI where the user chose, not in the cache
+          cacheable = pit->GetValue().empty();
+          }
+        // other values of output parameters are set by the CLI
+        }
+      else if ((id2fn = nodesToWrite.find(pit->GetValue())) != nodesToWrite.end())
+        {
+        cacheable = !IsHeaderFileName(id2fn->second)
+          && AppendFileToDigest(md5, id2fn->second);
+        }
+      else
+        {
+        AppendToDigest(md5, pit->GetValue());
+        if (pit->GetTag() == "file"
+            && itksys::SystemTools::FileExists(pit->GetValue().c_str(), true))
+          {
+          cacheable = AppendFileToDigest(md5, pit->GetValue());
+          }
+        }
+      }
+    }
+  // file of the return parameters
+  if ((id2fn = nodesToReload.find(cliNodeID)) != nodesToReload.end())
+    {
+    cachedOutputs[id2fn->second] = "ReturnParameters.params";
+    }
+
+  // Values resolved from the nodes when the command line is built (point
+  // and region coordinates, ...). Temporary file names change at each run.
+  std::vector<std::string> temporaryFileNames;
+  for (id2fn = nodesToWrite.begin(); id2fn != nodesToWrite.end(); ++id2fn)
+    {
+    temporaryFileNames.push_back(id2fn->second);
+    }
+  for (id2fn = nodesToReload.begin(); id2fn != nodesToReload.end(); ++id2fn)
+    {
+    temporaryFileNames.push_back(id2fn->second);
+    }
+  for (std::vector<std::string>::const_iterator ait = commandLine.begin();
+       ait != commandLine.end(); ++ait)
+    {
+    std::string argument = *ait;
+    for (std::vector<std::string>::const_iterator fit = temporaryFileNames.begin();
+         fit != temporaryFileNames.end(); ++fit)
+      {
+      if (!fit->empty())
+        {
+        vtksys::SystemTools::ReplaceString(argument, fit->c_str(),
+          ("<file>" + vtksys::SystemTools::GetFilenameLastExtension(*fit)).c_str());
+        }
+      }
+    AppendToDigest(md5, argument);
+    }
+
+  char digest[32];
+  itksysMD5_FinalizeHex(md5, digest);
+  itksysMD5_Delete(md5);
+  if (!cacheable || cachedOutputs.empty())
+    {
+    return std::string();
+    }
+  return std::string(digest, 32);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::TrimResultCache(const std::string& cacheDirectory, unsigned long long maximumSize)
+{
+  itksys::Directory entries;
+  if (!entries.Load(cacheDirectory.c_str()))
+    {
+    return;
+    }
+  std::vector<std::pair<long, std::string> > lastUses;
+  std::map<std::string, unsigned long long> entrySizes;
+  unsigned long long cacheSize = 0;
+  for (unsigned long i = 0; i < entries.GetNumberOfFiles(); ++i)
+    {
+    std::string name = entries.GetFile(i);
+    std::string entryDirectory = cacheDirectory + "/" + name;
+    if (name == "." || name == ".."
+        || !itksys::SystemTools::FileIsDirectory(entryDirectory.c_str()))
+      {
+      continue;
+      }
+    itksys::Directory files;
+    files.Load(entryDirectory.c_str());
+    unsigned long long entrySize = 0;
+    for (unsigned long j = 0; j < files.GetNumberOfFiles(); ++j)
+      {
+      std::string fileName = entryDirectory + "/" + files.GetFile(j);
+      if (!itksys::SystemTools::FileIsDirectory(fileName.c_str()))
+        {
+        entrySize += itksys::SystemTools::FileLength(fileName.c_str());
+        }
+      }
+    entrySizes[entryDirectory] = entrySize;
+    cacheSize += entrySize;
+    lastUses.push_back(std::make_pair(
+      itksys::SystemTools::ModifiedTime((entryDirectory + "/.lastused").c_str()),
+      entryDirectory));
+    }
+  std::sort(lastUses.begin(), lastUses.end());
+  for (std::vector<std::pair<long, std::string> >::const_iterator it = lastUses.begin();
+       cacheSize > maximumSize && it != lastUses.end(); ++it)
+    {
+    if (itksys::SystemTools::RemoveADirectory(it->second.c_str()))
+      {
+      cacheSize -= entrySizes[it->second];
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::SetRedirectModuleStreams(int value)
 {
@@ -486,7 +1367,8 @@ vtkSlicerCLIModuleLogic
                              const std::string& type,
                              const std::string& name,
                              const std::vector<std::string>& extensions,
-                             CommandLineModuleType commandType)
+                             CommandLineModuleType commandType,
+                             const std::string& executionTag)
 {
   std::string fname = name;
   std::string pid;
@@ -512,10 +1394,9 @@ vtkSlicerCLIModuleLogic
   // encoded to the same filename every time within that running
   // instance of Slicer).  This last point is an optimization to
   // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // module.  Modules run at the same time within the same Slicer
+  // process (batch jobs) give an execution tag to make the filenames
+  // unique per module execution.
   //
 
   // Encode process id into a string.  To avoid confusing the
@@ -548,7 +1429,14 @@ vtkSlicerCLIModuleLogic
     {
     temporaryDirectory = appLogic->GetTemporaryPath();
     }
-  fname = temporaryDirectory + "/" + pid + "_" + fname;
+  std::string tagPrefix;
+  if (!executionTag.empty())
+    {
+    tagPrefix = executionTag + "_";
+    std::transform(tagPrefix.begin(), tagPrefix.end(),
+                   tagPrefix.begin(), DigitsToCharacters());
+    }
+  fname = temporaryDirectory + "/" + pid + "_" + tagPrefix + fname;
 
   if (tag == "image")
     {
@@ -558,13 +1446,25 @@ vtkSlicerCLIModuleLogic
       {
       // If running an executable
 
-      // Use default fname construction, tack on extension
-      std::string ext = ".nrrd";
-      if (extensions.size() != 0)
+      if (commandType == CommandLineModule && extensions.size() == 0
+          && this->Internal->CanUseSharedMemoryTransfer(type))
+        {
+        // The executable reads/writes the image from/to a shared memory
+        // segment named after the file (see itkMRMLSharedMemoryImageIO).
+        // Inputs fall back to a file if the segment cannot be created.
+        fname = std::string(itk::MRMLSharedMemoryImageIO::GetScheme()) + ":"
+          + vtksys::SystemTools::GetFilenameName(fname);
+        }
+      else
         {
-        ext = extensions[0];
+        // Use default fname construction, tack on extension
+        std::string ext = ".nrrd";
+        if (extensions.size() != 0)
+          {
+          ext = extensions[0];
+          }
+        fname = fname + ext;
         }
-      fname = fname + ext;
       }
     else
       {
@@ -573,16 +1473,7 @@ vtkSlicerCLIModuleLogic
       // tree.
 
       // Redefine the filename to be a reference to a slicer node.
-
-      // Must be large enough to hold slicer:, #, an ascii
-      // representation of the scene pointer and the MRML node ID.
-      char *tname = new char[name.size() + 100];
-
-      sprintf(tname, "slicer:%p#%s", this->GetMRMLScene(), name.c_str());
-
-      fname = tname;
-
-      delete [] tname;
+      fname = ConstructMRMLIDFileName(this->GetMRMLScene(), name);
       }
     }
 
@@ -674,6 +1565,149 @@ void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node,
     }
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ApplyBatch(vtkCollection* nodes, bool updateDisplay)
+{
+  vtkInternal::BatchInformation batch;
+  batch.Logic = this;
+  batch.NextJob = 0;
+  batch.NumberOfRunningThreads = 0;
+
+  // Only executable CLIs, run in their own process, can run at the same time.
+  bool concurrentJobs = true;
+  for (int i = 0; nodes && i < nodes->GetNumberOfItems(); ++i)
+    {
+    vtkMRMLCommandLineModuleNode* node =
+      vtkMRMLCommandLineModuleNode::SafeDownCast(nodes->GetItemAsObject(i));
+    if (!node)
+      {
+      vtkErrorMacro("ApplyBatch: item " << i << " is not a vtkMRMLCommandLineModuleNode");
+      return;
+      }
+    const ModuleDescription& description = node->GetModuleDescription();
+    concurrentJobs = concurrentJobs
+      && description.GetType() == "CommandLineModule"
+      && description.GetTarget().compare(0, 7, "slicer:") != 0;
+    batch.Nodes.push_back(node);
+    }
+  if (batch.Nodes.empty())
+    {
+    return;
+    }
+  batch.JobTimes.resize(batch.Nodes.size(), 0.);
+
+  int numberOfProcessors = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int numberOfJobThreads = 1;
+  if (concurrentJobs)
+    {
+    numberOfJobThreads = this->Internal->MaximumNumberOfBatchJobs > 0 ?
+      this->Internal->MaximumNumberOfBatchJobs : numberOfProcessors;
+    numberOfJobThreads = std::min(numberOfJobThreads, static_cast<int>(batch.Nodes.size()));
+    numberOfJobThreads = std::max(std::min(numberOfJobThreads, VTK_MAX_THREADS), 1);
+    }
+  // Share the processors among the CLIs running at the same time instead
+  // of letting each of them use all the processors.
+  int numberOfThreadsPerJob = this->Internal->NumberOfThreadsPerBatchJob;
+  if (numberOfThreadsPerJob <= 0 && numberOfJobThreads > 1)
+    {
+    numberOfThreadsPerJob = std::max(numberOfProcessors / numberOfJobThreads, 1);
+    }
+  std::ostringstream numberOfThreadsPerJobString;
+  numberOfThreadsPerJobString << numberOfThreadsPerJob;
+
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = batch.Nodes.begin();
+       it != batch.Nodes.end(); ++it)
+    {
+    vtkMRMLCommandLineModuleNode* node = *it;
+    // released by ApplyTask()
+    node->Register(this);
+    node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
+    node->SetAttribute("BatchJob", "true");
+    if (numberOfThreadsPerJob > 0)
+      {
+      node->SetAttribute("NumberOfThreads", numberOfThreadsPerJobString.str().c_str());
+      }
+    node->SetOutputText("", false);
+    node->SetErrorText("", false);
+    node->SetStatus(vtkMRMLCommandLineModuleNode::Scheduled);
+    }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  vtkNew<vtkMultiThreader> threader;
+  std::vector<int> threadIDs;
+  for (int i = 0; numberOfJobThreads > 1 && i < numberOfJobThreads; ++i)
+    {
+    batch.Lock.Lock();
+    ++batch.NumberOfRunningThreads;
+    batch.Lock.Unlock();
+    int threadID = threader->SpawnThread(&vtkInternal::RunBatchJobs, &batch);
+    if (threadID < 0)
+      {
+      batch.Lock.Lock();
+      --batch.NumberOfRunningThreads;
+      batch.Lock.Unlock();
+      break;
+      }
+    threadIDs.push_back(threadID);
+    }
+  if (threadIDs.empty())
+    {
+    // Python CLIs must run in the main thread
+    vtkMultiThreader::ThreadInfo info;
+    info.UserData = &batch;
+    batch.NumberOfRunningThreads = 1;
+    vtkInternal::RunBatchJobs(&info);
+    }
+  // Load the outputs of the completed CLIs while the others are running
+  bool running = true;
+  while (running)
+    {
+    if (this->GetApplicationLogic()->GetReadDataQueueSize())
+      {
+      this->GetApplicationLogic()->ProcessReadData();
+      continue;
+      }
+    batch.Lock.Lock();
+    running = (batch.NumberOfRunningThreads > 0);
+    batch.Lock.Unlock();
+    if (running)
+      {
+      itksys::SystemTools::Delay(10);
+      }
+    }
+  for (std::vector<int>::const_iterator it = threadIDs.begin(); it != threadIDs.end(); ++it)
+    {
+    threader->TerminateThread(*it);
+    }
+  while (this->GetApplicationLogic()->GetReadDataQueueSize())
+    {
+    this->GetApplicationLogic()->ProcessReadData();
+    }
+
+  this->Internal->BatchTime = vtkTimerLog::GetUniversalTime() - startTime;
+  this->Internal->BatchJobTimes = batch.JobTimes;
+
+  std::string title;
+  for (std::vector<vtkMRMLCommandLineModuleNode*>::const_iterator it = batch.Nodes.begin();
+       it != batch.Nodes.end(); ++it)
+    {
+    (*it)->RemoveAttribute("BatchJob");
+    (*it)->RemoveAttribute("NumberOfThreads");
+    title = (*it)->GetModuleDescription().GetTitle();
+    }
+  std::ostringstream information;
+  information << title << " batch of " << batch.Nodes.size() << " runs completed in "
+              << this->Internal->BatchTime << " s with up to " << numberOfJobThreads
+              << " concurrent runs (" << this->GetBatchThroughput() << " runs per second)";
+  for (size_t job = 0; job < batch.JobTimes.size(); ++job)
+    {
+    const char* name = batch.Nodes[job]->GetName();
+    information << "\n  " << (name ? name : "") << ": " << batch.JobTimes[job] << " s";
+    }
+  // vtkSlicerApplication::GetInstance()->InformationMessage
+  qDebug() << information.str().c_str();
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::KillProcesses()
 {
@@ -916,6 +1950,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vector of files to delete
   std::set<std::string> filesToDelete;
 
+  // Batch jobs may run at the same time on the same input nodes, their
+  // temporary files are made unique to the CLI node.
+  std::string executionTag;
+  const char* batchJob = node0->GetAttribute("BatchJob");
+  if (batchJob && std::string(batchJob) == "true" && node0->GetID())
+    {
+    executionTag = node0->GetID();
+    }
+
   // iterators for parameter groups
   std::vector<ModuleParameterGroup>::iterator pgbeginit
     = node0->GetModuleDescription().GetParameterGroups().begin();
@@ -963,7 +2006,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              (*pit).GetType(),
                                              id,
                                              (*pit).GetFileExtensions(),
-                                             commandType);
+                                             commandType,
+                                             executionTag);
 
         filesToDelete.insert(fname);
         if ((*pit).GetChannel() == "input")
@@ -1114,6 +2158,26 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         }
       }
 
+    // Pass volumes to executables through a shared memory segment if
+    // requested, fall back to a temporary file if it cannot be created
+    if (out && itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str()))
+      {
+      if (WriteVolumeToSharedMemory(nd, (*id2fn0).second))
+        {
+        out = 0;
+        }
+      else
+        {
+        std::string segmentName = (*id2fn0).second.substr(
+          strlen(itk::MRMLSharedMemoryImageIO::GetScheme()) + 1);
+        std::string fname = temporaryDirectory + "/" + segmentName + ".nrrd";
+        itk::MRMLSharedMemoryImageIO::RemoveSegment((*id2fn0).second.c_str());
+        filesToDelete.erase((*id2fn0).second);
+        filesToDelete.insert(fname);
+        nodesToWrite[(*id2fn0).first] = fname;
+        }
+      }
+
     // if the file is to be written, then write it
     if (out)
       {
@@ -1815,6 +2879,30 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vtkSlicerApplication::GetInstance()->InformationMessage
   qDebug() << information0.str().c_str();
 
+  // Look for the results of a previous run with the same inputs and
+  // parameters in the result cache.
+  std::map<std::string, std::string> cachedOutputs;
+  std::string resultCacheDirectory = this->Internal->ResultCacheDirectory;
+  std::string resultCacheEntry;
+  bool resultCacheHit = false;
+  if (this->Internal->ResultCacheEnabled && commandType == CommandLineModule
+      && miniscene->GetNumberOfNodes() == 0 && node0->GetID())
+    {
+    std::string key = ComputeResultCacheKey(node0->GetModuleDescription(),
+      commandLineAsString, node0->GetID(), nodesToWrite, nodesToReload, cachedOutputs);
+    if (!key.empty())
+      {
+      if (resultCacheDirectory.empty())
+        {
+        resultCacheDirectory = temporaryDirectory + "/CLIResultCache";
+        }
+      resultCacheEntry = resultCacheDirectory + "/" + key;
+      ResultCacheLock.Lock();
+      resultCacheHit = ReadResultCacheEntry(resultCacheEntry, cachedOutputs);
+      ResultCacheLock.Unlock();
+      }
+    }
+
   // run the filter
   //
   //
@@ -1823,7 +2911,17 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   node0->SetErrorText("", false);
   node0->SetStatus(vtkMRMLCommandLineModuleNode::Running, false);
   this->GetApplicationLogic()->RequestModified( node0 );
-  if (commandType == CommandLineModule)
+  if (resultCacheHit)
+    {
+    // The outputs were copied from the result cache, they are loaded as
+    // if the CLI had written them.
+    std::string information = node0->GetModuleDescription().GetTitle()
+      + " results loaded from the cache " + resultCacheEntry;
+    // vtkSlicerApplication::GetInstance()->InformationMessage
+    qDebug() << information.c_str();
+    node0->SetOutputText(information, false);
+    }
+  else if (commandType == CommandLineModule)
     {
     // Run as a command line module
     //
@@ -1836,32 +2934,90 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     // statically linked to the executable.
     // Historically, there was an nvidia driver bug that causes the module
     // to fail on exit with undefined symbol.
+    // If images are passed through shared memory, only the plugin
+    // reading and writing shared memory segments (that does not depend on
+    // MRML) is loaded.
+     bool useSharedMemory = false;
+     for (id2fn0 = nodesToWrite.begin(); id2fn0 != nodesToWrite.end(); ++id2fn0)
+       {
+       useSharedMemory = useSharedMemory ||
+         itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str());
+       }
+     for (id2fn0 = nodesToReload.begin(); id2fn0 != nodesToReload.end(); ++id2fn0)
+       {
+       useSharedMemory = useSharedMemory ||
+         itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str());
+       }
+     // The environment is modified until the process is started
+     ProcessEnvironmentLock.Lock();
      std::string saveITKAutoLoadPath;
      itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
-     std::string emptyString("ITK_AUTOLOAD_PATH=");
+     std::string autoLoadPathString("ITK_AUTOLOAD_PATH=");
+     // The resident process of server mode may later receive images
+     // through shared memory.
+     if (useSharedMemory ||
+         (this->GetServerMode() && this->GetAllowSharedMemoryTransfer()))
+       {
+       autoLoadPathString += this->Internal->SharedMemoryPluginPath;
+       }
      int putSuccess =
-       itksys::SystemTools::PutEnv(const_cast <char *> (emptyString.c_str()));
+       itksys::SystemTools::PutEnv(const_cast <char *> (autoLoadPathString.c_str()));
      if (!putSuccess)
        {
        vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
        }
+     // Limit the number of ITK threads of the process (batch jobs)
+     const char* numberOfThreads = node0->GetAttribute("NumberOfThreads");
+     std::string saveITKNumberOfThreads;
+     bool hadITKNumberOfThreads = itksys::SystemTools::GetEnv(
+       "ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS", saveITKNumberOfThreads);
+     if (numberOfThreads)
+       {
+       std::string numberOfThreadsString("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS=");
+       numberOfThreadsString += numberOfThreads;
+       if (!itksys::SystemTools::PutEnv(const_cast <char *> (numberOfThreadsString.c_str())))
+         {
+         vtkErrorMacro( "Unable to set ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS.");
+         }
+       }
     //
     // now run the process
     //
-    itksysProcess *process = itksysProcess_New();
+    // In server mode, the invocation is sent to the resident process of
+    // the CLI instead of starting a new process.
+    itksysProcess *process = 0;
+    bool serverProcess = false;
+    if (this->GetServerMode()
+        && commandLineAsString[0] == node0->GetModuleDescription().GetTarget())
+      {
+      process = this->Internal->AcquireServerProcess(commandLineAsString[0],
+                                                     temporaryDirectory);
+      if (process && !this->Internal->SendServerRequest(commandLineAsString))
+        {
+        this->Internal->ReleaseServerProcess(false);
+        process = 0;
+        }
+      serverProcess = (process != 0);
+      }
+    if (!process)
+      {
+      process = itksysProcess_New();
 
-    this->Internal->Processes.push_back(process);
+      this->Internal->ProcessesKillLock->Lock();
+      this->Internal->Processes.push_back(process);
+      this->Internal->ProcessesKillLock->Unlock();
 
-    // setup the command
-    itksysProcess_SetCommand(process, command);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_Detach, 0);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_HideWindow, 1);
-    // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
+      // setup the command
+      itksysProcess_SetCommand(process, command);
+      itksysProcess_SetOption(process,
+                              itksysProcess_Option_Detach, 0);
+      itksysProcess_SetOption(process,
+                              itksysProcess_Option_HideWindow, 1);
+      // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
 
-    // execute the command
-    itksysProcess_Execute(process);
+      // execute the command
+      itksysProcess_Execute(process);
+      }
 
     // restore the load path
     std::string putEnvString = ("ITK_AUTOLOAD_PATH=");
@@ -1872,6 +3028,19 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       {
       vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
       }
+    if (numberOfThreads)
+      {
+      std::string numberOfThreadsString("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS=");
+      numberOfThreadsString += saveITKNumberOfThreads;
+      putSuccess = hadITKNumberOfThreads ?
+        itksys::SystemTools::PutEnv(const_cast <char *> (numberOfThreadsString.c_str())) :
+        itksys::SystemTools::UnPutEnv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS");
+      if (!putSuccess)
+        {
+        vtkErrorMacro( "Unable to restore ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS. ");
+        }
+      }
+    ProcessEnvironmentLock.Unlock();
 
     // Wait for the command to finish
     char *tbuffer;
@@ -1883,7 +3052,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     std::string stderrbuffer;
     std::string::size_type tagend;
     std::string::size_type tagstart;
-    while ((pipe = itksysProcess_WaitForData(process ,&tbuffer,
+    // the resident process reports the end of an invocation in its output
+    bool serverRequestCompleted = false;
+    int serverExitValue = 0;
+    while (!serverRequestCompleted &&
+           (pipe = itksysProcess_WaitForData(process ,&tbuffer,
                                              &length, &timeout)) != 0)
       {
       // increment the elapsed time
@@ -1898,8 +3071,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       if (node0->GetModuleDescription().GetProcessInformation()->Abort)
         {
         itksysProcess_Kill(process);
-        this->Internal->Processes.erase(
-              std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+        // the killed resident process is released below
+        if (!serverProcess)
+          {
+          this->Internal->ProcessesKillLock->Lock();
+          this->Internal->Processes.erase(
+                std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+          this->Internal->ProcessesKillLock->Unlock();
+          }
         node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
         node0->GetModuleDescription().GetProcessInformation()->StageProgress =0;
         this->GetApplicationLogic()->RequestModified( node0 );
@@ -1973,6 +3152,26 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
             {
             this->GetApplicationLogic()->RequestModified( node0 );
             }
+
+          // search for the end of the invocation in server mode
+          tagend = serverProcess ?
+            stdoutbuffer.find("</slicer-cli-server-exit>") : std::string::npos;
+          if (tagend != std::string::npos)
+            {
+            tagstart = stdoutbuffer.rfind("<slicer-cli-server-exit>", tagend);
+            if (tagstart != std::string::npos)
+              {
+              std::string exitValueString(stdoutbuffer, tagstart+24,
+                                          tagend-tagstart-24);
+              serverExitValue = atoi(exitValueString.c_str());
+              stdoutbuffer.erase(tagstart, tagend+25-tagstart);
+              if (tagstart < stdoutbuffer.size() && stdoutbuffer[tagstart] == '\n')
+                {
+                stdoutbuffer.erase(tagstart, 1);
+                }
+              serverRequestCompleted = true;
+              }
+            }
           }
         else if (pipe == itksysProcess_Pipe_STDERR)
           {
@@ -1980,9 +3179,30 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           }
         }
       }
-    this->Internal->ProcessesKillLock->Lock();
-    itksysProcess_WaitForExit(process, 0);
-    this->Internal->ProcessesKillLock->Unlock();
+    if (serverRequestCompleted)
+      {
+      // The resident process flushes its standard error before it reports
+      // the end of the invocation, but the pipes are read independently:
+      // collect the error output that has not been read yet.
+      double drainTimeout = timeoutlimit / 10.;
+      while ((pipe = itksysProcess_WaitForData(process, &tbuffer,
+                                               &length, &drainTimeout)) == itksysProcess_Pipe_STDERR
+             || pipe == itksysProcess_Pipe_STDOUT)
+        {
+        if (length != 0 && tbuffer != 0)
+          {
+          std::string& buffer = (pipe == itksysProcess_Pipe_STDERR ? stderrbuffer : stdoutbuffer);
+          buffer.append(tbuffer, length);
+          }
+        drainTimeout = timeoutlimit / 10.;
+        }
+      }
+    else
+      {
+      this->Internal->ProcessesKillLock->Lock();
+      itksysProcess_WaitForExit(process, 0);
+      this->Internal->ProcessesKillLock->Unlock();
+      }
 
     // remove the embedded XML from the stdout stream
     //
@@ -2062,15 +3282,23 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       {
       node0->SetStatus(vtkMRMLCommandLineModuleNode::Cancelled, false);
       this->GetApplicationLogic()->RequestModified(node0);
+      if (serverProcess)
+        {
+        // the resident process was killed, it is restarted on next use
+        this->Internal->ReleaseServerProcess(false);
+        }
       }
     else
       {
-      int result = itksysProcess_GetState(process);
+      int result = serverRequestCompleted ?
+        static_cast<int>(itksysProcess_State_Exited) : itksysProcess_GetState(process);
       if (result == itksysProcess_State_Exited)
         {
         // executable exited cleanly and must of done
         // "something"
-        if (itksysProcess_GetExitValue(process) == 0)
+        int exitValue = serverRequestCompleted ?
+          serverExitValue : itksysProcess_GetExitValue(process);
+        if (exitValue == 0)
           {
           // executable exited without errors,
           std::stringstream information;
@@ -2143,11 +3371,20 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         }
 
       // clean up
-      this->Internal->ProcessesKillLock->Lock();
-      this->Internal->Processes.erase(
-            std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
-      itksysProcess_Delete(process);
-      this->Internal->ProcessesKillLock->Unlock();
+      if (serverProcess)
+        {
+        // The resident process is kept for the next invocation, unless
+        // it exited before completing this one.
+        this->Internal->ReleaseServerProcess(serverRequestCompleted);
+        }
+      else
+        {
+        this->Internal->ProcessesKillLock->Lock();
+        this->Internal->Processes.erase(
+              std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+        itksysProcess_Delete(process);
+        this->Internal->ProcessesKillLock->Unlock();
+        }
       }
     }
   else if ( commandType == SharedObjectModule )
@@ -2340,6 +3577,18 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     {
     node0->SetStatus(vtkMRMLCommandLineModuleNode::Completing, false);
     this->GetApplicationLogic()->RequestModified( node0 );
+
+    // Store the outputs for the next runs with the same inputs
+    if (!resultCacheEntry.empty() && !resultCacheHit)
+      {
+      ResultCacheLock.Lock();
+      if (WriteResultCacheEntry(resultCacheEntry, cachedOutputs))
+        {
+        TrimResultCache(resultCacheDirectory,
+          static_cast<unsigned long long>(this->Internal->ResultCacheMaximumSize) * 1024 * 1024);
+        }
+      ResultCacheLock.Unlock();
+      }
     }
   // reset the progress to zero
   node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
@@ -2368,6 +3617,26 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       if (mit == sceneToMiniSceneMap.end())
         {
         // Node is not being communicated in the miniscene, load via a file
+        // (or a shared memory segment)
+
+        bool sharedMemoryOutput = itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName(
+          (*id2fn0).second.c_str());
+        if (sharedMemoryOutput)
+          {
+          // Copy the image into the node from this thread, the node events
+          // are invoked from the main thread as for shared object modules.
+          vtkMRMLNode* node = this->GetMRMLScene()->GetNodeByID((*id2fn0).first);
+          this->Internal->StartRescheduleNodeEvents(node);
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), true);
+          if (!ReadVolumeFromSharedMemory(node, (*id2fn0).second))
+            {
+            vtkErrorMacro("ERROR reading output image from " << (*id2fn0).second);
+            }
+          this->Internal->RescheduleCallback->RescheduleEventsFromThreadID(
+            vtkMultiThreader::GetCurrentThreadID(), false);
+          this->Internal->StopRescheduleNodeEvents(node);
+          }
 
         // Make request that data be reloaded. The data will loaded and
         // rendered in the main gui thread.  Data to be reloaded can be
@@ -2387,7 +3656,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           displayData=false;
         }
 
-        bool deleteFile = this->GetDeleteTemporaryFiles();
+        // Shared memory segments are not files, they are removed below
+        bool deleteFile = this->GetDeleteTemporaryFiles() && !sharedMemoryOutput;
         vtkMTimeType requestUID = this->GetApplicationLogic()
           ->RequestReadFile((*id2fn0).first.c_str(), (*id2fn0).second.c_str(),
                             displayData, deleteFile);
@@ -2538,6 +3808,25 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   //
   delete [] command;
 
+  // Remove the shared memory segments of the inputs and outputs. They are
+  // removed even if temporary files are kept, as they are held in memory.
+  for (id2fn0 = nodesToWrite.begin(); id2fn0 != nodesToWrite.end(); ++id2fn0)
+    {
+    if (itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str()))
+      {
+      itk::MRMLSharedMemoryImageIO::RemoveSegment((*id2fn0).second.c_str());
+      filesToDelete.erase((*id2fn0).second);
+      }
+    }
+  for (id2fn0 = nodesToReload.begin(); id2fn0 != nodesToReload.end(); ++id2fn0)
+    {
+    if (itk::MRMLSharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second.c_str()))
+      {
+      itk::MRMLSharedMemoryImageIO::RemoveSegment((*id2fn0).second.c_str());
+      filesToDelete.erase((*id2fn0).second);
+      }
+    }
+
   // Remove any remaining temporary files.  At this point, these files
   // should be the files written as inputs to the module
   if ( this->GetDeleteTemporaryFiles() )
@@ -2718,18 +4007,14 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       event == vtkSlicerApplicationLogic::RequestProcessedEvent)
     {
     vtkMTimeType uid = reinterpret_cast<vtkMTimeType>(callData);
-    vtkInternal::RequestType::iterator it =
-      std::find_if(this->Internal->LastRequests.begin(),
-      this->Internal->LastRequests.end(), vtkInternal::FindRequest(uid));
-    if (it != this->Internal->LastRequests.end())
+    // we are not interested in any request anymore because the cli node is
+    // Completed.
+    vtkMRMLCommandLineModuleNode* node = this->Internal->TakeLastRequest(uid);
+    if (node)
       {
-      vtkMRMLCommandLineModuleNode* node = it->second;
       // If the status is not Completing, then there should be no request made
       // on the application logic.
       assert(node->GetStatus() == vtkMRMLCommandLineModuleNode::Completing);
-      this->Internal->LastRequests.erase(it);
-      // we are not interested in any request anymore because the cli node is
-      // Completed.
 
       node->SetStatus(vtkMRMLCommandLineModuleNode::Completed);
       }
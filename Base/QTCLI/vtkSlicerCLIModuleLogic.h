@@ -21,13 +21,18 @@
 class ModuleDescription;
 class ModuleParameter;
 
+// VTK includes
+class vtkCollection;
+
 // MRML include
 #include "vtkMRMLScene.h"
 class vtkMRMLModelHierarchyNode;
 class MRMLIDMap;
 
 // STL includes
+#include <map>
 #include <string>
+#include <vector>
 
 #include "qSlicerBaseQTCLIExport.h"
 
@@ -80,6 +85,67 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory segments to pass scalar, label and vector
+  /// volumes to and from executable CLIs instead of temporary files.
+  /// The CLI must read and write images with ITK, as the segments are read
+  /// and written by an ITK ImageIO plugin. Files are used if shared memory is
+  /// not supported on the platform or a segment cannot be created.
+  /// Disabled by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
+  /// Control the server mode of executable CLIs. In server mode the CLI
+  /// process is kept running after an invocation and receives the next
+  /// invocations through a named pipe, which saves the startup time of the
+  /// executable. The resident process is restarted if it crashed or exited.
+  /// The CLI must be built with SEMCommandLineLibraryWrapper (library and
+  /// executable CLIs) and must not rely on global state being reset between
+  /// invocations. Not supported on Windows. Disabled by default.
+  void SetServerMode(int value);
+  int GetServerMode() const;
+
+  /// Control the cache of the results of executable CLIs. The outputs of a
+  /// run are stored on disk, keyed by the title, version and target of the
+  /// module, the parameter values and the digests of the input data. A run
+  /// with the same key loads the stored outputs instead of running the CLI.
+  /// The CLI must be deterministic. Runs that write files or directories
+  /// chosen by the user, or that pass nodes through a scene, are not cached.
+  /// Volumes are passed through files instead of shared memory segments.
+  /// Disabled by default.
+  /// \sa SetResultCacheDirectory(), SetResultCacheMaximumSize()
+  void SetResultCacheEnabled(int value);
+  int GetResultCacheEnabled() const;
+
+  /// Directory of the result cache. An empty directory (default) uses the
+  /// CLIResultCache sub-directory of the application temporary directory.
+  void SetResultCacheDirectory(const std::string& directory);
+  std::string GetResultCacheDirectory() const;
+
+  /// Maximum size in megabytes of the result cache. The least recently used
+  /// results are removed when the cache is larger. 1024 by default.
+  void SetResultCacheMaximumSize(int megabytes);
+  int GetResultCacheMaximumSize() const;
+
+  /// Key of the results of a run in the result cache: digest of the module,
+  /// of the parameter values, of the command line and of the input files
+  /// written for the input nodes (\a nodesToWrite). Names of the files written
+  /// for the nodes are removed from the command line, so that the key only
+  /// depends on their content, but the values resolved from nodes (such as
+  /// point and region coordinates) are taken into account.
+  /// \a cachedOutputs is filled with the name in the cache entry of each
+  /// output file (\a nodesToReload). Returns an empty key if the results
+  /// cannot be cached.
+  static std::string ComputeResultCacheKey(const ModuleDescription& description,
+    const std::vector<std::string>& commandLine,
+    const std::string& cliNodeID,
+    const std::map<std::string, std::string>& nodesToWrite,
+    const std::map<std::string, std::string>& nodesToReload,
+    std::map<std::string, std::string>& cachedOutputs);
+
+  /// Remove the least recently used entries of the result cache in
+  /// \a cacheDirectory until its size is below \a maximumSize bytes.
+  static void TrimResultCache(const std::string& cacheDirectory, unsigned long long maximumSize);
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -102,6 +168,37 @@ public:
   /// in the node selectors.
   void ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay = true);
 
+  /// Run the CLI once for each vtkMRMLCommandLineModuleNode of \a nodes, for
+  /// example clones of a parameter node to process many cases.
+  /// Up to MaximumNumberOfBatchJobs executable CLIs are run at the same time,
+  /// each from its own thread. Shared object and Python CLIs share the
+  /// streams and the global state of the application, they are run one after
+  /// the other. The nodes must not have the same output nodes.
+  /// This methods is blocking until all the CLIs finish to execute, as
+  /// ApplyAndWait().
+  /// \sa SetMaximumNumberOfBatchJobs(), SetNumberOfThreadsPerBatchJob(),
+  /// GetBatchJobTime(), GetBatchThroughput()
+  void ApplyBatch(vtkCollection* nodes, bool updateDisplay = false);
+
+  /// Maximum number of CLIs run at the same time by ApplyBatch().
+  /// 0 (default) uses the number of processors.
+  void SetMaximumNumberOfBatchJobs(int value);
+  int GetMaximumNumberOfBatchJobs() const;
+
+  /// Number of ITK threads of each executable CLI run at the same time by
+  /// ApplyBatch(). 0 (default) shares the processors among the CLIs, to
+  /// avoid running more threads than processors.
+  void SetNumberOfThreadsPerBatchJob(int value);
+  int GetNumberOfThreadsPerBatchJob() const;
+
+  /// Wall clock time in seconds of the \a job th CLI run by the last
+  /// ApplyBatch(), in the order of the nodes. Returns 0 if out of range.
+  double GetBatchJobTime(int job) const;
+  /// Wall clock time in seconds of the last ApplyBatch()
+  double GetBatchTime() const;
+  /// Number of CLIs run per second by the last ApplyBatch()
+  double GetBatchThroughput() const;
+
   void KillProcesses();
 
 //   void LazyEvaluateModuleTarget(ModuleDescription& moduleDescriptionObject);
@@ -127,7 +224,8 @@ protected:
                                          const std::string& type,
                                          const std::string& name,
                                      const std::vector<std::string>& extensions,
-                                     CommandLineModuleType commandType);
+                                     CommandLineModuleType commandType,
+                                     const std::string& executionTag = std::string());
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
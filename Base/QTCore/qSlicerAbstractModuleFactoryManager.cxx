@@ -20,6 +20,8 @@
 
 // Qt includes
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
 
 // SlicerQt includes
 #include "qSlicerCoreApplication.h"
@@ -41,6 +43,9 @@ public:
 
   void printAdditionalInfo();
 
+  /// Print the time each factory spent to register and instantiate modules.
+  void printTimingReport()const;
+
   typedef qSlicerAbstractModuleFactoryManager::qSlicerModuleFactory
     qSlicerModuleFactory;
   typedef qSlicerAbstractModuleFactoryManager::qSlicerFileBasedModuleFactory
@@ -60,6 +65,11 @@ public:
   QMap<QString, qSlicerModuleFactory*> RegisteredModules;
   QMap<QString, QStringList> ModuleDependees;
 
+  /// Time in milliseconds spent by each factory to register and to
+  /// instantiate its modules.
+  QHash<qSlicerModuleFactory*, qint64> RegistrationTimes;
+  QHash<qSlicerModuleFactory*, qint64> InstantiationTimes;
+
   bool Verbose;
 };
 
@@ -89,6 +99,19 @@ void qSlicerAbstractModuleFactoryManagerPrivate::printAdditionalInfo()
   qDebug() << "Instantiated modules:" << q->instantiatedModuleNames();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManagerPrivate::printTimingReport()const
+{
+  qDebug() << "Module factory timing:";
+  foreach(qSlicerModuleFactory* factory, this->Factories.keys())
+    {
+    qDebug() << "\t" << typeid(*factory).name() << ": "
+             << this->RegisteredModules.keys(factory).count() << "modules,"
+             << this->RegistrationTimes.value(factory) << "ms to register,"
+             << this->InstantiationTimes.value(factory) << "ms to instantiate";
+    }
+}
+
 //-----------------------------------------------------------------------------
 QVector<qSlicerAbstractModuleFactoryManagerPrivate::qSlicerFileBasedModuleFactory*>
 qSlicerAbstractModuleFactoryManagerPrivate::fileBasedFactories()const
@@ -254,7 +277,10 @@ void qSlicerAbstractModuleFactoryManager::registerModules()
   // \todo: don't support factories other than filebased factories
   foreach(qSlicerModuleFactory* factory, d->notFileBasedFactories())
     {
+    QElapsedTimer timer;
+    timer.start();
     factory->registerItems();
+    d->RegistrationTimes[factory] += timer.elapsed();
     foreach(const QString& moduleName, factory->itemKeys())
       {
       if (d->Verbose)
@@ -301,7 +327,11 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
       {
       qDebug() << " checking file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
       }
-    if (!factory->isValidFile(file))
+    QElapsedTimer timer;
+    timer.start();
+    bool validFile = factory->isValidFile(file);
+    d->RegistrationTimes[factory] += timer.elapsed();
+    if (!validFile)
       {
       continue;
       }
@@ -348,7 +378,10 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
     emit moduleIgnored(moduleName);
     return;
     }
+  QElapsedTimer timer;
+  timer.start();
   QString registeredModuleName = moduleFactory->registerFileItem(file);
+  d->RegistrationTimes[moduleFactory] += timer.elapsed();
   if (registeredModuleName != moduleName)
     {
     //qDebug() << "Ignore module" << moduleName;
@@ -386,6 +419,11 @@ void qSlicerAbstractModuleFactoryManager::instantiateModules()
   signal(SIGINT, SIG_DFL);
   #endif
 
+  if (d->Verbose)
+    {
+    d->printTimingReport();
+    }
+
   emit this->modulesInstantiated(this->instantiatedModuleNames());
 }
 
@@ -400,7 +438,10 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
     qCritical() << "Fail to instantiate module " << moduleName << " (not registered)";
     return 0;
     }
+  QElapsedTimer timer;
+  timer.start();
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  d->InstantiationTimes[factory] += timer.elapsed();
   if (!module)
     {
     qCritical() << "Fail to instantiate module " << moduleName;
@@ -0,0 +1,371 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Scalar volume display benchmark
+//
+// Measures the per-slice latency of mapping a scalar volume slice to RGBA display
+// colors (window/level, lookup table, threshold alpha and background stencil alpha)
+// with vtkImageMapToWindowLevelThresholdColors and with the filter chain that
+// vtkMRMLScalarVolumeDisplayNode used before, and reports the timings as JSON.
+//
+// Usage:
+//   vtkImageMapToWindowLevelThresholdColorsBenchmark [--sizes 512,2048]
+//     [--iterations N] [--warmup-iterations N] [--output file.json]
+
+// MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+
+// VTK includes
+#include <vtkImageAppendComponents.h>
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkImageLogic.h>
+#include <vtkImageMapToColors.h>
+#include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageStencil.h>
+#include <vtkImageThreshold.h>
+#include <vtkImageToImageStencil.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkOptions
+{
+  BenchmarkOptions()
+    {
+    this->SliceSizes.push_back(512);
+    this->SliceSizes.push_back(2048);
+    this->Iterations = 20;
+    this->WarmupIterations = 2;
+    }
+
+  std::vector<int> SliceSizes;
+  int Iterations;
+  int WarmupIterations;
+  std::string OutputFileName;
+};
+
+//----------------------------------------------------------------------------
+void PrintUsage(const char* executable)
+{
+  std::cerr << "Usage: " << executable << " [--sizes 512,2048] [--iterations N]"
+    << " [--warmup-iterations N] [--output file.json]" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], BenchmarkOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+    {
+    std::string argument = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (argument == "--sizes" && hasValue)
+      {
+      options.SliceSizes.clear();
+      std::stringstream sizes(argv[++i]);
+      std::string size;
+      while (std::getline(sizes, size, ','))
+        {
+        options.SliceSizes.push_back(atoi(size.c_str()));
+        }
+      }
+    else if (argument == "--iterations" && hasValue)
+      {
+      options.Iterations = atoi(argv[++i]);
+      }
+    else if (argument == "--warmup-iterations" && hasValue)
+      {
+      options.WarmupIterations = atoi(argv[++i]);
+      }
+    else if (argument == "--output" && hasValue)
+      {
+      options.OutputFileName = argv[++i];
+      }
+    else
+      {
+      std::cerr << "Invalid argument: " << argument << std::endl;
+      return false;
+      }
+    }
+  if (options.SliceSizes.empty() || options.Iterations < 1 || options.WarmupIterations < 0)
+    {
+    std::cerr << "Invalid benchmark parameters" << std::endl;
+    return false;
+    }
+  for (std::vector<int>::iterator it = options.SliceSizes.begin(); it != options.SliceSizes.end(); ++it)
+    {
+    if (*it < 1)
+      {
+      std::cerr << "Invalid slice size: " << *it << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Filter chain of vtkMRMLScalarVolumeDisplayNode before the single pass filter
+class DisplayFilterChain
+{
+public:
+  DisplayFilterChain()
+    {
+    this->MapToWindowLevelColors->SetOutputFormatToLuminance();
+    this->MapToColors->SetOutputFormatToRGBA();
+    this->MapToColors->SetInputConnection(this->MapToWindowLevelColors->GetOutputPort());
+    this->ExtractRGB->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractRGB->SetComponents(0, 1, 2);
+    this->ExtractAlpha->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractAlpha->SetComponents(3);
+    this->Threshold->ReplaceInOn();
+    this->Threshold->SetInValue(255);
+    this->Threshold->ReplaceOutOn();
+    this->Threshold->SetOutValue(255);
+    this->Threshold->SetOutputScalarTypeToUnsignedChar();
+    this->MultiplyAlpha->SetInputConnection(0, this->ExtractAlpha->GetOutputPort());
+    this->MultiplyAlpha->SetBackgroundValue(0);
+    this->AlphaLogic->SetOperationToAnd();
+    this->AlphaLogic->SetOutputTrueValue(255);
+    this->AlphaLogic->SetInputConnection(0, this->Threshold->GetOutputPort());
+    this->AlphaLogic->SetInputConnection(1, this->MultiplyAlpha->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort());
+    }
+
+  void Configure(vtkImageMapToWindowLevelThresholdColors* filter)
+    {
+    this->MapToWindowLevelColors->SetInputConnection(filter->GetInputConnection(0, 0));
+    this->Threshold->SetInputConnection(filter->GetInputConnection(0, 0));
+    this->MapToWindowLevelColors->SetWindow(filter->GetWindow());
+    this->MapToWindowLevelColors->SetLevel(filter->GetLevel());
+    this->MapToColors->SetLookupTable(filter->GetLookupTable());
+    this->Threshold->ThresholdBetween(filter->GetLowerThreshold(), filter->GetUpperThreshold());
+    this->Threshold->SetOutValue(filter->GetApplyThreshold() ? 0 : 255);
+    this->MultiplyAlpha->SetStencilConnection(filter->GetStencilConnection());
+    }
+
+  vtkImageData* Update()
+    {
+    this->AppendComponents->Update();
+    return this->AppendComponents->GetOutput();
+    }
+
+  vtkNew<vtkImageMapToWindowLevelColors> MapToWindowLevelColors;
+  vtkNew<vtkImageMapToColors> MapToColors;
+  vtkNew<vtkImageExtractComponents> ExtractRGB;
+  vtkNew<vtkImageExtractComponents> ExtractAlpha;
+  vtkNew<vtkImageThreshold> Threshold;
+  vtkNew<vtkImageStencil> MultiplyAlpha;
+  vtkNew<vtkImageLogic> AlphaLogic;
+  vtkNew<vtkImageAppendComponents> AppendComponents;
+};
+
+//----------------------------------------------------------------------------
+/// Slice image with values in [-1000, 3000] and a circular mask
+void CreateSliceImage(vtkImageData* image, vtkImageData* mask, int size)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  image->AllocateScalars(VTK_SHORT, 1);
+  mask->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  mask->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  short* imagePtr = static_cast<short*>(image->GetScalarPointer());
+  unsigned char* maskPtr = static_cast<unsigned char*>(mask->GetScalarPointer());
+  const int radius = size / 2;
+  for (int y = 0; y < size; y++)
+    {
+    for (int x = 0; x < size; x++)
+      {
+      *(imagePtr++) = static_cast<short>(-1000 + (x * 37 + y * 11) % 4001);
+      int dx = x - radius;
+      int dy = y - radius;
+      *(maskPtr++) = (dx * dx + dy * dy < radius * radius) ? 1 : 0;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Returns false if the outputs differ by more than the window/level rounding
+bool CompareOutputs(vtkImageData* expected, vtkImageData* actual)
+{
+  if (actual->GetNumberOfScalarComponents() != 4 || actual->GetScalarType() != VTK_UNSIGNED_CHAR
+    || actual->GetNumberOfPoints() != expected->GetNumberOfPoints())
+    {
+    return false;
+    }
+  const unsigned char* expectedPtr = static_cast<unsigned char*>(expected->GetScalarPointer());
+  const unsigned char* actualPtr = static_cast<unsigned char*>(actual->GetScalarPointer());
+  vtkIdType numberOfValues = actual->GetNumberOfPoints() * 4;
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    int tolerance = (i % 4 == 3) ? 0 : 1;
+    if (abs(int(expectedPtr[i]) - int(actualPtr[i])) > tolerance)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Time in milliseconds of recomputing the output of a modified slice
+double MeasureChainLatency(DisplayFilterChain& chain, vtkImageData* image)
+{
+  double startTime = vtkTimerLog::GetUniversalTime();
+  image->Modified();
+  chain.Update();
+  return (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+}
+
+//----------------------------------------------------------------------------
+double MeasureFilterLatency(vtkImageMapToWindowLevelThresholdColors* filter, vtkImageData* image)
+{
+  double startTime = vtkTimerLog::GetUniversalTime();
+  image->Modified();
+  filter->Update();
+  return (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+}
+
+//----------------------------------------------------------------------------
+void WriteStatistics(std::ostream& os, std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (std::vector<double>::iterator it = times.begin(); it != times.end(); ++it)
+    {
+    sum += *it;
+    }
+  size_t count = times.size();
+  os << "{\"mean\": " << (count ? sum / count : 0.0)
+     << ", \"median\": " << (count ? times[count / 2] : 0.0)
+     << ", \"p95\": " << (count ? times[std::min(count - 1, static_cast<size_t>(0.95 * count))] : 0.0)
+     << ", \"min\": " << (count ? times.front() : 0.0)
+     << ", \"max\": " << (count ? times.back() : 0.0) << "}";
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  if (!ParseArguments(argc, argv, options))
+    {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->SetTableRange(0, 255);
+  lookupTable->SetNumberOfTableValues(256);
+  for (int i = 0; i < 256; i++)
+    {
+    // First entries are transparent
+    lookupTable->SetTableValue(i, i / 255.0, 1.0 - i / 255.0, 0.5, i < 10 ? 0.0 : 1.0);
+    }
+
+  // Threshold and background stencil are applied, as in a typical foreground layer
+  vtkNew<vtkImageData> image;
+  vtkNew<vtkImageData> mask;
+  vtkNew<vtkImageToImageStencil> maskToStencil;
+  maskToStencil->SetInputData(mask.GetPointer());
+  maskToStencil->ThresholdByUpper(1);
+
+  vtkNew<vtkImageMapToWindowLevelThresholdColors> filter;
+  filter->SetInputData(image.GetPointer());
+  filter->SetLookupTable(lookupTable.GetPointer());
+  filter->SetWindow(2000);
+  filter->SetLevel(500);
+  filter->SetLowerThreshold(-200);
+  filter->SetUpperThreshold(2500);
+  filter->SetApplyThreshold(true);
+  filter->SetStencilConnection(maskToStencil->GetOutputPort());
+
+  DisplayFilterChain chain;
+  chain.Configure(filter.GetPointer());
+
+  std::stringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"vtkImageMapToWindowLevelThresholdColorsBenchmark\",\n"
+       << "  \"parameters\": {\"iterations\": " << options.Iterations
+       << ", \"warmupIterations\": " << options.WarmupIterations << "},\n"
+       << "  \"units\": \"ms\",\n"
+       << "  \"slices\": [";
+  for (size_t sizeIndex = 0; sizeIndex < options.SliceSizes.size(); sizeIndex++)
+    {
+    const int size = options.SliceSizes[sizeIndex];
+    CreateSliceImage(image.GetPointer(), mask.GetPointer(), size);
+    maskToStencil->Update();
+
+    std::vector<double> chainTimes;
+    std::vector<double> filterTimes;
+    for (int iteration = 0; iteration < options.WarmupIterations + options.Iterations; iteration++)
+      {
+      double chainTime = MeasureChainLatency(chain, image.GetPointer());
+      double filterTime = MeasureFilterLatency(filter.GetPointer(), image.GetPointer());
+      if (iteration < options.WarmupIterations)
+        {
+        continue;
+        }
+      chainTimes.push_back(chainTime);
+      filterTimes.push_back(filterTime);
+      }
+
+    // Timings are only meaningful if both compute the same slice
+    if (!CompareOutputs(chain.Update(), filter->GetOutput()))
+      {
+      std::cerr << "Output mismatch between the filter chain and the single pass filter for "
+        << size << "x" << size << " slice" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    json << (sizeIndex > 0 ? "," : "") << "\n"
+         << "    {\n"
+         << "      \"size\": [" << size << ", " << size << "],\n"
+         << "      \"filterChain\": ";
+    WriteStatistics(json, chainTimes);
+    json << ",\n"
+         << "      \"singlePass\": ";
+    WriteStatistics(json, filterTimes);
+    json << "\n    }";
+    }
+  json << "\n  ]\n}\n";
+
+  if (options.OutputFileName.empty())
+    {
+    std::cout << json.str();
+    }
+  else
+    {
+    std::ofstream output(options.OutputFileName.c_str());
+    if (!output)
+      {
+      std::cerr << "Failed to write output file: " << options.OutputFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    output << json.str();
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+
+// VTK includes
+#include <vtkImageAppendComponents.h>
+#include <vtkImageCast.h>
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkImageLogic.h>
+#include <vtkImageMapToColors.h>
+#include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageStencil.h>
+#include <vtkImageThreshold.h>
+#include <vtkImageToImageStencil.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Filter chain of vtkMRMLScalarVolumeDisplayNode
+class DisplayFilterChain
+{
+public:
+  DisplayFilterChain()
+    {
+    this->MapToWindowLevelColors->SetOutputFormatToLuminance();
+    this->MapToColors->SetOutputFormatToRGBA();
+    this->MapToColors->SetInputConnection(this->MapToWindowLevelColors->GetOutputPort());
+    this->ExtractRGB->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractRGB->SetComponents(0, 1, 2);
+    this->ExtractAlpha->SetInputConnection(this->MapToColors->GetOutputPort());
+    this->ExtractAlpha->SetComponents(3);
+    this->Threshold->ReplaceInOn();
+    this->Threshold->SetInValue(255);
+    this->Threshold->ReplaceOutOn();
+    this->Threshold->SetOutValue(255);
+    this->Threshold->SetOutputScalarTypeToUnsignedChar();
+    this->MultiplyAlpha->SetInputConnection(0, this->ExtractAlpha->GetOutputPort());
+    this->MultiplyAlpha->SetBackgroundValue(0);
+    this->AlphaLogic->SetOperationToAnd();
+    this->AlphaLogic->SetOutputTrueValue(255);
+    this->AlphaLogic->SetInputConnection(0, this->Threshold->GetOutputPort());
+    this->AlphaLogic->SetInputConnection(1, this->MultiplyAlpha->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort());
+    this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort());
+    }
+
+  void Configure(vtkImageMapToWindowLevelThresholdColors* filter)
+    {
+    this->MapToWindowLevelColors->SetInputConnection(filter->GetInputConnection(0, 0));
+    this->Threshold->SetInputConnection(filter->GetInputConnection(0, 0));
+    this->MapToWindowLevelColors->SetWindow(filter->GetWindow());
+    this->MapToWindowLevelColors->SetLevel(filter->GetLevel());
+    this->MapToColors->SetLookupTable(filter->GetLookupTable());
+    this->Threshold->ThresholdBetween(filter->GetLowerThreshold(), filter->GetUpperThreshold());
+    this->Threshold->SetOutValue(filter->GetApplyThreshold() ? 0 : 255);
+    this->MultiplyAlpha->SetStencilConnection(filter->GetStencilConnection());
+    }
+
+  vtkImageData* Update()
+    {
+    this->AppendComponents->Update();
+    return this->AppendComponents->GetOutput();
+    }
+
+  vtkNew<vtkImageMapToWindowLevelColors> MapToWindowLevelColors;
+  vtkNew<vtkImageMapToColors> MapToColors;
+  vtkNew<vtkImageExtractComponents> ExtractRGB;
+  vtkNew<vtkImageExtractComponents> ExtractAlpha;
+  vtkNew<vtkImageThreshold> Threshold;
+  vtkNew<vtkImageStencil> MultiplyAlpha;
+  vtkNew<vtkImageLogic> AlphaLogic;
+  vtkNew<vtkImageAppendComponents> AppendComponents;
+};
+
+//----------------------------------------------------------------------------
+/// Slice image with values in [-1000, 3000] and a circular mask
+void CreateSliceImage(vtkImageData* image, vtkImageData* mask, int size)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  image->AllocateScalars(VTK_SHORT, 1);
+  mask->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  mask->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  short* imagePtr = static_cast<short*>(image->GetScalarPointer());
+  unsigned char* maskPtr = static_cast<unsigned char*>(mask->GetScalarPointer());
+  const int radius = size / 2;
+  for (int y = 0; y < size; y++)
+    {
+    for (int x = 0; x < size; x++)
+      {
+      *(imagePtr++) = static_cast<short>(-1000 + (x * 37 + y * 11) % 4001);
+      int dx = x - radius;
+      int dy = y - radius;
+      *(maskPtr++) = (dx * dx + dy * dy < radius * radius) ? 1 : 0;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool CompareOutputs(vtkImageData* expected, vtkImageData* actual, int line)
+{
+  if (actual->GetNumberOfScalarComponents() != 4 || actual->GetScalarType() != VTK_UNSIGNED_CHAR
+    || actual->GetNumberOfPoints() != expected->GetNumberOfPoints())
+    {
+    std::cerr << line << ": Unexpected output image format" << std::endl;
+    return false;
+    }
+  const unsigned char* expectedPtr = static_cast<unsigned char*>(expected->GetScalarPointer());
+  const unsigned char* actualPtr = static_cast<unsigned char*>(actual->GetScalarPointer());
+  vtkIdType numberOfValues = actual->GetNumberOfPoints() * 4;
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    // Window/level rounding may differ by one at the window boundaries
+    int tolerance = (i % 4 == 3) ? 0 : 1;
+    if (abs(int(expectedPtr[i]) - int(actualPtr[i])) > tolerance)
+      {
+      std::cerr << line << ": Output mismatch at voxel " << i / 4 << " component " << i % 4
+        << ": " << int(actualPtr[i]) << " (expected " << int(expectedPtr[i]) << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Check red and alpha components of the output voxel \a x. The red component
+/// of the test lookup table is the window/level mapped value.
+bool CheckVoxel(vtkImageData* output, int x, int expectedRed, int expectedAlpha, int line)
+{
+  int red = static_cast<int>(output->GetScalarComponentAsDouble(x, 0, 0, 0));
+  int alpha = static_cast<int>(output->GetScalarComponentAsDouble(x, 0, 0, 3));
+  if (abs(red - expectedRed) > 1 || alpha != expectedAlpha)
+    {
+    std::cerr << line << ": Voxel " << x << " is (red " << red << ", alpha " << alpha
+      << "), expected (red " << expectedRed << ", alpha " << expectedAlpha << ")" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColorsTest1(int , char * [] )
+{
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->SetTableRange(0, 255);
+  lookupTable->SetNumberOfTableValues(256);
+  for (int i = 0; i < 256; i++)
+    {
+    // First entries are transparent
+    lookupTable->SetTableValue(i, i / 255.0, 1.0 - i / 255.0, 0.5, i < 10 ? 0.0 : 1.0);
+    }
+
+  vtkNew<vtkImageData> image;
+  vtkNew<vtkImageData> mask;
+  vtkNew<vtkImageToImageStencil> maskToStencil;
+  maskToStencil->SetInputData(mask.GetPointer());
+  maskToStencil->ThresholdByUpper(1);
+
+  vtkNew<vtkImageMapToWindowLevelThresholdColors> filter;
+  filter->SetInputData(image.GetPointer());
+  filter->SetLookupTable(lookupTable.GetPointer());
+  filter->SetWindow(2000);
+  filter->SetLevel(500);
+  filter->SetLowerThreshold(-200);
+  filter->SetUpperThreshold(2500);
+
+  DisplayFilterChain chain;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Same output as the filter chain
+
+  CreateSliceImage(image.GetPointer(), mask.GetPointer(), 64);
+  for (int applyThreshold = 0; applyThreshold <= 1; applyThreshold++)
+    {
+    for (int useStencil = 0; useStencil <= 1; useStencil++)
+      {
+      filter->SetApplyThreshold(applyThreshold != 0);
+      filter->SetStencilConnection(useStencil ? maskToStencil->GetOutputPort() : 0);
+      chain.Configure(filter.GetPointer());
+      filter->Update();
+      if (!CompareOutputs(chain.Update(), filter->GetOutput(), __LINE__))
+        {
+        std::cerr << "ApplyThreshold: " << applyThreshold << ", stencil: " << useStencil << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Floating point input is mapped without value table
+  vtkNew<vtkImageCast> castToFloat;
+  castToFloat->SetInputData(image.GetPointer());
+  castToFloat->SetOutputScalarTypeToFloat();
+  filter->SetInputConnection(castToFloat->GetOutputPort());
+  filter->SetWindow(1234.5);
+  chain.Configure(filter.GetPointer());
+  filter->Update();
+  if (!CompareOutputs(chain.Update(), filter->GetOutput(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  filter->SetInputData(image.GetPointer());
+  filter->SetWindow(2000);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Threshold and window results
+
+  vtkNew<vtkImageData> values;
+  values->SetExtent(0, 7, 0, 0, 0, 0);
+  values->AllocateScalars(VTK_SHORT, 1);
+  const short voxelValues[8] = { -1000, -201, -200, 500, 1500, 2500, 2501, 3000 };
+  for (int x = 0; x < 8; x++)
+    {
+    values->SetScalarComponentFromDouble(x, 0, 0, 0, voxelValues[x]);
+    }
+  filter->SetInputData(values.GetPointer());
+  filter->SetStencilConnection(0);
+  filter->SetApplyThreshold(true);
+  filter->SetWindow(2000);
+  filter->SetLevel(500);
+  filter->Update();
+  vtkImageData* output = filter->GetOutput();
+  // Window [-500, 1500]; lookup table entries below 10 are transparent;
+  // threshold range [-200, 2500]
+  if (!CheckVoxel(output, 0, 0, 0, __LINE__)          // below window, transparent color
+    || !CheckVoxel(output, 1, 38, 0, __LINE__)        // below threshold
+    || !CheckVoxel(output, 2, 38, 255, __LINE__)      // lower threshold is included
+    || !CheckVoxel(output, 3, 128, 255, __LINE__)     // level
+    || !CheckVoxel(output, 4, 255, 255, __LINE__)     // top of the window
+    || !CheckVoxel(output, 5, 255, 255, __LINE__)     // upper threshold is included
+    || !CheckVoxel(output, 6, 255, 0, __LINE__)       // above threshold
+    || !CheckVoxel(output, 7, 255, 0, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Changing the window and disabling the threshold updates the output
+  filter->SetApplyThreshold(false);
+  filter->SetWindow(1000);
+  filter->Update();
+  output = filter->GetOutput();
+  // Window [0, 1000]
+  if (!CheckVoxel(output, 1, 0, 0, __LINE__)          // transparent color
+    || !CheckVoxel(output, 3, 128, 255, __LINE__)
+    || !CheckVoxel(output, 4, 255, 255, __LINE__)
+    || !CheckVoxel(output, 7, 255, 255, __LINE__))    // threshold not applied
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -12,10 +12,163 @@
 
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLGridTransformNode.h"
+#include "vtkOrientedGridTransform.h"
 
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Smooth displacement field of 20 x 20 x 20 grid points with 10mm spacing
+void CreateGridTransform(vtkOrientedGridTransform* gridTransform, double amplitude)
+{
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(0, 19, 0, 19, 0, 19);
+  displacementGrid->SetOrigin(-100.0, -100.0, -100.0);
+  displacementGrid->SetSpacing(10.0, 10.0, 10.0);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  for (int k = 0; k < 20; k++)
+    {
+    for (int j = 0; j < 20; j++)
+      {
+      for (int i = 0; i < 20; i++)
+        {
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 0, amplitude * sin(j * 0.3));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 1, amplitude * cos(k * 0.2));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 2, amplitude * sin(i * 0.25));
+        }
+      }
+    }
+  vtkNew<vtkMatrix4x4> gridDirection;
+  gridTransform->SetGridDirectionMatrix(gridDirection.GetPointer());
+  gridTransform->SetDisplacementGridData(displacementGrid.GetPointer());
+  gridTransform->SetInterpolationModeToCubic();
+}
+
+//----------------------------------------------------------------------------
+/// Maximum distance between points transformed by the cached inverse and the
+/// iteratively computed inverse
+double GetMaximumInverseError(vtkAbstractTransform* cachedInverse, vtkAbstractTransform* forwardTransform)
+{
+  double maxError = 0.0;
+  for (double z = -60.0; z <= 60.0; z += 13.0)
+    {
+    for (double y = -60.0; y <= 60.0; y += 11.0)
+      {
+      for (double x = -60.0; x <= 60.0; x += 17.0)
+        {
+        double point[3] = { x, y, z };
+        double expected[3] = { 0.0, 0.0, 0.0 };
+        double actual[3] = { 0.0, 0.0, 0.0 };
+        forwardTransform->GetInverse()->TransformPoint(point, expected);
+        cachedInverse->TransformPoint(point, actual);
+        double error = sqrt(vtkMath::Distance2BetweenPoints(expected, actual));
+        maxError = std::max(maxError, error);
+        }
+      }
+    }
+  return maxError;
+}
+
+//----------------------------------------------------------------------------
+/// Returns the transform to world if it consists of a single transform
+vtkAbstractTransform* GetSingleTransformToWorldComponent(vtkMRMLTransformNode* node)
+{
+  vtkNew<vtkGeneralTransform> transformToWorld;
+  node->GetTransformToWorld(transformToWorld.GetPointer());
+  vtkNew<vtkCollection> transformToWorldComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformToWorldComponents.GetPointer(), transformToWorld.GetPointer());
+  if (transformToWorldComponents->GetNumberOfItems() != 1)
+    {
+    return NULL;
+    }
+  return vtkAbstractTransform::SafeDownCast(transformToWorldComponents->GetItemAsObject(0));
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 int vtkMRMLGridTransformNodeTest1(int , char * [] )
 {
   vtkNew<vtkMRMLGridTransformNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  //////////////////////////////////////////////////////////////////////////
+  // Cached inverse
+
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  CreateGridTransform(gridTransform.GetPointer(), 3.0);
+  vtkNew<vtkMRMLGridTransformNode> gridNode;
+  gridNode->SetAndObserveTransformFromParent(gridTransform.GetPointer());
+
+  // disabled by default, inverse is computed iteratively
+  CHECK_BOOL(gridNode->GetCacheInverse(), false);
+  vtkAbstractTransform* transformToParent = gridNode->GetTransformToParent();
+  CHECK_BOOL(vtkOrientedGridTransform::SafeDownCast(transformToParent) != NULL, true);
+  CHECK_BOOL(vtkOrientedGridTransform::SafeDownCast(transformToParent)->GetInverseFlag() != 0, true);
+
+  gridNode->SetCacheInverse(true);
+  gridNode->SetCachedInverseSpacing(5.0);
+  // the exact inverse is returned by the node (it is saved to file and recognized as an inverse)
+  transformToParent = gridNode->GetTransformToParent();
+  CHECK_BOOL(vtkOrientedGridTransform::SafeDownCast(transformToParent)->GetInverseFlag() != 0, true);
+  CHECK_POINTER(gridNode->GetTransformFromParent(), gridTransform.GetPointer());
+
+  // the cached inverse is used for computing the transform to world
+  vtkAbstractTransform* cachedInverse = GetSingleTransformToWorldComponent(gridNode.GetPointer());
+  CHECK_NOT_NULL(vtkOrientedGridTransform::SafeDownCast(cachedInverse));
+  CHECK_INT(vtkOrientedGridTransform::SafeDownCast(cachedInverse)->GetInverseFlag(), 0);
+  CHECK_BOOL(cachedInverse != transformToParent, true);
+  // same cached inverse is returned while the transform is not modified
+  vtkMTimeType cachedInverseMTime = cachedInverse->GetMTime();
+  CHECK_POINTER(GetSingleTransformToWorldComponent(gridNode.GetPointer()), cachedInverse);
+  CHECK_INT(cachedInverse->GetMTime(), cachedInverseMTime);
+
+  // the transform from world uses the transform that was set, not the inverse of the cached inverse
+  vtkNew<vtkGeneralTransform> transformFromWorld;
+  gridNode->GetTransformFromWorld(transformFromWorld.GetPointer());
+  vtkNew<vtkCollection> transformFromWorldComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformFromWorldComponents.GetPointer(), transformFromWorld.GetPointer());
+  CHECK_INT(transformFromWorldComponents->GetNumberOfItems(), 1);
+  CHECK_POINTER(transformFromWorldComponents->GetItemAsObject(0), gridTransform.GetPointer());
+
+  double maxError = GetMaximumInverseError(cachedInverse, gridTransform.GetPointer());
+  std::cout << "Cached inverse maximum error: " << maxError << " mm" << std::endl;
+  if (maxError > 0.1)
+    {
+    std::cerr << __LINE__ << ": Cached inverse error is too large: " << maxError << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // modifying the transform updates the cached inverse
+  CreateGridTransform(gridTransform.GetPointer(), 5.0);
+  CHECK_POINTER(GetSingleTransformToWorldComponent(gridNode.GetPointer()), cachedInverse);
+  CHECK_BOOL(cachedInverse->GetMTime() > cachedInverseMTime, true);
+  maxError = GetMaximumInverseError(cachedInverse, gridTransform.GetPointer());
+  if (maxError > 0.1)
+    {
+    std::cerr << __LINE__ << ": Cached inverse error is too large after transform modification: " << maxError << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // disabling the cache restores iterative inverse computation
+  gridNode->SetCacheInverse(false);
+  transformToParent = gridNode->GetTransformToParent();
+  CHECK_BOOL(vtkOrientedGridTransform::SafeDownCast(transformToParent)->GetInverseFlag() != 0, true);
+  vtkOrientedGridTransform* inverseToWorld =
+    vtkOrientedGridTransform::SafeDownCast(GetSingleTransformToWorldComponent(gridNode.GetPointer()));
+  CHECK_NOT_NULL(inverseToWorld);
+  CHECK_BOOL(inverseToWorld->GetInverseFlag() != 0, true);
+
   return EXIT_SUCCESS;
 }
@@ -13,9 +13,127 @@
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 
+// VTK includes
+#include <vtkAlgorithm.h>
+#include <vtkAlgorithmOutput.h>
+#include <vtkImageData.h>
+#include <vtkTrivialProducer.h>
+
+// STD includes
+#include <cstdlib>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Check the display color of the voxel of value \a value in the ramp image.
+/// Without color node the colors are gray levels.
+bool CheckDisplayedValue(vtkMRMLScalarVolumeDisplayNode* node, int value,
+                         int expectedGray, int expectedAlpha, int line)
+{
+  vtkAlgorithmOutput* outputConnection = node->GetOutputImageDataConnection();
+  vtkAlgorithm* outputAlgorithm = outputConnection ? outputConnection->GetProducer() : 0;
+  if (!outputAlgorithm)
+    {
+    std::cerr << line << ": No output image" << std::endl;
+    return false;
+    }
+  outputAlgorithm->Update();
+  vtkImageData* output = vtkImageData::SafeDownCast(
+    outputAlgorithm->GetOutputDataObject(outputConnection->GetIndex()));
+  if (!output || output->GetNumberOfScalarComponents() != 4)
+    {
+    std::cerr << line << ": Output is not an RGBA image" << std::endl;
+    return false;
+    }
+  int gray = static_cast<int>(output->GetScalarComponentAsDouble(value, 0, 0, 0));
+  int alpha = static_cast<int>(output->GetScalarComponentAsDouble(value, 0, 0, 3));
+  // window/level mapping may round differently by one
+  if (abs(gray - expectedGray) > 1 || alpha != expectedAlpha)
+    {
+    std::cerr << line << ": Value " << value << " is displayed as gray " << gray
+              << " alpha " << alpha << ", expected gray " << expectedGray
+              << " alpha " << expectedAlpha
+              << " (window: " << node->GetWindow() << ", level: " << node->GetLevel() << ")"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int TestDisplayedColors()
+{
+  // Ramp image: the voxel i has the value i
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(256, 1, 1);
+  image->AllocateScalars(VTK_SHORT, 1);
+  for (int i = 0; i < 256; ++i)
+    {
+    image->SetScalarComponentFromDouble(i, 0, 0, 0, i);
+    }
+  vtkNew<vtkTrivialProducer> producer;
+  producer->SetOutput(image.GetPointer());
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> node;
+  node->SetAutoWindowLevel(0);
+  node->SetInputImageDataConnection(producer->GetOutputPort());
+
+  // SetWindowLevel() must update the window and the level of the output
+  node->SetWindowLevel(100., 50.);
+  if (!CheckDisplayedValue(node.GetPointer(), 0, 0, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 50, 128, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 100, 255, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 200, 255, 255, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // as done by auto window/level
+  node->SetWindowLevelMinMax(100., 200.);
+  if (!CheckDisplayedValue(node.GetPointer(), 50, 0, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 150, 128, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 200, 255, 255, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // as done by window/level dragging
+  node->SetWindow(50.);
+  node->SetLevel(100.);
+  if (!CheckDisplayedValue(node.GetPointer(), 75, 0, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 100, 128, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 125, 255, 255, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Voxels out of the threshold range are transparent
+  node->SetWindowLevel(256., 128.);
+  node->SetThreshold(20., 200.);
+  node->SetApplyThreshold(1);
+  if (!CheckDisplayedValue(node.GetPointer(), 10, 10, 0, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 20, 20, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 200, 200, 255, __LINE__) ||
+      !CheckDisplayedValue(node.GetPointer(), 201, 201, 0, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  node->SetApplyThreshold(0);
+  if (!CheckDisplayedValue(node.GetPointer(), 10, 10, 255, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
 int vtkMRMLScalarVolumeDisplayNodeTest1(int , char * [] )
 {
   vtkNew<vtkMRMLScalarVolumeDisplayNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  CHECK_EXIT_SUCCESS(TestDisplayedColors());
   return EXIT_SUCCESS;
 }
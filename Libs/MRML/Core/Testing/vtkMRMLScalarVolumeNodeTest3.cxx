@@ -0,0 +1,205 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkOrientedBSplineTransform.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// B-spline covering the volume, optionally with a bulk transform
+void CreateBSpline(vtkOrientedBSplineTransform* bsplineTransform, bool withBulkTransform)
+{
+  vtkNew<vtkImageData> coefficients;
+  coefficients->SetExtent(0, 6, 0, 6, 0, 6);
+  coefficients->SetOrigin(-35.0, -5.0, -10.0);
+  coefficients->SetSpacing(15.0, 15.0, 15.0);
+  coefficients->AllocateScalars(VTK_DOUBLE, 3);
+  for (int k = 0; k <= 6; k++)
+    {
+    for (int j = 0; j <= 6; j++)
+      {
+      for (int i = 0; i <= 6; i++)
+        {
+        coefficients->SetScalarComponentFromDouble(i, j, k, 0, 3.0 * sin(0.9 * i + 0.4 * j));
+        coefficients->SetScalarComponentFromDouble(i, j, k, 1, 2.0 * cos(0.7 * j - 0.5 * k));
+        coefficients->SetScalarComponentFromDouble(i, j, k, 2, 2.5 * sin(0.6 * k + 0.8 * i));
+        }
+      }
+    }
+  bsplineTransform->SetCoefficientData(coefficients.GetPointer());
+
+  // Grid axes aligned with the volume axes, as for a registration result
+  vtkNew<vtkMatrix4x4> gridDirection;
+  bsplineTransform->SetGridDirectionMatrix(gridDirection.GetPointer());
+
+  if (withBulkTransform)
+    {
+    vtkNew<vtkTransform> bulkTransform;
+    bulkTransform->RotateZ(5.0);
+    bulkTransform->RotateX(-3.0);
+    bulkTransform->Translate(1.5, -2.0, 0.5);
+    bsplineTransform->SetBulkTransformMatrix(bulkTransform->GetMatrix());
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Smooth intensity pattern with a background value in the corners
+void CreateVolume(vtkMRMLScalarVolumeNode* volumeNode)
+{
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(30, 25, 20);
+  imageData->AllocateScalars(VTK_FLOAT, 1);
+  for (int k = 0; k < 20; k++)
+    {
+    for (int j = 0; j < 25; j++)
+      {
+      for (int i = 0; i < 30; i++)
+        {
+        imageData->SetScalarComponentFromDouble(i, j, k, 0,
+          100.0 + 40.0 * sin(0.3 * i) * cos(0.25 * j) + 2.0 * k);
+        }
+      }
+    }
+  volumeNode->SetOrigin(-20.0, 10.0, 5.0);
+  volumeNode->SetSpacing(1.5, 1.2, 2.0);
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+/// Harden the b-spline on a volume and compare the result with resampling
+/// the volume directly through the b-spline with vtkImageReslice.
+int TestBSplineHardening(bool withBulkTransform)
+{
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  CreateVolume(volumeNode.GetPointer());
+
+  // Reference, resampled as vtkMRMLVolumeNode::ApplyNonLinearTransform
+  // does for any non-linear transform
+  vtkNew<vtkOrientedBSplineTransform> referenceBSpline;
+  CreateBSpline(referenceBSpline.GetPointer(), withBulkTransform);
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  volumeNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  vtkNew<vtkMatrix4x4> rasToIJK;
+  volumeNode->GetRASToIJKMatrix(rasToIJK.GetPointer());
+  vtkNew<vtkGeneralTransform> resampleTransform;
+  resampleTransform->PostMultiply();
+  resampleTransform->Concatenate(ijkToRAS.GetPointer());
+  resampleTransform->Concatenate(referenceBSpline.GetPointer());
+  resampleTransform->Concatenate(rasToIJK.GetPointer());
+
+  vtkNew<vtkImageData> originalImage;
+  originalImage->DeepCopy(volumeNode->GetImageData());
+  vtkNew<vtkImageReslice> reslice;
+  reslice->GenerateStencilOutputOn();
+  reslice->SetResliceTransform(resampleTransform.GetPointer());
+  reslice->SetInputData(originalImage.GetPointer());
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetBackgroundLevel(volumeNode->GetImageBackgroundScalarComponentAsDouble(0));
+  reslice->AutoCropOutputOn();
+  reslice->TransformInputSamplingOff();
+  reslice->SetOptimization(1);
+  reslice->SetOutputDimensionality(3);
+  reslice->Update();
+  vtkImageData* expectedImage = reslice->GetOutput();
+
+  // Hardening: the transform to world of a registration result is the
+  // inverse of the b-spline, the resampling transform is the b-spline
+  vtkNew<vtkOrientedBSplineTransform> bsplineTransform;
+  CreateBSpline(bsplineTransform.GetPointer(), withBulkTransform);
+  bsplineTransform->Inverse();
+  volumeNode->ApplyNonLinearTransform(bsplineTransform.GetPointer());
+  vtkImageData* actualImage = volumeNode->GetImageData();
+
+  int expectedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  expectedImage->GetExtent(expectedExtent);
+  int actualExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  actualImage->GetExtent(actualExtent);
+  for (int i = 0; i < 6; i++)
+    {
+    if (actualExtent[i] != expectedExtent[i])
+      {
+      std::cerr << __LINE__ << ": Extent mismatch at index " << i << ": "
+        << actualExtent[i] << " != " << expectedExtent[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  double expectedOrigin_IJK[4] = { 0.0, 0.0, 0.0, 1.0 };
+  expectedImage->GetOrigin(expectedOrigin_IJK);
+  double expectedOrigin_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+  ijkToRAS->MultiplyPoint(expectedOrigin_IJK, expectedOrigin_RAS);
+  double* actualOrigin_RAS = volumeNode->GetOrigin();
+  for (int i = 0; i < 3; i++)
+    {
+    if (fabs(actualOrigin_RAS[i] - expectedOrigin_RAS[i]) > 1e-6)
+      {
+      std::cerr << __LINE__ << ": Origin mismatch at index " << i << ": "
+        << actualOrigin_RAS[i] << " != " << expectedOrigin_RAS[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Displacements are computed in single precision, intensity differences
+  // are expected to be small but not zero
+  int numberOfDifferences = 0;
+  double maximumDifference = 0.0;
+  for (int k = expectedExtent[4]; k <= expectedExtent[5]; k++)
+    {
+    for (int j = expectedExtent[2]; j <= expectedExtent[3]; j++)
+      {
+      for (int i = expectedExtent[0]; i <= expectedExtent[1]; i++)
+        {
+        double difference = fabs(actualImage->GetScalarComponentAsDouble(i, j, k, 0)
+          - expectedImage->GetScalarComponentAsDouble(i, j, k, 0));
+        maximumDifference = std::max(maximumDifference, difference);
+        if (difference > 1e-2)
+          {
+          numberOfDifferences++;
+          }
+        }
+      }
+    }
+  if (numberOfDifferences > 0)
+    {
+    std::cerr << __LINE__ << ": Hardened volume differs from the resampled volume "
+      << (withBulkTransform ? "with" : "without") << " bulk transform in "
+      << numberOfDifferences << " voxels, maximum difference: " << maximumDifference << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLScalarVolumeNodeTest3(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(TestBSplineHardening(false));
+  CHECK_EXIT_SUCCESS(TestBSplineHardening(true));
+  return EXIT_SUCCESS;
+}
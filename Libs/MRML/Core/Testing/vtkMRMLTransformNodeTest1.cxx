@@ -18,6 +18,8 @@
 
 // VTK includes
 #include <vtkGeneralTransform.h>
+#include <vtkLinearTransform.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkTransform.h>
@@ -158,6 +160,53 @@ int vtkMRMLTransformNodeTest1(int , char * [] )
   vtkNew<vtkMatrix4x4> identity;
   CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(identity.GetPointer(), test_mx.GetPointer()), true);
 
+  // Collapsed transform to world: linear transforms of the chain are multiplied into one matrix
+  vtkGeneralTransform* collapsedTransform = vtkGeneralTransform::SafeDownCast(eTransform->GetCollapsedTransformToWorld());
+  CHECK_NOT_NULL(collapsedTransform);
+  CHECK_INT(collapsedTransform->GetNumberOfConcatenatedTransforms(), 1);
+  vtkLinearTransform* collapsedLinearTransform = vtkLinearTransform::SafeDownCast(collapsedTransform->GetConcatenatedTransform(0));
+  CHECK_NOT_NULL(collapsedLinearTransform);
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_mx.GetPointer(), collapsedLinearTransform->GetMatrix()), true);
+  vtkNew<vtkGeneralTransform> e_to_w_transform;
+  eTransform->GetTransformToWorld(e_to_w_transform.GetPointer());
+
+  // Collapsed transform is not recomputed while the transforms are not modified
+  vtkMTimeType collapsedTransformMTime = collapsedTransform->GetMTime();
+  CHECK_POINTER(eTransform->GetCollapsedTransformToWorld(), collapsedTransform);
+  CHECK_INT(collapsedTransform->GetMTime(), collapsedTransformMTime);
+
+  // Modifying a transform in the chain updates the collapsed transform
+  vtkSmartPointer<vtkMatrix4x4> c_from_d_modified_mx = vtkSmartPointer<vtkMatrix4x4>::Take(CreateTransformMatrix(-5, 17, 2, 33, 4, -61));
+  dTransform->SetMatrixTransformToParent(c_from_d_modified_mx.GetPointer());
+  vtkNew<vtkMatrix4x4> w_from_e_modified_mx;
+  vtkMatrix4x4::Multiply4x4(c_from_d_modified_mx.GetPointer(), d_from_e_mx.GetPointer(), w_from_e_modified_mx.GetPointer());
+  vtkMatrix4x4::Multiply4x4(b_from_c_mx.GetPointer(), w_from_e_modified_mx.GetPointer(), w_from_e_modified_mx.GetPointer());
+  vtkMatrix4x4::Multiply4x4(w_from_b_mx.GetPointer(), w_from_e_modified_mx.GetPointer(), w_from_e_modified_mx.GetPointer());
+  // transform to world that was retrieved earlier follows the change,
+  // without requesting the transform from the node again
+  double testPoint[4] = { 12.0, -3.0, 41.0, 1.0 };
+  double expectedTransformedPoint[4] = { 0.0, 0.0, 0.0, 1.0 };
+  w_from_e_modified_mx->MultiplyPoint(testPoint, expectedTransformedPoint);
+  double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+  e_to_w_transform->TransformPoint(testPoint, transformedPoint);
+  CHECK_BOOL(vtkMath::Distance2BetweenPoints(expectedTransformedPoint, transformedPoint) < 1e-6, true);
+  CHECK_BOOL(collapsedTransform->GetMTime() > collapsedTransformMTime, true);
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_modified_mx.GetPointer(), test_mx.GetPointer()), true);
+  CHECK_POINTER(eTransform->GetCollapsedTransformToWorld(), collapsedTransform);
+  dTransform->SetMatrixTransformToParent(c_from_d_mx.GetPointer());
+
+  // Changing the parent transform node updates the collapsed transform
+  eTransform->SetAndObserveTransformNodeID(cTransform->GetID());
+  vtkNew<vtkMatrix4x4> w_from_e_reparented_mx;
+  vtkMatrix4x4::Multiply4x4(b_from_c_mx.GetPointer(), d_from_e_mx.GetPointer(), w_from_e_reparented_mx.GetPointer());
+  vtkMatrix4x4::Multiply4x4(w_from_b_mx.GetPointer(), w_from_e_reparented_mx.GetPointer(), w_from_e_reparented_mx.GetPointer());
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_reparented_mx.GetPointer(), test_mx.GetPointer()), true);
+  eTransform->SetAndObserveTransformNodeID(dTransform->GetID());
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_mx.GetPointer(), test_mx.GetPointer()), true);
+
   // Test when there is a nonlinear transform above the common parent of two transform nodes.
   // Transform to world is nonlinear but the relative transform is linear.
   vtkNew<vtkMRMLBSplineTransformNode> nonlinearTransform;
@@ -23,6 +23,9 @@
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 
+// STD includes
+#include <algorithm>
+
 typedef itk::BSplineDeformableTransform<double,3,3> itkBSplineType;
 
 double DisplacementScale=0.63;
@@ -311,6 +314,50 @@ double getInverseErrorVtk(const double inputPoint[3], vtkOrientedBSplineTransfor
   return errorOfInverseComputation;
 }
 
+//----------------------------------------------------------------------------
+// Compare displacements computed on a grid by ComputeDisplacementsOnGrid
+// to displacements of points transformed one by one
+int getNumberOfGridDisplacementMismatchesVtk(vtkOrientedBSplineTransform* bsplineVtk, vtkMatrix4x4* ijkToInput, int scalarType)
+{
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(-2, 17, 0, 22, 1, 13);
+  displacementGrid->AllocateScalars(scalarType, 3);
+  bsplineVtk->ComputeDisplacementsOnGrid(ijkToInput, displacementGrid.GetPointer());
+
+  int numberOfMismatches = 0;
+  int* extent = displacementGrid->GetExtent();
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++)
+        {
+        double ijk[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+        double inputPoint[4] = { 0.0, 0.0, 0.0, 1.0 };
+        ijkToInput->MultiplyPoint(ijk, inputPoint);
+        double outputPoint[3] = { 0.0, 0.0, 0.0 };
+        bsplineVtk->TransformPoint(inputPoint, outputPoint);
+        double maxDifference = 0.0;
+        for (int c = 0; c < 3; c++)
+          {
+          double displacement = displacementGrid->GetScalarComponentAsDouble(i, j, k, c);
+          maxDifference = std::max(maxDifference, fabs(displacement - (outputPoint[c] - inputPoint[c])));
+          }
+        if (maxDifference > (scalarType == VTK_FLOAT ? 1e-3 : 1e-6))
+          {
+          if (numberOfMismatches == 0)
+            {
+            std::cout << "ERROR: Grid displacement mismatch at grid point (" << i << "," << j << "," << k << "): "
+              << maxDifference << std::endl;
+            }
+          numberOfMismatches++;
+          }
+        }
+      }
+    }
+  return numberOfMismatches;
+}
+
 //----------------------------------------------------------------------------
 int vtkOrientedBSplineTransformTest1(int , char * [] )
 {
@@ -432,13 +479,40 @@ int vtkOrientedBSplineTransformTest1(int , char * [] )
       }
     }
 
+  // Evaluate the transform on grids that cover the b-spline region and beyond
+  int numberOfGridDisplacementMismatches = 0;
+  vtkNew<vtkMatrix4x4> ijkToInput;
+  for (int row = 0; row < 3; row++)
+    {
+    // grid aligned with the b-spline grid axes, in permuted order and flipped
+    ijkToInput->SetElement(row, 0, direction[row][1] * 37.0);
+    ijkToInput->SetElement(row, 1, direction[row][0] * 31.0);
+    ijkToInput->SetElement(row, 2, -direction[row][2] * 43.0);
+    ijkToInput->SetElement(row, 3, origin[row] - 40.0 * direction[row][0] + 550.0 * direction[row][2]);
+    }
+  numberOfGridDisplacementMismatches += getNumberOfGridDisplacementMismatchesVtk(bsplineVtk.GetPointer(), ijkToInput.GetPointer(), VTK_DOUBLE);
+  numberOfGridDisplacementMismatches += getNumberOfGridDisplacementMismatchesVtk(bsplineVtk.GetPointer(), ijkToInput.GetPointer(), VTK_FLOAT);
+  bsplineVtk->SetBorderModeToEdge();
+  numberOfGridDisplacementMismatches += getNumberOfGridDisplacementMismatchesVtk(bsplineVtk.GetPointer(), ijkToInput.GetPointer(), VTK_DOUBLE);
+  bsplineVtk->SetBorderModeToZero();
+  // inverse transform and oblique grid: points are transformed one by one
+  bsplineVtk->Inverse();
+  numberOfGridDisplacementMismatches += getNumberOfGridDisplacementMismatchesVtk(bsplineVtk.GetPointer(), ijkToInput.GetPointer(), VTK_DOUBLE);
+  bsplineVtk->Inverse();
+  vtkNew<vtkMatrix4x4> obliqueIjkToInput;
+  obliqueIjkToInput->DeepCopy(ijkToInput.GetPointer());
+  obliqueIjkToInput->SetElement(0, 0, obliqueIjkToInput->GetElement(0, 0) + 3.0);
+  numberOfGridDisplacementMismatches += getNumberOfGridDisplacementMismatchesVtk(bsplineVtk.GetPointer(), obliqueIjkToInput.GetPointer(), VTK_DOUBLE);
+
   std::cout << "Number of points tested: " << numberOfPointsTested << std::endl;
   std::cout << "Number of ITK/VTK mismatches: " << numberOfItkVtkPointMismatches << std::endl;
   std::cout << "Number of single/double precision mismatches: " << numberOfSingleDoubleVtkPointMismatches << std::endl;
   std::cout << "Number of derivative mismatches: " << numberOfDerivativeMismatches << std::endl;
   std::cout << "Number of inverse mismatches: " << numberOfInverseMismatches << std::endl;
+  std::cout << "Number of grid displacement mismatches: " << numberOfGridDisplacementMismatches << std::endl;
 
-  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0)
+  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0
+    && numberOfGridDisplacementMismatches==0)
     {
     std::cout << "Test result: PASSED" << std::endl;
     return EXIT_SUCCESS;
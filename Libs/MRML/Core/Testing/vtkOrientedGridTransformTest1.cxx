@@ -20,8 +20,10 @@
 
 // VTK includes
 #include "vtkImageData.h"
+#include "vtkMath.h"
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
+#include "vtkPoints.h"
 
 typedef double itkVectorComponentType;
 typedef itk::Vector<itkVectorComponentType, 3> itkVectorPixelType;
@@ -286,6 +288,37 @@ double getInverseErrorVtk(const double inputPoint[3], vtkOrientedGridTransform*
   return errorOfInverseComputation;
 }
 
+//----------------------------------------------------------------------------
+// Compare points transformed in a batch to points transformed one by one
+int getNumberOfBatchMismatchesVtk(vtkPoints* inputPoints, vtkAbstractTransform* transform)
+{
+  vtkNew<vtkPoints> outputPoints;
+  // batch transformation appends to existing points
+  outputPoints->InsertNextPoint(0.0, 0.0, 0.0);
+  transform->TransformPoints(inputPoints, outputPoints.GetPointer());
+  if (outputPoints->GetNumberOfPoints() != inputPoints->GetNumberOfPoints() + 1)
+    {
+    std::cout << "ERROR: Batch transformation output has " << outputPoints->GetNumberOfPoints()
+      << " points, expected " << inputPoints->GetNumberOfPoints() + 1 << std::endl;
+    return inputPoints->GetNumberOfPoints();
+    }
+  int numberOfMismatches = 0;
+  for (vtkIdType pointIndex = 0; pointIndex < inputPoints->GetNumberOfPoints(); pointIndex++)
+    {
+    double expectedPoint[3] = { 0.0, 0.0, 0.0 };
+    transform->TransformPoint(inputPoints->GetPoint(pointIndex), expectedPoint);
+    double* batchPoint = outputPoints->GetPoint(pointIndex + 1);
+    if (sqrt(vtkMath::Distance2BetweenPoints(expectedPoint, batchPoint)) > 1e-6)
+      {
+      std::cout << "ERROR: Batch transformation result mismatch at point " << pointIndex << ": "
+        << batchPoint[0] << " " << batchPoint[1] << " " << batchPoint[2] << " (expected "
+        << expectedPoint[0] << " " << expectedPoint[1] << " " << expectedPoint[2] << ")" << std::endl;
+      numberOfMismatches++;
+      }
+    }
+  return numberOfMismatches;
+}
+
 //----------------------------------------------------------------------------
 int vtkOrientedGridTransformTest1(int , char * [] )
 {
@@ -324,6 +357,8 @@ int vtkOrientedGridTransformTest1(int , char * [] )
   int numberOfSingleDoubleVtkPointMismatches=0;
   int numberOfDerivativeMismatches=0;
   int numberOfInverseMismatches=0;
+  int numberOfBatchMismatches=0;
+  vtkNew<vtkPoints> testPoints;
 
   // We take samples in the grid region (first node + 2 < node < last node - 1)
   // because the boundaries are handled differently in ITK and VTK (in ITK there is an
@@ -388,6 +423,7 @@ int vtkOrientedGridTransformTest1(int , char * [] )
           std::cout << "ERROR: Point transfom result mismatch between ITK and VTK at grid point ("<<i<<","<<j<<","<<k<<") with cubic interpolation"<< std::endl;
           numberOfItkVtkPointMismatches++;
           }
+        testPoints->InsertNextPoint(inputPoint);
         // Verify single/double-precision computation difference
         double differenceSingleDoubleVtk = getTransformedPointDifferenceSingleDoubleVtk(inputPoint, gridVtk.GetPointer(), false);
         if ( differenceSingleDoubleVtk > 1e-4 )
@@ -418,13 +454,19 @@ int vtkOrientedGridTransformTest1(int , char * [] )
       }
     }
 
+  // Verify batch (parallel) transformation of points in both directions
+  numberOfBatchMismatches += getNumberOfBatchMismatchesVtk(testPoints.GetPointer(), gridVtk.GetPointer());
+  numberOfBatchMismatches += getNumberOfBatchMismatchesVtk(testPoints.GetPointer(), gridVtk->GetInverse());
+
   std::cout << "Number of points tested: " << numberOfPointsTested << std::endl;
   std::cout << "Number of ITK/VTK mismatches: " << numberOfItkVtkPointMismatches << std::endl;
   std::cout << "Number of single/double precision mismatches: " << numberOfSingleDoubleVtkPointMismatches << std::endl;
   std::cout << "Number of derivative mismatches: " << numberOfDerivativeMismatches << std::endl;
   std::cout << "Number of inverse mismatches: " << numberOfInverseMismatches << std::endl;
+  std::cout << "Number of batch transformation mismatches: " << numberOfBatchMismatches << std::endl;
 
-  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0)
+  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0
+    && numberOfBatchMismatches==0)
     {
     std::cout << "Test result: PASSED" << std::endl;
     return EXIT_SUCCESS;
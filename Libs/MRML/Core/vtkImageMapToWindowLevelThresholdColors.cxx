@@ -0,0 +1,385 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageMapToWindowLevelThresholdColors.h"
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkDataArray.h>
+#include <vtkExecutive.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkScalarsToColors.h>
+
+// STD includes
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageMapToWindowLevelThresholdColors);
+vtkCxxSetObjectMacro(vtkImageMapToWindowLevelThresholdColors, LookupTable, vtkScalarsToColors);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Parameters of the intensity to color mapping, shared by all threads
+struct MappingParameters
+{
+  const unsigned char* ColorTable;
+  const unsigned char* ValueTable;
+  int ValueTableOffset;
+  double Shift;
+  double Scale;
+  bool ApplyThreshold;
+  double LowerThreshold;
+  double UpperThreshold;
+};
+
+//----------------------------------------------------------------------------
+/// Threshold is clamped to the scalar type range then cast to the scalar type,
+/// the same way as vtkImageThreshold does it.
+double CastThresholdToScalarType(double threshold, int scalarType)
+{
+  if (threshold < vtkDataArray::GetDataTypeMin(scalarType))
+    {
+    return vtkDataArray::GetDataTypeMin(scalarType);
+    }
+  if (threshold > vtkDataArray::GetDataTypeMax(scalarType))
+    {
+    return vtkDataArray::GetDataTypeMax(scalarType);
+    }
+  switch (scalarType)
+    {
+    vtkTemplateMacro(return static_cast<double>(static_cast<VTK_TT>(threshold)));
+    }
+  return threshold;
+}
+
+//----------------------------------------------------------------------------
+/// Input scalar types that are small enough to tabulate the output for each value
+bool IsValueTableScalarType(int scalarType)
+{
+  return scalarType == VTK_CHAR
+    || scalarType == VTK_SIGNED_CHAR
+    || scalarType == VTK_UNSIGNED_CHAR
+    || scalarType == VTK_SHORT
+    || scalarType == VTK_UNSIGNED_SHORT;
+}
+
+//----------------------------------------------------------------------------
+/// Window/level mapping of vtkImageMapToWindowLevelColors, result is in 0-255
+inline int WindowLevelMap(double value, double shift, double scale)
+{
+  double mapped = (value + shift) * scale;
+  if (!(mapped > 0.0))
+    {
+    return 0;
+    }
+  if (mapped >= 255.0)
+    {
+    return 255;
+    }
+  return static_cast<int>(mapped);
+}
+
+//----------------------------------------------------------------------------
+inline void MapValue(double value, const MappingParameters& params, unsigned char* rgba)
+{
+  const unsigned char* color = params.ColorTable + 4 * WindowLevelMap(value, params.Shift, params.Scale);
+  bool visible = color[3] != 0
+    && (!params.ApplyThreshold || (params.LowerThreshold <= value && value <= params.UpperThreshold));
+  rgba[0] = color[0];
+  rgba[1] = color[1];
+  rgba[2] = color[2];
+  rgba[3] = visible ? 255 : 0;
+}
+
+//----------------------------------------------------------------------------
+/// Set alpha to 0 in the parts of the row that are not covered by the stencil
+void ClearAlphaOutsideStencil(unsigned char* outRow, vtkImageStencilData* stencil,
+  int xMin, int xMax, int y, int z)
+{
+  int iter = 0;
+  int r1 = xMin;
+  int r2 = xMax;
+  int uncoveredStart = xMin;
+  while (stencil->GetNextExtent(r1, r2, xMin, xMax, y, z, iter))
+    {
+    for (int x = uncoveredStart; x < r1; x++)
+      {
+      outRow[4 * (x - xMin) + 3] = 0;
+      }
+    uncoveredStart = std::max(uncoveredStart, r2 + 1);
+    }
+  for (int x = uncoveredStart; x <= xMax; x++)
+    {
+    outRow[4 * (x - xMin) + 3] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void MapImageGeneric(const T* inPtr, const vtkIdType inIncrements[3],
+  unsigned char* outPtr, const vtkIdType outIncrements[3], const int extent[6],
+  const MappingParameters& params, vtkImageStencilData* stencil)
+{
+  const int rowLength = extent[1] - extent[0] + 1;
+  const vtkIdType inIncX = inIncrements[0];
+  for (int z = extent[4]; z <= extent[5]; z++)
+    {
+    for (int y = extent[2]; y <= extent[3]; y++)
+      {
+      const T* in = inPtr + (y - extent[2]) * inIncrements[1] + (z - extent[4]) * inIncrements[2];
+      unsigned char* outRow = outPtr + (y - extent[2]) * outIncrements[1] + (z - extent[4]) * outIncrements[2];
+      unsigned char* out = outRow;
+      if (params.ValueTable)
+        {
+        // Each voxel is a single table lookup, there are no branches in the loop
+        const unsigned char* valueTable = params.ValueTable;
+        const int offset = params.ValueTableOffset;
+        for (int x = 0; x < rowLength; x++, in += inIncX, out += 4)
+          {
+          const unsigned char* rgba = valueTable + 4 * (static_cast<int>(*in) + offset);
+          out[0] = rgba[0];
+          out[1] = rgba[1];
+          out[2] = rgba[2];
+          out[3] = rgba[3];
+          }
+        }
+      else
+        {
+        for (int x = 0; x < rowLength; x++, in += inIncX, out += 4)
+          {
+          MapValue(static_cast<double>(*in), params, out);
+          }
+        }
+      if (stencil)
+        {
+        ClearAlphaOutsideStencil(outRow, stencil, extent[0], extent[1], y, z);
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetNumberOfInputPorts(2);
+  this->Window = 256.0;
+  this->Level = 128.0;
+  this->LowerThreshold = VTK_SHORT_MIN;
+  this->UpperThreshold = VTK_SHORT_MAX;
+  this->ApplyThreshold = false;
+  this->LookupTable = NULL;
+  this->TablesScalarType = -1;
+}
+
+//----------------------------------------------------------------------------
+vtkImageMapToWindowLevelThresholdColors::~vtkImageMapToWindowLevelThresholdColors()
+{
+  this->SetLookupTable(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Window: " << this->Window << "\n";
+  os << indent << "Level: " << this->Level << "\n";
+  os << indent << "LowerThreshold: " << this->LowerThreshold << "\n";
+  os << indent << "UpperThreshold: " << this->UpperThreshold << "\n";
+  os << indent << "ApplyThreshold: " << (this->ApplyThreshold ? "true" : "false") << "\n";
+  os << indent << "LookupTable: " << this->LookupTable << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::SetStencilConnection(vtkAlgorithmOutput* stencilConnection)
+{
+  this->SetInputConnection(1, stencilConnection);
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput* vtkImageMapToWindowLevelThresholdColors::GetStencilConnection()
+{
+  return this->GetNumberOfInputConnections(1) ? this->GetInputConnection(1, 0) : 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageStencilData* vtkImageMapToWindowLevelThresholdColors::GetStencil()
+{
+  if (this->GetNumberOfInputConnections(1) < 1)
+    {
+    return NULL;
+    }
+  return vtkImageStencilData::SafeDownCast(this->GetExecutive()->GetInputData(1, 0));
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageMapToWindowLevelThresholdColors::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->LookupTable)
+    {
+    mTime = std::max(mTime, this->LookupTable->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (port == 1)
+    {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageStencilData");
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+    return 1;
+    }
+  return this->Superclass::FillInputPortInformation(port, info);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestInformation(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector),
+  vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToWindowLevelThresholdColors::RequestData(
+  vtkInformation* request,
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  // Tables are shared by all threads, update them before the threads start
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData* input = vtkImageData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  if (input)
+    {
+    this->UpdateTables(input->GetScalarType());
+    }
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::UpdateTables(int inputScalarType)
+{
+  if (this->LookupTable)
+    {
+    this->LookupTable->Build();
+    }
+  if (inputScalarType == this->TablesScalarType && this->TablesBuildTime > this->GetMTime())
+    {
+    return;
+    }
+
+  // Colors of all window/level mapped values
+  this->ColorTable.resize(256 * 4);
+  if (this->LookupTable)
+    {
+    unsigned char mappedValues[256];
+    for (int i = 0; i < 256; i++)
+      {
+      mappedValues[i] = static_cast<unsigned char>(i);
+      }
+    this->LookupTable->MapScalarsThroughTable2(mappedValues, &this->ColorTable[0],
+      VTK_UNSIGNED_CHAR, 256, 1, VTK_RGBA);
+    }
+  else
+    {
+    for (int i = 0; i < 256; i++)
+      {
+      this->ColorTable[4 * i] = this->ColorTable[4 * i + 1] = this->ColorTable[4 * i + 2] = static_cast<unsigned char>(i);
+      this->ColorTable[4 * i + 3] = 255;
+      }
+    }
+
+  // Output of all possible input values
+  this->ValueTable.clear();
+  if (IsValueTableScalarType(inputScalarType))
+    {
+    MappingParameters params;
+    params.ColorTable = &this->ColorTable[0];
+    params.ValueTable = NULL;
+    params.ValueTableOffset = 0;
+    params.Shift = this->Window / 2.0 - this->Level;
+    params.Scale = 255.0 / this->Window;
+    params.ApplyThreshold = this->ApplyThreshold;
+    params.LowerThreshold = CastThresholdToScalarType(this->LowerThreshold, inputScalarType);
+    params.UpperThreshold = CastThresholdToScalarType(this->UpperThreshold, inputScalarType);
+
+    int minimumValue = static_cast<int>(vtkDataArray::GetDataTypeMin(inputScalarType));
+    int maximumValue = static_cast<int>(vtkDataArray::GetDataTypeMax(inputScalarType));
+    this->ValueTable.resize(4 * (maximumValue - minimumValue + 1));
+    for (int value = minimumValue; value <= maximumValue; value++)
+      {
+      MapValue(value, params, &this->ValueTable[4 * (value - minimumValue)]);
+      }
+    }
+
+  this->TablesScalarType = inputScalarType;
+  this->TablesBuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToWindowLevelThresholdColors::ThreadedRequestData(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector),
+  vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData,
+  vtkImageData** outData,
+  int outExt[6], int vtkNotUsed(threadId))
+{
+  vtkImageData* input = inData[0][0];
+  vtkImageData* output = outData[0];
+  int scalarType = input->GetScalarType();
+  if (scalarType != this->TablesScalarType || this->ColorTable.empty())
+    {
+    vtkErrorMacro("ThreadedRequestData: Color tables are not initialized for scalar type " << scalarType);
+    return;
+    }
+
+  MappingParameters params;
+  params.ColorTable = &this->ColorTable[0];
+  params.ValueTable = this->ValueTable.empty() ? NULL : &this->ValueTable[0];
+  params.ValueTableOffset = -static_cast<int>(vtkDataArray::GetDataTypeMin(scalarType));
+  params.Shift = this->Window / 2.0 - this->Level;
+  params.Scale = 255.0 / this->Window;
+  params.ApplyThreshold = this->ApplyThreshold;
+  params.LowerThreshold = CastThresholdToScalarType(this->LowerThreshold, scalarType);
+  params.UpperThreshold = CastThresholdToScalarType(this->UpperThreshold, scalarType);
+
+  vtkIdType inIncrements[3] = { 0, 0, 0 };
+  input->GetIncrements(inIncrements);
+  vtkIdType outIncrements[3] = { 0, 0, 0 };
+  output->GetIncrements(outIncrements);
+  void* inPtr = input->GetScalarPointerForExtent(outExt);
+  unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointerForExtent(outExt));
+  vtkImageStencilData* stencil = this->GetStencil();
+
+  switch (scalarType)
+    {
+    vtkTemplateMacro(MapImageGeneric<VTK_TT>(static_cast<VTK_TT*>(inPtr), inIncrements,
+      outPtr, outIncrements, outExt, params, stencil));
+    default:
+      vtkErrorMacro("ThreadedRequestData: Unknown input scalar type");
+      return;
+    }
+}
@@ -0,0 +1,132 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageMapToWindowLevelThresholdColors_h
+#define __vtkImageMapToWindowLevelThresholdColors_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+// STD includes
+#include <vector>
+
+class vtkAlgorithmOutput;
+class vtkImageStencilData;
+class vtkScalarsToColors;
+
+/// \brief Map scalar image to RGBA display colors in a single pass.
+///
+/// Computes the same output as the window/level, lookup table, threshold and
+/// background stencil filter chain of vtkMRMLScalarVolumeDisplayNode
+/// (vtkImageMapToWindowLevelColors, vtkImageMapToColors, vtkImageThreshold,
+/// vtkImageStencil, vtkImageLogic, vtkImageAppendComponents), without
+/// allocating intermediate images:
+/// - RGB is the lookup table color of the window/level mapped value (0-255)
+/// - alpha is 255 if the lookup table alpha is non-zero, the value is within the
+///   threshold range (or threshold is not applied) and the voxel is inside the
+///   stencil (if a stencil is set); otherwise alpha is 0.
+///
+/// The lookup table is sampled once for all 256 window/level mapped values.
+/// For 8 and 16-bit integer inputs the complete mapping (including threshold)
+/// is tabulated for every possible input value, so each voxel costs a single
+/// table lookup.
+///
+/// Only the first scalar component of the input is used.
+class VTK_MRML_EXPORT vtkImageMapToWindowLevelThresholdColors : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageMapToWindowLevelThresholdColors *New();
+  vtkTypeMacro(vtkImageMapToWindowLevelThresholdColors, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  ///
+  /// Window and level of the intensity mapping
+  vtkSetMacro(Window, double);
+  vtkGetMacro(Window, double);
+  vtkSetMacro(Level, double);
+  vtkGetMacro(Level, double);
+
+  ///
+  /// Voxels outside of [LowerThreshold, UpperThreshold] are transparent
+  /// if ApplyThreshold is enabled.
+  vtkSetMacro(LowerThreshold, double);
+  vtkGetMacro(LowerThreshold, double);
+  vtkSetMacro(UpperThreshold, double);
+  vtkGetMacro(UpperThreshold, double);
+  vtkSetMacro(ApplyThreshold, bool);
+  vtkGetMacro(ApplyThreshold, bool);
+  vtkBooleanMacro(ApplyThreshold, bool);
+
+  ///
+  /// Lookup table that maps window/level mapped values (0-255) to colors.
+  /// If not set then a grayscale ramp is used.
+  virtual void SetLookupTable(vtkScalarsToColors* lookupTable);
+  vtkGetObjectMacro(LookupTable, vtkScalarsToColors);
+
+  ///
+  /// Optional stencil, voxels outside of the stencil are transparent
+  void SetStencilConnection(vtkAlgorithmOutput* stencilConnection);
+  vtkAlgorithmOutput* GetStencilConnection();
+  vtkImageStencilData* GetStencil();
+
+  ///
+  /// Take lookup table modification time into account
+  virtual vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+protected:
+  vtkImageMapToWindowLevelThresholdColors();
+  ~vtkImageMapToWindowLevelThresholdColors();
+
+  virtual int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+
+  virtual int RequestInformation(vtkInformation*,
+                                 vtkInformationVector**,
+                                 vtkInformationVector*) VTK_OVERRIDE;
+
+  virtual int RequestData(vtkInformation*,
+                          vtkInformationVector**,
+                          vtkInformationVector*) VTK_OVERRIDE;
+
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int extent[6], int threadId) VTK_OVERRIDE;
+
+  /// Update ColorTable and ValueTable if parameters or input scalar type changed
+  void UpdateTables(int inputScalarType);
+
+  double Window;
+  double Level;
+  double LowerThreshold;
+  double UpperThreshold;
+  bool ApplyThreshold;
+  vtkScalarsToColors* LookupTable;
+
+  /// RGBA colors of window/level mapped values, 256 * 4 elements
+  std::vector<unsigned char> ColorTable;
+  /// RGBA output for each possible input value of 8 and 16-bit integer
+  /// input scalar types (empty for other types), 4 elements per value,
+  /// starting at the minimum value of the scalar type.
+  std::vector<unsigned char> ValueTable;
+  int TablesScalarType;
+  vtkTimeStamp TablesBuildTime;
+
+private:
+  vtkImageMapToWindowLevelThresholdColors(const vtkImageMapToWindowLevelThresholdColors&); // Not implemented
+  void operator=(const vtkImageMapToWindowLevelThresholdColors&);                         // Not implemented
+};
+
+#endif
@@ -37,6 +37,8 @@ vtkMRMLGlyphableVolumeDisplayNode::vtkMRMLGlyphableVolumeDisplayNode()
   this->GlyphColorNodeID = NULL;
   this->GlyphColorNode = NULL;
   this->VisualizationMode = vtkMRMLGlyphableVolumeDisplayNode::visModeScalar;
+  // Subclasses rewire the filter chain of the scalar display node
+  this->UseWindowLevelThresholdColors = false;
   // try setting a default greyscale color map
   //this->SetDefaultColorMap(0);
 }
@@ -14,6 +14,7 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkImageMapToWindowLevelThresholdColors.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
@@ -105,6 +106,13 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   this->AppendComponents->AddInputConnection(0, this->ExtractRGB->GetOutputPort() );
   this->AppendComponents->AddInputConnection(0, this->AlphaLogic->GetOutputPort() );
 
+  this->WindowLevelThresholdColors = vtkImageMapToWindowLevelThresholdColors::New();
+  this->WindowLevelThresholdColors->SetWindow(256.);
+  this->WindowLevelThresholdColors->SetLevel(128.);
+  this->WindowLevelThresholdColors->SetLowerThreshold(VTK_SHORT_MIN);
+  this->WindowLevelThresholdColors->SetUpperThreshold(VTK_SHORT_MAX);
+  this->UseWindowLevelThresholdColors = true;
+
   this->Bimodal = NULL;
   this->Accumulate = NULL;
   this->IsInCalculateAutoLevels = false;
@@ -126,6 +134,7 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
   this->ExtractRGB->Delete();
   this->ExtractAlpha->Delete();
   this->MultiplyAlpha->Delete();
+  this->WindowLevelThresholdColors->Delete();
 
   if (this->Bimodal)
     {
@@ -178,6 +187,7 @@ void vtkMRMLScalarVolumeDisplayNode
 {
   this->Threshold->SetInputConnection(imageDataConnection);
   this->MapToWindowLevelColors->SetInputConnection(imageDataConnection);
+  this->WindowLevelThresholdColors->SetInputConnection(imageDataConnection);
 }
 
 //----------------------------------------------------------------------------
@@ -185,6 +195,7 @@ void vtkMRMLScalarVolumeDisplayNode
 ::SetBackgroundImageStencilDataConnection(vtkAlgorithmOutput *imageDataConnection)
 {
   this->MultiplyAlpha->SetStencilConnection(imageDataConnection);
+  this->WindowLevelThresholdColors->SetStencilConnection(imageDataConnection);
 }
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetBackgroundImageStencilDataConnection()
@@ -206,6 +217,10 @@ vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetInputImageDataConnection(
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLScalarVolumeDisplayNode::GetOutputImageDataConnection()
 {
+  if (this->UseWindowLevelThresholdColors)
+    {
+    return this->WindowLevelThresholdColors->GetOutputPort();
+    }
   return this->AppendComponents->GetOutputPort();
 }
 
@@ -441,6 +456,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindow(double window)
     }
 
   this->MapToWindowLevelColors->SetWindow(window);
+  this->WindowLevelThresholdColors->SetWindow(window);
   this->Modified();
 }
 
@@ -459,6 +475,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetLevel(double level)
     }
 
   this->MapToWindowLevelColors->SetLevel(level);
+  this->WindowLevelThresholdColors->SetLevel(level);
   this->Modified();
 }
 
@@ -473,6 +490,8 @@ void vtkMRMLScalarVolumeDisplayNode::SetWindowLevel(double window, double level)
 
   this->MapToWindowLevelColors->SetWindow(window);
   this->MapToWindowLevelColors->SetLevel(level);
+  this->WindowLevelThresholdColors->SetWindow(window);
+  this->WindowLevelThresholdColors->SetLevel(level);
   this->Modified();
 }
 
@@ -509,6 +528,7 @@ void vtkMRMLScalarVolumeDisplayNode::SetApplyThreshold(int apply)
     }
   this->ApplyThreshold = apply;
   this->Threshold->SetOutValue(apply ? 0 : 255);
+  this->WindowLevelThresholdColors->SetApplyThreshold(apply != 0);
   this->Modified();
 }
 
@@ -545,6 +565,8 @@ void vtkMRMLScalarVolumeDisplayNode::SetThreshold(double lowerThreshold, double
     return;
     }
   this->Threshold->ThresholdBetween( lowerThreshold, upperThreshold );
+  this->WindowLevelThresholdColors->SetLowerThreshold(lowerThreshold);
+  this->WindowLevelThresholdColors->SetUpperThreshold(upperThreshold);
   this->Modified();
 }
 
@@ -572,6 +594,7 @@ void vtkMRMLScalarVolumeDisplayNode::UpdateLookupTable(vtkMRMLColorNode* newColo
       }
     }
   this->MapToColors->SetLookupTable(lookupTable);
+  this->WindowLevelThresholdColors->SetLookupTable(lookupTable);
 }
 
 //---------------------------------------------------------------------------
@@ -25,6 +25,7 @@ class vtkImageAppendComponents;
 class vtkImageBimodalAnalysis;
 class vtkImageCast;
 class vtkImageLogic;
+class vtkImageMapToWindowLevelThresholdColors;
 class vtkImageMapToColors;
 class vtkImageMapToWindowLevelColors;
 class vtkImageStencil;
@@ -236,6 +237,13 @@ protected:
   vtkImageExtractComponents *ExtractAlpha;
   vtkImageStencil *MultiplyAlpha;
 
+  /// Computes the output of the filter chain above in a single pass.
+  /// It is kept in sync with the display properties and it provides the
+  /// output image if UseWindowLevelThresholdColors is enabled.
+  vtkImageMapToWindowLevelThresholdColors *WindowLevelThresholdColors;
+  /// Subclasses that rewire the filter chain must disable it (default: enabled)
+  bool UseWindowLevelThresholdColors;
+
   ///
   /// window level presets
   std::vector<WindowLevelPreset> WindowLevelPresets;
@@ -28,23 +28,181 @@ Version:   $Revision: 1.14 $
 #include <vtkCommand.h>
 #include <vtkCollection.h>
 #include <vtkCollectionIterator.h>
+#include <vtkDoubleArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
+#include <vtkMath.h>
+#include <vtkMutexLock.h>
 #include <vtkHomogeneousTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
+#include <vtkWarpTransform.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <stack>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLTransformNode);
 
+namespace
+{
+//----------------------------------------------------------------------------
+/// Computes the displacement of a transform at a range of slices of a
+/// displacement field. Each thread evaluates its own copy of the transform,
+/// as evaluating inverse warp transforms is not thread-safe (convergence
+/// failures are reported by modifying the transform and invoking events).
+class vtkDisplacementFieldWorker
+{
+public:
+  vtkDisplacementFieldWorker(vtkAbstractTransform* transform,
+    const double origin[3], const double axes[3][3], const int dimensions[3], double* displacements)
+    : Transform(transform)
+    , Displacements(displacements)
+  {
+    for (int i = 0; i < 3; i++)
+      {
+      this->Origin[i] = origin[i];
+      this->Dimensions[i] = dimensions[i];
+      for (int j = 0; j < 3; j++)
+        {
+        this->Axes[i][j] = axes[i][j];
+        }
+      }
+  }
+
+  void Initialize()
+  {
+    // Transform components are copied one at a time, as copying and updating
+    // modifies the pipeline information of the shared grids
+    vtkSmartPointer<vtkGeneralTransform>& localTransform = this->LocalTransform.Local();
+    localTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+    localTransform->PostMultiply();
+    this->Lock->Lock();
+    vtkNew<vtkCollection> transformComponents;
+    vtkMRMLTransformNode::FlattenGeneralTransform(transformComponents.GetPointer(), this->Transform);
+    for (int i = 0; i < transformComponents->GetNumberOfItems(); i++)
+      {
+      vtkAbstractTransform* component = vtkAbstractTransform::SafeDownCast(transformComponents->GetItemAsObject(i));
+      vtkSmartPointer<vtkAbstractTransform> componentCopy = vtkSmartPointer<vtkAbstractTransform>::Take(component->MakeTransform());
+      // the copy shares the grid or coefficients with the component, they are only read
+      componentCopy->DeepCopy(component);
+      localTransform->Concatenate(componentCopy);
+      }
+    localTransform->Update();
+    this->Lock->Unlock();
+  }
+
+  void operator()(vtkIdType beginSlice, vtkIdType endSlice)
+  {
+    vtkGeneralTransform* transform = this->LocalTransform.Local();
+    double point[3];
+    double transformedPoint[3];
+    for (vtkIdType k = beginSlice; k < endSlice; k++)
+      {
+      double* displacement = this->Displacements + 3 * k * this->Dimensions[0] * this->Dimensions[1];
+      for (int j = 0; j < this->Dimensions[1]; j++)
+        {
+        for (int i = 0; i < this->Dimensions[0]; i++)
+          {
+          for (int c = 0; c < 3; c++)
+            {
+            point[c] = this->Origin[c] + i * this->Axes[0][c] + j * this->Axes[1][c] + k * this->Axes[2][c];
+            }
+          transform->InternalTransformPoint(point, transformedPoint);
+          displacement[0] = transformedPoint[0] - point[0];
+          displacement[1] = transformedPoint[1] - point[1];
+          displacement[2] = transformedPoint[2] - point[2];
+          displacement += 3;
+          }
+        }
+      }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  vtkSMPThreadLocal<vtkSmartPointer<vtkGeneralTransform> > LocalTransform;
+  vtkNew<vtkMutexLock> Lock;
+  double Origin[3];
+  /// Position offset between neighbor grid points along each grid axis
+  double Axes[3][3];
+  int Dimensions[3];
+  double* Displacements;
+};
+
+//----------------------------------------------------------------------------
+/// Samples the displacement of a transform on a grid.
+/// Grid axis directions are the columns of the upper-left 3x3 part of directionMatrix.
+void SampleDisplacementField(vtkAbstractTransform* transform, vtkMatrix4x4* directionMatrix,
+  const double origin[3], const double spacing[3], const int dimensions[3], vtkImageData* displacementField)
+{
+  double axes[3][3];
+  for (int axis = 0; axis < 3; axis++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      axes[axis][c] = directionMatrix->GetElement(c, axis) * spacing[axis];
+      }
+    }
+  displacementField->SetExtent(0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1);
+  displacementField->SetOrigin(origin[0], origin[1], origin[2]);
+  displacementField->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  displacementField->AllocateScalars(VTK_DOUBLE, 3);
+  transform->Update();
+  vtkDisplacementFieldWorker worker(transform, origin, axes, dimensions,
+    static_cast<double*>(displacementField->GetScalarPointer()));
+  vtkSMPTools::For(0, dimensions[2], worker);
+}
+
+//----------------------------------------------------------------------------
+/// Get grid geometry of a grid or B-spline transform.
+/// Returns false if the transform is of a different type.
+bool GetWarpTransformGrid(vtkAbstractTransform* transform, vtkImageData*& grid, vtkMatrix4x4* directionMatrix)
+{
+  vtkMatrix4x4* gridDirectionMatrix = NULL;
+  vtkOrientedGridTransform* gridTransform = vtkOrientedGridTransform::SafeDownCast(transform);
+  vtkOrientedBSplineTransform* bsplineTransform = vtkOrientedBSplineTransform::SafeDownCast(transform);
+  if (gridTransform)
+    {
+    grid = gridTransform->GetDisplacementGrid();
+    gridDirectionMatrix = gridTransform->GetGridDirectionMatrix();
+    }
+  else if (bsplineTransform)
+    {
+    grid = bsplineTransform->GetCoefficientData();
+    gridDirectionMatrix = bsplineTransform->GetGridDirectionMatrix();
+    }
+  else
+    {
+    grid = NULL;
+    }
+  if (grid == NULL)
+    {
+    return false;
+    }
+  directionMatrix->Identity();
+  if (gridDirectionMatrix)
+    {
+    directionMatrix->DeepCopy(gridDirectionMatrix);
+    }
+  return true;
+}
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLTransformNode::vtkMRMLTransformNode()
 {
@@ -54,6 +212,15 @@ vtkMRMLTransformNode::vtkMRMLTransformNode()
 
   this->CachedMatrixTransformToParent=vtkMatrix4x4::New();
   this->CachedMatrixTransformFromParent=vtkMatrix4x4::New();
+
+  this->CacheInverse=false;
+  this->CachedInverseSpacing=0.0;
+  this->CachedInverseTolerance=0.001;
+  this->CachedInverseTransform=NULL;
+  this->CachedInverseSourceMTime=0;
+
+  this->CollapsedGridSpacing=0.0;
+  this->CollapsedTransformToWorld=NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -66,12 +233,30 @@ vtkMRMLTransformNode::~vtkMRMLTransformNode()
   this->CachedMatrixTransformToParent=NULL;
   this->CachedMatrixTransformFromParent->Delete();
   this->CachedMatrixTransformFromParent=NULL;
+
+  if (this->CachedInverseTransform)
+    {
+    this->CachedInverseTransform->Delete();
+    this->CachedInverseTransform=NULL;
+    }
+  if (this->CollapsedTransformToWorld)
+    {
+    this->CollapsedTransformToWorld->Delete();
+    this->CollapsedTransformToWorld=NULL;
+    }
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLTransformNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent);
+
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(cacheInverse, CacheInverse);
+  vtkMRMLWriteXMLFloatMacro(cachedInverseSpacing, CachedInverseSpacing);
+  vtkMRMLWriteXMLFloatMacro(cachedInverseTolerance, CachedInverseTolerance);
+  vtkMRMLWriteXMLFloatMacro(collapsedGridSpacing, CollapsedGridSpacing);
+  vtkMRMLWriteXMLEndMacro();
 }
 
 //----------------------------------------------------------------------------
@@ -81,6 +266,13 @@ void vtkMRMLTransformNode::ReadXMLAttributes(const char** atts)
 
   Superclass::ReadXMLAttributes(atts);
 
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(cacheInverse, CacheInverse);
+  vtkMRMLReadXMLFloatMacro(cachedInverseSpacing, CachedInverseSpacing);
+  vtkMRMLReadXMLFloatMacro(cachedInverseTolerance, CachedInverseTolerance);
+  vtkMRMLReadXMLFloatMacro(collapsedGridSpacing, CollapsedGridSpacing);
+  vtkMRMLReadXMLEndMacro();
+
   const char* attName;
   const char* attValue;
   while (*atts != NULL)
@@ -302,6 +494,13 @@ void vtkMRMLTransformNode::Copy(vtkMRMLNode *anode)
 
   this->SetReadAsTransformToParent(node->GetReadAsTransformToParent());
 
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyBooleanMacro(CacheInverse);
+  vtkMRMLCopyFloatMacro(CachedInverseSpacing);
+  vtkMRMLCopyFloatMacro(CachedInverseTolerance);
+  vtkMRMLCopyFloatMacro(CollapsedGridSpacing);
+  vtkMRMLCopyEndMacro();
+
   // Unfortunately VTK transform DeepCopy actually performs a shallow copy (only data object
   // pointers are copied, but not the contents itself), so we have to apply our custom DeepCopy
   // operation.
@@ -331,6 +530,10 @@ void vtkMRMLTransformNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
   os << indent << "ReadAsTransformToParent: " << this->ReadAsTransformToParent << "\n";
+  os << indent << "CacheInverse: " << this->CacheInverse << "\n";
+  os << indent << "CachedInverseSpacing: " << this->CachedInverseSpacing << "\n";
+  os << indent << "CachedInverseTolerance: " << this->CachedInverseTolerance << "\n";
+  os << indent << "CollapsedGridSpacing: " << this->CollapsedGridSpacing << "\n";
 
   // Flatten the transform list to make the copying simpler
   if (this->TransformToParent)
@@ -397,6 +600,34 @@ vtkAbstractTransform* vtkMRMLTransformNode::GetTransformFromParent()
     }
 }
 
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetTransformToParentForEvaluation()
+{
+  if (this->TransformToParent == NULL && this->TransformFromParent != NULL)
+    {
+    vtkAbstractTransform* cachedInverse = this->GetCachedInverse(this->TransformFromParent);
+    if (cachedInverse)
+      {
+      return cachedInverse;
+      }
+    }
+  return this->GetTransformToParent();
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetTransformFromParentForEvaluation()
+{
+  if (this->TransformFromParent == NULL && this->TransformToParent != NULL)
+    {
+    vtkAbstractTransform* cachedInverse = this->GetCachedInverse(this->TransformToParent);
+    if (cachedInverse)
+      {
+      return cachedInverse;
+      }
+    }
+  return this->GetTransformFromParent();
+}
+
 //----------------------------------------------------------------------------
 int  vtkMRMLTransformNode::IsTransformToWorldLinear()
 {
@@ -511,12 +742,36 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
     return;
     }
 
+  if (targetNode == NULL)
+    {
+    // transform from a node to the world, use the cached composite transform
+    transformSourceToTarget->Concatenate(sourceNode->GetCollapsedTransformToWorld());
+    return;
+    }
+  if (sourceNode == NULL)
+    {
+    // transform from the world to a node: invert the cached composite transform,
+    // unless a node in the chain caches inverses (then the inverse of the cached
+    // inverse would be computed iteratively, while the exact transform is available)
+    bool inverseCached = false;
+    for (vtkMRMLTransformNode* current = targetNode; current != NULL; current = current->GetParentTransformNode())
+      {
+      inverseCached = inverseCached || current->GetCacheInverse();
+      }
+    if (!inverseCached)
+      {
+      transformSourceToTarget->Concatenate(targetNode->GetCollapsedTransformToWorld());
+      transformSourceToTarget->Inverse();
+      return;
+      }
+    }
+
   if (sourceNode != NULL && sourceNode->IsTransformNodeMyParent(targetNode))
     {
     // traverse the transform tree from bottom to top, from sourceNode to targetNode
     for (vtkMRMLTransformNode* current = sourceNode; current != targetNode; current = current->GetParentTransformNode())
       {
-      vtkAbstractTransform* transformToParent=current->GetTransformToParent();
+      vtkAbstractTransform* transformToParent=current->GetTransformToParentForEvaluation();
       if (transformToParent)
         {
         transformSourceToTarget->Concatenate(transformToParent);
@@ -525,18 +780,18 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
     }
   else if (sourceNode == NULL || sourceNode->IsTransformNodeMyChild(targetNode))
     {
-    // traverse the transform tree from bottom to top, from targetNode to sourceNode
+    // traverse the transform tree from bottom to top, from targetNode to sourceNode,
+    // transforms from parent are applied in reverse order
+    transformSourceToTarget->PreMultiply();
     for (vtkMRMLTransformNode* current = targetNode; current != sourceNode; current = current->GetParentTransformNode())
       {
-      vtkAbstractTransform* transformToParent=current->GetTransformToParent();
-      if (transformToParent)
+      vtkAbstractTransform* transformFromParent=current->GetTransformFromParentForEvaluation();
+      if (transformFromParent)
         {
-        transformSourceToTarget->Concatenate(transformToParent);
+        transformSourceToTarget->Concatenate(transformFromParent);
         }
       }
-    // in transformSourceToTarget we have transform targetNode->sourceNode,
-    // need to invert to get sourceNode->targetNode
-    transformSourceToTarget->Inverse();
+    transformSourceToTarget->PostMultiply();
     }
   else
     {
@@ -545,8 +800,7 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
     sourceNode->GetTransformToNode(firstCommonParentNode, transformSourceToTarget);
 
     vtkNew<vtkGeneralTransform> transformFromCommonParentNode;
-    targetNode->GetTransformToNode(firstCommonParentNode, transformFromCommonParentNode.GetPointer());
-    transformFromCommonParentNode->Inverse();
+    targetNode->GetTransformFromNode(firstCommonParentNode, transformFromCommonParentNode.GetPointer());
 
     transformSourceToTarget->Concatenate(transformFromCommonParentNode.GetPointer());
     }
@@ -858,6 +1112,25 @@ int vtkMRMLTransformNode::GetMatrixTransformFromParent(vtkMatrix4x4* matrix)
 //----------------------------------------------------------------------------
 int  vtkMRMLTransformNode::GetMatrixTransformToWorld(vtkMatrix4x4* transformToWorld)
 {
+  if (transformToWorld == NULL)
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::GetMatrixTransformToWorld failed: transformToWorld is invalid");
+    return 0;
+    }
+  this->UpdateCollapsedTransformToWorld();
+  vtkGeneralTransform* collapsedTransform = this->CollapsedTransformToWorld;
+  if (collapsedTransform->GetNumberOfConcatenatedTransforms() == 0)
+    {
+    transformToWorld->Identity();
+    return 1;
+    }
+  vtkLinearTransform* linearTransform = vtkLinearTransform::SafeDownCast(collapsedTransform->GetConcatenatedTransform(0));
+  if (collapsedTransform->GetNumberOfConcatenatedTransforms() == 1 && linearTransform != NULL)
+    {
+    transformToWorld->DeepCopy(linearTransform->GetMatrix());
+    return 1;
+    }
+  // non-linear transform, report the error the same way as for other nodes
   return vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(this, NULL, transformToWorld);
 }
 
@@ -1114,6 +1387,7 @@ void vtkMRMLTransformNode::SetAndObserveTransform(vtkAbstractTransform** origina
 
   // We set the inverse to NULL, which means that it's unknown and will be computed atuomatically from the original transform
   vtkSetAndObserveMRMLObjectMacro((*inverseTransformPtr), NULL);
+  this->InvalidateCachedInverse();
 
   this->StorableModifiedTime.Modified();
   this->TransformModified();
@@ -1133,6 +1407,402 @@ void vtkMRMLTransformNode::SetAndObserveTransformFromParent(vtkAbstractTransform
   SetAndObserveTransform(&(this->TransformFromParent), &(this->TransformToParent), transform);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::SetCacheInverse(bool cacheInverse)
+{
+  if (this->CacheInverse == cacheInverse)
+    {
+    return;
+    }
+  this->CacheInverse = cacheInverse;
+  this->InvalidateCachedInverse();
+  this->Modified();
+  this->TransformModified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::SetCachedInverseSpacing(double spacing)
+{
+  if (this->CachedInverseSpacing == spacing)
+    {
+    return;
+    }
+  this->CachedInverseSpacing = spacing;
+  this->InvalidateCachedInverse();
+  this->Modified();
+  if (this->CacheInverse)
+    {
+    this->TransformModified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::SetCachedInverseTolerance(double tolerance)
+{
+  if (this->CachedInverseTolerance == tolerance)
+    {
+    return;
+    }
+  this->CachedInverseTolerance = tolerance;
+  this->InvalidateCachedInverse();
+  this->Modified();
+  if (this->CacheInverse)
+    {
+    this->TransformModified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::InvalidateCachedInverse()
+{
+  this->CachedInverseSource = NULL;
+  this->CachedInverseSourceMTime = 0;
+  if (!this->CacheInverse && this->CachedInverseTransform)
+    {
+    // release the displacement field, transforms that use the cached inverse keep a reference to it
+    this->CachedInverseTransform->Delete();
+    this->CachedInverseTransform = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetCachedInverse(vtkAbstractTransform* transform)
+{
+  if (!this->CacheInverse || transform == NULL)
+    {
+    return NULL;
+    }
+  if (transform == this->CachedInverseSource && this->CachedInverseTransform != NULL
+    && transform->GetMTime() <= this->CachedInverseSourceMTime)
+    {
+    // cached inverse is up-to-date
+    return this->CachedInverseTransform;
+    }
+  vtkMTimeType transformMTime = transform->GetMTime();
+  if (!this->UpdateCachedInverse(transform))
+    {
+    this->InvalidateCachedInverse();
+    return NULL;
+    }
+  this->CachedInverseSource = transform;
+  this->CachedInverseSourceMTime = transformMTime;
+  return this->CachedInverseTransform;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformNode::UpdateCachedInverse(vtkAbstractTransform* transform)
+{
+  // Only a single (non-inverted) grid or B-spline transform is supported
+  vtkNew<vtkCollection> transformList;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformList.GetPointer(), transform);
+  if (transformList->GetNumberOfItems() != 1)
+    {
+    return false;
+    }
+  vtkWarpTransform* warpTransform = vtkWarpTransform::SafeDownCast(transformList->GetItemAsObject(0));
+  if (warpTransform == NULL)
+    {
+    return false;
+    }
+  warpTransform->Update();
+  if (warpTransform->GetInverseFlag())
+    {
+    // the inverse is computed directly, no need to cache it
+    return false;
+    }
+  vtkImageData* grid = NULL;
+  vtkNew<vtkMatrix4x4> directionMatrix;
+  if (!GetWarpTransformGrid(warpTransform, grid, directionMatrix.GetPointer()))
+    {
+    return false;
+    }
+  int interpolationMode = VTK_CUBIC_INTERPOLATION;
+  vtkOrientedGridTransform* gridTransform = vtkOrientedGridTransform::SafeDownCast(warpTransform);
+  if (gridTransform)
+    {
+    interpolationMode = gridTransform->GetInterpolationMode();
+    }
+
+  // The displacement field covers the same region as the transform grid,
+  // with the same axis directions.
+  int* gridExtent = grid->GetExtent();
+  double* gridSpacing = grid->GetSpacing();
+  double* gridOrigin = grid->GetOrigin();
+  double spacing[3] = { 0.0, 0.0, 0.0 };
+  int dimensions[3] = { 0, 0, 0 };
+  double origin[3] = { gridOrigin[0], gridOrigin[1], gridOrigin[2] };
+  for (int axis = 0; axis < 3; axis++)
+    {
+    spacing[axis] = (this->CachedInverseSpacing > 0 ? this->CachedInverseSpacing : gridSpacing[axis]);
+    if (spacing[axis] <= 0)
+      {
+      vtkErrorMacro("UpdateCachedInverse: invalid spacing " << spacing[axis]);
+      return false;
+      }
+    double length = (gridExtent[axis * 2 + 1] - gridExtent[axis * 2]) * gridSpacing[axis];
+    dimensions[axis] = static_cast<int>(ceil(length / spacing[axis] - 1e-6)) + 1;
+    for (int c = 0; c < 3; c++)
+      {
+      origin[c] += directionMatrix->GetElement(c, axis) * gridExtent[axis * 2] * gridSpacing[axis];
+      }
+    }
+
+  vtkSmartPointer<vtkWarpTransform> inverseTransform = vtkSmartPointer<vtkWarpTransform>::Take(
+    vtkWarpTransform::SafeDownCast(warpTransform->MakeTransform()));
+  if (inverseTransform == NULL)
+    {
+    return false;
+    }
+  inverseTransform->DeepCopy(warpTransform);
+  inverseTransform->SetInverseTolerance(this->CachedInverseTolerance);
+  inverseTransform->Inverse();
+
+  vtkNew<vtkImageData> displacementField;
+  SampleDisplacementField(inverseTransform.GetPointer(), directionMatrix.GetPointer(), origin, spacing, dimensions,
+    displacementField.GetPointer());
+
+  if (this->CachedInverseTransform == NULL)
+    {
+    this->CachedInverseTransform = vtkOrientedGridTransform::New();
+    }
+  this->CachedInverseTransform->SetGridDirectionMatrix(directionMatrix.GetPointer());
+  this->CachedInverseTransform->SetDisplacementGridData(displacementField.GetPointer());
+  this->CachedInverseTransform->SetDisplacementScale(1.0);
+  this->CachedInverseTransform->SetDisplacementShift(0.0);
+  this->CachedInverseTransform->SetInterpolationMode(interpolationMode);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::SetCollapsedGridSpacing(double spacing)
+{
+  if (this->CollapsedGridSpacing == spacing)
+    {
+    return;
+    }
+  this->CollapsedGridSpacing = spacing;
+  // force rebuild of the collapsed transform at the next request
+  this->CollapsedTransformToWorldSources.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetCollapsedTransformToWorld()
+{
+  this->UpdateCollapsedTransformToWorld();
+  return this->CollapsedTransformToWorld;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::UpdateCollapsedTransformToWorld()
+{
+  // Get the transforms of the chain, from this node to the world
+  std::vector<vtkAbstractTransform*> sources;
+  vtkMTimeType latestMTime = 0;
+  for (vtkMRMLTransformNode* current = this; current != NULL; current = current->GetParentTransformNode())
+    {
+    vtkAbstractTransform* transformToParent = current->GetTransformToParentForEvaluation();
+    if (transformToParent)
+      {
+      sources.push_back(transformToParent);
+      latestMTime = std::max(latestMTime, transformToParent->GetMTime());
+      }
+    }
+  if (this->CollapsedTransformToWorld != NULL && sources == this->CollapsedTransformToWorldSources
+    && latestMTime <= this->CollapsedTransformToWorldTime.GetMTime())
+    {
+    // up-to-date (a transform that is created after the last update at the address
+    // of a deleted one has a newer modification time)
+    return;
+    }
+
+  vtkNew<vtkGeneralTransform> fullTransform;
+  fullTransform->PostMultiply();
+  for (std::vector<vtkAbstractTransform*>::iterator it = sources.begin(); it != sources.end(); ++it)
+    {
+    fullTransform->Concatenate(*it);
+    }
+  vtkNew<vtkCollection> fullTransformComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(fullTransformComponents.GetPointer(), fullTransform.GetPointer());
+
+  // Components are in the order of application. Replace each run of adjacent linear
+  // components by a single transform. The components are concatenated (not their
+  // current matrices), so that the merged transform follows their modifications.
+  vtkNew<vtkCollection> transformComponents;
+  int numberOfNonlinearComponents = 0;
+  vtkSmartPointer<vtkTransform> linearRun;
+  vtkLinearTransform* linearRunFirstComponent = NULL;
+  for (int i = 0; i <= fullTransformComponents->GetNumberOfItems(); i++)
+    {
+    vtkAbstractTransform* component = NULL;
+    if (i < fullTransformComponents->GetNumberOfItems())
+      {
+      component = vtkAbstractTransform::SafeDownCast(fullTransformComponents->GetItemAsObject(i));
+      }
+    vtkLinearTransform* linearComponent = vtkLinearTransform::SafeDownCast(component);
+    if (linearComponent != NULL)
+      {
+      if (linearRunFirstComponent == NULL)
+        {
+        linearRunFirstComponent = linearComponent;
+        }
+      else
+        {
+        if (linearRun == NULL)
+          {
+          linearRun = vtkSmartPointer<vtkTransform>::New();
+          linearRun->PostMultiply();
+          linearRun->Concatenate(linearRunFirstComponent);
+          }
+        linearRun->Concatenate(linearComponent);
+        }
+      continue;
+      }
+    // end of a linear run
+    if (linearRun != NULL)
+      {
+      transformComponents->AddItem(linearRun);
+      }
+    else if (linearRunFirstComponent != NULL)
+      {
+      // single linear transform, no need to make a copy
+      transformComponents->AddItem(linearRunFirstComponent);
+      }
+    linearRun = NULL;
+    linearRunFirstComponent = NULL;
+    if (component != NULL)
+      {
+      transformComponents->AddItem(component);
+      numberOfNonlinearComponents++;
+      }
+    }
+
+  if (this->CollapsedTransformToWorld == NULL)
+    {
+    this->CollapsedTransformToWorld = vtkGeneralTransform::New();
+    }
+  // The same object is reused, so that transforms that concatenate it are updated as well
+  this->CollapsedTransformToWorld->Identity();
+  this->CollapsedTransformToWorld->PostMultiply();
+  vtkSmartPointer<vtkAbstractTransform> collapsedGridTransform;
+  if (this->CollapsedGridSpacing > 0 && numberOfNonlinearComponents > 1)
+    {
+    collapsedGridTransform = vtkSmartPointer<vtkAbstractTransform>::Take(
+      this->CreateCollapsedGridTransform(transformComponents.GetPointer()));
+    }
+  if (collapsedGridTransform != NULL)
+    {
+    this->CollapsedTransformToWorld->Concatenate(collapsedGridTransform.GetPointer());
+    }
+  else
+    {
+    for (int i = 0; i < transformComponents->GetNumberOfItems(); i++)
+      {
+      this->CollapsedTransformToWorld->Concatenate(
+        vtkAbstractTransform::SafeDownCast(transformComponents->GetItemAsObject(i)));
+      }
+    }
+
+  this->CollapsedTransformToWorldSources = sources;
+  this->CollapsedTransformToWorldTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::CreateCollapsedGridTransform(vtkCollection* transformComponents)
+{
+  // The sampled region is the region of the first grid, mapped to the input space
+  // of the collapsed transform by the inverse of the preceding linear transform.
+  int firstNonlinearComponentIndex = 0;
+  vtkNew<vtkMatrix4x4> precedingMatrix;
+  vtkLinearTransform* precedingLinearTransform =
+    vtkLinearTransform::SafeDownCast(transformComponents->GetItemAsObject(0));
+  if (precedingLinearTransform)
+    {
+    precedingMatrix->DeepCopy(precedingLinearTransform->GetMatrix());
+    firstNonlinearComponentIndex = 1;
+    }
+  vtkAbstractTransform* firstNonlinearTransform = vtkAbstractTransform::SafeDownCast(
+    transformComponents->GetItemAsObject(firstNonlinearComponentIndex));
+  vtkImageData* grid = NULL;
+  vtkNew<vtkMatrix4x4> gridDirectionMatrix;
+  vtkWarpTransform* firstWarpTransform = vtkWarpTransform::SafeDownCast(firstNonlinearTransform);
+  if (firstWarpTransform == NULL || firstWarpTransform->GetInverseFlag()
+    || !GetWarpTransformGrid(firstWarpTransform, grid, gridDirectionMatrix.GetPointer()))
+    {
+    return NULL;
+    }
+  firstWarpTransform->Update();
+  vtkNew<vtkMatrix4x4> inputToGridMatrix;
+  vtkMatrix4x4::Invert(precedingMatrix.GetPointer(), inputToGridMatrix.GetPointer());
+  vtkNew<vtkMatrix4x4> gridIjkToGridMatrix;
+  for (int row = 0; row < 3; row++)
+    {
+    for (int column = 0; column < 3; column++)
+      {
+      gridIjkToGridMatrix->SetElement(row, column, gridDirectionMatrix->GetElement(row, column) * grid->GetSpacing()[column]);
+      }
+    gridIjkToGridMatrix->SetElement(row, 3, grid->GetOrigin()[row]);
+    }
+  vtkNew<vtkMatrix4x4> gridIjkToInputMatrix;
+  vtkMatrix4x4::Multiply4x4(inputToGridMatrix.GetPointer(), gridIjkToGridMatrix.GetPointer(), gridIjkToInputMatrix.GetPointer());
+
+  // Grid axes in the input space must be orthogonal to be represented by an oriented grid
+  int* gridExtent = grid->GetExtent();
+  double axes[3][3];
+  double lengths[3] = { 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; axis++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      axes[axis][c] = gridIjkToInputMatrix->GetElement(c, axis);
+      }
+    lengths[axis] = vtkMath::Normalize(axes[axis]) * (gridExtent[axis * 2 + 1] - gridExtent[axis * 2]);
+    }
+  for (int axis = 0; axis < 3; axis++)
+    {
+    if (fabs(vtkMath::Dot(axes[axis], axes[(axis + 1) % 3])) > 1e-3)
+      {
+      vtkDebugMacro("CreateCollapsedGridTransform: grid axes are not orthogonal in the input space, grid transforms are not collapsed");
+      return NULL;
+      }
+    }
+
+  vtkNew<vtkMatrix4x4> directionMatrix;
+  double spacing[3] = { this->CollapsedGridSpacing, this->CollapsedGridSpacing, this->CollapsedGridSpacing };
+  int dimensions[3] = { 0, 0, 0 };
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double gridIjkOrigin[4] = { static_cast<double>(gridExtent[0]), static_cast<double>(gridExtent[2]),
+    static_cast<double>(gridExtent[4]), 1.0 };
+  double inputOrigin[4] = { 0.0, 0.0, 0.0, 1.0 };
+  gridIjkToInputMatrix->MultiplyPoint(gridIjkOrigin, inputOrigin);
+  for (int axis = 0; axis < 3; axis++)
+    {
+    dimensions[axis] = static_cast<int>(ceil(lengths[axis] / spacing[axis] - 1e-6)) + 1;
+    origin[axis] = inputOrigin[axis];
+    for (int c = 0; c < 3; c++)
+      {
+      directionMatrix->SetElement(c, axis, axes[axis][c]);
+      }
+    }
+
+  // Sample all the components (including the linear ones) into a displacement field
+  vtkNew<vtkGeneralTransform> compositeTransform;
+  compositeTransform->PostMultiply();
+  for (int i = 0; i < transformComponents->GetNumberOfItems(); i++)
+    {
+    compositeTransform->Concatenate(vtkAbstractTransform::SafeDownCast(transformComponents->GetItemAsObject(i)));
+    }
+  vtkNew<vtkImageData> displacementField;
+  SampleDisplacementField(compositeTransform.GetPointer(), directionMatrix.GetPointer(), origin, spacing, dimensions,
+    displacementField.GetPointer());
+
+  vtkOrientedGridTransform* collapsedGridTransform = vtkOrientedGridTransform::New();
+  collapsedGridTransform->SetGridDirectionMatrix(directionMatrix.GetPointer());
+  collapsedGridTransform->SetDisplacementGridData(displacementField.GetPointer());
+  collapsedGridTransform->SetInterpolationModeToCubic();
+  return collapsedGridTransform;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLTransformNode::ProcessMRMLEvents ( vtkObject *caller,
                                                     unsigned long event,
@@ -1167,6 +1837,7 @@ void vtkMRMLTransformNode::Inverse()
   vtkAbstractTransform* oldTransformFromParent=this->TransformFromParent;
   this->TransformToParent=oldTransformFromParent;
   this->TransformFromParent=oldTransformToParent;
+  this->InvalidateCachedInverse();
 
   this->StorableModifiedTime.Modified();
   this->Modified();
@@ -17,10 +17,18 @@
 
 #include "vtkMRMLDisplayableNode.h"
 
+// VTK includes
+#include <vtkTimeStamp.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <vector>
+
 class vtkCollection;
 class vtkAbstractTransform;
 class vtkGeneralTransform;
 class vtkMatrix4x4;
+class vtkOrientedGridTransform;
 class vtkTransform;
 
 /// \brief MRML node for representing a transformation
@@ -120,9 +128,29 @@ public:
 
   ///
   /// Get concatenated transforms to world.
-  /// \sa GetTransformBetweenNodes
+  /// \sa GetTransformBetweenNodes, GetCollapsedTransformToWorld
   void GetTransformToWorld(vtkGeneralTransform* transformToWorld);
 
+  ///
+  /// Get the transform to world as a simplified composite transform.
+  /// Adjacent linear transforms of the chain are merged into a single transform and,
+  /// if CollapsedGridSpacing is set, multiple grid and B-spline transforms are sampled
+  /// into a single displacement field. The composite is cached and only rebuilt
+  /// when it is requested after a transform in the chain is modified or the parent
+  /// transform node is changed (see GetTransformToWorldMTime).
+  /// Merged linear transforms follow the modifications of the transforms they consist of.
+  /// The sampled displacement field is a snapshot: it is updated when this method
+  /// (or GetTransformToWorld) is called again.
+  /// The returned object is owned by the transform node.
+  vtkAbstractTransform* GetCollapsedTransformToWorld();
+
+  /// Get/Set spacing (in mm) of the displacement field that multiple grid and B-spline
+  /// transforms of the chain to world are sampled into. If 0 (default) then grid
+  /// transforms are not sampled, only linear transforms are collapsed.
+  /// \sa GetCollapsedTransformToWorld
+  vtkGetMacro(CollapsedGridSpacing, double);
+  virtual void SetCollapsedGridSpacing(double);
+
   ///
   /// Get concatenated transforms from world.
   /// \sa GetTransformBetweenNodes
@@ -265,6 +293,31 @@ public:
   vtkSetMacro(ReadAsTransformToParent, int);
   vtkBooleanMacro(ReadAsTransformToParent, int);
 
+  /// Get/Set CacheInverse
+  /// If enabled and the transform is a grid or B-spline transform that is only
+  /// available in one direction, then the other direction is not computed
+  /// point by point by iterative inversion, but a displacement field is
+  /// computed once that approximates the inverse. The field is recomputed
+  /// when the inverse is requested after the transform is modified.
+  /// The cached inverse is only used for computing transforms between nodes
+  /// (GetTransformToWorld, GetTransformBetweenNodes, ...). GetTransformToParent
+  /// and GetTransformFromParent always return the exact inverse.
+  /// Disabled by default.
+  /// \sa CachedInverseSpacing, CachedInverseTolerance
+  vtkGetMacro(CacheInverse, bool);
+  virtual void SetCacheInverse(bool);
+  vtkBooleanMacro(CacheInverse, bool);
+
+  /// Get/Set spacing (in mm) of the cached inverse displacement field.
+  /// If 0 (default) then the spacing of the transform grid is used.
+  vtkGetMacro(CachedInverseSpacing, double);
+  virtual void SetCachedInverseSpacing(double);
+
+  /// Get/Set tolerance (in mm) of the inversion at the cached inverse displacement field points.
+  /// Default is 0.001.
+  vtkGetMacro(CachedInverseTolerance, double);
+  virtual void SetCachedInverseTolerance(double);
+
   ///
   /// Indicates that the transform inside the object is modified.
   /// Typical usage would be to disable transform modified events, call a series of operations that change transforms
@@ -369,6 +422,40 @@ protected:
   /// Sets and observes a transform and deletes the inverse (so that the inverse will be computed automatically)
   virtual void SetAndObserveTransform(vtkAbstractTransform** originalTransformPtr, vtkAbstractTransform** inverseTransformPtr, vtkAbstractTransform *transform);
 
+  ///
+  /// Returns the cached inverse of the transform, recomputed if the transform has changed since
+  /// the last computation. Returns NULL if CacheInverse is disabled or the inverse of
+  /// the transform cannot be cached.
+  virtual vtkAbstractTransform* GetCachedInverse(vtkAbstractTransform* transform);
+
+  ///
+  /// Get transform to/from parent for computing transforms between nodes.
+  /// Same as GetTransformToParent/GetTransformFromParent, except that the cached
+  /// inverse is returned if the requested direction is not set and CacheInverse
+  /// is enabled. The returned transform must not be modified or saved.
+  vtkAbstractTransform* GetTransformToParentForEvaluation();
+  vtkAbstractTransform* GetTransformFromParentForEvaluation();
+
+  ///
+  /// Computes the displacement field of the inverse of a grid or B-spline transform.
+  /// Returns false if the transform type is not supported.
+  virtual bool UpdateCachedInverse(vtkAbstractTransform* transform);
+
+  ///
+  /// Indicates that the cached inverse has to be recomputed.
+  void InvalidateCachedInverse();
+
+  ///
+  /// Rebuilds the collapsed transform to world if any transform in the chain
+  /// has been modified or replaced since the last update.
+  virtual void UpdateCollapsedTransformToWorld();
+
+  ///
+  /// Samples the non-linear part of the transform (that starts with a grid or B-spline transform
+  /// component, optionally preceded by a linear transform) into a single displacement field.
+  /// Returns NULL if the transform cannot be sampled.
+  virtual vtkAbstractTransform* CreateCollapsedGridTransform(vtkCollection* transformComponents);
+
   ///
   /// These transforms store the transforms that were set externally.
   /// We use the capability of generic transforms for concatenating and inverting the same
@@ -388,6 +475,25 @@ protected:
   /// GetMatrixTransformToParent and GetMatrixFromParent methods
   vtkMatrix4x4* CachedMatrixTransformToParent;
   vtkMatrix4x4* CachedMatrixTransformFromParent;
+
+  bool CacheInverse;
+  double CachedInverseSpacing;
+  double CachedInverseTolerance;
+
+  /// Displacement field transform that approximates the inverse of CachedInverseSource
+  vtkOrientedGridTransform* CachedInverseTransform;
+  /// Transform that the cached inverse is computed from and its modification time at the computation
+  vtkWeakPointer<vtkAbstractTransform> CachedInverseSource;
+  vtkMTimeType CachedInverseSourceMTime;
+
+  double CollapsedGridSpacing;
+
+  /// Simplified transform to world, see GetCollapsedTransformToWorld
+  vtkGeneralTransform* CollapsedTransformToWorld;
+  /// Transforms to parent of the chain that the collapsed transform is computed from
+  /// and the time of the computation.
+  std::vector<vtkAbstractTransform*> CollapsedTransformToWorldSources;
+  vtkTimeStamp CollapsedTransformToWorldTime;
 };
 
 #endif
@@ -20,6 +20,7 @@ Version:   $Revision: 1.14 $
 #include "vtkMRMLTransformNode.h"
 
 // VTK includes
+#include <vtkCollection.h>
 #include <vtkCommand.h>
 #include <vtkGeneralTransform.h>
 #include <vtkIntArray.h>
@@ -189,7 +190,21 @@ bool vtkMRMLTransformableNode::HardenTransform()
     {
     vtkNew<vtkGeneralTransform> hardeningTransform;
     transformNode->GetTransformToWorld(hardeningTransform.GetPointer());
-    this->ApplyTransform(hardeningTransform.GetPointer());
+    // If there is only one transform then apply it directly, so that its
+    // batch point transformation is used instead of the point-by-point
+    // evaluation of the general transform.
+    vtkNew<vtkCollection> hardeningTransformList;
+    vtkMRMLTransformNode::FlattenGeneralTransform(hardeningTransformList.GetPointer(), hardeningTransform.GetPointer());
+    vtkAbstractTransform* singleTransform = (hardeningTransformList->GetNumberOfItems() == 1 ?
+      vtkAbstractTransform::SafeDownCast(hardeningTransformList->GetItemAsObject(0)) : NULL);
+    if (singleTransform)
+      {
+      this->ApplyTransform(singleTransform);
+      }
+    else
+      {
+      this->ApplyTransform(hardeningTransform.GetPointer());
+      }
     }
 
   this->SetAndObserveTransformNodeID(NULL);
@@ -17,29 +17,176 @@ Version:   $Revision: 1.14 $
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLVolumeNode.h"
 #include "vtkMRMLTransformNode.h"
+#include "vtkOrientedBSplineTransform.h"
+#include "vtkOrientedGridTransform.h"
 
 // VTK includes
 #include <vtkAlgorithmOutput.h>
 #include <vtkAppendPolyData.h>
 #include <vtkBoundingBox.h>
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
 #include <vtkEventForwarderCommand.h>
 #include <vtkGeneralTransform.h>
 #include <vtkHomogeneousTransform.h>
 #include <vtkImageData.h>
 #include <vtkImageDataGeometryFilter.h>
 #include <vtkImageReslice.h>
+#include <vtkInformation.h>
+#include <vtkLinearTransform.h>
+#include <vtkMath.h>
 #include <vtkMathUtilities.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTransform.h>
 #include <vtkTrivialProducer.h>
 
 #include <algorithm> // For std::min
 #include <cassert>
+#include <cmath>
 #include <vector>
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Resample an image through a transform that consists of a b-spline transform
+/// between linear transforms (typical for hardening a b-spline registration result).
+/// The b-spline is evaluated on the output voxel grid, slab by slab, using
+/// vtkOrientedBSplineTransform::ComputeDisplacementsOnGrid (which is much faster
+/// than evaluating it for each voxel), and the image is resampled through the
+/// computed displacement field. Output geometry is computed by the reslice filter.
+/// Returns false if the transform is not of this kind.
+bool ResliceThroughBSplineTransform(vtkImageReslice* reslice, vtkGeneralTransform* resampleTransform,
+  vtkImageData* outputImage)
+{
+  vtkNew<vtkCollection> transformComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformComponents.GetPointer(), resampleTransform);
+  vtkOrientedBSplineTransform* bsplineTransform = NULL;
+  vtkNew<vtkTransform> preTransform;
+  preTransform->PostMultiply();
+  vtkNew<vtkTransform> postTransform;
+  postTransform->PostMultiply();
+  for (int i = 0; i < transformComponents->GetNumberOfItems(); i++)
+    {
+    vtkObject* component = transformComponents->GetItemAsObject(i);
+    vtkLinearTransform* linearTransform = vtkLinearTransform::SafeDownCast(component);
+    if (linearTransform)
+      {
+      (bsplineTransform ? postTransform.GetPointer() : preTransform.GetPointer())->Concatenate(linearTransform->GetMatrix());
+      continue;
+      }
+    if (bsplineTransform != NULL)
+      {
+      // multiple non-linear transforms
+      return false;
+      }
+    bsplineTransform = vtkOrientedBSplineTransform::SafeDownCast(component);
+    if (bsplineTransform == NULL || bsplineTransform->GetInverseFlag())
+      {
+      // the inverse is computed iteratively, there is no gain in evaluating it on a grid
+      return false;
+      }
+    }
+  if (bsplineTransform == NULL)
+    {
+    return false;
+    }
+
+  // Get the auto-cropped output geometry and fix it, as the transform will be changed for each slab
+  reslice->UpdateInformation();
+  vtkInformation* outInfo = reslice->GetOutputInformation(0);
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  double outputOrigin[3] = { 0.0, 0.0, 0.0 };
+  double outputSpacing[3] = { 1.0, 1.0, 1.0 };
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), outputExtent);
+  outInfo->Get(vtkDataObject::ORIGIN(), outputOrigin);
+  outInfo->Get(vtkDataObject::SPACING(), outputSpacing);
+
+  // Output voxel grid in the b-spline input space
+  vtkNew<vtkMatrix4x4> outputIjkToOutput;
+  for (int axis = 0; axis < 3; axis++)
+    {
+    outputIjkToOutput->SetElement(axis, axis, outputSpacing[axis]);
+    outputIjkToOutput->SetElement(axis, 3, outputOrigin[axis]);
+    }
+  vtkNew<vtkMatrix4x4> outputIjkToBSplineInput;
+  vtkMatrix4x4::Multiply4x4(preTransform->GetMatrix(), outputIjkToOutput.GetPointer(), outputIjkToBSplineInput.GetPointer());
+  double gridAxes[3][3];
+  double gridSpacing[3] = { 1.0, 1.0, 1.0 };
+  double gridOrigin[3] = { 0.0, 0.0, 0.0 };
+  vtkNew<vtkMatrix4x4> gridDirectionMatrix;
+  for (int axis = 0; axis < 3; axis++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      gridAxes[axis][c] = outputIjkToBSplineInput->GetElement(c, axis);
+      }
+    gridSpacing[axis] = vtkMath::Normalize(gridAxes[axis]);
+    gridOrigin[axis] = outputIjkToBSplineInput->GetElement(axis, 3);
+    if (gridSpacing[axis] == 0.0)
+      {
+      return false;
+      }
+    for (int c = 0; c < 3; c++)
+      {
+      gridDirectionMatrix->SetElement(c, axis, gridAxes[axis][c]);
+      }
+    }
+  for (int axis = 0; axis < 3; axis++)
+    {
+    if (fabs(vtkMath::Dot(gridAxes[axis], gridAxes[(axis + 1) % 3])) > 1e-6)
+      {
+      // sheared voxel grid cannot be represented by a grid transform
+      return false;
+      }
+    }
+
+  reslice->AutoCropOutputOff();
+  reslice->SetOutputExtent(outputExtent);
+  reslice->SetOutputOrigin(outputOrigin);
+  reslice->SetOutputSpacing(outputSpacing);
+
+  outputImage->SetExtent(outputExtent);
+  outputImage->SetOrigin(outputOrigin);
+  outputImage->SetSpacing(outputSpacing);
+  outputImage->AllocateScalars(vtkImageData::GetScalarType(outInfo), vtkImageData::GetNumberOfScalarComponents(outInfo));
+
+  vtkNew<vtkOrientedGridTransform> slabGridTransform;
+  slabGridTransform->SetGridDirectionMatrix(gridDirectionMatrix.GetPointer());
+  slabGridTransform->SetInterpolationModeToLinear();
+  vtkNew<vtkGeneralTransform> slabResampleTransform;
+  slabResampleTransform->PostMultiply();
+  slabResampleTransform->Concatenate(preTransform.GetPointer());
+  slabResampleTransform->Concatenate(slabGridTransform.GetPointer());
+  slabResampleTransform->Concatenate(postTransform.GetPointer());
+  reslice->SetResliceTransform(slabResampleTransform.GetPointer());
+
+  // Displacements are computed exactly at the output voxel positions, so interpolation
+  // of the displacement field does not change the result
+  const int numberOfSlicesPerSlab = 16;
+  for (int slabStart = outputExtent[4]; slabStart <= outputExtent[5]; slabStart += numberOfSlicesPerSlab)
+    {
+    int slabExtent[6] = { outputExtent[0], outputExtent[1], outputExtent[2], outputExtent[3],
+      slabStart, std::min(slabStart + numberOfSlicesPerSlab - 1, outputExtent[5]) };
+    vtkNew<vtkImageData> displacementField;
+    displacementField->SetExtent(slabExtent);
+    displacementField->SetOrigin(gridOrigin);
+    displacementField->SetSpacing(gridSpacing);
+    displacementField->AllocateScalars(VTK_FLOAT, 3);
+    bsplineTransform->ComputeDisplacementsOnGrid(outputIjkToBSplineInput.GetPointer(), displacementField.GetPointer());
+    slabGridTransform->SetDisplacementGridData(displacementField.GetPointer());
+    reslice->SetOutputExtent(slabExtent);
+    reslice->Update();
+    outputImage->CopyAndCastFrom(reslice->GetOutput(), slabExtent);
+    }
+  return true;
+}
+
+}
+
 //----------------------------------------------------------------------------
 
 //----------------------------------------------------------------------------
@@ -1033,7 +1180,8 @@ void vtkMRMLVolumeNode::ApplyNonLinearTransform(vtkAbstractTransform* transform)
   // vtkImageReslice works faster if the input is a linear transform, so try to convert it
   // to a linear transform
   vtkNew<vtkTransform> linearResampleXform;
-  if (vtkMRMLTransformNode::IsGeneralTransformLinear(resampleXform.GetPointer(), linearResampleXform.GetPointer()))
+  bool linearResample = vtkMRMLTransformNode::IsGeneralTransformLinear(resampleXform.GetPointer(), linearResampleXform.GetPointer());
+  if (linearResample)
     {
     reslice->SetResliceTransform(linearResampleXform.GetPointer());
     }
@@ -1062,10 +1210,12 @@ void vtkMRMLVolumeNode::ApplyNonLinearTransform(vtkAbstractTransform* transform)
   reslice->SetOptimization(1);
   reslice->SetOutputDimensionality(3);
 
-  reslice->Update();
-
   vtkNew<vtkImageData> resampleImage;
-  resampleImage->DeepCopy(reslice->GetOutput());
+  if (linearResample || !ResliceThroughBSplineTransform(reslice.GetPointer(), resampleXform.GetPointer(), resampleImage.GetPointer()))
+    {
+    reslice->Update();
+    resampleImage->DeepCopy(reslice->GetOutput());
+    }
 
   // Perform image data and origin update in one step
   int wasModified = this->StartModify();
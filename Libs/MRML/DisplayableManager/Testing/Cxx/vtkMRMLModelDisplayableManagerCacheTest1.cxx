@@ -0,0 +1,326 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelDisplayableManager.h>
+#include <vtkThreadedLODActor.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLClipModelsNode.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceNode.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkDataSet.h>
+#include <vtkMapper.h>
+#include <vtkMapperCollection.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// 3D view with a model displayable manager, caches of a new view are empty
+class ModelView
+{
+public:
+  ModelView(vtkMRMLApplicationLogic* applicationLogic, vtkMRMLViewNode* viewNode)
+  {
+    this->RenderWindow->SetSize(200, 200);
+    this->RenderWindow->SetMultiSamples(0);
+    this->RenderWindow->AddRenderer(this->Renderer.GetPointer());
+    this->RenderWindow->SetInteractor(this->Interactor.GetPointer());
+    this->Group->SetRenderer(this->Renderer.GetPointer());
+    this->Group->SetMRMLDisplayableNode(viewNode);
+    this->DisplayableManager->SetMRMLApplicationLogic(applicationLogic);
+    this->Group->AddDisplayableManager(this->DisplayableManager.GetPointer());
+    this->Group->GetInteractor()->Initialize();
+  }
+  ~ModelView()
+  {
+    this->DisplayableManager->SetMRMLApplicationLogic(0);
+  }
+
+  vtkNew<vtkRenderer> Renderer;
+  vtkNew<vtkRenderWindow> RenderWindow;
+  vtkNew<vtkRenderWindowInteractor> Interactor;
+  vtkNew<vtkMRMLDisplayableManagerGroup> Group;
+  vtkNew<vtkMRMLModelDisplayableManager> DisplayableManager;
+};
+
+//----------------------------------------------------------------------------
+vtkDataSet* GetDisplayedMesh(vtkMRMLModelDisplayableManager* displayableManager,
+  vtkMRMLDisplayNode* displayNode)
+{
+  vtkActor* actor = vtkActor::SafeDownCast(displayableManager->GetActorByID(displayNode->GetID()));
+  if (!actor || !actor->GetMapper())
+    {
+    return 0;
+    }
+  actor->GetMapper()->Update();
+  return actor->GetMapper()->GetInput();
+}
+
+//----------------------------------------------------------------------------
+/// Compare mesh displayed by the view with the mesh displayed by a new view,
+/// which does not have any cached clippers or decimation filters
+bool CompareWithNewView(ModelView* view, vtkMRMLApplicationLogic* applicationLogic, vtkMRMLViewNode* viewNode,
+  vtkMRMLDisplayNode* displayNode, vtkIdType expectedNumberOfCells, int line)
+{
+  view->DisplayableManager->RequestRender();
+  ModelView referenceView(applicationLogic, viewNode);
+  vtkDataSet* mesh = GetDisplayedMesh(view->DisplayableManager.GetPointer(), displayNode);
+  vtkDataSet* referenceMesh = GetDisplayedMesh(referenceView.DisplayableManager.GetPointer(), displayNode);
+  if (!mesh || !referenceMesh)
+    {
+    std::cerr << line << ": Model is not displayed" << std::endl;
+    return false;
+    }
+  if (mesh->GetNumberOfPoints() != referenceMesh->GetNumberOfPoints()
+    || mesh->GetNumberOfCells() != referenceMesh->GetNumberOfCells())
+    {
+    std::cerr << line << ": Displayed mesh has " << mesh->GetNumberOfPoints() << " points and "
+      << mesh->GetNumberOfCells() << " cells, expected " << referenceMesh->GetNumberOfPoints()
+      << " points and " << referenceMesh->GetNumberOfCells() << " cells" << std::endl;
+    return false;
+    }
+  double bounds[6] = { 0.0 };
+  double referenceBounds[6] = { 0.0 };
+  mesh->GetBounds(bounds);
+  referenceMesh->GetBounds(referenceBounds);
+  for (int i = 0; i < 6; i++)
+    {
+    if (fabs(bounds[i] - referenceBounds[i]) > 1e-6)
+      {
+      std::cerr << line << ": Displayed mesh bounds mismatch at " << i << ": " << bounds[i]
+        << " (expected " << referenceBounds[i] << ")" << std::endl;
+      return false;
+      }
+    }
+  if (expectedNumberOfCells >= 0 && mesh->GetNumberOfCells() != expectedNumberOfCells)
+    {
+    std::cerr << line << ": Displayed mesh has " << mesh->GetNumberOfCells()
+      << " cells, expected " << expectedNumberOfCells << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void SetSliceOffset(vtkMRMLSliceNode* sliceNode, double offset)
+{
+  sliceNode->GetSliceToRAS()->SetElement(2, 3, offset);
+  sliceNode->UpdateMatrices();
+}
+
+} // end of anonymous namespace
+
+#define CHECK_SAME_AS_NEW_VIEW(expectedNumberOfCells) \
+  if (!CompareWithNewView(&view, applicationLogic.GetPointer(), \
+    viewNode.GetPointer(), modelDisplayNode.GetPointer(), expectedNumberOfCells, __LINE__)) \
+    { \
+    return EXIT_FAILURE; \
+    }
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManagerCacheTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode.GetPointer());
+
+  const char* layoutNames[3] = { "Red", "Green", "Yellow" };
+  vtkMRMLSliceNode* sliceNodes[3] = { 0, 0, 0 };
+  for (int i = 0; i < 3; i++)
+    {
+    vtkNew<vtkMRMLSliceNode> sliceNode;
+    sliceNode->SetLayoutName(layoutNames[i]);
+    scene->AddNode(sliceNode.GetPointer());
+    sliceNodes[i] = sliceNode.GetPointer();
+    }
+  sliceNodes[0]->SetOrientationToAxial();
+  sliceNodes[1]->SetOrientationToCoronal();
+  sliceNodes[2]->SetOrientationToSagittal();
+
+  vtkNew<vtkMRMLClipModelsNode> clipModelsNode;
+  scene->AddNode(clipModelsNode.GetPointer());
+
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(10.);
+  sphereSource->SetThetaResolution(16);
+  sphereSource->SetPhiResolution(16);
+  sphereSource->Update();
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetPolyDataConnection(sphereSource->GetOutputPort());
+  scene->AddNode(modelNode.GetPointer());
+  vtkNew<vtkMRMLModelDisplayNode> modelDisplayNode;
+  scene->AddNode(modelDisplayNode.GetPointer());
+  modelNode->AddAndObserveDisplayNodeID(modelDisplayNode->GetID());
+
+  ModelView view(applicationLogic.GetPointer(), viewNode.GetPointer());
+  const vtkIdType fullNumberOfCells = sphereSource->GetOutput()->GetNumberOfCells();
+
+  //////////////////////////////////////////////////////////////////////////
+  // Clipped mesh is recomputed when the clipping planes move
+
+  modelDisplayNode->SetClipping(1);
+  clipModelsNode->SetRedSliceClipState(vtkMRMLClipModelsNode::ClipPositiveSpace);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  vtkIdType clippedNumberOfCells = GetDisplayedMesh(view.DisplayableManager.GetPointer(), modelDisplayNode.GetPointer())->GetNumberOfCells();
+  if (clippedNumberOfCells <= 0 || clippedNumberOfCells >= fullNumberOfCells)
+    {
+    std::cerr << __LINE__ << ": Model is not clipped, number of cells: " << clippedNumberOfCells << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // repeated updates without changes keep the clipped mesh
+  sliceNodes[1]->Modified();
+  CHECK_SAME_AS_NEW_VIEW(clippedNumberOfCells);
+
+  SetSliceOffset(sliceNodes[0], 5.0);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  SetSliceOffset(sliceNodes[0], -3.0);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+
+  clipModelsNode->SetRedSliceClipState(vtkMRMLClipModelsNode::ClipNegativeSpace);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  clipModelsNode->SetGreenSliceClipState(vtkMRMLClipModelsNode::ClipPositiveSpace);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  clipModelsNode->SetClipType(vtkMRMLClipModelsNode::ClipUnion);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  clipModelsNode->SetClippingMethod(vtkMRMLClipModelsNode::WholeCells);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Clipped mesh is recomputed when the model mesh changes
+
+  sphereSource->SetThetaResolution(24);
+  sphereSource->Update();
+  CHECK_SAME_AS_NEW_VIEW(-1);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Clipped mesh is released when clipping is turned off
+
+  modelDisplayNode->SetClipping(0);
+  CHECK_SAME_AS_NEW_VIEW(sphereSource->GetOutput()->GetNumberOfCells());
+  modelDisplayNode->SetClipping(1);
+  CHECK_SAME_AS_NEW_VIEW(-1);
+  clipModelsNode->SetRedSliceClipState(vtkMRMLClipModelsNode::ClipOff);
+  clipModelsNode->SetGreenSliceClipState(vtkMRMLClipModelsNode::ClipOff);
+  CHECK_SAME_AS_NEW_VIEW(sphereSource->GetOutput()->GetNumberOfCells());
+
+  //////////////////////////////////////////////////////////////////////////
+  // Level of detail actor displays the same mesh as the regular actor
+
+  if (!view.DisplayableManager->GetLevelOfDetail()
+    || !vtkThreadedLODActor::SafeDownCast(view.DisplayableManager->GetActorByID(modelDisplayNode->GetID())))
+    {
+    std::cerr << __LINE__ << ": Level of detail actor is not used by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+  view.DisplayableManager->SetLevelOfDetail(false);
+  if (vtkThreadedLODActor::SafeDownCast(view.DisplayableManager->GetActorByID(modelDisplayNode->GetID())))
+    {
+    std::cerr << __LINE__ << ": Level of detail actor is used after it is disabled" << std::endl;
+    return EXIT_FAILURE;
+    }
+  CHECK_SAME_AS_NEW_VIEW(sphereSource->GetOutput()->GetNumberOfCells());
+  view.DisplayableManager->SetLevelOfDetail(true);
+  CHECK_SAME_AS_NEW_VIEW(sphereSource->GetOutput()->GetNumberOfCells());
+
+  // decimated meshes are generated from the current model mesh, in a
+  // background thread, and only used once they are ready
+  for (int resolution = 32; resolution <= 48; resolution += 16)
+    {
+    sphereSource->SetThetaResolution(resolution);
+    sphereSource->SetPhiResolution(resolution);
+    sphereSource->Update();
+    view.DisplayableManager->RequestRender();
+    view.RenderWindow->Render();
+    vtkThreadedLODActor* lodActor = vtkThreadedLODActor::SafeDownCast(
+      view.DisplayableManager->GetActorByID(modelDisplayNode->GetID()));
+    if (!lodActor)
+      {
+      std::cerr << __LINE__ << ": Level of detail actor is not displayed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (lodActor->GetLevelsOfDetailReady() || lodActor->GetLODMappers()->GetNumberOfItems() != 0)
+      {
+      std::cerr << __LINE__ << ": Decimated meshes of the previous mesh are used, resolution "
+        << resolution << std::endl;
+      return EXIT_FAILURE;
+      }
+    lodActor->WaitForLevelsOfDetail();
+    if (!lodActor->GetLevelsOfDetailReady())
+      {
+      // the background thread was still generating the decimated meshes of
+      // the previous mesh, the current mesh is decimated after this render
+      view.RenderWindow->Render();
+      lodActor->WaitForLevelsOfDetail();
+      }
+    if (!lodActor->GetLevelsOfDetailReady() || lodActor->GetLODMappers()->GetNumberOfItems() != 2)
+      {
+      std::cerr << __LINE__ << ": Decimated meshes are not used once generated, resolution "
+        << resolution << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkMapper* lowResMapper = vtkMapper::SafeDownCast(lodActor->GetLODMappers()->GetItemAsObject(1));
+    vtkDataSet* lowResMesh = lowResMapper ? lowResMapper->GetInput() : 0;
+    vtkIdType lowResNumberOfCells = lowResMesh ? lowResMesh->GetNumberOfCells() : 0;
+    if (lowResNumberOfCells <= 0 || lowResNumberOfCells > sphereSource->GetOutput()->GetNumberOfCells())
+      {
+      std::cerr << __LINE__ << ": Decimated mesh is not generated from the current mesh, resolution "
+        << resolution << ", decimated cells: " << lowResNumberOfCells << std::endl;
+      return EXIT_FAILURE;
+      }
+    double lowResBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+    lowResMesh->GetBounds(lowResBounds);
+    double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+    sphereSource->GetOutput()->GetBounds(bounds);
+    for (int i = 0; i < 6; i++)
+      {
+      if (fabs(lowResBounds[i] - bounds[i]) > 0.1 * sphereSource->GetRadius())
+        {
+        std::cerr << __LINE__ << ": Decimated mesh bounds differ from the mesh bounds, resolution "
+          << resolution << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    CHECK_SAME_AS_NEW_VIEW(sphereSource->GetOutput()->GetNumberOfCells());
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,692 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slice view benchmark
+//
+// Sets up a slice view (vtkMRMLSliceLogic, displayable managers and an offscreen
+// render window) with synthetic data, replays scripted interactions and reports
+// per-stage frame timings as JSON, for tracking slice view performance regressions.
+//
+// Usage:
+//   vtkMRMLSliceViewBenchmark [--volume-size N] [--view-size W H] [--frames N]
+//     [--warmup-frames N] [--points N] [--interactions scroll,windowLevel,panZoom,opacity]
+//     [--displayable-manager ClassName]... [--output file.json]
+//
+// Stages of each frame:
+//   mrml                : node modification and synchronous processing of MRML events
+//                         by the slice logic and the displayable managers
+//   reslice             : vtkImageReslice of each layer
+//   display             : volume display pipeline of each layer
+//   blend               : compositing of the layers
+//   displayableManagers : update of the pipelines of the displayable manager actors
+//   render              : rendering of the up-to-date scene
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLCrosshairDisplayableManager.h>
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelSliceDisplayableManager.h>
+
+// MRMLLogic includes
+#include <vtkCachedImageReslice.h>
+#include <vtkMRMLApplicationLogic.h>
+#include <vtkMRMLSliceLayerLogic.h>
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLLabelMapVolumeDisplayNode.h>
+#include <vtkMRMLLabelMapVolumeNode.h>
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkActor.h>
+#include <vtkActor2D.h>
+#include <vtkAlgorithmOutput.h>
+#include <vtkGlyph3D.h>
+#include <vtkImageBlend.h>
+#include <vtkImageData.h>
+#include <vtkImageMapper.h>
+#include <vtkMapper.h>
+#include <vtkMapper2D.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+enum
+{
+  StageMRML = 0,
+  StageReslice,
+  StageDisplay,
+  StageBlend,
+  StageDisplayableManagers,
+  StageRender,
+  NumberOfStages
+};
+
+const char* StageNames[NumberOfStages] =
+{
+  "mrml", "reslice", "display", "blend", "displayableManagers", "render"
+};
+
+//----------------------------------------------------------------------------
+struct BenchmarkOptions
+{
+  BenchmarkOptions()
+    {
+    this->VolumeSize = 256;
+    this->ViewSize[0] = 800;
+    this->ViewSize[1] = 600;
+    this->Frames = 50;
+    this->WarmupFrames = 2;
+    this->NumberOfPoints = 500;
+    this->Interactions.push_back("scroll");
+    this->Interactions.push_back("windowLevel");
+    this->Interactions.push_back("panZoom");
+    this->Interactions.push_back("opacity");
+    }
+
+  int VolumeSize;
+  int ViewSize[2];
+  int Frames;
+  int WarmupFrames;
+  int NumberOfPoints;
+  std::vector<std::string> Interactions;
+  std::vector<std::string> DisplayableManagers;
+  std::string OutputFileName;
+};
+
+//----------------------------------------------------------------------------
+void PrintUsage(const char* executable)
+{
+  std::cerr << "Usage: " << executable << " [--volume-size N] [--view-size W H] [--frames N]"
+    << " [--warmup-frames N] [--points N] [--interactions scroll,windowLevel,panZoom,opacity]"
+    << " [--displayable-manager ClassName]... [--output file.json]" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], BenchmarkOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+    {
+    std::string argument = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (argument == "--volume-size" && hasValue)
+      {
+      options.VolumeSize = atoi(argv[++i]);
+      }
+    else if (argument == "--view-size" && i + 2 < argc)
+      {
+      options.ViewSize[0] = atoi(argv[++i]);
+      options.ViewSize[1] = atoi(argv[++i]);
+      }
+    else if (argument == "--frames" && hasValue)
+      {
+      options.Frames = atoi(argv[++i]);
+      }
+    else if (argument == "--warmup-frames" && hasValue)
+      {
+      options.WarmupFrames = atoi(argv[++i]);
+      }
+    else if (argument == "--points" && hasValue)
+      {
+      options.NumberOfPoints = atoi(argv[++i]);
+      }
+    else if (argument == "--interactions" && hasValue)
+      {
+      options.Interactions.clear();
+      std::stringstream interactions(argv[++i]);
+      std::string interaction;
+      while (std::getline(interactions, interaction, ','))
+        {
+        options.Interactions.push_back(interaction);
+        }
+      }
+    else if (argument == "--displayable-manager" && hasValue)
+      {
+      options.DisplayableManagers.push_back(argv[++i]);
+      }
+    else if (argument == "--output" && hasValue)
+      {
+      options.OutputFileName = argv[++i];
+      }
+    else
+      {
+      std::cerr << "Invalid argument: " << argument << std::endl;
+      return false;
+      }
+    }
+  if (options.VolumeSize < 8 || options.ViewSize[0] < 1 || options.ViewSize[1] < 1
+    || options.Frames < 1 || options.WarmupFrames < 0 || options.NumberOfPoints < 0)
+    {
+    std::cerr << "Invalid benchmark parameters" << std::endl;
+    return false;
+    }
+  for (std::vector<std::string>::iterator it = options.Interactions.begin(); it != options.Interactions.end(); ++it)
+    {
+    if (*it != "scroll" && *it != "windowLevel" && *it != "panZoom" && *it != "opacity")
+      {
+      std::cerr << "Invalid interaction: " << *it << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Deterministic pseudo-random generator, results do not depend on the platform
+unsigned int NextRandom(unsigned int& state)
+{
+  state = state * 1103515245u + 12345u;
+  return (state >> 16) & 0x7fff;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLColorTableNode* AddColorNode(vtkMRMLScene* scene, bool labels)
+{
+  vtkNew<vtkMRMLColorTableNode> colorNode;
+  if (labels)
+    {
+    colorNode->SetTypeToLabels();
+    }
+  else
+    {
+    colorNode->SetTypeToGrey();
+    }
+  scene->AddNode(colorNode.GetPointer());
+  return colorNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+/// Short volume with smooth structures and texture, similar to a CT
+vtkMRMLScalarVolumeNode* AddBackgroundVolume(vtkMRMLScene* scene, int size)
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(size, size, size);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* ptr = static_cast<short*>(image->GetScalarPointer());
+  const double center = size / 2.0;
+  unsigned int randomState = 1;
+  for (int z = 0; z < size; z++)
+    {
+    for (int y = 0; y < size; y++)
+      {
+      for (int x = 0; x < size; x++)
+        {
+        double r = sqrt((x - center) * (x - center) + (y - center) * (y - center) + (z - center) * (z - center));
+        double value = (r < 0.45 * size ? 40.0 + 1000.0 * (r < 0.15 * size) : -1000.0);
+        *(ptr++) = static_cast<short>(value + static_cast<int>(NextRandom(randomState) % 40) - 20);
+        }
+      }
+    }
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  displayNode->SetAutoWindowLevel(false);
+  displayNode->SetWindowLevel(400, 40);
+  scene->AddNode(displayNode.GetPointer());
+  displayNode->SetAndObserveColorNodeID(AddColorNode(scene, false)->GetID());
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName("Background");
+  volumeNode->SetOrigin(-size / 2.0, -size / 2.0, -size / 2.0);
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return volumeNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+/// Lower resolution unsigned char volume, so that the foreground is resampled differently
+vtkMRMLScalarVolumeNode* AddForegroundVolume(vtkMRMLScene* scene, int size)
+{
+  const int foregroundSize = size / 2;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(foregroundSize, foregroundSize, foregroundSize);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* ptr = static_cast<unsigned char*>(image->GetScalarPointer());
+  for (int z = 0; z < foregroundSize; z++)
+    {
+    for (int y = 0; y < foregroundSize; y++)
+      {
+      for (int x = 0; x < foregroundSize; x++)
+        {
+        *(ptr++) = static_cast<unsigned char>((x * 3 + y * 5 + z * 7) % 256);
+        }
+      }
+    }
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  displayNode->SetAutoWindowLevel(false);
+  displayNode->SetWindowLevel(255, 127.5);
+  scene->AddNode(displayNode.GetPointer());
+  displayNode->SetAndObserveColorNodeID(AddColorNode(scene, false)->GetID());
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetName("Foreground");
+  volumeNode->SetSpacing(2.0, 2.0, 2.0);
+  volumeNode->SetOrigin(-size / 2.0, -size / 2.0, -size / 2.0);
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return volumeNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+/// Labelmap with nested and overlapping spherical segments
+vtkMRMLLabelMapVolumeNode* AddLabelVolume(vtkMRMLScene* scene, int size)
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(size, size, size);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* ptr = static_cast<unsigned char*>(image->GetScalarPointer());
+  const int numberOfSegments = 5;
+  for (int z = 0; z < size; z++)
+    {
+    for (int y = 0; y < size; y++)
+      {
+      for (int x = 0; x < size; x++)
+        {
+        unsigned char label = 0;
+        for (int segment = 1; segment <= numberOfSegments; segment++)
+          {
+          double center = size * (0.2 + 0.12 * segment);
+          double radius = size * 0.15;
+          double dx = x - center;
+          double dy = y - size / 2.0;
+          double dz = z - size / 2.0;
+          if (dx * dx + dy * dy + dz * dz < radius * radius)
+            {
+            label = static_cast<unsigned char>(segment);
+            }
+          }
+        *(ptr++) = label;
+        }
+      }
+    }
+
+  vtkNew<vtkMRMLLabelMapVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+  displayNode->SetAndObserveColorNodeID(AddColorNode(scene, true)->GetID());
+
+  vtkNew<vtkMRMLLabelMapVolumeNode> volumeNode;
+  volumeNode->SetName("Label");
+  volumeNode->SetOrigin(-size / 2.0, -size / 2.0, -size / 2.0);
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return volumeNode.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+/// Model made of small spheres at random positions, intersected with the slice
+/// by the model slice displayable manager
+void AddPointSetModel(vtkMRMLScene* scene, int size, int numberOfPoints)
+{
+  if (numberOfPoints <= 0)
+    {
+    return;
+    }
+  vtkNew<vtkPoints> points;
+  unsigned int randomState = 2;
+  for (int i = 0; i < numberOfPoints; i++)
+    {
+    double position[3];
+    for (int axis = 0; axis < 3; axis++)
+      {
+      position[axis] = (NextRandom(randomState) / 32767.0 - 0.5) * size;
+      }
+    points->InsertNextPoint(position);
+    }
+  vtkNew<vtkPolyData> pointSet;
+  pointSet->SetPoints(points.GetPointer());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(2.0);
+  vtkNew<vtkGlyph3D> glyph;
+  glyph->SetInputData(pointSet.GetPointer());
+  glyph->SetSourceConnection(sphere->GetOutputPort());
+  glyph->Update();
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  displayNode->SetSliceIntersectionVisibility(1);
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetName("Points");
+  modelNode->SetAndObservePolyData(glyph->GetOutput());
+  scene->AddNode(modelNode.GetPointer());
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+}
+
+//----------------------------------------------------------------------------
+/// Modify the MRML nodes to simulate the given frame of an interaction
+void ApplyInteraction(const std::string& interaction, int frame, vtkMRMLSliceLogic* sliceLogic,
+  const double sliceBounds[6], double sliceSpacing, const double fieldOfView[3])
+{
+  vtkMRMLSliceNode* sliceNode = sliceLogic->GetSliceNode();
+  if (interaction == "scroll")
+    {
+    // scroll through the volume back and forth, one slice per frame
+    int numberOfSlices = static_cast<int>((sliceBounds[5] - sliceBounds[4]) / sliceSpacing);
+    numberOfSlices = std::max(numberOfSlices, 1);
+    int sliceIndex = frame % (2 * numberOfSlices);
+    if (sliceIndex >= numberOfSlices)
+      {
+      sliceIndex = 2 * numberOfSlices - 1 - sliceIndex;
+      }
+    sliceLogic->SetSliceOffset(sliceBounds[4] + (sliceIndex + 0.5) * sliceSpacing);
+    }
+  else if (interaction == "windowLevel")
+    {
+    // mouse drag changes window and level continuously
+    double phase = frame * 0.1;
+    sliceLogic->SetBackgroundWindowLevel(400.0 + 300.0 * sin(phase), 40.0 + 100.0 * cos(phase));
+    }
+  else if (interaction == "panZoom")
+    {
+    double phase = frame * 0.1;
+    double zoom = 1.0 + 0.5 * sin(phase);
+    sliceNode->SetFieldOfView(fieldOfView[0] * zoom, fieldOfView[1] * zoom, fieldOfView[2]);
+    sliceNode->SetXYZOrigin(20.0 * cos(phase), 20.0 * sin(phase), 0.0);
+    }
+  else if (interaction == "opacity")
+    {
+    double phase = frame * 0.1;
+    vtkMRMLSliceCompositeNode* compositeNode = sliceLogic->GetSliceCompositeNode();
+    compositeNode->SetForegroundOpacity(0.5 + 0.5 * sin(phase));
+    compositeNode->SetLabelOpacity(0.5 + 0.5 * cos(phase));
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Update the pipelines that are executed during rendering one by one and
+/// record how long each stage takes
+void RenderFrame(vtkMRMLSliceLogic* sliceLogic, vtkRenderWindow* renderWindow,
+  vtkRenderer* renderer, vtkActor2D* sliceActor, double stageTimes[NumberOfStages])
+{
+  vtkMRMLSliceLayerLogic* layers[3] =
+    { sliceLogic->GetBackgroundLayer(), sliceLogic->GetForegroundLayer(), sliceLogic->GetLabelLayer() };
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  for (int layerIndex = 0; layerIndex < 3; layerIndex++)
+    {
+    if (layers[layerIndex] && layers[layerIndex]->GetVolumeNode())
+      {
+      layers[layerIndex]->GetReslice()->Update();
+      }
+    }
+  double resliceTime = vtkTimerLog::GetUniversalTime();
+  stageTimes[StageReslice] += (resliceTime - startTime) * 1000.0;
+
+  for (int layerIndex = 0; layerIndex < 3; layerIndex++)
+    {
+    vtkAlgorithmOutput* layerConnection = (layers[layerIndex] ? layers[layerIndex]->GetImageDataConnection() : 0);
+    if (layerConnection && layerConnection->GetProducer())
+      {
+      layerConnection->GetProducer()->Update(layerConnection->GetIndex());
+      }
+    }
+  double displayTime = vtkTimerLog::GetUniversalTime();
+  stageTimes[StageDisplay] += (displayTime - resliceTime) * 1000.0;
+
+  sliceLogic->GetBlend()->Update();
+  double blendTime = vtkTimerLog::GetUniversalTime();
+  stageTimes[StageBlend] += (blendTime - displayTime) * 1000.0;
+
+  vtkPropCollection* props = renderer->GetViewProps();
+  vtkCollectionSimpleIterator it;
+  props->InitTraversal(it);
+  for (vtkProp* prop = props->GetNextProp(it); prop; prop = props->GetNextProp(it))
+    {
+    if (!prop->GetVisibility() || prop == sliceActor)
+      {
+      continue;
+      }
+    vtkActor* actor = vtkActor::SafeDownCast(prop);
+    vtkActor2D* actor2D = vtkActor2D::SafeDownCast(prop);
+    if (actor && actor->GetMapper())
+      {
+      actor->GetMapper()->Update();
+      }
+    else if (actor2D && actor2D->GetMapper())
+      {
+      actor2D->GetMapper()->Update();
+      }
+    }
+  double displayableManagersTime = vtkTimerLog::GetUniversalTime();
+  stageTimes[StageDisplayableManagers] += (displayableManagersTime - blendTime) * 1000.0;
+
+  renderWindow->Render();
+  stageTimes[StageRender] += (vtkTimerLog::GetUniversalTime() - displayableManagersTime) * 1000.0;
+}
+
+//----------------------------------------------------------------------------
+void WriteStatistics(std::ostream& os, std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (std::vector<double>::iterator it = times.begin(); it != times.end(); ++it)
+    {
+    sum += *it;
+    }
+  size_t count = times.size();
+  os << "{\"mean\": " << (count ? sum / count : 0.0)
+     << ", \"median\": " << (count ? times[count / 2] : 0.0)
+     << ", \"p95\": " << (count ? times[std::min(count - 1, static_cast<size_t>(0.95 * count))] : 0.0)
+     << ", \"min\": " << (count ? times.front() : 0.0)
+     << ", \"max\": " << (count ? times.back() : 0.0) << "}";
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  if (!ParseArguments(argc, argv, options))
+    {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  // Scene and synthetic data
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSliceNode::AddDefaultSliceOrientationPresets(scene.GetPointer());
+
+  // Application logic - Handle creation of vtkMRMLSelectionNode and vtkMRMLInteractionNode
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLSliceLogic> sliceLogic;
+  sliceLogic->SetName("Red");
+  sliceLogic->SetMRMLScene(scene.GetPointer());
+  sliceLogic->ResizeSliceNode(options.ViewSize[0], options.ViewSize[1]);
+  vtkMRMLSliceNode* sliceNode = sliceLogic->GetSliceNode();
+  sliceNode->SetSliceResolutionMode(vtkMRMLSliceNode::SliceResolutionMatch2DView);
+
+  vtkMRMLScalarVolumeNode* backgroundNode = AddBackgroundVolume(scene.GetPointer(), options.VolumeSize);
+  vtkMRMLScalarVolumeNode* foregroundNode = AddForegroundVolume(scene.GetPointer(), options.VolumeSize);
+  vtkMRMLLabelMapVolumeNode* labelNode = AddLabelVolume(scene.GetPointer(), options.VolumeSize);
+  AddPointSetModel(scene.GetPointer(), options.VolumeSize, options.NumberOfPoints);
+
+  vtkMRMLSliceCompositeNode* compositeNode = sliceLogic->GetSliceCompositeNode();
+  compositeNode->SetBackgroundVolumeID(backgroundNode->GetID());
+  compositeNode->SetForegroundVolumeID(foregroundNode->GetID());
+  compositeNode->SetForegroundOpacity(0.5);
+  compositeNode->SetLabelVolumeID(labelNode->GetID());
+  compositeNode->SetLabelOpacity(1.0);
+  sliceLogic->FitSliceToAll(options.ViewSize[0], options.ViewSize[1]);
+
+  // Offscreen slice view
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(options.ViewSize[0], options.ViewSize[1]);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer.GetPointer());
+  renderWindow->SetInteractor(renderWindowInteractor.GetPointer());
+
+  vtkNew<vtkImageMapper> sliceMapper;
+  sliceMapper->SetColorWindow(255.0);
+  sliceMapper->SetColorLevel(127.5);
+  sliceMapper->SetInputConnection(sliceLogic->GetImageDataConnection());
+  vtkNew<vtkActor2D> sliceActor;
+  sliceActor->SetMapper(sliceMapper.GetPointer());
+  renderer->AddViewProp(sliceActor.GetPointer());
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer.GetPointer());
+  vtkNew<vtkMRMLModelSliceDisplayableManager> modelSliceDisplayableManager;
+  modelSliceDisplayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  displayableManagerGroup->AddDisplayableManager(modelSliceDisplayableManager.GetPointer());
+  vtkNew<vtkMRMLCrosshairDisplayableManager> crosshairDisplayableManager;
+  crosshairDisplayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+  displayableManagerGroup->AddDisplayableManager(crosshairDisplayableManager.GetPointer());
+  for (std::vector<std::string>::iterator it = options.DisplayableManagers.begin();
+    it != options.DisplayableManagers.end(); ++it)
+    {
+    // Displayable managers of loadable modules (segmentations, markups, ...) are available
+    // if their library is linked and registers the class in the object factory
+    vtkSmartPointer<vtkMRMLAbstractDisplayableManager> displayableManager;
+    displayableManager.TakeReference(vtkMRMLDisplayableManagerGroup::InstantiateDisplayableManager(it->c_str()));
+    if (!displayableManager)
+      {
+      std::cerr << "Failed to instantiate displayable manager: " << *it << std::endl;
+      return EXIT_FAILURE;
+      }
+    displayableManager->SetMRMLApplicationLogic(applicationLogic.GetPointer());
+    displayableManagerGroup->AddDisplayableManager(displayableManager);
+    }
+  displayableManagerGroup->SetMRMLDisplayableNode(sliceNode);
+  renderWindow->Render();
+
+  double sliceBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  sliceLogic->GetLowestVolumeSliceBounds(sliceBounds);
+  double sliceSpacing = sliceLogic->GetLowestVolumeSliceSpacing()[2];
+  double fieldOfView[3] = { 0.0, 0.0, 0.0 };
+  sliceNode->GetFieldOfView(fieldOfView);
+  double initialSliceOffset = sliceLogic->GetSliceOffset();
+  double initialXYZOrigin[3] = { 0.0, 0.0, 0.0 };
+  sliceNode->GetXYZOrigin(initialXYZOrigin);
+
+  // Replay interactions
+  std::stringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"vtkMRMLSliceViewBenchmark\",\n"
+       << "  \"parameters\": {\"volumeSize\": " << options.VolumeSize
+       << ", \"viewSize\": [" << options.ViewSize[0] << ", " << options.ViewSize[1] << "]"
+       << ", \"frames\": " << options.Frames
+       << ", \"warmupFrames\": " << options.WarmupFrames
+       << ", \"points\": " << options.NumberOfPoints
+       << ", \"displayableManagers\": " << displayableManagerGroup->GetDisplayableManagerCount() << "},\n"
+       << "  \"units\": \"ms\",\n"
+       << "  \"interactions\": [";
+  for (size_t interactionIndex = 0; interactionIndex < options.Interactions.size(); interactionIndex++)
+    {
+    const std::string& interaction = options.Interactions[interactionIndex];
+    std::vector<double> stageTimes[NumberOfStages];
+    std::vector<double> frameTimes;
+    vtkCachedImageReslice* backgroundReslice = sliceLogic->GetBackgroundLayer()->GetReslice();
+    for (int frame = 0; frame < options.WarmupFrames + options.Frames; frame++)
+      {
+      if (frame == options.WarmupFrames)
+        {
+        backgroundReslice->ResetStatistics();
+        }
+      double frameStageTimes[NumberOfStages] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      double startTime = vtkTimerLog::GetUniversalTime();
+      ApplyInteraction(interaction, frame, sliceLogic.GetPointer(), sliceBounds, sliceSpacing, fieldOfView);
+      frameStageTimes[StageMRML] = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+      RenderFrame(sliceLogic.GetPointer(), renderWindow.GetPointer(), renderer.GetPointer(),
+        sliceActor.GetPointer(), frameStageTimes);
+      double frameTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+      if (frame < options.WarmupFrames)
+        {
+        continue;
+        }
+      for (int stage = 0; stage < NumberOfStages; stage++)
+        {
+        stageTimes[stage].push_back(frameStageTimes[stage]);
+        }
+      frameTimes.push_back(frameTime);
+      }
+
+    json << (interactionIndex > 0 ? "," : "") << "\n"
+         << "    {\n"
+         << "      \"name\": \"" << interaction << "\",\n"
+         << "      \"stages\": {";
+    for (int stage = 0; stage < NumberOfStages; stage++)
+      {
+      json << (stage > 0 ? "," : "") << "\n        \"" << StageNames[stage] << "\": ";
+      WriteStatistics(json, stageTimes[stage]);
+      }
+    json << "\n      },\n"
+         << "      \"frame\": ";
+    WriteStatistics(json, frameTimes);
+    json << ",\n"
+         << "      \"backgroundResliceCacheHitRate\": " << backgroundReslice->GetCacheHitRate() << "\n"
+         << "    }";
+
+    // Restore the initial view for the next interaction
+    sliceNode->SetFieldOfView(fieldOfView[0], fieldOfView[1], fieldOfView[2]);
+    sliceNode->SetXYZOrigin(initialXYZOrigin[0], initialXYZOrigin[1], initialXYZOrigin[2]);
+    sliceLogic->SetSliceOffset(initialSliceOffset);
+    sliceLogic->SetBackgroundWindowLevel(400, 40);
+    compositeNode->SetForegroundOpacity(0.5);
+    compositeNode->SetLabelOpacity(1.0);
+    }
+  json << "\n  ]\n}\n";
+
+  if (options.OutputFileName.empty())
+    {
+    std::cout << json.str();
+    }
+  else
+    {
+    std::ofstream output(options.OutputFileName.c_str());
+    if (!output)
+      {
+      std::cerr << "Failed to write output file: " << options.OutputFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    output << json.str();
+    }
+
+  displayableManagerGroup->SetMRMLDisplayableNode(0);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,218 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slice intersection benchmark
+//
+// Measures the per-frame latency of cutting a model with the slice plane while
+// scrolling, with vtkCutter on the whole mesh and with vtkCutter on the cells
+// selected by vtkPlaneIntersectingCellsFilter, and reports the timings as JSON.
+//
+// Usage:
+//   vtkPlaneIntersectingCellsFilterBenchmark [--resolution N] [--frames N]
+//     [--output file.json]
+
+// MRMLDisplayableManager includes
+#include "vtkPlaneIntersectingCellsFilter.h"
+
+// VTK includes
+#include <vtkCutter.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkOptions
+{
+  BenchmarkOptions()
+    {
+    this->Resolution = 1000;
+    this->Frames = 20;
+    }
+
+  /// Theta and phi resolution of the sphere (about 2 * Resolution^2 triangles)
+  int Resolution;
+  int Frames;
+  std::string OutputFileName;
+};
+
+//----------------------------------------------------------------------------
+void PrintUsage(const char* executable)
+{
+  std::cerr << "Usage: " << executable << " [--resolution N] [--frames N] [--output file.json]" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], BenchmarkOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+    {
+    std::string argument = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (argument == "--resolution" && hasValue)
+      {
+      options.Resolution = atoi(argv[++i]);
+      }
+    else if (argument == "--frames" && hasValue)
+      {
+      options.Frames = atoi(argv[++i]);
+      }
+    else if (argument == "--output" && hasValue)
+      {
+      options.OutputFileName = argv[++i];
+      }
+    else
+      {
+      std::cerr << "Invalid argument: " << argument << std::endl;
+      return false;
+      }
+    }
+  if (options.Resolution < 3 || options.Frames < 1)
+    {
+    std::cerr << "Invalid benchmark parameters" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void WriteStatistics(std::ostream& os, std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (std::vector<double>::iterator it = times.begin(); it != times.end(); ++it)
+    {
+    sum += *it;
+    }
+  size_t count = times.size();
+  os << "{\"mean\": " << (count ? sum / count : 0.0)
+     << ", \"median\": " << (count ? times[count / 2] : 0.0)
+     << ", \"p95\": " << (count ? times[std::min(count - 1, static_cast<size_t>(0.95 * count))] : 0.0)
+     << ", \"min\": " << (count ? times.front() : 0.0)
+     << ", \"max\": " << (count ? times.back() : 0.0) << "}";
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  if (!ParseArguments(argc, argv, options))
+    {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.0);
+  sphere->SetThetaResolution(options.Resolution);
+  sphere->SetPhiResolution(options.Resolution);
+  sphere->Update();
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0.0, 0.0, 1.0);
+
+  vtkNew<vtkCutter> referenceCutter;
+  referenceCutter->SetCutFunction(plane.GetPointer());
+  referenceCutter->SetInputConnection(sphere->GetOutputPort());
+
+  vtkNew<vtkPlaneIntersectingCellsFilter> intersectingCells;
+  intersectingCells->SetPlane(plane.GetPointer());
+  intersectingCells->SetInputConnection(sphere->GetOutputPort());
+  vtkNew<vtkCutter> cutter;
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetInputConnection(intersectingCells->GetOutputPort());
+
+  // The index is built once, at the first cut
+  double startTime = vtkTimerLog::GetUniversalTime();
+  cutter->Update();
+  double indexBuildTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+
+  // Scroll through the mesh
+  std::vector<double> referenceTimes;
+  std::vector<double> indexedTimes;
+  for (int frame = 0; frame < options.Frames; frame++)
+    {
+    plane->SetOrigin(0.0, 0.0, -40.0 + 80.0 * frame / options.Frames);
+
+    startTime = vtkTimerLog::GetUniversalTime();
+    referenceCutter->Update();
+    referenceTimes.push_back((vtkTimerLog::GetUniversalTime() - startTime) * 1000.0);
+
+    startTime = vtkTimerLog::GetUniversalTime();
+    cutter->Update();
+    indexedTimes.push_back((vtkTimerLog::GetUniversalTime() - startTime) * 1000.0);
+
+    // Timings are only meaningful if both compute the same intersection
+    if (cutter->GetOutput()->GetNumberOfPoints() != referenceCutter->GetOutput()->GetNumberOfPoints()
+      || cutter->GetOutput()->GetNumberOfCells() != referenceCutter->GetOutput()->GetNumberOfCells())
+      {
+      std::cerr << "Intersection mismatch at frame " << frame << ": "
+        << cutter->GetOutput()->GetNumberOfCells() << " cells (expected "
+        << referenceCutter->GetOutput()->GetNumberOfCells() << " cells)" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::stringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"vtkPlaneIntersectingCellsFilterBenchmark\",\n"
+       << "  \"parameters\": {\"resolution\": " << options.Resolution
+       << ", \"triangles\": " << sphere->GetOutput()->GetNumberOfCells()
+       << ", \"frames\": " << options.Frames << "},\n"
+       << "  \"units\": \"ms\",\n"
+       << "  \"indexBuild\": " << indexBuildTime << ",\n"
+       << "  \"cutter\": ";
+  WriteStatistics(json, referenceTimes);
+  json << ",\n"
+       << "  \"planeIntersectingCellsFilter\": ";
+  WriteStatistics(json, indexedTimes);
+  json << ",\n"
+       << "  \"testedCells\": " << intersectingCells->GetNumberOfTestedCells() << "\n"
+       << "}\n";
+
+  if (options.OutputFileName.empty())
+    {
+    std::cout << json.str();
+    }
+  else
+    {
+    std::ofstream output(options.OutputFileName.c_str());
+    if (!output)
+      {
+      std::cerr << "Failed to write output file: " << options.OutputFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    output << json.str();
+    }
+
+  return EXIT_SUCCESS;
+}
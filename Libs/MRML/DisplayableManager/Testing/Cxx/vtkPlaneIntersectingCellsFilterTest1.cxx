@@ -0,0 +1,154 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkPlaneIntersectingCellsFilter.h"
+
+// VTK includes
+#include <vtkCutter.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+double GetTotalLineLength(vtkPolyData* lines)
+{
+  double length = 0.0;
+  vtkNew<vtkIdList> pointIds;
+  for (vtkIdType cellId = 0; cellId < lines->GetNumberOfCells(); ++cellId)
+    {
+    lines->GetCellPoints(cellId, pointIds.GetPointer());
+    for (vtkIdType i = 1; i < pointIds->GetNumberOfIds(); ++i)
+      {
+      length += std::sqrt(vtkMath::Distance2BetweenPoints(
+        lines->GetPoint(pointIds->GetId(i - 1)), lines->GetPoint(pointIds->GetId(i))));
+      }
+    }
+  return length;
+}
+
+//----------------------------------------------------------------------------
+bool CompareCuts(vtkCutter* referenceCutter, vtkCutter* cutter, int line)
+{
+  referenceCutter->Update();
+  cutter->Update();
+  vtkPolyData* expected = referenceCutter->GetOutput();
+  vtkPolyData* actual = cutter->GetOutput();
+  if (actual->GetNumberOfPoints() != expected->GetNumberOfPoints()
+    || actual->GetNumberOfCells() != expected->GetNumberOfCells())
+    {
+    std::cerr << line << ": Intersection mismatch: " << actual->GetNumberOfPoints() << " points, "
+      << actual->GetNumberOfCells() << " cells (expected " << expected->GetNumberOfPoints() << " points, "
+      << expected->GetNumberOfCells() << " cells)" << std::endl;
+    return false;
+    }
+  double expectedLength = GetTotalLineLength(expected);
+  double actualLength = GetTotalLineLength(actual);
+  if (std::fabs(expectedLength - actualLength) > 1e-6 * expectedLength)
+    {
+    std::cerr << line << ": Intersection length mismatch: " << actualLength
+      << " (expected " << expectedLength << ")" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkPlaneIntersectingCellsFilterTest1(int , char * [] )
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.0);
+  sphere->SetThetaResolution(120);
+  sphere->SetPhiResolution(120);
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0.0, 0.0, 1.0);
+
+  vtkNew<vtkCutter> referenceCutter;
+  referenceCutter->SetCutFunction(plane.GetPointer());
+  referenceCutter->SetInputConnection(sphere->GetOutputPort());
+
+  vtkNew<vtkPlaneIntersectingCellsFilter> intersectingCells;
+  intersectingCells->SetPlane(plane.GetPointer());
+  intersectingCells->SetInputConnection(sphere->GetOutputPort());
+  vtkNew<vtkCutter> cutter;
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetInputConnection(intersectingCells->GetOutputPort());
+
+  //////////////////////////////////////////////////////////////////////////
+  // Scrolling: same intersection as cutting the whole mesh, index is built once
+
+  for (double offset = -55.0; offset <= 55.0; offset += 7.3)
+    {
+    plane->SetOrigin(0.0, 0.0, offset);
+    if (!CompareCuts(referenceCutter.GetPointer(), cutter.GetPointer(), __LINE__))
+      {
+      std::cerr << "Slice offset: " << offset << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (intersectingCells->GetNumberOfIndexBuilds() != 1)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of index builds: "
+      << intersectingCells->GetNumberOfIndexBuilds() << std::endl;
+    return EXIT_FAILURE;
+    }
+  plane->SetOrigin(0.0, 0.0, 10.0);
+  cutter->Update();
+  vtkIdType numberOfCells = sphere->GetOutput()->GetNumberOfCells();
+  if (intersectingCells->GetNumberOfTestedCells() * 10 > numberOfCells)
+    {
+    std::cerr << __LINE__ << ": Too many cells are tested: " << intersectingCells->GetNumberOfTestedCells()
+      << " of " << numberOfCells << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Rotating the plane or modifying the mesh rebuilds the index
+
+  plane->SetNormal(0.3, -0.5, 0.8);
+  if (!CompareCuts(referenceCutter.GetPointer(), cutter.GetPointer(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  sphere->SetCenter(3.0, 2.0, 1.0);
+  if (!CompareCuts(referenceCutter.GetPointer(), cutter.GetPointer(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  if (intersectingCells->GetNumberOfIndexBuilds() != 3)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of index builds: "
+      << intersectingCells->GetNumberOfIndexBuilds() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
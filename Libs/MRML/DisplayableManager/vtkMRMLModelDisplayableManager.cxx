@@ -16,6 +16,7 @@
 
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelDisplayableManager.h"
+#include "vtkThreadedLODActor.h"
 #include "vtkThreeDViewInteractorStyle.h"
 #include "vtkMRMLApplicationLogic.h"
 
@@ -104,6 +105,17 @@ public:
   std::map<std::string, int>                       RegisteredModelHierarchies;
   std::map<std::string, vtkTransformFilter *>      DisplayNodeTransformFilters;
 
+  /// Filters of a display node that are kept when its actor is rebuilt,
+  /// to avoid recomputing clipped meshes that have not changed
+  struct CachedPipeline
+    {
+    vtkSmartPointer<vtkAlgorithm> Clipper;
+    /// Clipping parameters the clipper was created for
+    std::vector<double> ClipParameters;
+    };
+  std::map<std::string, CachedPipeline>            CachedPipelines;
+  bool                                             LevelOfDetail;
+
   vtkMRMLSliceNode *   RedSliceNode;
   vtkMRMLSliceNode *   GreenSliceNode;
   vtkMRMLSliceNode *   YellowSliceNode;
@@ -154,6 +166,8 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal()
   this->ModelHierarchiesPresent = false;
   this->UpdateHierachyRequested = false;
 
+  this->LevelOfDetail = true;
+
   // Instantiate and initialize Pickers
   this->WorldPointPicker = vtkSmartPointer<vtkWorldPointPicker>::New();
   this->PropPicker = vtkSmartPointer<vtkPropPicker>::New();
@@ -252,6 +266,7 @@ void vtkMRMLModelDisplayableManager::PrintSelf ( ostream& os, vtkIndent indent )
   os << indent << "ClippingMethod = " << this->Internal->ClippingMethod << "\n";
   os << indent << "ClippingOn = " << (this->Internal->ClippingOn ? "true" : "false") << "\n";
   os << indent << "ModelHierarchiesPresent = " << this->Internal->ModelHierarchiesPresent << "\n";
+  os << indent << "LevelOfDetail = " << (this->Internal->LevelOfDetail ? "true" : "false") << "\n";
 
   os << indent << "PickedNodeID = " << this->Internal->PickedNodeID.c_str() << "\n";
   os << indent << "PickedRAS = (" << this->Internal->PickedRAS[0] << ", "
@@ -297,6 +312,40 @@ void vtkMRMLModelDisplayableManager::SetClipModelsNode(vtkMRMLClipModelsNode *sn
   vtkSetAndObserveMRMLNodeMacro(this->Internal->ClipModelsNode, snode);
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::SetLevelOfDetail(bool enable)
+{
+  if (this->Internal->LevelOfDetail == enable)
+    {
+    return;
+    }
+  this->Internal->LevelOfDetail = enable;
+  // actors are recreated with the requested type at the next update
+  std::vector<std::string> removedIDs;
+  std::map<std::string, vtkProp3D *>::iterator iter;
+  for (iter = this->Internal->DisplayedActors.begin(); iter != this->Internal->DisplayedActors.end(); iter++)
+    {
+    if (this->GetRenderer())
+      {
+      this->GetRenderer()->RemoveViewProp(iter->second);
+      }
+    removedIDs.push_back(iter->first);
+    }
+  for (unsigned int i=0; i< removedIDs.size(); i++)
+    {
+    this->RemoveDispalyedID(removedIDs[i]);
+    }
+  this->Modified();
+  this->SetUpdateFromMRMLRequested(1);
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::GetLevelOfDetail()
+{
+  return this->Internal->LevelOfDetail;
+}
+
 //---------------------------------------------------------------------------
 int vtkMRMLModelDisplayableManager::UpdateClipSlicesFromMRML()
 {
@@ -858,6 +907,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
     this->Internal->DisplayedClipState.clear();
     this->Internal->DisplayedVisibility.clear();
     this->Internal->DisplayNodeTransformFilters.clear();
+    this->Internal->CachedPipelines.clear();
     this->UpdateModelHierarchies();
     }
 
@@ -1017,7 +1067,18 @@ void vtkMRMLModelDisplayableManager
       {
       if (!prop)
         {
-        prop = vtkActor::New();
+        vtkMRMLModelNode::MeshTypeHint meshType = modelNode ? modelNode->GetMeshType() : vtkMRMLModelNode::PolyDataMeshType;
+        if (this->Internal->LevelOfDetail && meshType == vtkMRMLModelNode::PolyDataMeshType)
+          {
+          // decimated meshes are generated in a background thread after the
+          // mesh is rendered, interaction is only faster once they are ready
+          vtkThreadedLODActor* lodActor = vtkThreadedLODActor::New();
+          prop = lodActor;
+          }
+        else
+          {
+          prop = vtkActor::New();
+          }
         }
       }
     else
@@ -1062,7 +1123,18 @@ void vtkMRMLModelDisplayableManager
       vtkMRMLModelNode::MeshTypeHint meshType = modelNode ? modelNode->GetMeshType() : vtkMRMLModelNode::PolyDataMeshType;
       if (this->Internal->ClippingOn && modelDisplayNode != 0 && clipping)
         {
-        clipper = this->CreateTransformedClipper(modelNode->GetParentTransformNode(), meshType);
+        clipper = this->CreateCachedTransformedClipper(displayNode, modelNode->GetParentTransformNode(), meshType);
+        }
+      else
+        {
+        // release the clipped mesh
+        std::map<std::string, vtkInternal::CachedPipeline>::iterator pit =
+          this->Internal->CachedPipelines.find(displayNode->GetID());
+        if (pit != this->Internal->CachedPipelines.end())
+          {
+          pit->second.Clipper = 0;
+          pit->second.ClipParameters.clear();
+          }
         }
 
       vtkMapper *mapper = NULL;
@@ -1329,6 +1401,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
       {
       this->GetRenderer()->RemoveViewProp(iter->second);
       removedIDs.push_back(iter->first);
+      this->Internal->CachedPipelines.erase(iter->first);
       }
     else
       {
@@ -1371,6 +1444,7 @@ void vtkMRMLModelDisplayableManager::RemoveDisplayable(vtkMRMLDisplayableNode* m
   for (int i=0; i<ndnodes; i++)
     {
     const char* displayNodeIDToRemove = model->GetNthDisplayNodeID(i);
+    this->Internal->CachedPipelines.erase(displayNodeIDToRemove);
     std::map<std::string, vtkProp3D *>::iterator iter =
       this->Internal->DisplayedActors.find(displayNodeIDToRemove);
     if (iter != this->Internal->DisplayedActors.end())
@@ -2120,6 +2194,69 @@ vtkAlgorithm* vtkMRMLModelDisplayableManager
     }
 }
 
+//---------------------------------------------------------------------------
+vtkAlgorithm* vtkMRMLModelDisplayableManager
+::CreateCachedTransformedClipper(vtkMRMLDisplayNode *displayNode,
+                                 vtkMRMLTransformNode *tnode,
+                                 vtkMRMLModelNode::MeshTypeHint type)
+{
+  // Changes of the input mesh are handled by the pipeline, the clipper only
+  // needs to be recreated when any of these parameters change.
+  std::vector<double> clipParameters;
+  clipParameters.push_back(type);
+  clipParameters.push_back(this->Internal->ClippingMethod);
+  clipParameters.push_back(this->Internal->ClipType);
+  int clipStates[3] =
+    {
+    this->Internal->RedSliceClipState,
+    this->Internal->GreenSliceClipState,
+    this->Internal->YellowSliceClipState
+    };
+  vtkPlane* slicePlanes[3] =
+    {
+    this->Internal->RedSlicePlane,
+    this->Internal->GreenSlicePlane,
+    this->Internal->YellowSlicePlane
+    };
+  for (int i = 0; i < 3; i++)
+    {
+    clipParameters.push_back(clipStates[i]);
+    if (clipStates[i] == vtkMRMLClipModelsNode::ClipOff)
+      {
+      continue;
+      }
+    double* normal = slicePlanes[i]->GetNormal();
+    double* origin = slicePlanes[i]->GetOrigin();
+    clipParameters.insert(clipParameters.end(), normal, normal + 3);
+    clipParameters.insert(clipParameters.end(), origin, origin + 3);
+    }
+  // planes of linearly transformed models are set in the model coordinate system
+  if (tnode != 0 && tnode->IsTransformToWorldLinear())
+    {
+    vtkNew<vtkMatrix4x4> transformToWorld;
+    tnode->GetMatrixTransformToWorld(transformToWorld.GetPointer());
+    for (int row = 0; row < 4; row++)
+      {
+      for (int column = 0; column < 4; column++)
+        {
+        clipParameters.push_back(transformToWorld->GetElement(row, column));
+        }
+      }
+    }
+
+  vtkInternal::CachedPipeline& cachedPipeline = this->Internal->CachedPipelines[displayNode->GetID()];
+  if (!cachedPipeline.Clipper || cachedPipeline.ClipParameters != clipParameters)
+    {
+    vtkAlgorithm* clipper = this->CreateTransformedClipper(tnode, type);
+    cachedPipeline.Clipper = clipper;
+    clipper->Delete();
+    cachedPipeline.ClipParameters = clipParameters;
+    }
+  vtkAlgorithm* clipper = cachedPipeline.Clipper;
+  clipper->Register(this);
+  return clipper;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
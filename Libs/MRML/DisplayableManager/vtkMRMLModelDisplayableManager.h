@@ -148,6 +148,15 @@ public:
   static bool IsCellScalarsActive(vtkMRMLDisplayNode* displayNode,
     vtkMRMLModelNode* model = 0);
 
+  /// Render polydata models using a decimated mesh during camera interaction
+  /// if the full resolution mesh cannot be rendered at the desired frame rate.
+  /// Decimated meshes are generated in a background thread after the mesh
+  /// is rendered and used once ready, see vtkThreadedLODActor.
+  /// Enabled by default.
+  void SetLevelOfDetail(bool enable);
+  bool GetLevelOfDetail();
+  vtkBooleanMacro(LevelOfDetail, bool);
+
 protected:
 
   vtkMRMLModelDisplayableManager();
@@ -198,6 +207,13 @@ protected:
   int UpdateClipSlicesFromMRML();
   vtkAlgorithm *CreateTransformedClipper(vtkMRMLTransformNode *tnode,
                                          vtkMRMLModelNode::MeshTypeHint type);
+  /// Same as CreateTransformedClipper but returns the clipper previously created
+  /// for the display node if the clipping planes have not changed since then,
+  /// so that the clipped mesh is not recomputed.
+  /// The returned clipper must be deleted by the caller.
+  vtkAlgorithm *CreateCachedTransformedClipper(vtkMRMLDisplayNode *displayNode,
+                                               vtkMRMLTransformNode *tnode,
+                                               vtkMRMLModelNode::MeshTypeHint type);
 
   void AddHierarchyObservers();
   void RemoveHierarchyObservers(int clearCache);
@@ -18,6 +18,7 @@
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelSliceDisplayableManager.h"
 #include "vtkMRMLModelDisplayableManager.h"
+#include "vtkPlaneIntersectingCellsFilter.h"
 
 // MRML includes
 #include <vtkMRMLApplicationLogic.h>
@@ -85,6 +86,7 @@ public:
     vtkSmartPointer<vtkDataSetSurfaceFilter> SurfaceExtractor;
     vtkSmartPointer<vtkTransformFilter> ModelWarper;
     vtkSmartPointer<vtkPlane> Plane;
+    vtkSmartPointer<vtkPlaneIntersectingCellsFilter> IntersectingCells; // only cells near the plane are cut
 #if VTK_MAJOR_VERSION >= 9
     vtkSmartPointer<vtkPlaneCutter> Cutter;
     vtkSmartPointer<vtkCompositeDataGeometryFilter> GeometryFilter; // appends multiple cut pieces into a single polydata
@@ -361,20 +363,23 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   pipeline->ModelWarper = vtkSmartPointer<vtkTransformFilter>::New();
   pipeline->SurfaceExtractor = vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
   pipeline->Plane = vtkSmartPointer<vtkPlane>::New();
+  pipeline->IntersectingCells = vtkSmartPointer<vtkPlaneIntersectingCellsFilter>::New();
 
   // Set up pipeline
   pipeline->Transformer->SetTransform(pipeline->TransformToSlice);
+  pipeline->IntersectingCells->SetPlane(pipeline->Plane);
+  pipeline->IntersectingCells->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
 #if VTK_MAJOR_VERSION >= 9
   pipeline->Transformer->SetInputConnection(pipeline->GeometryFilter->GetOutputPort());
   pipeline->Cutter->SetPlane(pipeline->Plane);
   pipeline->Cutter->BuildTreeOff(); // the cutter crashes for complex geometries if build tree is enabled
-  pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+  pipeline->Cutter->SetInputConnection(pipeline->IntersectingCells->GetOutputPort());
   pipeline->GeometryFilter->SetInputConnection(pipeline->Cutter->GetOutputPort());
 #else
   pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
   pipeline->Cutter->SetCutFunction(pipeline->Plane);
   pipeline->Cutter->SetGenerateCutScalars(0);
-  pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+  pipeline->Cutter->SetInputConnection(pipeline->IntersectingCells->GetOutputPort());
 #endif
   // Projection is created from outer surface of volumetric meshes (for polydata surface
   // extraction is just shallow-copy)
@@ -513,7 +518,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
       pipeline->Cutter->SetLocator(locator.GetPointer());
     }
 #endif
-    pipeline->Cutter->SetInputConnection(pipeline->ModelWarper->GetOutputPort());
+    pipeline->Cutter->SetInputConnection(pipeline->IntersectingCells->GetOutputPort());
 
     //  Set Poly Data Transform
     vtkNew<vtkMatrix4x4> rasToSliceXY;
@@ -0,0 +1,397 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkPlaneIntersectingCellsFilter.h"
+
+// VTK includes
+#include <vtkCellData.h>
+#include <vtkIdList.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkPlaneIntersectingCellsFilter);
+vtkCxxSetObjectMacro(vtkPlaneIntersectingCellsFilter, Plane, vtkPlane);
+
+//----------------------------------------------------------------------------
+class vtkPlaneIntersectingCellsFilter::vtkInternal
+{
+public:
+  vtkInternal()
+  {
+    this->Clear();
+  }
+
+  void Clear()
+  {
+    this->IndexedInput = NULL;
+    this->IndexedInputMTime = 0;
+    this->IndexedNormal[0] = this->IndexedNormal[1] = this->IndexedNormal[2] = 0.0;
+    this->CellMinimum.clear();
+    this->CellMaximum.clear();
+    this->NumberOfSlabs = 0;
+    this->SlabMinimum = 0.0;
+    this->SlabWidth = 1.0;
+    this->RangeMinimum = 0.0;
+    this->RangeMaximum = -1.0;
+    this->SlabOffsets.clear();
+    this->SlabCells.clear();
+  }
+
+  bool IsIndexValid(vtkDataSet* input, const double normal[3])
+  {
+    return this->IndexedInput == input
+      && this->IndexedInputMTime == input->GetMTime()
+      && vtkMath::Dot(normal, this->IndexedNormal) > 1.0 - 1e-12;
+  }
+
+  int GetSlabIndex(double distance)
+  {
+    int slabIndex = static_cast<int>((distance - this->SlabMinimum) / this->SlabWidth);
+    return std::max(0, std::min(this->NumberOfSlabs - 1, slabIndex));
+  }
+
+  void BuildIndex(vtkDataSet* input, const double normal[3]);
+  void GetIntersectingCells(double distance, std::vector<vtkIdType>& cellIds, vtkIdType& numberOfTestedCells);
+
+  vtkDataSet* IndexedInput;
+  vtkMTimeType IndexedInputMTime;
+  double IndexedNormal[3];
+
+  /// Range of the signed distance of the points of each cell along the normal
+  std::vector<double> CellMinimum;
+  std::vector<double> CellMaximum;
+  double RangeMinimum;
+  double RangeMaximum;
+
+  /// Cells that overlap each slab, stored consecutively: cells of slab i are
+  /// SlabCells[SlabOffsets[i]] ... SlabCells[SlabOffsets[i+1]-1]
+  int NumberOfSlabs;
+  double SlabMinimum;
+  double SlabWidth;
+  std::vector<vtkIdType> SlabOffsets;
+  std::vector<vtkIdType> SlabCells;
+
+  /// Output point ID of each input point during extraction, -1 if not copied yet
+  std::vector<vtkIdType> PointMap;
+};
+
+//----------------------------------------------------------------------------
+void vtkPlaneIntersectingCellsFilter::vtkInternal::BuildIndex(vtkDataSet* input, const double normal[3])
+{
+  this->Clear();
+  this->IndexedInput = input;
+  this->IndexedInputMTime = input->GetMTime();
+  this->IndexedNormal[0] = normal[0];
+  this->IndexedNormal[1] = normal[1];
+  this->IndexedNormal[2] = normal[2];
+
+  vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  vtkIdType numberOfCells = input->GetNumberOfCells();
+  std::vector<double> pointDistances(numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    pointDistances[pointId] = vtkMath::Dot(input->GetPoint(pointId), normal);
+    }
+
+  this->CellMinimum.resize(numberOfCells);
+  this->CellMaximum.resize(numberOfCells);
+  vtkNew<vtkIdList> cellPointIds;
+  bool firstCell = true;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    input->GetCellPoints(cellId, cellPointIds.GetPointer());
+    vtkIdType numberOfCellPoints = cellPointIds->GetNumberOfIds();
+    if (numberOfCellPoints == 0)
+      {
+      // empty cell, never intersects
+      this->CellMinimum[cellId] = 1.0;
+      this->CellMaximum[cellId] = 0.0;
+      continue;
+      }
+    double minimum = pointDistances[cellPointIds->GetId(0)];
+    double maximum = minimum;
+    for (vtkIdType i = 1; i < numberOfCellPoints; ++i)
+      {
+      double distance = pointDistances[cellPointIds->GetId(i)];
+      minimum = std::min(minimum, distance);
+      maximum = std::max(maximum, distance);
+      }
+    this->CellMinimum[cellId] = minimum;
+    this->CellMaximum[cellId] = maximum;
+    if (firstCell)
+      {
+      this->RangeMinimum = minimum;
+      this->RangeMaximum = maximum;
+      firstCell = false;
+      }
+    else
+      {
+      this->RangeMinimum = std::min(this->RangeMinimum, minimum);
+      this->RangeMaximum = std::max(this->RangeMaximum, maximum);
+      }
+    }
+  if (firstCell)
+    {
+    // no cells with points
+    return;
+    }
+
+  // A few dozen cells per slab keeps both the index small and the number of
+  // tested cells low for meshes with cells of similar size.
+  this->NumberOfSlabs = static_cast<int>(std::max(vtkIdType(1), std::min(vtkIdType(65536), numberOfCells / 32)));
+  this->SlabMinimum = this->RangeMinimum;
+  this->SlabWidth = (this->RangeMaximum - this->RangeMinimum) / this->NumberOfSlabs;
+  if (this->SlabWidth <= 0.0)
+    {
+    // flat mesh, parallel to the plane
+    this->NumberOfSlabs = 1;
+    this->SlabWidth = 1.0;
+    }
+
+  this->SlabOffsets.assign(this->NumberOfSlabs + 1, 0);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    if (this->CellMinimum[cellId] > this->CellMaximum[cellId])
+      {
+      continue;
+      }
+    int lastSlab = this->GetSlabIndex(this->CellMaximum[cellId]);
+    for (int slab = this->GetSlabIndex(this->CellMinimum[cellId]); slab <= lastSlab; ++slab)
+      {
+      this->SlabOffsets[slab + 1]++;
+      }
+    }
+  for (int slab = 0; slab < this->NumberOfSlabs; ++slab)
+    {
+    this->SlabOffsets[slab + 1] += this->SlabOffsets[slab];
+    }
+  this->SlabCells.resize(this->SlabOffsets[this->NumberOfSlabs]);
+  std::vector<vtkIdType> slabFillPosition(this->SlabOffsets.begin(), this->SlabOffsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    if (this->CellMinimum[cellId] > this->CellMaximum[cellId])
+      {
+      continue;
+      }
+    int lastSlab = this->GetSlabIndex(this->CellMaximum[cellId]);
+    for (int slab = this->GetSlabIndex(this->CellMinimum[cellId]); slab <= lastSlab; ++slab)
+      {
+      this->SlabCells[slabFillPosition[slab]++] = cellId;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlaneIntersectingCellsFilter::vtkInternal::GetIntersectingCells(
+  double distance, std::vector<vtkIdType>& cellIds, vtkIdType& numberOfTestedCells)
+{
+  cellIds.clear();
+  numberOfTestedCells = 0;
+  if (this->NumberOfSlabs == 0)
+    {
+    return;
+    }
+  // Cells that touch the plane are kept, as the cutter may generate points for them
+  const double tolerance = 1e-9 * std::max(1.0, this->RangeMaximum - this->RangeMinimum);
+  if (distance < this->RangeMinimum - tolerance || distance > this->RangeMaximum + tolerance)
+    {
+    return;
+    }
+  int firstSlab = this->GetSlabIndex(distance - tolerance);
+  int lastSlab = this->GetSlabIndex(distance + tolerance);
+  for (int slab = firstSlab; slab <= lastSlab; ++slab)
+    {
+    for (vtkIdType i = this->SlabOffsets[slab]; i < this->SlabOffsets[slab + 1]; ++i)
+      {
+      vtkIdType cellId = this->SlabCells[i];
+      // cells that span multiple queried slabs are only visited in the first one
+      if (slab != std::max(firstSlab, this->GetSlabIndex(this->CellMinimum[cellId])))
+        {
+        continue;
+        }
+      ++numberOfTestedCells;
+      if (this->CellMinimum[cellId] <= distance + tolerance && this->CellMaximum[cellId] >= distance - tolerance)
+        {
+        cellIds.push_back(cellId);
+        }
+      }
+    }
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+template <class TDataSet>
+void ExtractCells(TDataSet* input, TDataSet* output,
+  const std::vector<vtkIdType>& cellIds, std::vector<vtkIdType>& pointMap)
+{
+  vtkPoints* inputPoints = input->GetPoints();
+  vtkPointData* inputPointData = input->GetPointData();
+  vtkCellData* inputCellData = input->GetCellData();
+
+  vtkNew<vtkPoints> outputPoints;
+  outputPoints->SetDataType(inputPoints->GetDataType());
+  vtkPointData* outputPointData = output->GetPointData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputPointData->CopyAllocate(inputPointData, static_cast<vtkIdType>(cellIds.size()));
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+  output->Allocate(static_cast<vtkIdType>(cellIds.size()));
+
+  pointMap.resize(input->GetNumberOfPoints(), -1);
+  std::vector<vtkIdType> copiedPointIds;
+  vtkNew<vtkIdList> inputCellPointIds;
+  vtkNew<vtkIdList> outputCellPointIds;
+  for (std::vector<vtkIdType>::const_iterator cellIdIt = cellIds.begin(); cellIdIt != cellIds.end(); ++cellIdIt)
+    {
+    input->GetCellPoints(*cellIdIt, inputCellPointIds.GetPointer());
+    vtkIdType numberOfCellPoints = inputCellPointIds->GetNumberOfIds();
+    outputCellPointIds->SetNumberOfIds(numberOfCellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      vtkIdType inputPointId = inputCellPointIds->GetId(i);
+      if (pointMap[inputPointId] < 0)
+        {
+        vtkIdType outputPointId = outputPoints->InsertNextPoint(inputPoints->GetPoint(inputPointId));
+        outputPointData->CopyData(inputPointData, inputPointId, outputPointId);
+        pointMap[inputPointId] = outputPointId;
+        copiedPointIds.push_back(inputPointId);
+        }
+      outputCellPointIds->SetId(i, pointMap[inputPointId]);
+      }
+    vtkIdType outputCellId = output->InsertNextCell(input->GetCellType(*cellIdIt), outputCellPointIds.GetPointer());
+    outputCellData->CopyData(inputCellData, *cellIdIt, outputCellId);
+    }
+  output->SetPoints(outputPoints.GetPointer());
+  output->GetFieldData()->PassData(input->GetFieldData());
+  output->Squeeze();
+
+  // Reset only the entries that were used, so that the next extraction does not
+  // need to visit all the input points
+  for (std::vector<vtkIdType>::iterator pointIdIt = copiedPointIds.begin(); pointIdIt != copiedPointIds.end(); ++pointIdIt)
+    {
+    pointMap[*pointIdIt] = -1;
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkPlaneIntersectingCellsFilter::vtkPlaneIntersectingCellsFilter()
+{
+  this->Plane = NULL;
+  this->NumberOfTestedCells = 0;
+  this->NumberOfExtractedCells = 0;
+  this->NumberOfIndexBuilds = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkPlaneIntersectingCellsFilter::~vtkPlaneIntersectingCellsFilter()
+{
+  this->SetPlane(NULL);
+  delete this->Internal;
+  this->Internal = NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlaneIntersectingCellsFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfTestedCells: " << this->NumberOfTestedCells << "\n";
+  os << indent << "NumberOfExtractedCells: " << this->NumberOfExtractedCells << "\n";
+  os << indent << "NumberOfIndexBuilds: " << this->NumberOfIndexBuilds << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkPlaneIntersectingCellsFilter::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->Plane)
+    {
+    mTime = std::max(mTime, this->Plane->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlaneIntersectingCellsFilter::RequestData(vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+  vtkDataSet* input = vtkDataSet::GetData(inputVector[0]);
+  vtkDataSet* output = vtkDataSet::GetData(outputVector);
+  if (!input || !output)
+    {
+    return 0;
+    }
+  this->NumberOfTestedCells = 0;
+  this->NumberOfExtractedCells = 0;
+
+  vtkPolyData* inputPolyData = vtkPolyData::SafeDownCast(input);
+  vtkUnstructuredGrid* inputGrid = vtkUnstructuredGrid::SafeDownCast(input);
+  // Polyhedron faces are not copied, so grids with polyhedra are passed through
+  bool supportedInput = (inputPolyData != NULL || (inputGrid != NULL && inputGrid->GetFaces() == NULL));
+  double normal[3] = { 0.0, 0.0, 0.0 };
+  if (this->Plane)
+    {
+    this->Plane->GetNormal(normal);
+    }
+  if (!supportedInput || vtkMath::Normalize(normal) == 0.0 || !vtkPointSet::SafeDownCast(input)->GetPoints())
+    {
+    output->ShallowCopy(input);
+    this->Internal->Clear();
+    return 1;
+    }
+
+  if (!this->Internal->IsIndexValid(input, normal))
+    {
+    this->Internal->BuildIndex(input, normal);
+    this->NumberOfIndexBuilds++;
+    }
+
+  output->Initialize();
+  std::vector<vtkIdType> cellIds;
+  double distance = vtkMath::Dot(this->Plane->GetOrigin(), normal);
+  this->Internal->GetIntersectingCells(distance, cellIds, this->NumberOfTestedCells);
+  this->NumberOfExtractedCells = static_cast<vtkIdType>(cellIds.size());
+
+  if (inputPolyData)
+    {
+    ExtractCells(inputPolyData, vtkPolyData::SafeDownCast(output), cellIds, this->Internal->PointMap);
+    }
+  else
+    {
+    ExtractCells(inputGrid, vtkUnstructuredGrid::SafeDownCast(output), cellIds, this->Internal->PointMap);
+    }
+
+  return 1;
+}
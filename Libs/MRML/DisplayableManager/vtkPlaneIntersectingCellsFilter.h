@@ -0,0 +1,90 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPlaneIntersectingCellsFilter_h
+#define __vtkPlaneIntersectingCellsFilter_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerExport.h"
+
+// VTK includes
+#include <vtkPassInputTypeAlgorithm.h>
+
+class vtkPlane;
+
+/// \brief Extract cells of a mesh that intersect a plane.
+///
+/// Cutting a large mesh with a slice plane visits every cell of the mesh,
+/// although only a small fraction of the cells intersects the plane. This filter
+/// keeps an index of the cells sorted into slabs along the plane normal, so
+/// that only cells of the slab containing the plane are tested and copied to
+/// the output. The output can be cut by vtkCutter (or vtkPlaneCutter) with
+/// the same plane, giving the same intersection as cutting the whole mesh.
+///
+/// The index is built when the input or the direction of the plane normal
+/// changes, therefore moving the plane along its normal (scrolling through
+/// slices) only costs time proportional to the number of intersecting cells.
+///
+/// Cells of vtkPolyData and vtkUnstructuredGrid inputs are extracted, other
+/// inputs are passed through without changes.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkPlaneIntersectingCellsFilter : public vtkPassInputTypeAlgorithm
+{
+public:
+  static vtkPlaneIntersectingCellsFilter *New();
+  vtkTypeMacro(vtkPlaneIntersectingCellsFilter, vtkPassInputTypeAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  ///
+  /// Plane that the extracted cells intersect
+  virtual void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  ///
+  /// Number of cells tested and number of cells extracted in the last execution
+  vtkGetMacro(NumberOfTestedCells, vtkIdType);
+  vtkGetMacro(NumberOfExtractedCells, vtkIdType);
+
+  ///
+  /// Number of times the cell index has been built
+  vtkGetMacro(NumberOfIndexBuilds, int);
+
+  /// Return this object's modified time, including the plane
+  virtual vtkMTimeType GetMTime() VTK_OVERRIDE;
+
+protected:
+  vtkPlaneIntersectingCellsFilter();
+  ~vtkPlaneIntersectingCellsFilter();
+
+  virtual int RequestData(vtkInformation *request,
+                          vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector) VTK_OVERRIDE;
+
+  vtkPlane* Plane;
+
+  vtkIdType NumberOfTestedCells;
+  vtkIdType NumberOfExtractedCells;
+  int NumberOfIndexBuilds;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkPlaneIntersectingCellsFilter(const vtkPlaneIntersectingCellsFilter&);  // Not implemented.
+  void operator=(const vtkPlaneIntersectingCellsFilter&);  // Not implemented.
+};
+
+#endif
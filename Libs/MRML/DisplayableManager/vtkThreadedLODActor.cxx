@@ -0,0 +1,354 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkThreadedLODActor.h"
+
+// VTK includes
+#include <vtkCriticalSection.h>
+#include <vtkMapperCollection.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkQuadricClustering.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkThreadedLODActor);
+
+namespace
+{
+/// Background threads of all actors, only modified with the lock
+vtkSimpleCriticalSection NumberOfBuildThreadsLock;
+int NumberOfBuildThreads = 0;
+int MaximumNumberOfBuildThreads = 0;
+
+//----------------------------------------------------------------------------
+vtkPolyDataAlgorithm* CreateQuadricClustering(int numberOfDivisions)
+{
+  vtkQuadricClustering* filter = vtkQuadricClustering::New();
+  filter->SetNumberOfDivisions(numberOfDivisions, numberOfDivisions, numberOfDivisions);
+  // keep scalars
+  filter->UseInputPointsOn();
+  filter->CopyCellDataOn();
+  return filter;
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkThreadedLODActor::vtkInternal
+{
+public:
+  vtkInternal()
+  {
+    this->BuildThreadID = -1;
+    this->BuildFinished = false;
+    this->BuildSourceMTime = 0;
+    this->LODSourceMTime = 0;
+    this->BuildFilters[0] = 0;
+    this->BuildFilters[1] = 0;
+  }
+
+  static bool IsCurrent(vtkPolyData* source, vtkMTimeType sourceMTime, vtkPolyData* mesh)
+  {
+    return mesh != 0 && source == mesh && sourceMTime == mesh->GetMTime();
+  }
+
+  static VTK_THREAD_RETURN_TYPE BuildThreadFunction(void* arg);
+
+  vtkNew<vtkMultiThreader> Threader;
+  int BuildThreadID;
+  /// Set by the background thread when the decimated meshes are generated
+  bool BuildFinished;
+  vtkSimpleCriticalSection BuildFinishedLock;
+  /// Copy of the mesh the background thread generates decimated meshes of
+  vtkSmartPointer<vtkPolyData> BuildInput;
+  vtkWeakPointer<vtkPolyData> BuildSource;
+  vtkMTimeType BuildSourceMTime;
+  /// Medium and low resolution filters run by the background thread
+  vtkSmartPointer<vtkPolyDataAlgorithm> BuildFilters[2];
+
+  /// Levels of detail in use and the mesh they are generated from
+  vtkSmartPointer<vtkPolyDataMapper> LODMappers[2];
+  vtkSmartPointer<vtkPolyData> LODMeshes[2];
+  vtkWeakPointer<vtkPolyData> LODSource;
+  vtkMTimeType LODSourceMTime;
+  vtkTimeStamp LODMappersUpdateTime;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkThreadedLODActor::vtkInternal::BuildThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkInternal* self = static_cast<vtkInternal*>(threadInfo->UserData);
+  // The filters and their input are not used by the render thread until
+  // the thread is joined.
+  self->BuildFilters[0]->Update();
+  self->BuildFilters[1]->Update();
+
+  self->BuildFinishedLock.Lock();
+  self->BuildFinished = true;
+  self->BuildFinishedLock.Unlock();
+
+  NumberOfBuildThreadsLock.Lock();
+  NumberOfBuildThreads--;
+  NumberOfBuildThreadsLock.Unlock();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkThreadedLODActor::vtkThreadedLODActor()
+{
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkThreadedLODActor::~vtkThreadedLODActor()
+{
+  if (this->Internal->BuildThreadID >= 0)
+    {
+    this->Internal->Threader->TerminateThread(this->Internal->BuildThreadID);
+    }
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "LevelsOfDetailReady: " << this->GetLevelsOfDetailReady() << "\n";
+  os << indent << "BuildThreadRunning: " << (this->Internal->BuildThreadID >= 0) << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::SetMaximumNumberOfBuildThreads(int numberOfThreads)
+{
+  NumberOfBuildThreadsLock.Lock();
+  MaximumNumberOfBuildThreads = numberOfThreads;
+  NumberOfBuildThreadsLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkThreadedLODActor::GetMaximumNumberOfBuildThreads()
+{
+  NumberOfBuildThreadsLock.Lock();
+  int numberOfThreads = MaximumNumberOfBuildThreads;
+  NumberOfBuildThreadsLock.Unlock();
+  return numberOfThreads > 0 ? numberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::CreateOwnLODs()
+{
+  // Decimated meshes are generated in a background thread, see Render()
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::UpdateOwnLODs()
+{
+  // Decimated meshes are generated in a background thread, see Render()
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData* vtkThreadedLODActor::GetRenderedMesh()
+{
+  vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(this->Mapper);
+  return mapper ? mapper->GetInput() : 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkThreadedLODActor::GetLevelsOfDetailReady()
+{
+  return this->Internal->LODMappers[0] != 0
+    && vtkInternal::IsCurrent(this->Internal->LODSource, this->Internal->LODSourceMTime, this->GetRenderedMesh());
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::Render(vtkRenderer* renderer, vtkMapper* mapper)
+{
+  vtkPolyDataMapper* polyDataMapper = vtkPolyDataMapper::SafeDownCast(this->Mapper);
+  if (polyDataMapper && polyDataMapper->GetNumberOfInputConnections(0) > 0)
+    {
+    // The levels of detail are chosen for the mesh about to be rendered
+    polyDataMapper->Update();
+    }
+  vtkPolyData* mesh = this->GetRenderedMesh();
+
+  this->FinishLevelsOfDetailBuild(false);
+  if (this->Internal->LODMappers[0] && !this->GetLevelsOfDetailReady())
+    {
+    this->RemoveLevelsOfDetail();
+    }
+  if (this->Internal->LODMappers[0] && this->Mapper->GetMTime() > this->Internal->LODMappersUpdateTime)
+    {
+    this->UpdateLevelsOfDetailMappers();
+    }
+
+  this->Superclass::Render(renderer, mapper);
+
+  if (mesh && mesh->GetNumberOfCells() > 0
+    && !this->Internal->LODMappers[0] && this->Internal->BuildThreadID < 0)
+    {
+    this->StartLevelsOfDetailBuild(mesh);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::WaitForLevelsOfDetail()
+{
+  this->FinishLevelsOfDetailBuild(true);
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::StartLevelsOfDetailBuild(vtkPolyData* mesh)
+{
+  int maximumNumberOfBuildThreads = vtkThreadedLODActor::GetMaximumNumberOfBuildThreads();
+  NumberOfBuildThreadsLock.Lock();
+  if (NumberOfBuildThreads >= maximumNumberOfBuildThreads)
+    {
+    // try again at the next render
+    NumberOfBuildThreadsLock.Unlock();
+    return;
+    }
+  NumberOfBuildThreads++;
+  NumberOfBuildThreadsLock.Unlock();
+
+  if (!this->MediumResFilter)
+    {
+    vtkPolyDataAlgorithm* filter = CreateQuadricClustering(128);
+    this->SetMediumResFilter(filter);
+    filter->Delete();
+    }
+  if (!this->LowResFilter)
+    {
+    vtkPolyDataAlgorithm* filter = CreateQuadricClustering(32);
+    this->SetLowResFilter(filter);
+    filter->Delete();
+    }
+
+  // The mesh may be modified by the render thread while the decimated
+  // meshes are generated
+  this->Internal->BuildInput = vtkSmartPointer<vtkPolyData>::New();
+  this->Internal->BuildInput->DeepCopy(mesh);
+  this->Internal->BuildSource = mesh;
+  this->Internal->BuildSourceMTime = mesh->GetMTime();
+  this->Internal->BuildFilters[0] = this->MediumResFilter;
+  this->Internal->BuildFilters[1] = this->LowResFilter;
+  for (int i = 0; i < 2; i++)
+    {
+    this->Internal->BuildFilters[i]->SetInputData(this->Internal->BuildInput);
+    }
+  this->Internal->BuildFinished = false;
+  this->Internal->BuildThreadID = this->Internal->Threader->SpawnThread(
+    vtkInternal::BuildThreadFunction, this->Internal);
+  if (this->Internal->BuildThreadID < 0)
+    {
+    vtkWarningMacro("StartLevelsOfDetailBuild: failed to start thread, levels of detail are not used");
+    NumberOfBuildThreadsLock.Lock();
+    NumberOfBuildThreads--;
+    NumberOfBuildThreadsLock.Unlock();
+    this->ReleaseBuildData();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::FinishLevelsOfDetailBuild(bool wait)
+{
+  if (this->Internal->BuildThreadID < 0)
+    {
+    return;
+    }
+  if (!wait)
+    {
+    this->Internal->BuildFinishedLock.Lock();
+    bool finished = this->Internal->BuildFinished;
+    this->Internal->BuildFinishedLock.Unlock();
+    if (!finished)
+      {
+      return;
+      }
+    }
+  this->Internal->Threader->TerminateThread(this->Internal->BuildThreadID);
+  this->Internal->BuildThreadID = -1;
+
+  // Decimated meshes of a mesh that changed since are discarded
+  if (vtkInternal::IsCurrent(this->Internal->BuildSource, this->Internal->BuildSourceMTime, this->GetRenderedMesh()))
+    {
+    this->RemoveLevelsOfDetail();
+    for (int i = 0; i < 2; i++)
+      {
+      this->Internal->LODMeshes[i] = vtkSmartPointer<vtkPolyData>::New();
+      this->Internal->LODMeshes[i]->DeepCopy(this->Internal->BuildFilters[i]->GetOutput());
+      this->Internal->LODMappers[i] = vtkSmartPointer<vtkPolyDataMapper>::New();
+      }
+    this->Internal->LODSource = this->Internal->BuildSource;
+    this->Internal->LODSourceMTime = this->Internal->BuildSourceMTime;
+    this->UpdateLevelsOfDetailMappers();
+    for (int i = 0; i < 2; i++)
+      {
+      this->AddLODMapper(this->Internal->LODMappers[i]);
+      }
+    }
+  this->ReleaseBuildData();
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::ReleaseBuildData()
+{
+  for (int i = 0; i < 2; i++)
+    {
+    if (this->Internal->BuildFilters[i])
+      {
+      this->Internal->BuildFilters[i]->SetInputData(0);
+      this->Internal->BuildFilters[i]->GetOutput()->ReleaseData();
+      this->Internal->BuildFilters[i] = 0;
+      }
+    }
+  this->Internal->BuildInput = 0;
+  this->Internal->BuildSource = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::UpdateLevelsOfDetailMappers()
+{
+  for (int i = 0; i < 2; i++)
+    {
+    // rendering properties of the mapper, mesh of the level of detail
+    this->Internal->LODMappers[i]->ShallowCopy(this->Mapper);
+    this->Internal->LODMappers[i]->SetInputData(this->Internal->LODMeshes[i]);
+    }
+  this->Internal->LODMappersUpdateTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkThreadedLODActor::RemoveLevelsOfDetail()
+{
+  for (int i = 0; i < 2; i++)
+    {
+    if (this->Internal->LODMappers[i])
+      {
+      this->LODMappers->RemoveItem(this->Internal->LODMappers[i]);
+      }
+    this->Internal->LODMappers[i] = 0;
+    this->Internal->LODMeshes[i] = 0;
+    }
+  this->Internal->LODSource = 0;
+}
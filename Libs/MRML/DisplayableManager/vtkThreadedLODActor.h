@@ -0,0 +1,102 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c)
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkThreadedLODActor_h
+#define __vtkThreadedLODActor_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerExport.h"
+
+// VTK includes
+#include <vtkLODActor.h>
+
+class vtkPolyData;
+
+/// \brief Level of detail actor generating its decimated meshes in a background thread.
+///
+/// vtkLODActor generates its low resolution meshes when they are first
+/// rendered, which makes the first interactive frame after loading or
+/// modifying a large mesh slower than rendering the full resolution mesh.
+/// This actor instead copies the mesh rendered by its mapper after it is
+/// rendered and runs the medium and low resolution filters on the copy in a
+/// background thread. The decimated meshes are added as level of detail
+/// mappers at the first render after they are ready, until then the full
+/// resolution mesh is rendered. Decimated meshes of a mesh that has changed
+/// since are discarded.
+///
+/// The medium and low resolution filters are only used by the background
+/// thread; vtkQuadricClustering filters are created if none are set.
+/// The mapper must be a vtkPolyDataMapper.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkThreadedLODActor : public vtkLODActor
+{
+public:
+  static vtkThreadedLODActor *New();
+  vtkTypeMacro(vtkThreadedLODActor, vtkLODActor);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  ///
+  /// Switch in the decimated meshes if they are ready, render, then start
+  /// generating the decimated meshes of the current mesh if needed.
+  virtual void Render(vtkRenderer* renderer, vtkMapper* mapper) VTK_OVERRIDE;
+
+  ///
+  /// Return true if the decimated meshes of the rendered mesh are used as
+  /// levels of detail.
+  bool GetLevelsOfDetailReady();
+
+  ///
+  /// Wait for the background thread to finish and switch in the decimated
+  /// meshes if they are of the current mesh.
+  void WaitForLevelsOfDetail();
+
+  ///
+  /// Maximum number of background threads generating decimated meshes, for
+  /// all actors. Actors start generating their decimated meshes at a later
+  /// render if all threads are busy. Defaults to the number of processors.
+  static void SetMaximumNumberOfBuildThreads(int numberOfThreads);
+  static int GetMaximumNumberOfBuildThreads();
+
+protected:
+  vtkThreadedLODActor();
+  ~vtkThreadedLODActor();
+
+  /// Reimplemented to not generate decimated meshes in the render thread
+  virtual void CreateOwnLODs() VTK_OVERRIDE;
+  virtual void UpdateOwnLODs() VTK_OVERRIDE;
+
+  /// Return the mesh rendered by the mapper
+  vtkPolyData* GetRenderedMesh();
+
+  /// Copy the mesh and generate its decimated meshes in a background thread
+  void StartLevelsOfDetailBuild(vtkPolyData* mesh);
+  /// Join the background thread if it has finished (or wait for it) and
+  /// switch in the decimated meshes if they are of the rendered mesh
+  void FinishLevelsOfDetailBuild(bool wait);
+  void ReleaseBuildData();
+  /// Copy the rendering properties of the mapper to the level of detail mappers
+  void UpdateLevelsOfDetailMappers();
+  void RemoveLevelsOfDetail();
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkThreadedLODActor(const vtkThreadedLODActor&);  /// Not implemented.
+  void operator=(const vtkThreadedLODActor&);  /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,360 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLIDImageIO includes
+#include "itkMRMLSharedMemoryImageIO.h"
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIterator.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+typedef itk::Image<short, 3> ImageType;
+
+//----------------------------------------------------------------------------
+ImageType::Pointer CreateImage()
+{
+  ImageType::SizeType size;
+  size[0] = 10;
+  size[1] = 8;
+  size[2] = 6;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = -12.0;
+  origin[1] = 30.5;
+  origin[2] = 7.25;
+  image->SetOrigin(origin);
+  // rotation around the third axis
+  ImageType::DirectionType direction;
+  direction.SetIdentity();
+  direction[0][0] = 0.6;
+  direction[0][1] = -0.8;
+  direction[1][0] = 0.8;
+  direction[1][1] = 0.6;
+  image->SetDirection(direction);
+
+  short value = -500;
+  for (itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+    {
+    it.Set(value);
+    value += 7;
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+bool CompareImages(ImageType* expected, ImageType* actual, int line)
+{
+  if (expected->GetLargestPossibleRegion() != actual->GetLargestPossibleRegion())
+    {
+    std::cerr << line << ": Image size mismatch" << std::endl;
+    return false;
+    }
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    if (std::fabs(expected->GetSpacing()[i] - actual->GetSpacing()[i]) > 1e-9
+      || std::fabs(expected->GetOrigin()[i] - actual->GetOrigin()[i]) > 1e-9)
+      {
+      std::cerr << line << ": Image spacing or origin mismatch" << std::endl;
+      return false;
+      }
+    for (unsigned int j = 0; j < 3; ++j)
+      {
+      if (std::fabs(expected->GetDirection()[i][j] - actual->GetDirection()[i][j]) > 1e-9)
+        {
+        std::cerr << line << ": Image direction mismatch" << std::endl;
+        return false;
+        }
+      }
+    }
+  itk::ImageRegionConstIterator<ImageType> expectedIt(expected, expected->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> actualIt(actual, actual->GetLargestPossibleRegion());
+  for (; !expectedIt.IsAtEnd(); ++expectedIt, ++actualIt)
+    {
+    if (expectedIt.Get() != actualIt.Get())
+      {
+      std::cerr << line << ": Pixel mismatch at " << expectedIt.GetIndex() << ": " << actualIt.Get()
+        << " (expected " << expectedIt.Get() << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+#if !defined(_WIN32)
+//----------------------------------------------------------------------------
+/// Open the segment of the file name directly, bypassing the ImageIO
+int OpenSegment(const std::string& fileName)
+{
+  std::string segmentName = "/" + fileName.substr(fileName.find(':') + 1);
+  return shm_open(segmentName.c_str(), O_RDWR, 0);
+}
+#endif
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int itkMRMLSharedMemoryImageIOTest1(int , char * [] )
+{
+  typedef itk::MRMLSharedMemoryImageIO IOType;
+
+  //////////////////////////////////////////////////////////////////////////
+  // File names
+
+  const char* invalidFileNames[] = { "slicershm:", "slicershm:abc/def", "slicershm:/abc",
+    "slicershmabc", "abc:def", "/tmp/image.nrrd", "" };
+  for (unsigned int i = 0; i < sizeof(invalidFileNames) / sizeof(invalidFileNames[0]); ++i)
+    {
+    IOType::Pointer io = IOType::New();
+    if (IOType::IsSharedMemoryFileName(invalidFileNames[i])
+      || io->CanWriteFile(invalidFileNames[i]) || io->CanReadFile(invalidFileNames[i])
+      || IOType::RemoveSegment(invalidFileNames[i]))
+      {
+      std::cerr << __LINE__ << ": Invalid file name is accepted: " << invalidFileNames[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (IOType::IsSharedMemoryFileName(ITK_NULLPTR))
+    {
+    std::cerr << __LINE__ << ": NULL file name is accepted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!IOType::IsSupported())
+    {
+    IOType::Pointer io = IOType::New();
+    if (io->CanWriteFile("slicershm:abc"))
+      {
+      std::cerr << __LINE__ << ": Shared memory is reported as not supported but can be written" << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << "Shared memory segments are not supported on this platform" << std::endl;
+    return EXIT_SUCCESS;
+    }
+
+#if !defined(_WIN32)
+  std::stringstream fileNameStream;
+  fileNameStream << IOType::GetScheme() << ":itkMRMLSharedMemoryImageIOTest1_" << getpid();
+  const std::string fileName = fileNameStream.str();
+  if (!IOType::IsSharedMemoryFileName(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Valid file name is rejected: " << fileName << std::endl;
+    return EXIT_FAILURE;
+    }
+  IOType::RemoveSegment(fileName.c_str());
+  IOType::Pointer missingSegmentIO = IOType::New();
+  if (missingSegmentIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Missing segment can be read" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Write and read
+
+  ImageType::Pointer image = CreateImage();
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetImageIO(IOType::New());
+  writer->SetFileName(fileName);
+  writer->SetInput(image);
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    std::cerr << __LINE__ << ": Failed to write image: " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  IOType::Pointer readerIO = IOType::New();
+  if (!readerIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Written segment cannot be read" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetImageIO(readerIO);
+  reader->SetFileName(fileName);
+  try
+    {
+    reader->Update();
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    std::cerr << __LINE__ << ": Failed to read image: " << e << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  if (!CompareImages(image, reader->GetOutput(), __LINE__))
+    {
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+
+  // Header describes the image, pixels can be accessed without copying
+  IOType::Pointer headerIO = IOType::New();
+  headerIO->SetFileName(fileName);
+  headerIO->ReadImageInformation();
+  if (headerIO->GetNumberOfDimensions() != 3
+    || headerIO->GetComponentType() != itk::ImageIOBase::SHORT
+    || headerIO->GetPixelType() != itk::ImageIOBase::SCALAR
+    || headerIO->GetNumberOfComponents() != 1
+    || headerIO->GetDimensions(0) != 10 || headerIO->GetDimensions(1) != 8 || headerIO->GetDimensions(2) != 6
+    || headerIO->GetImageSizeInBytes() != image->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(short))
+    {
+    std::cerr << __LINE__ << ": Unexpected image information in segment header" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  if (headerIO->GetSegmentBuffer() == ITK_NULLPTR
+    || memcmp(headerIO->GetSegmentBuffer(), image->GetBufferPointer(), headerIO->GetImageSizeInBytes()) != 0)
+    {
+    std::cerr << __LINE__ << ": Unexpected segment buffer" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  headerIO = ITK_NULLPTR;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Invalid segments are rejected
+
+  // Incomplete segment (writer is still filling the buffer)
+  IOType::Pointer incompleteIO = IOType::New();
+  incompleteIO->SetFileName(fileName);
+  incompleteIO->SetNumberOfDimensions(3);
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    incompleteIO->SetDimensions(i, image->GetLargestPossibleRegion().GetSize()[i]);
+    }
+  incompleteIO->SetPixelType(itk::ImageIOBase::SCALAR);
+  incompleteIO->SetComponentType(itk::ImageIOBase::SHORT);
+  if (incompleteIO->CreateSegment() == ITK_NULLPTR)
+    {
+    std::cerr << __LINE__ << ": Failed to create segment" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  IOType::Pointer validatingIO = IOType::New();
+  if (validatingIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Incomplete segment can be read" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  bool exceptionThrown = false;
+  validatingIO->SetFileName(fileName);
+  try
+    {
+    validatingIO->ReadImageInformation();
+    }
+  catch (itk::ExceptionObject&)
+    {
+    exceptionThrown = true;
+    }
+  if (!exceptionThrown || validatingIO->GetSegmentBuffer() != ITK_NULLPTR)
+    {
+    std::cerr << __LINE__ << ": Reading an incomplete segment did not fail" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  incompleteIO->CompleteSegment();
+  if (!validatingIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Completed segment cannot be read" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  incompleteIO = ITK_NULLPTR;
+
+  // Segment that is smaller than the image described in the header
+  int fd = OpenSegment(fileName);
+  struct stat status;
+  if (fd < 0 || fstat(fd, &status) != 0 || ftruncate(fd, status.st_size / 2) != 0)
+    {
+    std::cerr << __LINE__ << ": Failed to truncate segment" << std::endl;
+    if (fd >= 0)
+      {
+      close(fd);
+      }
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  if (validatingIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Truncated segment can be read" << std::endl;
+    close(fd);
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+
+  // Segment that was not written by the ImageIO
+  if (ftruncate(fd, status.st_size) != 0 || pwrite(fd, "NOTSLICER", 8, 0) != 8)
+    {
+    std::cerr << __LINE__ << ": Failed to overwrite segment" << std::endl;
+    close(fd);
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+  close(fd);
+  if (validatingIO->CanReadFile(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Segment with invalid header can be read" << std::endl;
+    IOType::RemoveSegment(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Removed segment cannot be read
+
+  if (!IOType::RemoveSegment(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Failed to remove segment" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (validatingIO->CanReadFile(fileName.c_str()) || IOType::RemoveSegment(fileName.c_str()))
+    {
+    std::cerr << __LINE__ << ": Removed segment still exists" << std::endl;
+    return EXIT_FAILURE;
+    }
+#endif
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+/// itkMRMLSharedMemoryIOExport
+///
+/// The itkMRMLSharedMemoryIOExport captures some system differences between Unix
+/// and Windows operating systems.
+
+#ifndef itkMRMLSharedMemoryIOExport_h
+#define itkMRMLSharedMemoryIOExport_h
+
+#include <itkMRMLIDImageIOConfigure.h>
+
+#if defined(WIN32) && !defined(MRMLIDIO_STATIC)
+#if defined(MRMLSharedMemoryIO_EXPORTS)
+#define MRMLSharedMemoryIO_EXPORT __declspec( dllexport )
+#else
+#define MRMLSharedMemoryIO_EXPORT __declspec( dllimport )
+#endif
+#else
+#define MRMLSharedMemoryIO_EXPORT
+#endif
+
+#endif
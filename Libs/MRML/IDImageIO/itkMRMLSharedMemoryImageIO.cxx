@@ -0,0 +1,382 @@
+/*=auto=========================================================================
+
+Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "itkMRMLSharedMemoryImageIO.h"
+#include "itkIntTypes.h"
+
+// STD includes
+#include <cstring>
+
+#if !defined(_WIN32)
+#define MRML_SHARED_MEMORY_SUPPORTED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+const char SegmentMagic[8] = { 'S', 'L', 'I', 'C', 'E', 'R', 'S', 'M' };
+
+/// Pixel buffer starts at this offset from the beginning of the segment
+const itk::ImageIOBase::SizeValueType SegmentHeaderSize = 256;
+
+//----------------------------------------------------------------------------
+/// Image description stored at the beginning of the segment. Geometry is
+/// stored in LPS coordinate system, as for other ITK ImageIOs.
+struct SegmentHeader
+{
+  char Magic[8];
+  itk::uint32_t Complete;
+  itk::uint32_t NumberOfDimensions;
+  itk::uint32_t PixelType;
+  itk::uint32_t ComponentType;
+  itk::uint32_t NumberOfComponents;
+  itk::uint32_t Reserved;
+  itk::uint64_t Dimensions[3];
+  double Spacing[3];
+  double Origin[3];
+  double Direction[9]; // column i is the direction of axis i
+  itk::uint64_t BufferSize;
+};
+
+//----------------------------------------------------------------------------
+std::string FileNameToSegmentName(const std::string& filename)
+{
+  const std::string prefix = std::string(itk::MRMLSharedMemoryImageIO::GetScheme()) + ":";
+  if (filename.compare(0, prefix.size(), prefix) != 0
+    || filename.size() == prefix.size()
+    || filename.find('/', prefix.size()) != std::string::npos)
+    {
+    return std::string();
+    }
+  return "/" + filename.substr(prefix.size());
+}
+
+//----------------------------------------------------------------------------
+bool IsValidHeader(const SegmentHeader* header, itk::ImageIOBase::SizeValueType segmentSize)
+{
+  return segmentSize >= SegmentHeaderSize
+    && memcmp(header->Magic, SegmentMagic, sizeof(SegmentMagic)) == 0
+    && header->Complete == 1
+    && header->NumberOfDimensions >= 1 && header->NumberOfDimensions <= 3
+    && header->NumberOfComponents >= 1
+    && header->BufferSize <= segmentSize - SegmentHeaderSize;
+}
+
+} // end of anonymous namespace
+
+namespace itk {
+//----------------------------------------------------------------------------
+MRMLSharedMemoryImageIO
+::MRMLSharedMemoryImageIO()
+{
+  this->m_Segment = ITK_NULLPTR;
+  this->m_SegmentSize = 0;
+}
+
+//----------------------------------------------------------------------------
+MRMLSharedMemoryImageIO
+::~MRMLSharedMemoryImageIO()
+{
+  this->UnmapSegment();
+}
+
+//----------------------------------------------------------------------------
+const char*
+MRMLSharedMemoryImageIO
+::GetScheme()
+{
+  return "slicershm";
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::IsSupported()
+{
+#ifdef MRML_SHARED_MEMORY_SUPPORTED
+  return true;
+#else
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::IsSharedMemoryFileName(const char* filename)
+{
+  return filename && !FileNameToSegmentName(filename).empty();
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::RemoveSegment(const char* filename)
+{
+#ifdef MRML_SHARED_MEMORY_SUPPORTED
+  if (!IsSharedMemoryFileName(filename))
+    {
+    return false;
+    }
+  return shm_unlink(FileNameToSegmentName(filename).c_str()) == 0;
+#else
+  (void)filename;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::MapSegment(SizeValueType size)
+{
+  this->UnmapSegment();
+#ifdef MRML_SHARED_MEMORY_SUPPORTED
+  std::string segmentName = FileNameToSegmentName(m_FileName);
+  if (segmentName.empty())
+    {
+    return false;
+    }
+  bool create = (size > 0);
+  int fd = create ? shm_open(segmentName.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR)
+                  : shm_open(segmentName.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    {
+    return false;
+    }
+  if (create)
+    {
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+      {
+      close(fd);
+      return false;
+      }
+    }
+  else
+    {
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<SizeValueType>(status.st_size) < SegmentHeaderSize)
+      {
+      close(fd);
+      return false;
+      }
+    size = static_cast<SizeValueType>(status.st_size);
+    }
+  void* segment = mmap(ITK_NULLPTR, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                       MAP_SHARED, fd, 0);
+  // the mapping remains valid after the descriptor is closed
+  close(fd);
+  if (segment == MAP_FAILED)
+    {
+    return false;
+    }
+  this->m_Segment = segment;
+  this->m_SegmentSize = size;
+  return true;
+#else
+  (void)size;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::UnmapSegment()
+{
+#ifdef MRML_SHARED_MEMORY_SUPPORTED
+  if (this->m_Segment)
+    {
+    munmap(this->m_Segment, this->m_SegmentSize);
+    }
+#endif
+  this->m_Segment = ITK_NULLPTR;
+  this->m_SegmentSize = 0;
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::CanReadFile(const char* filename)
+{
+  if (!IsSupported() || !IsSharedMemoryFileName(filename))
+    {
+    return false;
+    }
+  MRMLSharedMemoryImageIO::Pointer io = MRMLSharedMemoryImageIO::New();
+  io->SetFileName(filename);
+  return io->MapSegment(0)
+    && IsValidHeader(static_cast<const SegmentHeader*>(io->m_Segment), io->m_SegmentSize);
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::ReadImageInformation()
+{
+  if (!this->MapSegment(0))
+    {
+    itkExceptionMacro("Cannot open shared memory segment " << m_FileName);
+    }
+  const SegmentHeader* header = static_cast<const SegmentHeader*>(this->m_Segment);
+  if (!IsValidHeader(header, this->m_SegmentSize))
+    {
+    this->UnmapSegment();
+    itkExceptionMacro("Shared memory segment " << m_FileName << " does not contain a complete image");
+    }
+
+  unsigned int numberOfDimensions = header->NumberOfDimensions;
+  this->SetNumberOfDimensions(numberOfDimensions);
+  for (unsigned int i = 0; i < numberOfDimensions; ++i)
+    {
+    this->SetDimensions(i, static_cast<SizeValueType>(header->Dimensions[i]));
+    this->SetSpacing(i, header->Spacing[i]);
+    this->SetOrigin(i, header->Origin[i]);
+    std::vector<double> direction(numberOfDimensions);
+    for (unsigned int j = 0; j < numberOfDimensions; ++j)
+      {
+      direction[j] = header->Direction[i * 3 + j];
+      }
+    this->SetDirection(i, direction);
+    }
+  this->SetPixelType(static_cast<IOPixelType>(header->PixelType));
+  this->SetComponentType(static_cast<IOComponentType>(header->ComponentType));
+  this->SetNumberOfComponents(header->NumberOfComponents);
+
+  if (this->GetImageSizeInBytes() > header->BufferSize)
+    {
+    this->UnmapSegment();
+    itkExceptionMacro("Shared memory segment " << m_FileName << " is smaller than the image it describes");
+    }
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::Read(void *buffer)
+{
+  if (!this->m_Segment)
+    {
+    this->ReadImageInformation();
+    }
+  memcpy(buffer, this->GetSegmentBuffer(), this->GetImageSizeInBytes());
+}
+
+//----------------------------------------------------------------------------
+const void*
+MRMLSharedMemoryImageIO
+::GetSegmentBuffer() const
+{
+  if (!this->m_Segment)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const char*>(this->m_Segment) + SegmentHeaderSize;
+}
+
+//----------------------------------------------------------------------------
+bool
+MRMLSharedMemoryImageIO
+::CanWriteFile(const char* filename)
+{
+  return IsSupported() && IsSharedMemoryFileName(filename);
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::WriteImageInformation()
+{
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::Write(const void *buffer)
+{
+  void* segmentBuffer = this->CreateSegment();
+  if (!segmentBuffer)
+    {
+    itkExceptionMacro("Cannot create shared memory segment " << m_FileName);
+    }
+  memcpy(segmentBuffer, buffer, this->GetImageSizeInBytes());
+  this->CompleteSegment();
+  this->UnmapSegment();
+}
+
+//----------------------------------------------------------------------------
+void*
+MRMLSharedMemoryImageIO
+::CreateSegment()
+{
+  unsigned int numberOfDimensions = this->GetNumberOfDimensions();
+  if (numberOfDimensions < 1 || numberOfDimensions > 3)
+    {
+    itkWarningMacro("Only 1D, 2D and 3D images can be stored in shared memory");
+    return ITK_NULLPTR;
+    }
+  SizeType bufferSize = this->GetImageSizeInBytes();
+  if (!this->MapSegment(SegmentHeaderSize + bufferSize))
+    {
+    return ITK_NULLPTR;
+    }
+
+  SegmentHeader* header = static_cast<SegmentHeader*>(this->m_Segment);
+  memset(header, 0, SegmentHeaderSize);
+  memcpy(header->Magic, SegmentMagic, sizeof(SegmentMagic));
+  header->NumberOfDimensions = numberOfDimensions;
+  header->PixelType = static_cast<itk::uint32_t>(this->GetPixelType());
+  header->ComponentType = static_cast<itk::uint32_t>(this->GetComponentType());
+  header->NumberOfComponents = this->GetNumberOfComponents();
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    header->Dimensions[i] = (i < numberOfDimensions) ? this->GetDimensions(i) : 1;
+    header->Spacing[i] = (i < numberOfDimensions) ? this->GetSpacing(i) : 1.0;
+    header->Origin[i] = (i < numberOfDimensions) ? this->GetOrigin(i) : 0.0;
+    for (unsigned int j = 0; j < 3; ++j)
+      {
+      header->Direction[i * 3 + j] = (i < numberOfDimensions && j < numberOfDimensions) ?
+        this->GetDirection(i)[j] : (i == j ? 1.0 : 0.0);
+      }
+    }
+  header->BufferSize = bufferSize;
+  header->Complete = 0;
+
+  return static_cast<char*>(this->m_Segment) + SegmentHeaderSize;
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::CompleteSegment()
+{
+  if (this->m_Segment)
+    {
+    static_cast<SegmentHeader*>(this->m_Segment)->Complete = 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+void
+MRMLSharedMemoryImageIO
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "SegmentSize: " << this->m_SegmentSize << std::endl;
+}
+
+} // end namespace itk
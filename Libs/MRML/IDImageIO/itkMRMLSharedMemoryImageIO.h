@@ -0,0 +1,129 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkMRMLSharedMemoryImageIO_h
+#define itkMRMLSharedMemoryImageIO_h
+
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMRMLSharedMemoryIOExport.h"
+
+#include "itkImageIOBase.h"
+
+namespace itk
+{
+/** \class MRMLSharedMemoryImageIO
+ * \brief ImageIO object for exchanging images with Slicer through shared memory
+ *
+ * Command line modules that run as executables are given file names
+ * for their input and output images. Writing and parsing these files
+ * can take longer than the processing itself for large images.
+ * MRMLSharedMemoryImageIO lets Slicer and the executable exchange
+ * images through named shared memory segments instead: the writer
+ * creates a segment that holds a small header describing the image
+ * (pixel type, size and LPS geometry) followed by the pixel buffer,
+ * and the reader maps the same segment.
+ *
+ * Unlike MRMLIDImageIO, this class only depends on ITK, so that it can
+ * be loaded in executables that do not link with MRML.
+ *
+ * The "filename" specified will look like a URI:
+ *     <code>slicershm:\<segment name\></code>
+ *
+ * Segments outlive the process that created them and are removed by
+ * the process that requested the transfer (see RemoveSegment()).
+ * Shared memory segments are only supported on POSIX systems,
+ * CanReadFile() and CanWriteFile() return false on other platforms.
+ */
+class MRMLSharedMemoryIO_EXPORT MRMLSharedMemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef MRMLSharedMemoryImageIO Self;
+  typedef ImageIOBase             Superclass;
+  typedef SmartPointer<Self>      Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MRMLSharedMemoryImageIO, ImageIOBase);
+
+  /** Scheme of the file names referring to shared memory segments */
+  static const char* GetScheme();
+
+  /** Returns true if shared memory segments are supported on this platform */
+  static bool IsSupported();
+
+  /** Returns true if the file name refers to a shared memory segment */
+  static bool IsSharedMemoryFileName(const char* filename);
+
+  /** Remove the segment referred by the file name. The memory is released
+   * when the last process that maps the segment unmaps it. */
+  static bool RemoveSegment(const char* filename);
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanReadFile(const char*) ITK_OVERRIDE;
+
+  /** Set the spacing and dimension information for the set filename. */
+  virtual void ReadImageInformation() ITK_OVERRIDE;
+
+  /** Reads the data from the segment into the memory buffer provided. */
+  virtual void Read(void* buffer) ITK_OVERRIDE;
+
+  /** Pixel buffer of the segment mapped by ReadImageInformation(), or NULL
+   * if no segment is mapped. It can be used instead of Read() to avoid
+   * copying the pixels into an intermediate buffer. */
+  const void* GetSegmentBuffer() const;
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanWriteFile(const char*) ITK_OVERRIDE;
+
+  /** Writes the header of the image.
+   * The header is written together with the data in Write(). */
+  virtual void WriteImageInformation() ITK_OVERRIDE;
+
+  /** Writes the data to the segment from the memory buffer provided. */
+  virtual void Write(const void* buffer) ITK_OVERRIDE;
+
+  /** Create the segment for the current image information and return its
+   * pixel buffer, so that the caller can fill it directly. CompleteSegment()
+   * must be called once the buffer is filled. Returns NULL on failure. */
+  void* CreateSegment();
+
+  /** Mark the segment created by CreateSegment() as complete, readers
+   * ignore incomplete segments. */
+  void CompleteSegment();
+
+protected:
+  MRMLSharedMemoryImageIO();
+  ~MRMLSharedMemoryImageIO();
+  void PrintSelf(std::ostream& os, Indent indent) const ITK_OVERRIDE;
+
+  /** Map the segment referred by the current file name. If \a size is
+   * not 0, the segment is created (or resized) with that size. */
+  bool MapSegment(SizeValueType size);
+  void UnmapSegment();
+
+private:
+  MRMLSharedMemoryImageIO(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  void*         m_Segment;
+  SizeValueType m_SegmentSize;
+};
+
+} /// end namespace itk
+#endif /// itkMRMLSharedMemoryImageIO_h
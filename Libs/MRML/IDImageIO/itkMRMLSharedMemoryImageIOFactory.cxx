@@ -0,0 +1,41 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkMRMLSharedMemoryImageIOFactory.h"
+#include "itkVersion.h"
+
+
+namespace itk
+{
+MRMLSharedMemoryImageIOFactory::MRMLSharedMemoryImageIOFactory()
+{
+  this->RegisterOverride("itkImageIOBase",
+                         "itkMRMLSharedMemoryImageIO",
+                         "ImageIO to exchange images with Slicer through shared memory.",
+                         1,
+                         CreateObjectFunction<MRMLSharedMemoryImageIO>::New());
+}
+
+MRMLSharedMemoryImageIOFactory::~MRMLSharedMemoryImageIOFactory()
+{
+}
+
+const char*
+MRMLSharedMemoryImageIOFactory::GetITKSourceVersion(void) const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char*
+MRMLSharedMemoryImageIOFactory::GetDescription() const
+{
+  return "ImageIOFactory that imports/exports data to a shared memory segment.";
+}
+
+} // end namespace itk
@@ -0,0 +1,65 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkMRMLSharedMemoryImageIOFactory_h
+#define itkMRMLSharedMemoryImageIOFactory_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+#include "itkMRMLSharedMemoryImageIO.h"
+
+#include "itkMRMLSharedMemoryIOExport.h"
+
+namespace itk
+{
+/** \class MRMLSharedMemoryImageIOFactory
+ * \brief Create instances of MRMLSharedMemoryImageIO objects using an object factory.
+ */
+class MRMLSharedMemoryIO_EXPORT MRMLSharedMemoryImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef MRMLSharedMemoryImageIOFactory Self;
+  typedef ObjectFactoryBase              Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char* GetITKSourceVersion(void) const ITK_OVERRIDE;
+  virtual const char* GetDescription(void) const ITK_OVERRIDE;
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro(Self);
+  static MRMLSharedMemoryImageIOFactory* FactoryNew() { return new MRMLSharedMemoryImageIOFactory;}
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MRMLSharedMemoryImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory(void)
+  {
+    MRMLSharedMemoryImageIOFactory::Pointer factory = MRMLSharedMemoryImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory(factory);
+  }
+
+protected:
+  MRMLSharedMemoryImageIOFactory();
+  ~MRMLSharedMemoryImageIOFactory();
+
+private:
+  MRMLSharedMemoryImageIOFactory(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+};
+
+
+} /// end namespace itk
+
+#endif
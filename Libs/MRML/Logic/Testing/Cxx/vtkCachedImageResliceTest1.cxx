@@ -0,0 +1,280 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkCachedImageReslice.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CreateVolume(vtkImageData* image, int size)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, size - 1);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* ptr = static_cast<short*>(image->GetScalarPointer());
+  for (int z = 0; z < size; z++)
+    {
+    for (int y = 0; y < size; y++)
+      {
+      for (int x = 0; x < size; x++)
+        {
+        *(ptr++) = static_cast<short>((x * 7 + y * 13 + z * 29) % 2000);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Oblique slice at the given offset along the slice normal
+void SetSliceOffset(vtkTransform* transform, int size, double offset)
+{
+  transform->Identity();
+  transform->Translate(size / 2.0, size / 2.0, size / 2.0);
+  transform->RotateX(20);
+  transform->RotateY(-30);
+  transform->Translate(-size / 2.0, -size / 2.0, offset);
+}
+
+//----------------------------------------------------------------------------
+void SetupReslice(vtkImageReslice* reslice, vtkImageData* volume, vtkTransform* transform, int size)
+{
+  reslice->SetInputData(volume);
+  reslice->SetResliceTransform(transform);
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetBackgroundColor(0, 0, 0, 0);
+  reslice->AutoCropOutputOff();
+  reslice->SetOptimization(1);
+  reslice->SetOutputOrigin(0, 0, 0);
+  reslice->SetOutputSpacing(1, 1, 1);
+  reslice->SetOutputDimensionality(3);
+  reslice->SetOutputExtent(0, size - 1, 0, size - 1, 0, 0);
+  reslice->GenerateStencilOutputOn();
+}
+
+//----------------------------------------------------------------------------
+bool CompareImages(vtkImageData* expected, vtkImageData* actual, int line)
+{
+  if (actual->GetNumberOfPoints() != expected->GetNumberOfPoints()
+    || actual->GetScalarType() != expected->GetScalarType())
+    {
+    std::cerr << line << ": Unexpected output image format" << std::endl;
+    return false;
+    }
+  const short* expectedPtr = static_cast<short*>(expected->GetScalarPointer());
+  const short* actualPtr = static_cast<short*>(actual->GetScalarPointer());
+  for (vtkIdType i = 0; i < actual->GetNumberOfPoints(); i++)
+    {
+    if (expectedPtr[i] != actualPtr[i])
+      {
+      std::cerr << line << ": Output mismatch at voxel " << i << ": " << actualPtr[i]
+        << " (expected " << expectedPtr[i] << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Compute slice at the offset with both filters and compare the results
+bool UpdateSlice(vtkImageReslice* referenceReslice, vtkTransform* referenceTransform,
+  vtkCachedImageReslice* cachedReslice, vtkTransform* cachedTransform, int size, double offset, int line)
+{
+  SetSliceOffset(referenceTransform, size, offset);
+  SetSliceOffset(cachedTransform, size, offset);
+  referenceReslice->Update();
+  cachedReslice->Update();
+  if (!CompareImages(referenceReslice->GetOutput(), cachedReslice->GetOutput(), line))
+    {
+    std::cerr << "Slice offset: " << offset << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCachedImageResliceTest1(int , char * [] )
+{
+  const int size = 64;
+  vtkNew<vtkImageData> volume;
+  CreateVolume(volume.GetPointer(), size);
+
+  vtkNew<vtkTransform> referenceTransform;
+  vtkNew<vtkImageReslice> referenceReslice;
+  SetupReslice(referenceReslice.GetPointer(), volume.GetPointer(), referenceTransform.GetPointer(), size);
+
+  vtkNew<vtkTransform> cachedTransform;
+  vtkNew<vtkCachedImageReslice> cachedReslice;
+  SetupReslice(cachedReslice.GetPointer(), volume.GetPointer(), cachedTransform.GetPointer(), size);
+  cachedReslice->SetCacheSize(16);
+  cachedReslice->SetNumberOfSlicesToPrefetch(0);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Scrolling back and forth is served from the cache
+
+  for (int offset = 0; offset <= 10; offset++)
+    {
+    if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+      cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, offset, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if (cachedReslice->GetNumberOfCacheHits() != 0 || cachedReslice->GetNumberOfCacheMisses() != 11)
+    {
+    std::cerr << __LINE__ << ": Unexpected cache hits: " << cachedReslice->GetNumberOfCacheHits()
+      << ", misses: " << cachedReslice->GetNumberOfCacheMisses() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int offset = 10; offset >= 0; offset--)
+    {
+    if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+      cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, offset, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if (cachedReslice->GetNumberOfCacheHits() != 11 || cachedReslice->GetNumberOfCachedSlices() != 11)
+    {
+    std::cerr << __LINE__ << ": Unexpected cache hits: " << cachedReslice->GetNumberOfCacheHits()
+      << ", cached slices: " << cachedReslice->GetNumberOfCachedSlices() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Cache size is bounded
+
+  cachedReslice->SetCacheSize(4);
+  if (cachedReslice->GetNumberOfCachedSlices() != 4)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of cached slices: "
+      << cachedReslice->GetNumberOfCachedSlices() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Modified input invalidates the cache
+
+  cachedReslice->ResetStatistics();
+  short* voxel = static_cast<short*>(volume->GetScalarPointer(size / 2, size / 2, size / 2));
+  *voxel = 3000;
+  volume->Modified();
+  if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+    cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, 1, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  if (cachedReslice->GetNumberOfCacheHits() != 0 || cachedReslice->GetNumberOfCachedSlices() != 1)
+    {
+    std::cerr << __LINE__ << ": Cache is not cleared when the input is modified" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Slices in the scroll direction are prefetched
+
+  cachedReslice->SetCacheSize(16);
+  cachedReslice->SetNumberOfSlicesToPrefetch(2);
+  for (int offset = 2; offset <= 3; offset++)
+    {
+    if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+      cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, offset, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  // Re-request the current slice until slices 4 and 5 are prefetched and collected
+  // (slices 1, 2 and 3 are already in the cache)
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (cachedReslice->GetNumberOfCachedSlices() < 5 && vtkTimerLog::GetUniversalTime() - startTime < 10.0)
+    {
+    vtksys::SystemTools::Delay(10);
+    cachedReslice->Modified();
+    cachedReslice->Update();
+    }
+  if (cachedReslice->GetNumberOfCachedSlices() != 5)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of cached slices: "
+      << cachedReslice->GetNumberOfCachedSlices() << std::endl;
+    return EXIT_FAILURE;
+    }
+  cachedReslice->ResetStatistics();
+  for (int offset = 4; offset <= 5; offset++)
+    {
+    if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+      cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, offset, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if (cachedReslice->GetNumberOfCacheHits() != 2 || cachedReslice->GetNumberOfPrefetchHits() != 2)
+    {
+    std::cerr << __LINE__ << ": Unexpected cache hits: " << cachedReslice->GetNumberOfCacheHits()
+      << ", prefetch hits: " << cachedReslice->GetNumberOfPrefetchHits() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Input volume released while its slices are prefetched (new volume or
+  // scene close): the prefetch thread must not read freed voxels
+
+  for (int iteration = 0; iteration < 10; iteration++)
+    {
+    vtkImageData* temporaryVolume = vtkImageData::New();
+    CreateVolume(temporaryVolume, size);
+    cachedReslice->SetInputData(temporaryVolume);
+    referenceReslice->SetInputData(temporaryVolume);
+    for (int offset = 6; offset <= 7; offset++)
+      {
+      if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+        cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, offset, __LINE__))
+        {
+        temporaryVolume->Delete();
+        return EXIT_FAILURE;
+        }
+      }
+    // prefetch of the next slices is running now
+    cachedReslice->SetInputData(volume.GetPointer());
+    referenceReslice->SetInputData(volume.GetPointer());
+    temporaryVolume->Delete();
+    if (iteration % 2)
+      {
+      cachedReslice->ClearCache();
+      }
+    if (!UpdateSlice(referenceReslice.GetPointer(), referenceTransform.GetPointer(),
+      cachedReslice.GetPointer(), cachedTransform.GetPointer(), size, 8, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Cache hit rate: " << cachedReslice->GetCacheHitRate()
+    << ", average hit time: " << cachedReslice->GetAverageHitTime() << " ms"
+    << ", average miss time: " << cachedReslice->GetAverageMissTime() << " ms" << std::endl;
+
+  return EXIT_SUCCESS;
+}
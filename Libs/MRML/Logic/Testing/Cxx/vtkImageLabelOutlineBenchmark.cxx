@@ -0,0 +1,353 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Label outline benchmark
+//
+// Measures the per-frame latency of outlining a label layer slice with the
+// row-wise implementation of vtkImageLabelOutline and with a generic
+// implementation that visits the neighborhood of each voxel with per-neighbor
+// boundary checks, for each scalar type and outline thickness, and reports the
+// timings as JSON.
+//
+// Usage:
+//   vtkImageLabelOutlineBenchmark [--sizes 512,2048] [--outlines 1,2,3,4]
+//     [--iterations N] [--warmup-iterations N] [--output file.json]
+
+// MRMLLogic includes
+#include "vtkImageLabelOutline.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkOptions
+{
+  BenchmarkOptions()
+    {
+    this->SliceSizes.push_back(512);
+    this->SliceSizes.push_back(2048);
+    for (int outline = 1; outline <= 4; outline++)
+      {
+      this->Outlines.push_back(outline);
+      }
+    this->Iterations = 10;
+    this->WarmupIterations = 1;
+    }
+
+  std::vector<int> SliceSizes;
+  std::vector<int> Outlines;
+  int Iterations;
+  int WarmupIterations;
+  std::string OutputFileName;
+};
+
+//----------------------------------------------------------------------------
+const int ScalarTypes[] =
+{
+  VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_UNSIGNED_SHORT, VTK_INT, VTK_FLOAT, VTK_DOUBLE
+};
+const int NumberOfScalarTypes = sizeof(ScalarTypes) / sizeof(ScalarTypes[0]);
+
+//----------------------------------------------------------------------------
+void PrintUsage(const char* executable)
+{
+  std::cerr << "Usage: " << executable << " [--sizes 512,2048] [--outlines 1,2,3,4]"
+    << " [--iterations N] [--warmup-iterations N] [--output file.json]" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool ParseIntegerList(const char* text, std::vector<int>& values)
+{
+  values.clear();
+  std::stringstream stream(text);
+  std::string value;
+  while (std::getline(stream, value, ','))
+    {
+    values.push_back(atoi(value.c_str()));
+    if (values.back() < 1)
+      {
+      return false;
+      }
+    }
+  return !values.empty();
+}
+
+//----------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], BenchmarkOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+    {
+    std::string argument = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (argument == "--sizes" && hasValue)
+      {
+      if (!ParseIntegerList(argv[++i], options.SliceSizes))
+        {
+        std::cerr << "Invalid slice sizes: " << argv[i] << std::endl;
+        return false;
+        }
+      }
+    else if (argument == "--outlines" && hasValue)
+      {
+      if (!ParseIntegerList(argv[++i], options.Outlines))
+        {
+        std::cerr << "Invalid outline thicknesses: " << argv[i] << std::endl;
+        return false;
+        }
+      }
+    else if (argument == "--iterations" && hasValue)
+      {
+      options.Iterations = atoi(argv[++i]);
+      }
+    else if (argument == "--warmup-iterations" && hasValue)
+      {
+      options.WarmupIterations = atoi(argv[++i]);
+      }
+    else if (argument == "--output" && hasValue)
+      {
+      options.OutputFileName = argv[++i];
+      }
+    else
+      {
+      std::cerr << "Invalid argument: " << argument << std::endl;
+      return false;
+      }
+    }
+  if (options.Iterations < 1 || options.WarmupIterations < 0)
+    {
+    std::cerr << "Invalid benchmark parameters" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Labelmap slice with overlapping disks of different labels
+void CreateLabelmap(vtkImageData* image, int size, int scalarType)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  image->AllocateScalars(scalarType, 1);
+  for (int y = 0; y < size; y++)
+    {
+    for (int x = 0; x < size; x++)
+      {
+      int label = 0;
+      for (int disk = 1; disk <= 5; disk++)
+        {
+        int centerX = (disk * size * 3 / 11) % size;
+        int centerY = (disk * size * 5 / 13) % size;
+        int radius = size / (disk + 3);
+        if ((x - centerX) * (x - centerX) + (y - centerY) * (y - centerY) < radius * radius)
+          {
+          label = disk;
+          }
+        }
+      image->SetScalarComponentFromDouble(x, y, 0, 0, label);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Generic outline: visits the neighborhood of each non-background voxel and
+/// checks the image boundary for each neighbor. Neighbors outside of the image
+/// make the voxel an outline voxel, as in vtkImageLabelOutline.
+template <class T>
+void GenericLabelOutline(vtkImageData* input, vtkImageData* output, int outline)
+{
+  int extent[6];
+  input->GetExtent(extent);
+  output->SetExtent(extent);
+  output->AllocateScalars(input->GetScalarType(), 1);
+  const int size0 = extent[1] - extent[0] + 1;
+  const int size1 = extent[3] - extent[2] + 1;
+  const T* inPtr = static_cast<T*>(input->GetScalarPointer());
+  T* outPtr = static_cast<T*>(output->GetScalarPointer());
+  const T background = static_cast<T>(0);
+  for (int y = 0; y < size1; y++)
+    {
+    for (int x = 0; x < size0; x++)
+      {
+      const T label = inPtr[y * size0 + x];
+      bool isOutline = false;
+      for (int hoodY = -outline; label != background && hoodY <= outline; hoodY++)
+        {
+        for (int hoodX = -outline; hoodX <= outline; hoodX++)
+          {
+          int neighborX = x + hoodX;
+          int neighborY = y + hoodY;
+          if (neighborX < 0 || neighborX >= size0 || neighborY < 0 || neighborY >= size1
+            || inPtr[neighborY * size0 + neighborX] != label)
+            {
+            isOutline = true;
+            }
+          }
+        }
+      outPtr[y * size0 + x] = (isOutline ? label : background);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void GenericLabelOutline(vtkImageData* input, vtkImageData* output, int outline)
+{
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(GenericLabelOutline<VTK_TT>(input, output, outline));
+    }
+}
+
+//----------------------------------------------------------------------------
+bool CompareOutputs(vtkImageData* expected, vtkImageData* actual)
+{
+  int* extent = expected->GetExtent();
+  for (int y = extent[2]; y <= extent[3]; y++)
+    {
+    for (int x = extent[0]; x <= extent[1]; x++)
+      {
+      if (expected->GetScalarComponentAsDouble(x, y, 0, 0) != actual->GetScalarComponentAsDouble(x, y, 0, 0))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void WriteStatistics(std::ostream& os, std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+  double sum = 0.0;
+  for (std::vector<double>::iterator it = times.begin(); it != times.end(); ++it)
+    {
+    sum += *it;
+    }
+  size_t count = times.size();
+  os << "{\"mean\": " << (count ? sum / count : 0.0)
+     << ", \"median\": " << (count ? times[count / 2] : 0.0)
+     << ", \"p95\": " << (count ? times[std::min(count - 1, static_cast<size_t>(0.95 * count))] : 0.0)
+     << ", \"min\": " << (count ? times.front() : 0.0)
+     << ", \"max\": " << (count ? times.back() : 0.0) << "}";
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  if (!ParseArguments(argc, argv, options))
+    {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkImageData> labelmap;
+  vtkNew<vtkImageData> genericOutput;
+  vtkNew<vtkImageLabelOutline> outlineFilter;
+  outlineFilter->SetInputData(labelmap.GetPointer());
+
+  std::stringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"vtkImageLabelOutlineBenchmark\",\n"
+       << "  \"parameters\": {\"iterations\": " << options.Iterations
+       << ", \"warmupIterations\": " << options.WarmupIterations << "},\n"
+       << "  \"units\": \"ms\",\n"
+       << "  \"slices\": [";
+  bool first = true;
+  for (size_t sizeIndex = 0; sizeIndex < options.SliceSizes.size(); sizeIndex++)
+    {
+    const int size = options.SliceSizes[sizeIndex];
+    for (int typeIndex = 0; typeIndex < NumberOfScalarTypes; typeIndex++)
+      {
+      CreateLabelmap(labelmap.GetPointer(), size, ScalarTypes[typeIndex]);
+      for (size_t outlineIndex = 0; outlineIndex < options.Outlines.size(); outlineIndex++)
+        {
+        const int outline = options.Outlines[outlineIndex];
+        outlineFilter->SetOutline(outline);
+
+        std::vector<double> rowWiseTimes;
+        std::vector<double> genericTimes;
+        for (int iteration = 0; iteration < options.WarmupIterations + options.Iterations; iteration++)
+          {
+          double startTime = vtkTimerLog::GetUniversalTime();
+          labelmap->Modified();
+          outlineFilter->Update();
+          double rowWiseTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+
+          startTime = vtkTimerLog::GetUniversalTime();
+          GenericLabelOutline(labelmap.GetPointer(), genericOutput.GetPointer(), outline);
+          double genericTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+          if (iteration < options.WarmupIterations)
+            {
+            continue;
+            }
+          rowWiseTimes.push_back(rowWiseTime);
+          genericTimes.push_back(genericTime);
+          }
+
+        // Timings are only meaningful if both compute the same outline
+        if (!CompareOutputs(genericOutput.GetPointer(), outlineFilter->GetOutput()))
+          {
+          std::cerr << "Output mismatch between the row-wise and the generic outline for "
+            << size << "x" << size << " " << vtkImageScalarTypeNameMacro(ScalarTypes[typeIndex])
+            << " slice, outline " << outline << std::endl;
+          return EXIT_FAILURE;
+          }
+
+        json << (first ? "" : ",") << "\n"
+             << "    {\n"
+             << "      \"size\": [" << size << ", " << size << "],\n"
+             << "      \"scalarType\": \"" << vtkImageScalarTypeNameMacro(ScalarTypes[typeIndex]) << "\",\n"
+             << "      \"outline\": " << outline << ",\n"
+             << "      \"rowWise\": ";
+        WriteStatistics(json, rowWiseTimes);
+        json << ",\n"
+             << "      \"generic\": ";
+        WriteStatistics(json, genericTimes);
+        json << "\n    }";
+        first = false;
+        }
+      }
+    }
+  json << "\n  ]\n}\n";
+
+  if (options.OutputFileName.empty())
+    {
+    std::cout << json.str();
+    }
+  else
+    {
+    std::ofstream output(options.OutputFileName.c_str());
+    if (!output)
+      {
+      std::cerr << "Failed to write output file: " << options.OutputFileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    output << json.str();
+    }
+
+  return EXIT_SUCCESS;
+}
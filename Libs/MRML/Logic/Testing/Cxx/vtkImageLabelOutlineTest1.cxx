@@ -0,0 +1,170 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageLabelOutline.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Labelmap slice with overlapping disks of different labels
+void CreateLabelmap(vtkImageData* image, int size, int scalarType)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  image->AllocateScalars(scalarType, 1);
+  for (int y = 0; y < size; y++)
+    {
+    for (int x = 0; x < size; x++)
+      {
+      int label = 0;
+      for (int disk = 1; disk <= 5; disk++)
+        {
+        int centerX = (disk * size * 3 / 11) % size;
+        int centerY = (disk * size * 5 / 13) % size;
+        int radius = size / (disk + 3);
+        if ((x - centerX) * (x - centerX) + (y - centerY) * (y - centerY) < radius * radius)
+          {
+          label = disk;
+          }
+        }
+      image->SetScalarComponentFromDouble(x, y, 0, 0, label);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Expected output value: label of non-background voxels that have a different
+/// neighbor (or the image boundary) within outline distance
+double ExpectedOutline(vtkImageData* image, int x, int y, int outline)
+{
+  int* extent = image->GetExtent();
+  double label = image->GetScalarComponentAsDouble(x, y, 0, 0);
+  if (label == 0)
+    {
+    return 0;
+    }
+  for (int dy = -outline; dy <= outline; dy++)
+    {
+    for (int dx = -outline; dx <= outline; dx++)
+      {
+      if (x + dx < extent[0] || x + dx > extent[1] || y + dy < extent[2] || y + dy > extent[3]
+        || image->GetScalarComponentAsDouble(x + dx, y + dy, 0, 0) != label)
+        {
+        return label;
+        }
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool CheckOutline(vtkImageData* input, vtkImageData* output, int outline, int line)
+{
+  int* extent = input->GetExtent();
+  for (int y = extent[2]; y <= extent[3]; y++)
+    {
+    for (int x = extent[0]; x <= extent[1]; x++)
+      {
+      double expected = ExpectedOutline(input, x, y, outline);
+      double actual = output->GetScalarComponentAsDouble(x, y, 0, 0);
+      if (actual != expected)
+        {
+        std::cerr << line << ": Outline " << outline << " mismatch at (" << x << ", " << y << "): "
+          << actual << " (expected " << expected << ")" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelOutlineTest1(int , char * [] )
+{
+  vtkNew<vtkImageData> labelmap;
+  vtkNew<vtkImageLabelOutline> outlineFilter;
+  outlineFilter->SetInputData(labelmap.GetPointer());
+
+  //////////////////////////////////////////////////////////////////////////
+  // Outline matches the definition for all thicknesses and scalar types
+
+  const int scalarTypes[3] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT };
+  for (int typeIndex = 0; typeIndex < 3; typeIndex++)
+    {
+    CreateLabelmap(labelmap.GetPointer(), 61, scalarTypes[typeIndex]);
+    for (int outline = 1; outline <= 5; outline++)
+      {
+      outlineFilter->SetOutline(outline);
+      outlineFilter->Update();
+      if (outlineFilter->GetOutput()->GetScalarType() != scalarTypes[typeIndex]
+        || !CheckOutline(labelmap.GetPointer(), outlineFilter->GetOutput(), outline, __LINE__))
+        {
+        std::cerr << "Scalar type: " << labelmap->GetScalarTypeAsString() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Boundary voxels of a square: the square border and the ring around the
+  // inner label are kept, voxels touching the image border count as boundary
+
+  labelmap->SetExtent(0, 8, 0, 8, 0, 0);
+  labelmap->AllocateScalars(VTK_SHORT, 1);
+  short* labelPtr = static_cast<short*>(labelmap->GetScalarPointer());
+  for (int y = 0; y < 9; y++)
+    {
+    for (int x = 0; x < 9; x++)
+      {
+      // 7x7 square of label 3 in the corner, with a single label 7 voxel inside
+      short label = (x < 7 && y < 7) ? 3 : 0;
+      *(labelPtr++) = (x == 5 && y == 5) ? 7 : label;
+      }
+    }
+  outlineFilter->SetOutline(1);
+  outlineFilter->Update();
+  const short expectedOutline[9][9] = {
+    { 3, 3, 3, 3, 3, 3, 3, 0, 0 },
+    { 3, 0, 0, 0, 0, 0, 3, 0, 0 },
+    { 3, 0, 0, 0, 0, 0, 3, 0, 0 },
+    { 3, 0, 0, 0, 0, 0, 3, 0, 0 },
+    { 3, 0, 0, 0, 3, 3, 3, 0, 0 },
+    { 3, 0, 0, 0, 3, 7, 3, 0, 0 },
+    { 3, 3, 3, 3, 3, 3, 3, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0 } };
+  for (int y = 0; y < 9; y++)
+    {
+    for (int x = 0; x < 9; x++)
+      {
+      double actual = outlineFilter->GetOutput()->GetScalarComponentAsDouble(x, y, 0, 0);
+      if (actual != expectedOutline[y][x])
+        {
+        std::cerr << __LINE__ << ": Boundary mismatch at (" << x << ", " << y << "): "
+          << actual << " (expected " << expectedOutline[y][x] << ")" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageLayerBlend.h"
+
+// VTK includes
+#include <vtkImageAppendComponents.h>
+#include <vtkImageBlend.h>
+#include <vtkImageCast.h>
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkImageMathematics.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// RGBA layer with a pattern that depends on the seed, some voxels are transparent
+void CreateLayer(vtkImageData* image, int size, int seed, int numberOfSlices = 1)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, numberOfSlices - 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 4);
+  unsigned char* ptr = static_cast<unsigned char*>(image->GetScalarPointer());
+  for (int z = 0; z < numberOfSlices; z++)
+    {
+    for (int y = 0; y < size; y++)
+      {
+      for (int x = 0; x < size; x++)
+        {
+        *(ptr++) = static_cast<unsigned char>((x * (seed + 3) + y + z * 11) % 256);
+        *(ptr++) = static_cast<unsigned char>((y * (seed + 5) + x) % 256);
+        *(ptr++) = static_cast<unsigned char>((x + y + seed * 40) % 256);
+        *(ptr++) = ((x + seed + z) % 7 == 0) ? 0 : 255;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool CompareImages(vtkImageData* expected, vtkImageData* actual, int line)
+{
+  if (actual->GetNumberOfScalarComponents() != expected->GetNumberOfScalarComponents()
+    || actual->GetNumberOfPoints() != expected->GetNumberOfPoints())
+    {
+    std::cerr << line << ": Unexpected output image format" << std::endl;
+    return false;
+    }
+  const unsigned char* expectedPtr = static_cast<unsigned char*>(expected->GetScalarPointer());
+  const unsigned char* actualPtr = static_cast<unsigned char*>(actual->GetScalarPointer());
+  vtkIdType numberOfValues = actual->GetNumberOfPoints() * actual->GetNumberOfScalarComponents();
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    if (expectedPtr[i] != actualPtr[i])
+      {
+      std::cerr << line << ": Output mismatch at value " << i << ": " << int(actualPtr[i])
+        << " (expected " << int(expectedPtr[i]) << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLayerBlendTest1(int , char * [] )
+{
+  vtkNew<vtkImageData> background;
+  vtkNew<vtkImageData> foreground;
+  vtkNew<vtkImageData> label;
+
+  vtkNew<vtkImageBlend> referenceBlend;
+  vtkNew<vtkImageLayerBlend> layerBlend;
+  vtkImageBlend* blends[2] = { referenceBlend.GetPointer(), layerBlend.GetPointer() };
+  for (int i = 0; i < 2; i++)
+    {
+    blends[i]->AddInputData(background.GetPointer());
+    blends[i]->AddInputData(foreground.GetPointer());
+    blends[i]->AddInputData(label.GetPointer());
+    blends[i]->SetOpacity(1, 0.3);
+    blends[i]->SetOpacity(2, 0.75);
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Alpha blending is identical to vtkImageBlend
+
+  CreateLayer(background.GetPointer(), 64, 0);
+  CreateLayer(foreground.GetPointer(), 64, 1);
+  CreateLayer(label.GetPointer(), 64, 2);
+  referenceBlend->Update();
+  layerBlend->Update();
+  if (!CompareImages(referenceBlend->GetOutput(), layerBlend->GetOutput(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Add and subtract first two layers: RGB is clamped, alpha is taken from background
+
+  vtkNew<vtkImageLayerBlend> addSubtractBlend;
+  addSubtractBlend->AddInputData(background.GetPointer());
+  addSubtractBlend->AddInputData(foreground.GetPointer());
+  addSubtractBlend->SetOpacity(1, 0.3);
+  for (int operation = vtkImageLayerBlend::FirstLayersAdd; operation <= vtkImageLayerBlend::FirstLayersSubtract; operation++)
+    {
+    addSubtractBlend->SetFirstLayersOperation(operation);
+    addSubtractBlend->Update();
+    for (int y = 0; y < 64; y += 7)
+      {
+      for (int x = 0; x < 64; x += 5)
+        {
+        for (int c = 0; c < 4; c++)
+          {
+          int backgroundValue = static_cast<int>(background->GetScalarComponentAsDouble(x, y, 0, c));
+          int foregroundValue = static_cast<int>(foreground->GetScalarComponentAsDouble(x, y, 0, c));
+          int expected = backgroundValue;
+          if (c < 3)
+            {
+            expected = (operation == vtkImageLayerBlend::FirstLayersAdd)
+              ? std::min(backgroundValue + foregroundValue, 255)
+              : std::max(backgroundValue - foregroundValue, 0);
+            }
+          int actual = static_cast<int>(addSubtractBlend->GetOutput()->GetScalarComponentAsDouble(x, y, 0, c));
+          if (actual != expected)
+            {
+            std::cerr << __LINE__ << ": Operation " << operation << " mismatch at (" << x << ", " << y
+              << ") component " << c << ": " << actual << " (expected " << expected << ")" << std::endl;
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Lightbox: requesting one tile of the slab blends the whole slab, the
+  // remaining tiles are served from the output without re-executing
+
+  CreateLayer(background.GetPointer(), 32, 0, 6);
+  CreateLayer(foreground.GetPointer(), 32, 1, 6);
+  CreateLayer(label.GetPointer(), 32, 2, 6);
+  referenceBlend->Update();
+  layerBlend->GenerateWholeExtentOn();
+  vtkMTimeType firstTileBlendTime = 0;
+  for (int tile = 0; tile < 6; tile++)
+    {
+    int tileExtent[6] = { 0, 31, 0, 31, tile, tile };
+    layerBlend->UpdateExtent(tileExtent);
+    int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    layerBlend->GetOutput()->GetExtent(outputExtent);
+    if (outputExtent[4] != 0 || outputExtent[5] != 5)
+      {
+      std::cerr << __LINE__ << ": Whole slab is not generated for tile " << tile << ", output z extent: "
+        << outputExtent[4] << ".." << outputExtent[5] << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (tile == 0)
+      {
+      firstTileBlendTime = layerBlend->GetOutput()->GetMTime();
+      }
+    else if (layerBlend->GetOutput()->GetMTime() != firstTileBlendTime)
+      {
+      std::cerr << __LINE__ << ": Blend is re-executed for tile " << tile << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (!CompareImages(referenceBlend->GetOutput(), layerBlend->GetOutput(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+  layerBlend->GenerateWholeExtentOff();
+
+  //////////////////////////////////////////////////////////////////////////
+  // Add and subtract compositing with a label layer gives the same output as
+  // the cast/mathematics/extract/append filter chain that the slice logic used
+  // before blending the label layer
+
+  CreateLayer(background.GetPointer(), 64, 0);
+  CreateLayer(foreground.GetPointer(), 64, 1);
+  CreateLayer(label.GetPointer(), 64, 2);
+
+  vtkNew<vtkImageCast> addSubBackgroundCast;
+  addSubBackgroundCast->SetInputData(background.GetPointer());
+  addSubBackgroundCast->SetOutputScalarTypeToShort();
+  vtkNew<vtkImageCast> addSubForegroundCast;
+  addSubForegroundCast->SetInputData(foreground.GetPointer());
+  addSubForegroundCast->SetOutputScalarTypeToShort();
+  vtkNew<vtkImageMathematics> addSubMath;
+  addSubMath->SetInputConnection(0, addSubBackgroundCast->GetOutputPort());
+  addSubMath->SetInputConnection(1, addSubForegroundCast->GetOutputPort());
+  vtkNew<vtkImageCast> addSubOutputCast;
+  addSubOutputCast->SetInputConnection(addSubMath->GetOutputPort());
+  addSubOutputCast->SetOutputScalarTypeToUnsignedChar();
+  addSubOutputCast->ClampOverflowOn();
+  vtkNew<vtkImageExtractComponents> addSubExtractRGB;
+  addSubExtractRGB->SetInputConnection(addSubOutputCast->GetOutputPort());
+  addSubExtractRGB->SetComponents(0, 1, 2);
+  vtkNew<vtkImageExtractComponents> addSubExtractAlpha;
+  addSubExtractAlpha->SetInputData(background.GetPointer());
+  addSubExtractAlpha->SetComponents(3);
+  vtkNew<vtkImageAppendComponents> addSubAppendRGBA;
+  addSubAppendRGBA->AddInputConnection(addSubExtractRGB->GetOutputPort());
+  addSubAppendRGBA->AddInputConnection(addSubExtractAlpha->GetOutputPort());
+  vtkNew<vtkImageBlend> addSubReferenceBlend;
+  addSubReferenceBlend->AddInputConnection(addSubAppendRGBA->GetOutputPort());
+  addSubReferenceBlend->AddInputData(label.GetPointer());
+  addSubReferenceBlend->SetOpacity(1, 0.75);
+
+  vtkNew<vtkImageLayerBlend> addSubLayerBlend;
+  addSubLayerBlend->AddInputData(background.GetPointer());
+  addSubLayerBlend->AddInputData(foreground.GetPointer());
+  addSubLayerBlend->AddInputData(label.GetPointer());
+  addSubLayerBlend->SetOpacity(2, 0.75);
+  for (int operation = vtkImageLayerBlend::FirstLayersAdd; operation <= vtkImageLayerBlend::FirstLayersSubtract; operation++)
+    {
+    if (operation == vtkImageLayerBlend::FirstLayersAdd)
+      {
+      addSubMath->SetOperationToAdd();
+      }
+    else
+      {
+      addSubMath->SetOperationToSubtract();
+      }
+    addSubLayerBlend->SetFirstLayersOperation(operation);
+    addSubReferenceBlend->Update();
+    addSubLayerBlend->Update();
+    if (!CompareImages(addSubReferenceBlend->GetOutput(), addSubLayerBlend->GetOutput(), __LINE__))
+      {
+      std::cerr << "Operation: " << operation << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Switching back to alpha blending gives the vtkImageBlend output again
+  layerBlend->Update();
+  referenceBlend->Update();
+  if (!CompareImages(referenceBlend->GetOutput(), layerBlend->GetOutput(), __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,678 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkCachedImageReslice.h"
+
+// VTK includes
+#include <vtkConditionVariable.h>
+#include <vtkDataArray.h>
+#include <vtkHomogeneousTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+#include <deque>
+#include <list>
+
+vtkStandardNewMacro(vtkCachedImageReslice);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Parameters that determine the output of the reslice filter
+struct SliceKey
+{
+  vtkImageData* Input; // only used for comparison, never dereferenced
+  vtkMTimeType InputMTime;
+  double Matrix[16];
+  int Extent[6];
+  double Spacing[3];
+  double Origin[3];
+  int InterpolationMode;
+  int OutputScalarType;
+  int GenerateStencilOutput;
+
+  /// Returns true if all parameters match, translation of the matrix is ignored
+  bool IsSameExceptTranslation(const SliceKey& other) const
+    {
+    if (this->Input != other.Input || this->InputMTime != other.InputMTime
+      || this->InterpolationMode != other.InterpolationMode
+      || this->OutputScalarType != other.OutputScalarType
+      || this->GenerateStencilOutput != other.GenerateStencilOutput)
+      {
+      return false;
+      }
+    for (int i = 0; i < 6; i++)
+      {
+      if (this->Extent[i] != other.Extent[i])
+        {
+        return false;
+        }
+      }
+    for (int i = 0; i < 3; i++)
+      {
+      if (this->Spacing[i] != other.Spacing[i] || this->Origin[i] != other.Origin[i])
+        {
+        return false;
+        }
+      }
+    for (int row = 0; row < 4; row++)
+      {
+      for (int column = 0; column < 3; column++)
+        {
+        if (fabs(this->Matrix[row * 4 + column] - other.Matrix[row * 4 + column]) > 1e-6)
+          {
+          return false;
+          }
+        }
+      }
+    return true;
+    }
+
+  bool IsSame(const SliceKey& other) const
+    {
+    return this->IsSameExceptTranslation(other)
+      && fabs(this->Matrix[3] - other.Matrix[3]) <= 1e-6
+      && fabs(this->Matrix[7] - other.Matrix[7]) <= 1e-6
+      && fabs(this->Matrix[11] - other.Matrix[11]) <= 1e-6;
+    }
+};
+
+//----------------------------------------------------------------------------
+struct CacheEntry
+{
+  SliceKey Key;
+  vtkSmartPointer<vtkImageData> Image;
+  vtkSmartPointer<vtkImageStencilData> Stencil;
+  bool Prefetched;
+};
+
+//----------------------------------------------------------------------------
+/// Slice computed on the prefetch thread. The request is created and deleted
+/// on the main thread, the prefetch thread only updates the reslice filter.
+struct PrefetchRequest
+{
+  SliceKey Key;
+  int Generation;
+  vtkSmartPointer<vtkImageReslice> Reslice;
+  /// Scalars of the input, referenced so that the voxel buffer read by the
+  /// prefetch thread is not freed while the request exists, even if the
+  /// input volume is replaced or deleted.
+  vtkSmartPointer<vtkDataArray> InputScalars;
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkCachedImageReslice::vtkInternal
+{
+public:
+  vtkInternal();
+  ~vtkInternal();
+
+  /// Get parameters of the current request. Returns false if the request cannot be cached.
+  bool GetSliceKey(vtkCachedImageReslice* self, vtkImageData* input, vtkInformation* outInfo, SliceKey& key);
+
+  /// Returns the cache entry matching the key (and moves it to the front), or NULL
+  CacheEntry* FindEntry(const SliceKey& key);
+  void AddEntry(const SliceKey& key, vtkImageData* image, vtkImageStencilData* stencil, bool prefetched);
+  void TrimCache(int size);
+
+  /// Move slices computed by the prefetch thread into the cache.
+  /// Returns the number of slices added to the cache.
+  int CollectPrefetchedSlices(int cacheSize);
+  /// Queue prefetch of slices next to the current slice in the scroll direction
+  void PrefetchNeighbors(vtkCachedImageReslice* self, vtkImageData* input, const SliceKey& key);
+  /// Remove all cached slices and discard pending and running prefetch requests.
+  /// Waits for the running prefetch request to complete.
+  void Clear();
+
+  void StartPrefetchThread();
+  void ProcessPrefetchRequests();
+  static VTK_THREAD_RETURN_TYPE PrefetchThreadFunction(void* arg);
+
+  std::list<CacheEntry> Entries;
+  SliceKey LastKey;
+  bool LastKeyValid;
+
+  // Members below are shared with the prefetch thread and protected by Lock
+  vtkNew<vtkMutexLock> Lock;
+  vtkNew<vtkConditionVariable> Condition;
+  std::deque<PrefetchRequest*> PendingRequests;
+  std::deque<PrefetchRequest*> CompletedRequests;
+  /// Request being computed by the prefetch thread, NULL if none
+  PrefetchRequest* RunningRequest;
+  bool TerminatePrefetch;
+
+  // Incremented when the cache is cleared, requests of earlier generations are discarded
+  int Generation;
+
+  vtkNew<vtkMultiThreader> MultiThreader;
+  int PrefetchThreadID;
+};
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::vtkInternal::vtkInternal()
+{
+  this->LastKeyValid = false;
+  this->RunningRequest = NULL;
+  this->TerminatePrefetch = false;
+  this->Generation = 0;
+  this->PrefetchThreadID = -1;
+}
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::vtkInternal::~vtkInternal()
+{
+  if (this->PrefetchThreadID >= 0)
+    {
+    this->Lock->Lock();
+    this->TerminatePrefetch = true;
+    this->Condition->Broadcast();
+    this->Lock->Unlock();
+    // waits for the running request to complete
+    this->MultiThreader->TerminateThread(this->PrefetchThreadID);
+    this->PrefetchThreadID = -1;
+    }
+  for (std::deque<PrefetchRequest*>::iterator it = this->PendingRequests.begin(); it != this->PendingRequests.end(); ++it)
+    {
+    delete *it;
+    }
+  for (std::deque<PrefetchRequest*>::iterator it = this->CompletedRequests.begin(); it != this->CompletedRequests.end(); ++it)
+    {
+    delete *it;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkCachedImageReslice::vtkInternal::GetSliceKey(vtkCachedImageReslice* self,
+  vtkImageData* input, vtkInformation* outInfo, SliceKey& key)
+{
+  vtkHomogeneousTransform* transform = vtkHomogeneousTransform::SafeDownCast(self->GetResliceTransform());
+  if (!input || self->GetResliceAxes() != NULL || (self->GetResliceTransform() != NULL && transform == NULL))
+    {
+    return false;
+    }
+  vtkNew<vtkMatrix4x4> matrix;
+  if (transform)
+    {
+    transform->GetMatrix(matrix.GetPointer());
+    }
+  for (int row = 0; row < 4; row++)
+    {
+    for (int column = 0; column < 4; column++)
+      {
+      key.Matrix[row * 4 + column] = matrix->GetElement(row, column);
+      }
+    }
+  key.Input = input;
+  key.InputMTime = input->GetMTime();
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), key.Extent);
+  outInfo->Get(vtkDataObject::SPACING(), key.Spacing);
+  outInfo->Get(vtkDataObject::ORIGIN(), key.Origin);
+  key.InterpolationMode = self->GetInterpolationMode();
+  key.OutputScalarType = self->GetOutputScalarType();
+  key.GenerateStencilOutput = self->GetGenerateStencilOutput();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+CacheEntry* vtkCachedImageReslice::vtkInternal::FindEntry(const SliceKey& key)
+{
+  for (std::list<CacheEntry>::iterator it = this->Entries.begin(); it != this->Entries.end(); ++it)
+    {
+    if (it->Key.IsSame(key))
+      {
+      // most recently used entry is kept at the front
+      this->Entries.splice(this->Entries.begin(), this->Entries, it);
+      return &this->Entries.front();
+      }
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::AddEntry(const SliceKey& key,
+  vtkImageData* image, vtkImageStencilData* stencil, bool prefetched)
+{
+  CacheEntry entry;
+  entry.Key = key;
+  entry.Image = image;
+  entry.Stencil = stencil;
+  entry.Prefetched = prefetched;
+  this->Entries.push_front(entry);
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::TrimCache(int size)
+{
+  while (static_cast<int>(this->Entries.size()) > size && !this->Entries.empty())
+    {
+    this->Entries.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkCachedImageReslice::vtkInternal::CollectPrefetchedSlices(int cacheSize)
+{
+  std::deque<PrefetchRequest*> completedRequests;
+  this->Lock->Lock();
+  completedRequests.swap(this->CompletedRequests);
+  this->Lock->Unlock();
+
+  int numberOfCollectedSlices = 0;
+  for (std::deque<PrefetchRequest*>::iterator it = completedRequests.begin(); it != completedRequests.end(); ++it)
+    {
+    PrefetchRequest* request = *it;
+    if (request->Generation == this->Generation && this->FindEntry(request->Key) == NULL)
+      {
+      vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+      image->ShallowCopy(request->Reslice->GetOutput());
+      vtkSmartPointer<vtkImageStencilData> stencil;
+      if (request->Key.GenerateStencilOutput)
+        {
+        stencil = vtkSmartPointer<vtkImageStencilData>::New();
+        stencil->ShallowCopy(request->Reslice->GetStencilOutput());
+        }
+      this->AddEntry(request->Key, image, stencil, true);
+      numberOfCollectedSlices++;
+      }
+    delete request;
+    }
+  this->TrimCache(cacheSize);
+  return numberOfCollectedSlices;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::PrefetchNeighbors(vtkCachedImageReslice* self,
+  vtkImageData* input, const SliceKey& key)
+{
+  if (this->LastKeyValid && this->LastKey.IsSame(key))
+    {
+    // same slice is requested again, keep prefetching in the current direction
+    return;
+    }
+  bool scrolling = false;
+  double step[3] = { 0.0, 0.0, 0.0 };
+  if (this->LastKeyValid && this->LastKey.IsSameExceptTranslation(key))
+    {
+    // Only prefetch if the slice moved along the output Z axis (slice offset change),
+    // not when the slice is panned
+    double axis[3] = { key.Matrix[2], key.Matrix[6], key.Matrix[10] };
+    step[0] = key.Matrix[3] - this->LastKey.Matrix[3];
+    step[1] = key.Matrix[7] - this->LastKey.Matrix[7];
+    step[2] = key.Matrix[11] - this->LastKey.Matrix[11];
+    double cross[3] =
+      {
+      step[1] * axis[2] - step[2] * axis[1],
+      step[2] * axis[0] - step[0] * axis[2],
+      step[0] * axis[1] - step[1] * axis[0]
+      };
+    double stepNorm = sqrt(step[0] * step[0] + step[1] * step[1] + step[2] * step[2]);
+    double axisNorm = sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    double crossNorm = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+    scrolling = (stepNorm > 1e-6 && crossNorm <= 1e-3 * stepNorm * axisNorm);
+    }
+  this->LastKey = key;
+  this->LastKeyValid = true;
+
+  this->Lock->Lock();
+  // requests that are not started yet may be in the wrong direction
+  std::deque<PrefetchRequest*> cancelledRequests;
+  cancelledRequests.swap(this->PendingRequests);
+  this->Lock->Unlock();
+  for (std::deque<PrefetchRequest*>::iterator it = cancelledRequests.begin(); it != cancelledRequests.end(); ++it)
+    {
+    delete *it;
+    }
+
+  vtkDataArray* scalars = input->GetPointData()->GetScalars();
+  if (!scrolling || self->GetNumberOfSlicesToPrefetch() <= 0
+    || !scalars || !scalars->HasStandardMemoryLayout())
+    {
+    return;
+    }
+
+  std::deque<PrefetchRequest*> newRequests;
+  for (int sliceIndex = 1; sliceIndex <= self->GetNumberOfSlicesToPrefetch(); sliceIndex++)
+    {
+    SliceKey neighborKey = key;
+    neighborKey.Matrix[3] += sliceIndex * step[0];
+    neighborKey.Matrix[7] += sliceIndex * step[1];
+    neighborKey.Matrix[11] += sliceIndex * step[2];
+    bool cached = false;
+    for (std::list<CacheEntry>::iterator it = this->Entries.begin(); it != this->Entries.end(); ++it)
+      {
+      if (it->Key.IsSame(neighborKey))
+        {
+        cached = true;
+        break;
+        }
+      }
+    if (cached)
+      {
+      continue;
+      }
+
+    // The prefetch thread gets its own image and scalar array objects that refer to the
+    // voxel buffer of the input, so that reference counts of objects that are used in the
+    // main thread are not modified on the prefetch thread. The request keeps a reference to
+    // the input scalars (taken and released on the main thread) so that the buffer outlives
+    // the request. Results computed while the input is modified are discarded, as the cache
+    // is cleared when the input modified time changes.
+    vtkSmartPointer<vtkDataArray> sharedScalars = vtkSmartPointer<vtkDataArray>::Take(scalars->NewInstance());
+    sharedScalars->SetNumberOfComponents(scalars->GetNumberOfComponents());
+    sharedScalars->SetVoidArray(scalars->GetVoidPointer(0),
+      scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents(), 1);
+    vtkNew<vtkImageData> sharedInput;
+    sharedInput->CopyStructure(input);
+    sharedInput->GetPointData()->SetScalars(sharedScalars);
+
+    vtkNew<vtkTransform> transform;
+    transform->SetMatrix(neighborKey.Matrix);
+
+    PrefetchRequest* request = new PrefetchRequest;
+    request->Key = neighborKey;
+    request->Generation = this->Generation;
+    request->InputScalars = scalars;
+    request->Reslice = vtkSmartPointer<vtkImageReslice>::New();
+    request->Reslice->SetInputData(sharedInput.GetPointer());
+    request->Reslice->SetResliceTransform(transform.GetPointer());
+    request->Reslice->SetInterpolationMode(self->GetInterpolationMode());
+    request->Reslice->SetOutputScalarType(self->GetOutputScalarType());
+    request->Reslice->SetBackgroundColor(self->GetBackgroundColor());
+    request->Reslice->SetWrap(self->GetWrap());
+    request->Reslice->SetMirror(self->GetMirror());
+    request->Reslice->SetBorder(self->GetBorder());
+    request->Reslice->SetOptimization(self->GetOptimization());
+    request->Reslice->SetOutputDimensionality(self->GetOutputDimensionality());
+    request->Reslice->SetOutputExtent(neighborKey.Extent);
+    request->Reslice->SetOutputSpacing(neighborKey.Spacing);
+    request->Reslice->SetOutputOrigin(neighborKey.Origin);
+    request->Reslice->SetGenerateStencilOutput(neighborKey.GenerateStencilOutput);
+    newRequests.push_back(request);
+    }
+  if (newRequests.empty())
+    {
+    return;
+    }
+
+  this->StartPrefetchThread();
+  this->Lock->Lock();
+  this->PendingRequests.insert(this->PendingRequests.end(), newRequests.begin(), newRequests.end());
+  this->Condition->Signal();
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::Clear()
+{
+  this->Entries.clear();
+  this->LastKeyValid = false;
+  this->Generation++;
+
+  std::deque<PrefetchRequest*> cancelledRequests;
+  this->Lock->Lock();
+  cancelledRequests.swap(this->PendingRequests);
+  // the input may be modified or released after the cache is cleared,
+  // the prefetch thread must not read it anymore
+  while (this->RunningRequest)
+    {
+    this->Condition->Wait(this->Lock.GetPointer());
+    }
+  cancelledRequests.insert(cancelledRequests.end(), this->CompletedRequests.begin(), this->CompletedRequests.end());
+  this->CompletedRequests.clear();
+  this->Lock->Unlock();
+  for (std::deque<PrefetchRequest*>::iterator it = cancelledRequests.begin(); it != cancelledRequests.end(); ++it)
+    {
+    delete *it;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::StartPrefetchThread()
+{
+  if (this->PrefetchThreadID >= 0)
+    {
+    return;
+    }
+  this->PrefetchThreadID = this->MultiThreader->SpawnThread(
+    (vtkThreadFunctionType) &vtkInternal::PrefetchThreadFunction, static_cast<void*>(this));
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkCachedImageReslice::vtkInternal::PrefetchThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkInternal* self = static_cast<vtkInternal*>(info->UserData);
+  self->ProcessPrefetchRequests();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::vtkInternal::ProcessPrefetchRequests()
+{
+  while (true)
+    {
+    this->Lock->Lock();
+    while (!this->TerminatePrefetch && this->PendingRequests.empty())
+      {
+      this->Condition->Wait(this->Lock.GetPointer());
+      }
+    if (this->TerminatePrefetch)
+      {
+      this->Lock->Unlock();
+      return;
+      }
+    PrefetchRequest* request = this->PendingRequests.front();
+    this->PendingRequests.pop_front();
+    this->RunningRequest = request;
+    this->Lock->Unlock();
+
+    request->Reslice->Update();
+
+    this->Lock->Lock();
+    this->RunningRequest = NULL;
+    this->CompletedRequests.push_back(request);
+    // wake up Clear() waiting for the running request
+    this->Condition->Broadcast();
+    this->Lock->Unlock();
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::vtkCachedImageReslice()
+{
+  this->CacheSize = 16;
+  this->NumberOfSlicesToPrefetch = 2;
+  this->Internal = new vtkInternal;
+  this->ResetStatistics();
+}
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::~vtkCachedImageReslice()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSize: " << this->CacheSize << "\n";
+  os << indent << "NumberOfSlicesToPrefetch: " << this->NumberOfSlicesToPrefetch << "\n";
+  os << indent << "NumberOfCachedSlices: " << this->Internal->Entries.size() << "\n";
+  os << indent << "NumberOfCacheHits: " << this->NumberOfCacheHits << "\n";
+  os << indent << "NumberOfCacheMisses: " << this->NumberOfCacheMisses << "\n";
+  os << indent << "NumberOfPrefetchHits: " << this->NumberOfPrefetchHits << "\n";
+  os << indent << "NumberOfPrefetchedSlices: " << this->NumberOfPrefetchedSlices << "\n";
+  os << indent << "LastRequestTime: " << this->LastRequestTime << "\n";
+  os << indent << "AverageHitTime: " << this->GetAverageHitTime() << "\n";
+  os << indent << "AverageMissTime: " << this->GetAverageMissTime() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::SetCacheSize(int size)
+{
+  size = (size < 0 ? 0 : size);
+  if (this->CacheSize == size)
+    {
+    return;
+    }
+  this->CacheSize = size;
+  if (size == 0)
+    {
+    this->Internal->Clear();
+    }
+  else
+    {
+    this->Internal->TrimCache(size);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::ClearCache()
+{
+  this->Internal->Clear();
+}
+
+//----------------------------------------------------------------------------
+int vtkCachedImageReslice::GetNumberOfCachedSlices()
+{
+  return static_cast<int>(this->Internal->Entries.size());
+}
+
+//----------------------------------------------------------------------------
+double vtkCachedImageReslice::GetCacheHitRate()
+{
+  int numberOfRequests = this->NumberOfCacheHits + this->NumberOfCacheMisses;
+  return (numberOfRequests > 0 ? double(this->NumberOfCacheHits) / numberOfRequests : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCachedImageReslice::GetAverageHitTime()
+{
+  return (this->NumberOfCacheHits > 0 ? this->TotalHitTime / this->NumberOfCacheHits : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCachedImageReslice::GetAverageMissTime()
+{
+  return (this->NumberOfCacheMisses > 0 ? this->TotalMissTime / this->NumberOfCacheMisses : 0.0);
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::ResetStatistics()
+{
+  this->NumberOfCacheHits = 0;
+  this->NumberOfCacheMisses = 0;
+  this->NumberOfPrefetchHits = 0;
+  this->NumberOfPrefetchedSlices = 0;
+  this->LastRequestTime = 0.0;
+  this->TotalHitTime = 0.0;
+  this->TotalMissTime = 0.0;
+}
+
+//----------------------------------------------------------------------------
+int vtkCachedImageReslice::RequestData(vtkInformation *request,
+                                       vtkInformationVector **inputVector,
+                                       vtkInformationVector *outputVector)
+{
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData* input = vtkImageData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkImageData* output = vtkImageData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  SliceKey key;
+  if (this->CacheSize <= 0 || !output || !this->Internal->GetSliceKey(this, input, outInfo, key))
+    {
+    int result = this->Superclass::RequestData(request, inputVector, outputVector);
+    this->LastRequestTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+    return result;
+    }
+
+  if (this->Internal->LastKeyValid
+    && (this->Internal->LastKey.Input != key.Input || this->Internal->LastKey.InputMTime != key.InputMTime))
+    {
+    // input image is modified, none of the cached slices are valid anymore
+    this->Internal->Clear();
+    }
+  this->NumberOfPrefetchedSlices += this->Internal->CollectPrefetchedSlices(this->CacheSize);
+
+  vtkImageStencilData* stencil = NULL;
+  if (this->GenerateStencilOutput)
+    {
+    stencil = vtkImageStencilData::SafeDownCast(
+      outputVector->GetInformationObject(1)->Get(vtkDataObject::DATA_OBJECT()));
+    }
+
+  int result = 1;
+  CacheEntry* entry = this->Internal->FindEntry(key);
+  if (entry)
+    {
+    output->DeepCopy(entry->Image);
+    if (stencil && entry->Stencil)
+      {
+      stencil->DeepCopy(entry->Stencil);
+      }
+    if (entry->Prefetched)
+      {
+      this->NumberOfPrefetchHits++;
+      entry->Prefetched = false;
+      }
+    }
+  else
+    {
+    result = this->Superclass::RequestData(request, inputVector, outputVector);
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    image->DeepCopy(output);
+    vtkSmartPointer<vtkImageStencilData> stencilCopy;
+    if (stencil)
+      {
+      stencilCopy = vtkSmartPointer<vtkImageStencilData>::New();
+      stencilCopy->DeepCopy(stencil);
+      }
+    this->Internal->AddEntry(key, image, stencilCopy, false);
+    this->Internal->TrimCache(this->CacheSize);
+    }
+
+  this->Internal->PrefetchNeighbors(this, input, key);
+
+  this->LastRequestTime = (vtkTimerLog::GetUniversalTime() - startTime) * 1000.0;
+  if (entry)
+    {
+    this->NumberOfCacheHits++;
+    this->TotalHitTime += this->LastRequestTime;
+    }
+  else
+    {
+    this->NumberOfCacheMisses++;
+    this->TotalMissTime += this->LastRequestTime;
+    }
+  return result;
+}
@@ -0,0 +1,117 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkCachedImageReslice_h
+#define __vtkCachedImageReslice_h
+
+#include "vtkMRMLLogicExport.h"
+
+// VTK includes
+#include <vtkImageReslice.h>
+
+/// \brief Image reslice filter that keeps recently computed slices.
+///
+/// Slice views recompute the resliced image each time the slice offset changes,
+/// even when the user scrolls back and forth over the same region. This filter
+/// keeps a bounded least-recently-used cache of output images (and stencil outputs)
+/// and copies a cached slice to the output instead of reslicing again if the
+/// input image, the reslice matrix, the output extent/spacing/origin, the output
+/// scalar type and the interpolation mode match.
+///
+/// When consecutive requests differ only by a translation along the output
+/// Z axis (slice offset change), the next NumberOfSlicesToPrefetch slices in the
+/// scroll direction are resliced on a background thread and added to the cache.
+///
+/// Only linear reslice transforms without reslice axes are cached, all other
+/// requests are processed by vtkImageReslice. Changing any other reslice parameter
+/// (background color, wrap, mirror, custom interpolator, ...) requires calling
+/// ClearCache().
+///
+/// Hit and miss counts and average request times are available for profiling.
+class VTK_MRML_LOGIC_EXPORT vtkCachedImageReslice : public vtkImageReslice
+{
+public:
+  static vtkCachedImageReslice *New();
+  vtkTypeMacro(vtkCachedImageReslice, vtkImageReslice);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  ///
+  /// Maximum number of slices kept in the cache. 0 disables caching and prefetching.
+  /// Default is 16.
+  void SetCacheSize(int size);
+  vtkGetMacro(CacheSize, int);
+
+  ///
+  /// Number of slices that are resliced in advance in the scroll direction.
+  /// 0 disables prefetching. Default is 2.
+  vtkSetClampMacro(NumberOfSlicesToPrefetch, int, 0, 64);
+  vtkGetMacro(NumberOfSlicesToPrefetch, int);
+
+  ///
+  /// Remove all cached slices and cancel pending prefetch requests.
+  void ClearCache();
+
+  ///
+  /// Number of slices currently in the cache
+  int GetNumberOfCachedSlices();
+
+  ///
+  /// Number of requests served from the cache and number of requests
+  /// that required reslicing
+  vtkGetMacro(NumberOfCacheHits, int);
+  vtkGetMacro(NumberOfCacheMisses, int);
+  /// Number of cache hits that were served by a prefetched slice
+  vtkGetMacro(NumberOfPrefetchHits, int);
+  /// Number of slices computed by the prefetcher
+  vtkGetMacro(NumberOfPrefetchedSlices, int);
+  /// Ratio of cache hits among cacheable requests, in the range [0, 1]
+  double GetCacheHitRate();
+
+  ///
+  /// Time in milliseconds spent in the last request
+  vtkGetMacro(LastRequestTime, double);
+  /// Average time in milliseconds of requests served from the cache
+  double GetAverageHitTime();
+  /// Average time in milliseconds of requests that required reslicing
+  double GetAverageMissTime();
+
+  ///
+  /// Set all counters and timers to zero
+  void ResetStatistics();
+
+protected:
+  vtkCachedImageReslice();
+  ~vtkCachedImageReslice();
+
+  virtual int RequestData(vtkInformation *request,
+                          vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector) VTK_OVERRIDE;
+
+  int CacheSize;
+  int NumberOfSlicesToPrefetch;
+
+  int NumberOfCacheHits;
+  int NumberOfCacheMisses;
+  int NumberOfPrefetchHits;
+  int NumberOfPrefetchedSlices;
+  double LastRequestTime;
+  double TotalHitTime;
+  double TotalMissTime;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkCachedImageReslice(const vtkCachedImageReslice&);  // Not implemented.
+  void operator=(const vtkCachedImageReslice&);  // Not implemented.
+};
+
+#endif
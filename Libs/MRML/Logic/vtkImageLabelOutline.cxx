@@ -20,6 +20,10 @@
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkVersion.h>
 
+// STD includes
+#include <algorithm>
+#include <vector>
+
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkImageLabelOutline);
 
@@ -45,81 +49,59 @@ vtkImageLabelOutline::~vtkImageLabelOutline()
 
 // Description:
 // This templated function executes the filter for any type of data.
-template <class T>
-static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
-                     vtkImageData *inData, T *inPtr,
+// A voxel is an outline voxel if it is not background and there is a voxel
+// with a different value (or the boundary of the input) within Outline
+// distance in the same slice.
+// Instead of visiting the neighborhood of each voxel, the comparisons are
+// done for a whole row with each neighbor offset at a time. These loops
+// contain no branches, so the compiler can vectorize them. The outline
+// thickness is a template parameter for the common thicknesses, so the
+// neighborhood loops are unrolled (Thickness = 0 means it is read at run time).
+template <class T, int Thickness>
+static void vtkImageLabelOutlineExecuteRows(vtkImageLabelOutline *self,
+                     vtkImageData *inData, T *vtkNotUsed(inPtr),
                      vtkImageData *outData,
                      int outExt[6], int id)
 {
-  int *kernelMiddle, *kernelSize;
-  // For looping though output (and input) pixels.
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  T *outPtr0, *outPtr1, *outPtr2;
-  // For looping through hood pixels
-  int hoodMin0, hoodMax0, hoodMin1, hoodMax1, hoodMin2, hoodMax2;
-  int hoodIdx0, hoodIdx1, hoodIdx2;
-  T *hoodPtr0, *hoodPtr1, *hoodPtr2;
+  const int outline = (Thickness > 0 ? Thickness : self->GetOutline());
+  const T backgroundLabelValue = (T)(self->GetBackground());
+
   // The extent of the whole input image
-  int inImageMin0, inImageMin1, inImageMin2;
-  int inImageMax0, inImageMax1, inImageMax2;
-  // Other
-  T backgroundLabelValue = (T)(self->GetBackground());
-  T inLabelValue;
-  T *outPtr = (T*)outData->GetScalarPointerForExtent(outExt);
-  unsigned long count = 0;
-  unsigned long target;
+  int inImageExt[6];
+  self->GetInputInformation()->Get(
+        vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inImageExt);
 
-  // Get information to march through data
+  // Single component input, so voxels of a row are contiguous
+  const vtkIdType inInc1 = inData->GetIncrements()[1];
 
-  inData->GetIncrements(inInc0, inInc1, inInc2);
-  int inExt[6];
-  self->GetInputInformation()->Get(
-        vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
-  inImageMin0 = inExt[0]; inImageMax0 = inExt[1];
-  inImageMin1 = inExt[2]; inImageMax1 = inExt[3];
-  inImageMin2 = inExt[4]; inImageMax2 = inExt[5];
-  outData->GetIncrements(outInc0, outInc1, outInc2);
-  outMin0 = outExt[0];   outMax0 = outExt[1];
-  outMin1 = outExt[2];   outMax1 = outExt[3];
-  outMin2 = outExt[4];   outMax2 = outExt[5];
-
-  // Neighborhood around current voxel
-  kernelSize = self->GetKernelSize();
-  kernelMiddle = self->GetKernelMiddle();
-  hoodMin0 = kernelMiddle[0] - kernelSize[0]/2; // truncate on purpose
-  hoodMin1 = kernelMiddle[1] - kernelSize[1]/2; // to round down odd sizes
-  hoodMin2 = kernelMiddle[2] - kernelSize[2]/2;
-  hoodMax0 = hoodMin0 + kernelSize[0];
-  hoodMax1 = hoodMin1 + kernelSize[1];
-  hoodMax2 = hoodMin2 + kernelSize[2];
-
-  int outline = self->GetOutline();
-  hoodMin0 = - outline;
-  hoodMin1 = - outline;
-  hoodMin2 = 0;
-  hoodMax0 = outline;
-  hoodMax1 = outline;
-  hoodMax2 = 0;
-
-  // in and out should be marching through corresponding pixels.
-  inPtr = (T *)(inData->GetScalarPointer(outMin0, outMin1, outMin2));
-
-  target = (unsigned long)((outMax2-outMin2+1)*(outMax1-outMin1+1)/50.0);
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  if (rowLength <= 0)
+    {
+    return;
+    }
+
+  // Voxels that are closer to the left/right boundary of the input than the
+  // outline thickness are always outline voxels, neighbors are only compared
+  // in the [firstInterior, lastInterior] range of the row.
+  const int firstInterior = std::max(0, inImageExt[0] + outline - outExt[0]);
+  const int lastInterior = std::min(rowLength - 1, inImageExt[1] - outline - outExt[0]);
+  std::vector<unsigned char> boundaryRow(rowLength, 0);
+  for (int i = 0; i < rowLength; i++)
+    {
+    boundaryRow[i] = (i < firstInterior || i > lastInterior) ? 1 : 0;
+    }
+  // differs[i] is nonzero if any neighbor of voxel i in the row has a different value
+  std::vector<unsigned char> differsRow(rowLength);
+  unsigned char* differs = &differsRow[0];
+
+  unsigned long count = 0;
+  unsigned long target = (unsigned long)((outExt[5]-outExt[4]+1)*(outExt[3]-outExt[2]+1)/50.0);
   target++;
 
-  // loop through pixels of output
-  outPtr2 = outPtr;
-  inPtr2 = inPtr;
-  for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
+  for (int outIdx2 = outExt[4]; outIdx2 <= outExt[5]; outIdx2++)
     {
-    outPtr1 = outPtr2;
-    inPtr1 = inPtr2;
-    for (outIdx1 = outMin1;
-      !self->AbortExecute && outIdx1 <= outMax1; outIdx1++)
+    for (int outIdx1 = outExt[2];
+      !self->AbortExecute && outIdx1 <= outExt[3]; outIdx1++)
       {
       if (!id)
         {
@@ -129,74 +111,70 @@ static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
           }
         count++;
         }
-      outPtr0 = outPtr1;
-      inPtr0 = inPtr1;
-      for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+      const T* center = static_cast<T*>(inData->GetScalarPointer(outExt[0], outIdx1, outIdx2));
+      T* out = static_cast<T*>(outData->GetScalarPointer(outExt[0], outIdx1, outIdx2));
+
+      if (outIdx1 - outline < inImageExt[2] || outIdx1 + outline > inImageExt[3])
         {
-        inLabelValue = *inPtr0;
-        // Default output equal to backgroundLabelValue
-        // on the assumption this is not an outline pixel
-        *outPtr0 = backgroundLabelValue;
-
-        // look at neighborhood around non-background
-        // pixels to see if there is a transition.
-        // If there is, then this is an outline pixel
-        if (inLabelValue != backgroundLabelValue)
+        // neighborhood reaches outside of the input domain in the row direction,
+        // so all non-background voxels of this row are outline voxels
+        std::fill(differsRow.begin(), differsRow.end(), 1);
+        }
+      else
+        {
+        std::copy(boundaryRow.begin(), boundaryRow.end(), differsRow.begin());
+        for (int hoodIdx1 = -outline; hoodIdx1 <= outline; ++hoodIdx1)
           {
-          // Loop through neighborhood pixels
-          // Note: hood pointer marches out of bounds.
-          // start at lower left pixel
-          hoodPtr2 = inPtr0 + hoodMin0 * inInc0
-                            + hoodMin1 * inInc1
-                            + hoodMin2 * inInc2;
-
-          for (hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
+          const T* hoodRow = center + hoodIdx1 * inInc1;
+          for (int hoodIdx0 = -outline; hoodIdx0 <= outline; ++hoodIdx0)
             {
-            hoodPtr1 = hoodPtr2;
-            for (hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1; ++hoodIdx1)
+            if (hoodIdx0 == 0 && hoodIdx1 == 0)
+              {
+              continue;
+              }
+            const T* neighbor = hoodRow + hoodIdx0;
+            for (int i = firstInterior; i <= lastInterior; ++i)
               {
-              hoodPtr0 = hoodPtr1;
-              for (hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
-                {
-                // handle boundaries
-                if (outIdx0 + hoodIdx0 >= inImageMin0 &&
-                    outIdx0 + hoodIdx0 <= inImageMax0 &&
-                    outIdx1 + hoodIdx1 >= inImageMin1 &&
-                    outIdx1 + hoodIdx1 <= inImageMax1 &&
-                    outIdx2 + hoodIdx2 >= inImageMin2 &&
-                    outIdx2 + hoodIdx2 <= inImageMax2)
-                  {
-                  // If the neighbor value is not the same label value
-                  // that means this is an outline pixel
-                  // (border is within neighborhood).
-                  // so set the output to foreground
-                  if (*hoodPtr0 != inLabelValue)
-                    {
-                    *outPtr0 = inLabelValue;
-                    }
-                  }
-                else
-                  {
-                  // neighborhood reaches outside of the input
-                  // domain, so this is also an outline pixel
-                  *outPtr0 = inLabelValue;
-                  }
-                hoodPtr0 += inInc0;
-                }//for0
-              hoodPtr1 += inInc1;
-              }//for1
-            hoodPtr2 += inInc2;
-            }//for2
-          }//if
-        inPtr0 += inInc0;
-        outPtr0 += outInc0;
-        }//for0
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
-      }//for1
-    inPtr2 += inInc2;
-    outPtr2 += outInc2;
-    }//for2
+              differs[i] |= static_cast<unsigned char>(neighbor[i] != center[i]);
+              }
+            }
+          }
+        }
+
+      // Default output equal to backgroundLabelValue
+      // on the assumption this is not an outline pixel
+      for (int i = 0; i < rowLength; ++i)
+        {
+        out[i] = (differs[i] && center[i] != backgroundLabelValue) ? center[i] : backgroundLabelValue;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Description:
+// Selects the template instance for the outline thickness.
+template <class T>
+static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
+                     vtkImageData *inData, T *inPtr,
+                     vtkImageData *outData,
+                     int outExt[6], int id)
+{
+  switch (self->GetOutline())
+    {
+  case 1:
+    vtkImageLabelOutlineExecuteRows<T, 1>(self, inData, inPtr, outData, outExt, id);
+    break;
+  case 2:
+    vtkImageLabelOutlineExecuteRows<T, 2>(self, inData, inPtr, outData, outExt, id);
+    break;
+  case 3:
+    vtkImageLabelOutlineExecuteRows<T, 3>(self, inData, inPtr, outData, outExt, id);
+    break;
+  default:
+    vtkImageLabelOutlineExecuteRows<T, 0>(self, inData, inPtr, outData, outExt, id);
+    break;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,248 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageLayerBlend.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <cstring>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageLayerBlend);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Add or subtract RGB of the foreground to/from the background, alpha is taken
+/// from the background
+void AddSubtractRow(const unsigned char* background, int backgroundComponents,
+  const unsigned char* foreground, int foregroundComponents,
+  unsigned char* out, int outComponents, int rowLength, bool subtract)
+{
+  const int sign = subtract ? -1 : 1;
+  for (int x = 0; x < rowLength; x++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      int value = background[c] + sign * foreground[c];
+      out[c] = static_cast<unsigned char>(value < 0 ? 0 : (value > 255 ? 255 : value));
+      }
+    if (outComponents == 4)
+      {
+      out[3] = (backgroundComponents == 4 ? background[3] : 255);
+      }
+    background += backgroundComponents;
+    foreground += foregroundComponents;
+    out += outComponents;
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Blend RGBA input over the output, same arithmetic as vtkImageBlend
+void BlendRGBARow(const unsigned char* in, unsigned char* out, int outComponents,
+  int rowLength, unsigned short opacity)
+{
+  for (int x = 0; x < rowLength; x++)
+    {
+    // multiply to get a number in the range [0,65280]
+    // where 65280 = 255*256 = range of in[3] * range of opacity
+    unsigned short r = static_cast<unsigned short>(in[3] * opacity);
+    unsigned short f = static_cast<unsigned short>(65280 - r);
+    out[0] = static_cast<unsigned char>((out[0] * f + in[0] * r) >> 16);
+    out[1] = static_cast<unsigned char>((out[1] * f + in[1] * r) >> 16);
+    out[2] = static_cast<unsigned char>((out[2] * f + in[2] * r) >> 16);
+    in += 4;
+    out += outComponents;
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Blend RGB input over the output, same arithmetic as vtkImageBlend
+void BlendRGBRow(const unsigned char* in, unsigned char* out, int outComponents,
+  int rowLength, unsigned short opacity)
+{
+  const unsigned short r = opacity;
+  const unsigned short f = static_cast<unsigned short>(256 - opacity);
+  for (int x = 0; x < rowLength; x++)
+    {
+    out[0] = static_cast<unsigned char>((out[0] * f + in[0] * r) >> 8);
+    out[1] = static_cast<unsigned char>((out[1] * f + in[1] * r) >> 8);
+    out[2] = static_cast<unsigned char>((out[2] * f + in[2] * r) >> 8);
+    in += 3;
+    out += outComponents;
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageLayerBlend::vtkImageLayerBlend()
+{
+  this->FirstLayersOperation = FirstLayersBlend;
+  this->GenerateWholeExtent = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlend::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FirstLayersOperation: " << this->FirstLayersOperation << "\n";
+  os << indent << "GenerateWholeExtent: " << (this->GenerateWholeExtent ? "On" : "Off") << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLayerBlend::RequestUpdateExtent(vtkInformation *request,
+                                            vtkInformationVector **inputVector,
+                                            vtkInformationVector *outputVector)
+{
+  if (this->GenerateWholeExtent)
+    {
+    // The executive only gets here if the current output does not contain the
+    // requested extent. Enlarge the request so that the inputs are updated and
+    // the output is allocated and blended for the whole extent at once.
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), wholeExtent, 6);
+    }
+  return this->Superclass::RequestUpdateExtent(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLayerBlend::CanBlendInSinglePass(vtkImageData ***inData, vtkImageData* outData, const int extent[6])
+{
+  if (this->GetBlendMode() != VTK_IMAGE_BLEND_MODE_NORMAL || this->GetStencil() != NULL)
+    {
+    return false;
+    }
+  int numberOfInputs = this->GetNumberOfInputConnections(0);
+  if (numberOfInputs < 1 || !outData || outData->GetScalarType() != VTK_UNSIGNED_CHAR)
+    {
+    return false;
+    }
+  int outComponents = outData->GetNumberOfScalarComponents();
+  for (int inputIndex = 0; inputIndex < numberOfInputs; inputIndex++)
+    {
+    vtkImageData* input = inData[0][inputIndex];
+    if (!input || input->GetScalarType() != VTK_UNSIGNED_CHAR)
+      {
+      return false;
+      }
+    int inComponents = input->GetNumberOfScalarComponents();
+    if ((inComponents != 3 && inComponents != 4)
+      || (inputIndex == 0 && inComponents != outComponents))
+      {
+      return false;
+      }
+    int inExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    input->GetExtent(inExtent);
+    for (int axis = 0; axis < 3; axis++)
+      {
+      if (inExtent[2 * axis] > extent[2 * axis] || inExtent[2 * axis + 1] < extent[2 * axis + 1])
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlend::ThreadedRequestData(
+  vtkInformation* request,
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector,
+  vtkImageData*** inData,
+  vtkImageData** outData,
+  int outExt[6], int threadId)
+{
+  if (!this->CanBlendInSinglePass(inData, outData[0], outExt))
+    {
+    if (this->FirstLayersOperation != FirstLayersBlend)
+      {
+      vtkErrorMacro("ThreadedRequestData: add and subtract are only supported for unsigned char RGB(A) inputs"
+        " in normal blend mode without stencil, layers are alpha blended instead");
+      }
+    this->Superclass::ThreadedRequestData(request, inputVector, outputVector, inData, outData, outExt, threadId);
+    return;
+    }
+
+  const int numberOfInputs = this->GetNumberOfInputConnections(0);
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  vtkImageData* output = outData[0];
+  const int outComponents = output->GetNumberOfScalarComponents();
+  vtkIdType outIncrements[3] = { 0, 0, 0 };
+  output->GetIncrements(outIncrements);
+  unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointerForExtent(outExt));
+
+  std::vector<const unsigned char*> inPtrs(numberOfInputs);
+  std::vector<vtkIdType> inIncrements(3 * numberOfInputs);
+  std::vector<int> inComponents(numberOfInputs);
+  std::vector<unsigned short> opacities(numberOfInputs);
+  for (int inputIndex = 0; inputIndex < numberOfInputs; inputIndex++)
+    {
+    vtkImageData* input = inData[0][inputIndex];
+    inPtrs[inputIndex] = static_cast<unsigned char*>(input->GetScalarPointerForExtent(outExt));
+    input->GetIncrements(&inIncrements[3 * inputIndex]);
+    inComponents[inputIndex] = input->GetNumberOfScalarComponents();
+    // round opacity to a value in the range [0,256], because division
+    // by 256 can be efficiently achieved by bit-shifting by 8 bits
+    double opacity = this->GetOpacity(inputIndex);
+    opacity = (opacity < 0.0 ? 0.0 : (opacity > 1.0 ? 1.0 : opacity));
+    opacities[inputIndex] = static_cast<unsigned short>(256 * opacity + 0.5);
+    }
+
+  const bool addSubtract = (this->FirstLayersOperation != FirstLayersBlend && numberOfInputs >= 2);
+  const int firstBlendedInput = (addSubtract ? 2 : 1);
+
+  for (int z = outExt[4]; z <= outExt[5]; z++)
+    {
+    for (int y = outExt[2]; y <= outExt[3]; y++)
+      {
+      unsigned char* outRow = outPtr + (y - outExt[2]) * outIncrements[1] + (z - outExt[4]) * outIncrements[2];
+      const unsigned char* firstRow = inPtrs[0]
+        + (y - outExt[2]) * inIncrements[1] + (z - outExt[4]) * inIncrements[2];
+      if (addSubtract)
+        {
+        const unsigned char* secondRow = inPtrs[1]
+          + (y - outExt[2]) * inIncrements[4] + (z - outExt[4]) * inIncrements[5];
+        AddSubtractRow(firstRow, inComponents[0], secondRow, inComponents[1], outRow, outComponents,
+          rowLength, this->FirstLayersOperation == FirstLayersSubtract);
+        }
+      else
+        {
+        // opacity of the first input is ignored
+        memcpy(outRow, firstRow, rowLength * outComponents);
+        }
+      for (int inputIndex = firstBlendedInput; inputIndex < numberOfInputs; inputIndex++)
+        {
+        const unsigned char* inRow = inPtrs[inputIndex]
+          + (y - outExt[2]) * inIncrements[3 * inputIndex + 1]
+          + (z - outExt[4]) * inIncrements[3 * inputIndex + 2];
+        if (inComponents[inputIndex] == 4)
+          {
+          BlendRGBARow(inRow, outRow, outComponents, rowLength, opacities[inputIndex]);
+          }
+        else
+          {
+          BlendRGBRow(inRow, outRow, outComponents, rowLength, opacities[inputIndex]);
+          }
+        }
+      }
+    }
+}
@@ -0,0 +1,99 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageLayerBlend_h
+#define __vtkImageLayerBlend_h
+
+#include "vtkMRMLLogicExport.h"
+
+// VTK includes
+#include <vtkImageBlend.h>
+
+/// \brief Blend slice view layers in a single pass.
+///
+/// Blends RGB(A) unsigned char layers the same way as vtkImageBlend in normal
+/// blend mode (alpha blending with the integer arithmetic of vtkImageBlend,
+/// opacity of the first input is ignored), but all layers are combined while
+/// a row of the output is in the cache instead of traversing the whole output
+/// image once per layer.
+///
+/// Optionally the first two inputs (background and foreground) are added or
+/// subtracted before the remaining layers are blended on top. This replaces the
+/// cast/mathematics/extract/append filter chain that was needed for add and subtract
+/// compositing with vtkImageBlend: RGB components are clamped to [0, 255] and
+/// alpha is taken from the first input. Opacity of the second input is ignored
+/// in this case.
+///
+/// Inputs that are not unsigned char RGB(A) images covering the whole output extent,
+/// stencils and compound blend mode are processed by vtkImageBlend.
+///
+/// If GenerateWholeExtent is enabled, the whole output extent is computed even
+/// if only part of it is requested. Lightbox views request the slab of tiles one
+/// slice at a time; computing the whole slab at the first request lets the
+/// upstream reslice and display filters process all tiles in a single multithreaded
+/// pass, and the requests of the remaining tiles are served from the output.
+class VTK_MRML_LOGIC_EXPORT vtkImageLayerBlend : public vtkImageBlend
+{
+public:
+  static vtkImageLayerBlend *New();
+  vtkTypeMacro(vtkImageLayerBlend, vtkImageBlend);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  enum
+    {
+    FirstLayersBlend = 0,
+    FirstLayersAdd,
+    FirstLayersSubtract
+    };
+
+  ///
+  /// Set how the first two inputs are combined: alpha blending (default),
+  /// addition or subtraction (first input minus second input).
+  vtkSetClampMacro(FirstLayersOperation, int, FirstLayersBlend, FirstLayersSubtract);
+  vtkGetMacro(FirstLayersOperation, int);
+  void SetFirstLayersOperationToBlend() { this->SetFirstLayersOperation(FirstLayersBlend); };
+  void SetFirstLayersOperationToAdd() { this->SetFirstLayersOperation(FirstLayersAdd); };
+  void SetFirstLayersOperationToSubtract() { this->SetFirstLayersOperation(FirstLayersSubtract); };
+
+  ///
+  /// Compute the whole output extent for any requested extent.
+  /// Default is off.
+  vtkSetMacro(GenerateWholeExtent, bool);
+  vtkGetMacro(GenerateWholeExtent, bool);
+  vtkBooleanMacro(GenerateWholeExtent, bool);
+
+protected:
+  vtkImageLayerBlend();
+  ~vtkImageLayerBlend() {};
+
+  virtual int RequestUpdateExtent(vtkInformation *request,
+                                  vtkInformationVector **inputVector,
+                                  vtkInformationVector *outputVector) VTK_OVERRIDE;
+
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int extent[6], int threadId) VTK_OVERRIDE;
+
+  /// Returns true if all inputs can be blended in a single pass
+  bool CanBlendInSinglePass(vtkImageData ***inData, vtkImageData* outData, const int extent[6]);
+
+  int FirstLayersOperation;
+  bool GenerateWholeExtent;
+
+private:
+  vtkImageLayerBlend(const vtkImageLayerBlend&);  // Not implemented.
+  void operator=(const vtkImageLayerBlend&);  // Not implemented.
+};
+
+#endif
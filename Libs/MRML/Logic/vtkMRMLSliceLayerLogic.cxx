@@ -13,6 +13,7 @@
 =========================================================================auto=*/
 
 // MRMLLogic includes
+#include "vtkCachedImageReslice.h"
 #include "vtkMRMLSliceLayerLogic.h"
 
 // MRML includes
@@ -121,7 +122,7 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->AssignAttributeScalarsToTensorsUVW->Assign(vtkDataSetAttributes::SCALARS, vtkDataSetAttributes::TENSORS, vtkAssignAttribute::POINT_DATA);
 
   // Create the parts for the scalar layer pipeline
-  this->Reslice = vtkImageReslice::New();
+  this->Reslice = vtkCachedImageReslice::New();
   this->ResliceUVW = vtkImageReslice::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
@@ -315,6 +316,10 @@ void vtkMRMLSliceLayerLogic::SetVolumeNode(vtkMRMLVolumeNode *volumeNode)
   events->InsertNextValue(vtkCommand::ModifiedEvent);
   vtkSetAndObserveMRMLNodeEventsMacro(this->VolumeNode, volumeNode, events.GetPointer());
 
+  // Slices of the previous volume are not needed anymore, this also waits for
+  // the slice being prefetched and releases the previous voxels
+  this->Reslice->ClearCache();
+
   // Update the reslice transform to move this image into XY
   this->UpdateTransforms();
   this->UpdateImageDisplay();
@@ -48,6 +48,7 @@
 #include <vtkVersion.h>
 
 class vtkAssignAttribute;
+class vtkCachedImageReslice;
 class vtkImageReslice;
 class vtkGeneralTransform;
 
@@ -85,8 +86,10 @@ public:
   void SetSliceNode (vtkMRMLSliceNode *SliceNode);
 
   ///
-  /// The image reslice or slice being used
-  vtkGetObjectMacro (Reslice, vtkImageReslice);
+  /// The image reslice or slice being used.
+  /// Reslice keeps recently resliced slices and prefetches neighbor slices
+  /// while scrolling, its cache hit rate and timings can be used for profiling.
+  vtkGetObjectMacro (Reslice, vtkCachedImageReslice);
   vtkGetObjectMacro (ResliceUVW, vtkImageReslice);
 
   ///
@@ -166,7 +169,7 @@ protected:
 
   ///
   /// the VTK class instances that implement this Logic's operations
-  vtkImageReslice *Reslice;
+  vtkCachedImageReslice *Reslice;
   vtkImageReslice *ResliceUVW;
   vtkImageLabelOutline *LabelOutline;
   vtkImageLabelOutline *LabelOutlineUVW;
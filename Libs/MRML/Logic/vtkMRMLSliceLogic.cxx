@@ -15,6 +15,7 @@
 // MRMLLogic includes
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLSliceLayerLogic.h"
+#include "vtkImageLayerBlend.h"
 
 // MRML includes
 #include <vtkEventBroker.h>
@@ -32,12 +33,8 @@
 #include <vtkAlgorithmOutput.h>
 #include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
-#include <vtkImageAppendComponents.h>
-#include <vtkImageBlend.h>
 #include <vtkImageResample.h>
-#include <vtkImageCast.h>
 #include <vtkImageData.h>
-#include <vtkImageMathematics.h>
 #include <vtkImageReslice.h>
 #include <vtkImageThreshold.h>
 #include <vtkInformation.h>
@@ -89,38 +86,18 @@ struct BlendPipeline
     //
     // Add, Subtract:
     //
-    //   Casting is needed to avoid overflow during adding (or subtracting).
+    //   Blend adds/subtracts the first two layers (background and foreground)
+    //   and uses the background's alpha channel in the output, in the same pass
+    //   as the remaining layers are alpha blended.
     //
-    //   AddSubMath adds/subtracts alpha channel, therefore we copy RGB and alpha
-    //   components and copy of the background's alpha channel to the output.
-    //   Splitting and appending channels is probably quite inefficient, but there does not
-    //   seem to be simpler pipeline to do this in VTK.
-    //
-    //   foreground > AddSubForegroundCast \
-    //                                      > AddSubMath > AddSubOutputCast ...
-    //   background > AddSubBackroundCast  /
-    //
-    //
-    //     ... AddSubOutputCast > AddSubExtractRGB \
-    //                                              > AddSubAppendRGBA > Blend
-    //             background > AddSubExtractAlpha /
+    //   foreground \
+    //               > Blend (FirstLayersOperation: Add or Subtract)
+    //   background /
     */
 
-    this->AddSubForegroundCast->SetOutputScalarTypeToShort();
-    this->AddSubBackgroundCast->SetOutputScalarTypeToShort();
-    this->AddSubMath->SetOperationToAdd();
-    this->AddSubMath->SetInputConnection(0, this->AddSubBackgroundCast->GetOutputPort());
-    this->AddSubMath->SetInputConnection(1, this->AddSubForegroundCast->GetOutputPort());
-    this->AddSubOutputCast->SetInputConnection(this->AddSubMath->GetOutputPort());
-
-    this->AddSubExtractRGB->SetInputConnection(this->AddSubOutputCast->GetOutputPort());
-    this->AddSubExtractRGB->SetComponents(0, 1, 2);
-    this->AddSubExtractAlpha->SetComponents(3);
-    this->AddSubAppendRGBA->AddInputConnection(this->AddSubExtractRGB->GetOutputPort());
-    this->AddSubAppendRGBA->AddInputConnection(this->AddSubExtractAlpha->GetOutputPort());
-
-    this->AddSubOutputCast->SetOutputScalarTypeToUnsignedChar();
-    this->AddSubOutputCast->ClampOverflowOn();
+    // In lightbox mode the slab of all tiles is resliced, mapped and blended
+    // in one pass instead of re-executing the pipeline for each tile.
+    this->Blend->GenerateWholeExtentOn();
   }
 
   void AddLayers(std::deque<SliceLayerInfo>& layers, int sliceCompositing,
@@ -139,6 +116,7 @@ struct BlendPipeline
 
     if (sliceCompositing == vtkMRMLSliceCompositeNode::Alpha)
       {
+      this->Blend->SetFirstLayersOperationToBlend();
       if (backgroundImagePort)
         {
         layers.push_back(SliceLayerInfo(backgroundImagePort, 1.0));
@@ -150,6 +128,7 @@ struct BlendPipeline
       }
     else if (sliceCompositing == vtkMRMLSliceCompositeNode::ReverseAlpha)
       {
+      this->Blend->SetFirstLayersOperationToBlend();
       if (foregroundImagePort)
         {
         layers.push_back(SliceLayerInfo(foregroundImagePort, 1.0));
@@ -161,18 +140,16 @@ struct BlendPipeline
       }
     else
       {
-      this->AddSubForegroundCast->SetInputConnection(foregroundImagePort);
-      this->AddSubBackgroundCast->SetInputConnection(backgroundImagePort);
-      this->AddSubExtractAlpha->SetInputConnection(backgroundImagePort);
       if (sliceCompositing == vtkMRMLSliceCompositeNode::Add)
         {
-        this->AddSubMath->SetOperationToAdd();
+        this->Blend->SetFirstLayersOperationToAdd();
         }
       else
         {
-        this->AddSubMath->SetOperationToSubtract();
+        this->Blend->SetFirstLayersOperationToSubtract();
         }
-      layers.push_back(SliceLayerInfo(this->AddSubAppendRGBA->GetOutputPort(), 1.0));
+      layers.push_back(SliceLayerInfo(backgroundImagePort, 1.0));
+      layers.push_back(SliceLayerInfo(foregroundImagePort, 1.0));
       }
 
     // always blending the label layer
@@ -182,14 +159,7 @@ struct BlendPipeline
       }
   }
 
-  vtkNew<vtkImageCast> AddSubForegroundCast;
-  vtkNew<vtkImageCast> AddSubBackgroundCast;
-  vtkNew<vtkImageMathematics> AddSubMath;
-  vtkNew<vtkImageExtractComponents> AddSubExtractRGB;
-  vtkNew<vtkImageExtractComponents> AddSubExtractAlpha;
-  vtkNew<vtkImageAppendComponents> AddSubAppendRGBA;
-  vtkNew<vtkImageCast> AddSubOutputCast;
-  vtkNew<vtkImageBlend> Blend;
+  vtkNew<vtkImageLayerBlend> Blend;
 };
 
 //----------------------------------------------------------------------------
@@ -1098,12 +1068,20 @@ void vtkMRMLSliceLogic::UpdatePipeline()
     std::deque<SliceLayerInfo> layers;
     std::deque<SliceLayerInfo> layersUVW;
 
+    // compositing mode change may only modify the blend operation but not the inputs
+    vtkMTimeType oldBlendMTime = this->Pipeline->Blend->GetMTime();
+    vtkMTimeType oldBlendMTimeUVW = this->PipelineUVW->Blend->GetMTime();
     this->Pipeline->AddLayers(layers, this->SliceCompositeNode->GetCompositing(),
       backgroundImagePort, foregroundImagePort, this->SliceCompositeNode->GetForegroundOpacity(),
       labelImagePort, this->SliceCompositeNode->GetLabelOpacity());
     this->PipelineUVW->AddLayers(layersUVW, this->SliceCompositeNode->GetCompositing(),
       backgroundImagePortUVW, foregroundImagePortUVW, this->SliceCompositeNode->GetForegroundOpacity(),
       labelImagePortUVW, this->SliceCompositeNode->GetLabelOpacity());
+    if (this->Pipeline->Blend->GetMTime() > oldBlendMTime
+      || this->PipelineUVW->Blend->GetMTime() > oldBlendMTimeUVW)
+      {
+      modified = 1;
+      }
 
     if (this->UpdateBlendLayers(this->Pipeline->Blend.GetPointer(), layers))
       {
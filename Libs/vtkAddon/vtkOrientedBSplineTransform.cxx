@@ -12,9 +12,12 @@
 #include "vtkImageData.h"
 #include "vtkMath.h"
 #include "vtkMatrix4x4.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkOrientedBSplineTransform);
 
@@ -492,3 +495,283 @@ vtkAbstractTransform *vtkOrientedBSplineTransform::MakeTransform()
 {
   return vtkOrientedBSplineTransform::New();
 }
+
+//----------------------------------------------------------------------------
+// Cubic b-spline weights of the 4 coefficients around a point (at offsets
+// -1, 0, 1, 2 from the coefficient below the point), f is the fractional
+// position of the point between the coefficients.
+inline void vtkOrientedBSplineTransformWeights(double w[4], double f)
+{
+  const double sixth = 1.0/6.0;
+  double f2 = f*f;
+  w[3] = f2*f*sixth;
+  w[0] = (f2 - f)*0.5 - w[3] + sixth;
+  w[2] = f + w[0] - w[3]*2;
+  w[1] = 1 - w[0] - w[2] - w[3];
+}
+
+//----------------------------------------------------------------------------
+// Spline weights and coefficient offsets along one b-spline grid axis, for each
+// index along the resampling grid axis that the b-spline axis is aligned with.
+struct vtkOrientedBSplineTransformAxisTable
+{
+  int FirstIndex;
+  std::vector<double> Weights; // 4 values per index
+  std::vector<vtkIdType> Offsets; // 4 values per index
+
+  void Compute(double scale, double shift, int firstIndex, int lastIndex,
+    int gridMinIndex, int gridMaxIndex, vtkIdType gridIncrement, int borderMode)
+  {
+    this->FirstIndex = firstIndex;
+    int numberOfIndices = lastIndex - firstIndex + 1;
+    this->Weights.resize(4 * numberOfIndices);
+    this->Offsets.resize(4 * numberOfIndices);
+    for (int n = 0; n < numberOfIndices; n++)
+      {
+      double position = scale * (firstIndex + n) + shift;
+      double floorPosition = floor(position);
+      double* weights = &this->Weights[4 * n];
+      vtkOrientedBSplineTransformWeights(weights, position - floorPosition);
+      int firstCoefficientIndex = static_cast<int>(floorPosition) - 1;
+      for (int m = 0; m < 4; m++)
+        {
+        int coefficientIndex = firstCoefficientIndex + m;
+        if (coefficientIndex < gridMinIndex || coefficientIndex > gridMaxIndex)
+          {
+          if (borderMode != VTK_BSPLINE_EDGE)
+            {
+            // coefficients beyond the edge are zero
+            weights[m] = 0.0;
+            }
+          coefficientIndex = (coefficientIndex < gridMinIndex ? gridMinIndex : gridMaxIndex);
+          }
+        this->Offsets[4 * n + m] = (coefficientIndex - gridMinIndex) * gridIncrement;
+        }
+      }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Computes displacements for a range of slices of the output grid.
+// If axis tables are available then the spline weights of the two axes that
+// are constant along a row are combined once per row, so for each point only
+// the weights along the row have to be applied. Otherwise each point is
+// transformed separately.
+class vtkOrientedBSplineTransform::vtkDisplacementsOnGridWorker
+{
+public:
+  vtkDisplacementsOnGridWorker(vtkOrientedBSplineTransform* transform,
+    vtkMatrix4x4* ijkToInput, vtkImageData* displacementGrid)
+    : Transform(transform)
+    , DisplacementGrid(displacementGrid)
+    , UseAxisTables(false)
+    , GridScalarType(VTK_VOID)
+  {
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->IjkToInput[row][col] = ijkToInput->GetElement(row, col);
+        }
+      }
+    displacementGrid->GetExtent(this->Extent);
+  }
+
+  // Precompute spline weights if the output grid axes are aligned with the b-spline grid axes
+  void ComputeAxisTables(vtkMatrix4x4* ijkToInput, int gridScalarType)
+  {
+    vtkOrientedBSplineTransform* transform = this->Transform;
+    if (transform->GetInverseFlag() || !transform->GridPointer
+      || transform->BorderMode == VTK_BSPLINE_ZERO_AT_BORDER
+      || (gridScalarType != VTK_FLOAT && gridScalarType != VTK_DOUBLE))
+      {
+      return;
+      }
+    vtkNew<vtkMatrix4x4> ijkToGridIndex;
+    vtkMatrix4x4::Multiply4x4(transform->OutputToGridIndexTransformMatrixCached, ijkToInput, ijkToGridIndex.GetPointer());
+    bool ijkAxisUsed[3] = { false, false, false };
+    int gridAxisForIjkAxis[3] = { -1, -1, -1 };
+    for (int gridAxis = 0; gridAxis < 3; gridAxis++)
+      {
+      int alignedIjkAxis = -1;
+      double maxElement = 0.0;
+      for (int ijkAxis = 0; ijkAxis < 3; ijkAxis++)
+        {
+        double element = fabs(ijkToGridIndex->GetElement(gridAxis, ijkAxis));
+        if (element > maxElement)
+          {
+          maxElement = element;
+          alignedIjkAxis = ijkAxis;
+          }
+        }
+      if (alignedIjkAxis < 0 || ijkAxisUsed[alignedIjkAxis])
+        {
+        return;
+        }
+      for (int ijkAxis = 0; ijkAxis < 3; ijkAxis++)
+        {
+        if (ijkAxis != alignedIjkAxis && fabs(ijkToGridIndex->GetElement(gridAxis, ijkAxis)) > 1e-9 * maxElement)
+          {
+          // oblique grid, weights would be different for each point
+          return;
+          }
+        }
+      ijkAxisUsed[alignedIjkAxis] = true;
+      gridAxisForIjkAxis[alignedIjkAxis] = gridAxis;
+      }
+    for (int ijkAxis = 0; ijkAxis < 3; ijkAxis++)
+      {
+      int gridAxis = gridAxisForIjkAxis[ijkAxis];
+      this->AxisTables[ijkAxis].Compute(ijkToGridIndex->GetElement(gridAxis, ijkAxis),
+        ijkToGridIndex->GetElement(gridAxis, 3), this->Extent[ijkAxis * 2], this->Extent[ijkAxis * 2 + 1],
+        transform->GridExtent[gridAxis * 2], transform->GridExtent[gridAxis * 2 + 1],
+        transform->GridIncrements[gridAxis], transform->BorderMode);
+      }
+    this->GridScalarType = gridScalarType;
+    this->UseAxisTables = true;
+  }
+
+  void operator()(vtkIdType beginSlice, vtkIdType endSlice)
+  {
+    if (this->DisplacementGrid->GetScalarType() == VTK_FLOAT)
+      {
+      this->ComputeSlices<float>(static_cast<int>(beginSlice), static_cast<int>(endSlice));
+      }
+    else
+      {
+      this->ComputeSlices<double>(static_cast<int>(beginSlice), static_cast<int>(endSlice));
+      }
+  }
+
+  template <class O>
+  void ComputeSlices(int beginSlice, int endSlice)
+  {
+    vtkOrientedBSplineTransform* transform = this->Transform;
+    double scale = transform->DisplacementScale;
+    double (*bulkMatrix)[4] = (transform->BulkTransformMatrix ? transform->BulkTransformMatrix->Element : NULL);
+    double rowWeights[16];
+    vtkIdType rowOffsets[16];
+    double point[3];
+    double transformedPoint[3];
+    for (int k = beginSlice; k < endSlice; k++)
+      {
+      for (int j = this->Extent[2]; j <= this->Extent[3]; j++)
+        {
+        O* displacementPtr = static_cast<O*>(this->DisplacementGrid->GetScalarPointer(this->Extent[0], j, k));
+        if (this->UseAxisTables)
+          {
+          const double* jWeights = &this->AxisTables[1].Weights[4 * (j - this->AxisTables[1].FirstIndex)];
+          const vtkIdType* jOffsets = &this->AxisTables[1].Offsets[4 * (j - this->AxisTables[1].FirstIndex)];
+          const double* kWeights = &this->AxisTables[2].Weights[4 * (k - this->AxisTables[2].FirstIndex)];
+          const vtkIdType* kOffsets = &this->AxisTables[2].Offsets[4 * (k - this->AxisTables[2].FirstIndex)];
+          for (int mk = 0; mk < 4; mk++)
+            {
+            for (int mj = 0; mj < 4; mj++)
+              {
+              rowWeights[mk * 4 + mj] = kWeights[mk] * jWeights[mj];
+              rowOffsets[mk * 4 + mj] = kOffsets[mk] + jOffsets[mj];
+              }
+            }
+          }
+        for (int i = this->Extent[0]; i <= this->Extent[1]; i++)
+          {
+          for (int c = 0; c < 3; c++)
+            {
+            point[c] = this->IjkToInput[c][0] * i + this->IjkToInput[c][1] * j + this->IjkToInput[c][2] * k + this->IjkToInput[c][3];
+            }
+          if (this->UseAxisTables)
+            {
+            if (bulkMatrix)
+              {
+              vtkLinearTransformPoint(bulkMatrix, point, transformedPoint);
+              }
+            else
+              {
+              transformedPoint[0] = point[0];
+              transformedPoint[1] = point[1];
+              transformedPoint[2] = point[2];
+              }
+            double displacement[3] = { 0.0, 0.0, 0.0 };
+            const double* iWeights = &this->AxisTables[0].Weights[4 * (i - this->AxisTables[0].FirstIndex)];
+            const vtkIdType* iOffsets = &this->AxisTables[0].Offsets[4 * (i - this->AxisTables[0].FirstIndex)];
+            if (this->GridScalarType == VTK_FLOAT)
+              {
+              this->AddSplineDisplacement(static_cast<float*>(transform->GridPointer), iWeights, iOffsets,
+                rowWeights, rowOffsets, displacement);
+              }
+            else
+              {
+              this->AddSplineDisplacement(static_cast<double*>(transform->GridPointer), iWeights, iOffsets,
+                rowWeights, rowOffsets, displacement);
+              }
+            transformedPoint[0] += displacement[0] * scale;
+            transformedPoint[1] += displacement[1] * scale;
+            transformedPoint[2] += displacement[2] * scale;
+            }
+          else
+            {
+            transform->InternalTransformPoint(point, transformedPoint);
+            }
+          *(displacementPtr++) = static_cast<O>(transformedPoint[0] - point[0]);
+          *(displacementPtr++) = static_cast<O>(transformedPoint[1] - point[1]);
+          *(displacementPtr++) = static_cast<O>(transformedPoint[2] - point[2]);
+          }
+        }
+      }
+  }
+
+  template <class T>
+  void AddSplineDisplacement(const T* gridPtr, const double* iWeights, const vtkIdType* iOffsets,
+    const double* rowWeights, const vtkIdType* rowOffsets, double displacement[3])
+  {
+    for (int mi = 0; mi < 4; mi++)
+      {
+      if (iWeights[mi] == 0.0)
+        {
+        continue;
+        }
+      const T* columnPtr = gridPtr + iOffsets[mi];
+      for (int m = 0; m < 16; m++)
+        {
+        double weight = iWeights[mi] * rowWeights[m];
+        const T* coefficientPtr = columnPtr + rowOffsets[m];
+        displacement[0] += weight * coefficientPtr[0];
+        displacement[1] += weight * coefficientPtr[1];
+        displacement[2] += weight * coefficientPtr[2];
+        }
+      }
+  }
+
+private:
+  vtkOrientedBSplineTransform* Transform;
+  vtkImageData* DisplacementGrid;
+  double IjkToInput[4][4];
+  int Extent[6];
+  bool UseAxisTables;
+  int GridScalarType;
+  /// Tables for the b-spline axes aligned with i, j, k output grid axes
+  vtkOrientedBSplineTransformAxisTable AxisTables[3];
+};
+
+//----------------------------------------------------------------------------
+void vtkOrientedBSplineTransform::ComputeDisplacementsOnGrid(vtkMatrix4x4* ijkToInput, vtkImageData* displacementGrid)
+{
+  if (ijkToInput == NULL || displacementGrid == NULL
+    || displacementGrid->GetNumberOfScalarComponents() != 3
+    || (displacementGrid->GetScalarType() != VTK_FLOAT && displacementGrid->GetScalarType() != VTK_DOUBLE)
+    || displacementGrid->GetScalarPointer() == NULL)
+    {
+    vtkErrorMacro("ComputeDisplacementsOnGrid failed: displacement grid with 3-component float or double scalars is required");
+    return;
+    }
+  this->Update();
+  int gridScalarType = VTK_VOID;
+  if (this->GetCoefficientData())
+    {
+    gridScalarType = this->GetCoefficientData()->GetScalarType();
+    }
+  vtkDisplacementsOnGridWorker worker(this, ijkToInput, displacementGrid);
+  worker.ComputeAxisTables(ijkToInput, gridScalarType);
+  int* extent = displacementGrid->GetExtent();
+  vtkSMPTools::For(extent[4], extent[5] + 1, worker);
+}
@@ -31,6 +31,8 @@
 
 #include "vtkBSplineTransform.h"
 
+class vtkImageData;
+
 class VTK_ADDON_EXPORT vtkOrientedBSplineTransform : public vtkBSplineTransform
 {
 public:
@@ -56,6 +58,18 @@ public:
   virtual void SetBulkTransformMatrix(vtkMatrix4x4*);
   vtkGetObjectMacro(BulkTransformMatrix,vtkMatrix4x4);
 
+  // Description:
+  // Compute the displacement (transformed position minus position) at each
+  // point of a regular grid. Point positions are defined by the extent of
+  // displacementGrid and the ijkToInput matrix, which maps point indices to
+  // input positions. displacementGrid must have 3-component float or double
+  // scalars allocated.
+  // If the grid axes are aligned with the b-spline grid axes then spline
+  // weights are computed once for each grid index along each axis and reused
+  // for all rows, which is much faster than transforming each point.
+  // Points are processed in parallel.
+  void ComputeDisplacementsOnGrid(vtkMatrix4x4* ijkToInput, vtkImageData* displacementGrid);
+
 protected:
   vtkOrientedBSplineTransform();
   ~vtkOrientedBSplineTransform();
@@ -93,6 +107,8 @@ protected:
   vtkMatrix4x4* OutputToGridIndexTransformMatrixCached;
   vtkMatrix4x4* InverseBulkTransformMatrixCached;
 
+  class vtkDisplacementsOnGridWorker;
+
 private:
   vtkOrientedBSplineTransform(const vtkOrientedBSplineTransform&);  // Not implemented.
   void operator=(const vtkOrientedBSplineTransform&);  // Not implemented.
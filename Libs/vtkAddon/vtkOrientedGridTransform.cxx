@@ -13,6 +13,9 @@
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 vtkStandardNewMacro(vtkOrientedGridTransform);
 
@@ -185,6 +188,32 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
     return;
     }
 
+  double errorSquared = 0.0;
+  int iterations = 0;
+  bool converged = this->SolveInverseTransformDerivative(inPoint, outPoint, derivative, errorSquared, iterations);
+  vtkDebugMacro("Inverse Iterations: " << (iterations+1));
+  if (!converged)
+    {
+    if (this->MTime > this->LastWarningMTime)
+      {
+      vtkWarningMacro("InverseTransformPoint: no convergence (" <<
+                      inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
+                      ") error = " << sqrt(errorSquared) << " after " <<
+                      iterations << " iterations."
+                      "  Further convergence warnings suppressed until transform is modified.");
+      this->LastWarningMTime = this->MTime;
+      }
+    this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::SolveInverseTransformDerivative(const double inPoint[3],
+                                                       double outPoint[3],
+                                                       double derivative[3][3],
+                                                       double& errorSquared,
+                                                       int& iterations)
+{
   void *gridPtr = this->GridPointer;
   int gridType = this->GridScalarType;
 
@@ -201,7 +230,7 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
   double functionDerivative = 0;
   double lastFunctionValue = VTK_DOUBLE_MAX;
 
-  double errorSquared = 0.0;
+  errorSquared = 0.0;
   double toleranceSquared = this->InverseTolerance;
   toleranceSquared *= toleranceSquared;
 
@@ -315,31 +344,124 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
     inverse[2] = lastInverse[2] - f*deltaI[2];
     }
 
-  vtkDebugMacro("Inverse Iterations: " << (i+1));
-
-  if (i >= n)
+  iterations = i;
+  bool converged = (i < n);
+  if (!converged)
     {
     // didn't converge: back up to last good result
     inverse[0] = lastInverse[0];
     inverse[1] = lastInverse[1];
     inverse[2] = lastInverse[2];
+    }
+
+  // convert point
+  outPoint[0] = inverse[0];
+  outPoint[1] = inverse[1];
+  outPoint[2] = inverse[2];
+  return converged;
+}
+
+//----------------------------------------------------------------------------
+// Transforms a range of points. Each thread counts the points where the
+// inverse did not converge, so that the failure is reported only once
+// (from the calling thread) after all points are transformed.
+class vtkOrientedGridTransform::vtkTransformPointsWorker
+{
+public:
+  vtkTransformPointsWorker(vtkOrientedGridTransform* transform,
+    vtkPoints* inPoints, vtkPoints* outPoints, vtkIdType outOffset)
+    : Transform(transform)
+    , InPoints(inPoints)
+    , OutPoints(outPoints)
+    , OutOffset(outOffset)
+  {
+  }
+
+  void Initialize()
+  {
+    this->ConvergenceFailures.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int& convergenceFailures = this->ConvergenceFailures.Local();
+    double point[3];
+    double derivative[3][3];
+    double errorSquared = 0.0;
+    int iterations = 0;
+    bool inverse = (this->Transform->InverseFlag != 0);
+    for (vtkIdType pointId = begin; pointId < end; pointId++)
+      {
+      this->InPoints->GetPoint(pointId, point);
+      if (inverse)
+        {
+        if (!this->Transform->SolveInverseTransformDerivative(point, point, derivative, errorSquared, iterations))
+          {
+          convergenceFailures++;
+          }
+        }
+      else
+        {
+        this->Transform->vtkOrientedGridTransform::ForwardTransformPoint(point, point);
+        }
+      this->OutPoints->SetPoint(this->OutOffset + pointId, point);
+      }
+  }
 
+  void Reduce()
+  {
+  }
+
+  int GetNumberOfConvergenceFailures()
+  {
+    int numberOfFailures = 0;
+    for (vtkSMPThreadLocal<int>::iterator it = this->ConvergenceFailures.begin();
+      it != this->ConvergenceFailures.end(); ++it)
+      {
+      numberOfFailures += *it;
+      }
+    return numberOfFailures;
+  }
+
+private:
+  vtkOrientedGridTransform* Transform;
+  vtkPoints* InPoints;
+  vtkPoints* OutPoints;
+  vtkIdType OutOffset;
+  vtkSMPThreadLocal<int> ConvergenceFailures;
+};
+
+//----------------------------------------------------------------------------
+void vtkOrientedGridTransform::TransformPoints(vtkPoints *inPts, vtkPoints *outPts)
+{
+  this->Update();
+  if (this->GridDirectionMatrix == NULL || this->GridPointer == NULL || !inPts || !outPts)
+    {
+    this->Superclass::TransformPoints(inPts, outPts);
+    return;
+    }
+
+  // Transformed points are appended to the output, same as in the base class
+  vtkIdType numberOfPoints = inPts->GetNumberOfPoints();
+  vtkIdType outOffset = outPts->GetNumberOfPoints();
+  outPts->SetNumberOfPoints(outOffset + numberOfPoints);
+
+  vtkTransformPointsWorker worker(this, inPts, outPts, outOffset);
+  vtkSMPTools::For(0, numberOfPoints, worker);
+  outPts->Modified();
+
+  int numberOfFailures = worker.GetNumberOfConvergenceFailures();
+  if (numberOfFailures > 0)
+    {
     if (this->MTime > this->LastWarningMTime)
       {
-      vtkWarningMacro("InverseTransformPoint: no convergence (" <<
-                      inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
-                      ") error = " << sqrt(errorSquared) << " after " <<
-                      i << " iterations."
-                      "  Further convergence warnings suppressed until transform is modified.");
+      vtkWarningMacro("TransformPoints: inverse did not converge for " << numberOfFailures
+        << " of " << numberOfPoints << " points."
+        "  Further convergence warnings suppressed until transform is modified.");
       this->LastWarningMTime = this->MTime;
       }
     this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
     }
-
-  // convert point
-  outPoint[0] = inverse[0];
-  outPoint[1] = inverse[1];
-  outPoint[2] = inverse[2];
 }
 
 //----------------------------------------------------------------------------
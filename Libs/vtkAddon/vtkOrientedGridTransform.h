@@ -40,6 +40,12 @@ public:
   // Make another transform of the same type.
   vtkAbstractTransform *MakeTransform() VTK_OVERRIDE;
 
+  // Description:
+  // Apply the transformation to a series of points, and append the
+  // results to outPts. Points are transformed in parallel (using vtkSMPTools)
+  // and a convergence failure of the inverse is reported only once.
+  void TransformPoints(vtkPoints *inPts, vtkPoints *outPts) VTK_OVERRIDE;
+
   /// List of custom events fired by the class.
   // ConvergenceFailureEvent is invoked when the gradient cannot be
   // inverted, probably due to a singular transform or numeric instability.
@@ -77,6 +83,13 @@ protected:
   void InverseTransformDerivative(const double in[3], double out[3],
                                   double derivative[3][3]) VTK_OVERRIDE;
 
+  // Description:
+  // Compute the inverse using Newton's method without reporting convergence
+  // failures. Returns false if the inverse did not converge.
+  // Can be called from multiple threads.
+  bool SolveInverseTransformDerivative(const double in[3], double out[3],
+    double derivative[3][3], double& errorSquared, int& iterations);
+
   // Description:
   // Grid axis direction vectors (i, j, k) in the output space
   vtkMatrix4x4* GridDirectionMatrix;
@@ -92,6 +105,8 @@ protected:
   // by keeping track of the MTime when the last warning was issued.
   vtkMTimeType LastWarningMTime;
 
+  class vtkTransformPointsWorker;
+
 private:
   vtkOrientedGridTransform(const vtkOrientedGridTransform&);  // Not implemented.
   void operator=(const vtkOrientedGridTransform&);  // Not implemented.
@@ -0,0 +1,218 @@
+#include <vtkITKMorphologicalContourInterpolator.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// ITK includes
+#include <itkFactoryRegistration.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Draw a disk of \a label in slice \a k
+void DrawDisk(vtkImageData* image, int k, int centerI, int centerJ, int radius, short label)
+{
+  int* extent = image->GetExtent();
+  for (int j = extent[2]; j <= extent[3]; j++)
+    {
+    for (int i = extent[0]; i <= extent[1]; i++)
+      {
+      if ((i - centerI) * (i - centerI) + (j - centerJ) * (j - centerJ) <= radius * radius)
+        {
+        image->SetScalarComponentFromDouble(i, j, k, 0, label);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Segmentation drawn on key slices only, as with Fill between slices.
+/// Labels are far enough apart for their interpolated regions not to overlap.
+void CreateLabelmap(vtkImageData* image)
+{
+  image->SetDimensions(40, 40, 24);
+  image->AllocateScalars(VTK_SHORT, 1);
+  image->GetPointData()->GetScalars()->FillComponent(0, 0);
+  DrawDisk(image, 4, 10, 10, 4, 1);
+  DrawDisk(image, 10, 10, 10, 6, 1);
+  DrawDisk(image, 16, 9, 11, 4, 1);
+  DrawDisk(image, 6, 30, 12, 5, 2);
+  DrawDisk(image, 12, 30, 12, 5, 2);
+  DrawDisk(image, 4, 20, 30, 6, 5);
+  DrawDisk(image, 14, 22, 30, 3, 5);
+}
+
+//----------------------------------------------------------------------------
+int CountDifferences(vtkImageData* expected, vtkImageData* actual)
+{
+  vtkDataArray* expectedScalars = expected->GetPointData()->GetScalars();
+  vtkDataArray* actualScalars = actual->GetPointData()->GetScalars();
+  if (expectedScalars->GetNumberOfTuples() != actualScalars->GetNumberOfTuples())
+    {
+    return static_cast<int>(expectedScalars->GetNumberOfTuples());
+    }
+  int differences = 0;
+  for (vtkIdType id = 0; id < expectedScalars->GetNumberOfTuples(); id++)
+    {
+    if (expectedScalars->GetTuple1(id) != actualScalars->GetTuple1(id))
+      {
+      differences++;
+      }
+    }
+  return differences;
+}
+
+//----------------------------------------------------------------------------
+int CountLabelVoxels(vtkImageData* image, int k, short label)
+{
+  int* extent = image->GetExtent();
+  int count = 0;
+  for (int j = extent[2]; j <= extent[3]; j++)
+    {
+    for (int i = extent[0]; i <= extent[1]; i++)
+      {
+      if (image->GetScalarComponentAsDouble(i, j, k, 0) == label)
+        {
+        count++;
+        }
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+/// Compare the output of the parallel interpolation with the interpolation
+/// of all labels at once by the ITK filter.
+bool CheckParallelOutput(vtkImageData* labelmap, vtkITKMorphologicalContourInterpolator* parallelInterpolator)
+{
+  vtkNew<vtkITKMorphologicalContourInterpolator> serialInterpolator;
+  serialInterpolator->SetInputData(labelmap);
+  serialInterpolator->SetAxis(parallelInterpolator->GetAxis());
+  serialInterpolator->SetHeuristicAlignment(parallelInterpolator->GetHeuristicAlignment());
+  serialInterpolator->Update();
+
+  parallelInterpolator->Update();
+
+  int differences = CountDifferences(serialInterpolator->GetOutput(), parallelInterpolator->GetOutput());
+  if (differences != 0)
+    {
+    std::cerr << "Parallel output differs from serial output in " << differences << " voxels" << std::endl;
+    return false;
+    }
+  // Interpolated slices between the key slices of each label
+  if (CountLabelVoxels(parallelInterpolator->GetOutput(), 7, 1) == 0
+    || CountLabelVoxels(parallelInterpolator->GetOutput(), 9, 2) == 0
+    || CountLabelVoxels(parallelInterpolator->GetOutput(), 9, 5) == 0)
+    {
+    std::cerr << "Labels are not interpolated between key slices" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  itk::itkFactoryRegistration();
+
+  vtkNew<vtkImageData> labelmap;
+  CreateLabelmap(labelmap.GetPointer());
+
+  vtkNew<vtkITKMorphologicalContourInterpolator> interpolator;
+  interpolator->SetInputData(labelmap.GetPointer());
+  interpolator->InterpolateLabelsInParallelOn();
+
+  // Along all axes and along the axis of the key slices
+  const int axes[2] = { -1, 2 };
+  for (int axisIndex = 0; axisIndex < 2; axisIndex++)
+    {
+    interpolator->SetAxis(axes[axisIndex]);
+    if (!CheckParallelOutput(labelmap.GetPointer(), interpolator.GetPointer()))
+      {
+      std::cerr << "Line " << __LINE__ << " - Parallel interpolation failed along axis " << axes[axisIndex] << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (interpolator->GetNumberOfInterpolatedLabels() != 3 || interpolator->GetNumberOfCachedLabels() != 0)
+      {
+      std::cerr << "Line " << __LINE__ << " - Labels are cached with UseLabelCache off" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Cache: unchanged labels are not interpolated again
+  interpolator->SetAxis(-1);
+  interpolator->UseLabelCacheOn();
+  interpolator->Update();
+  labelmap->Modified();
+  if (!CheckParallelOutput(labelmap.GetPointer(), interpolator.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Cached interpolation failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (interpolator->GetNumberOfInterpolatedLabels() != 0 || interpolator->GetNumberOfCachedLabels() != 3)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unchanged labels are interpolated again: "
+      << interpolator->GetNumberOfInterpolatedLabels() << " interpolated, "
+      << interpolator->GetNumberOfCachedLabels() << " cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Cache: the label whose mask changed is interpolated again, within the
+  // same bounding box
+  DrawDisk(labelmap.GetPointer(), 12, 30, 12, 5, 0);
+  DrawDisk(labelmap.GetPointer(), 12, 31, 12, 4, 2);
+  labelmap->Modified();
+  if (!CheckParallelOutput(labelmap.GetPointer(), interpolator.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Interpolation of modified label failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (interpolator->GetNumberOfInterpolatedLabels() != 1 || interpolator->GetNumberOfCachedLabels() != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Modified label is not interpolated again: "
+      << interpolator->GetNumberOfInterpolatedLabels() << " interpolated, "
+      << interpolator->GetNumberOfCachedLabels() << " cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Cache: the label whose bounding box changed is interpolated again
+  DrawDisk(labelmap.GetPointer(), 20, 20, 30, 3, 5);
+  labelmap->Modified();
+  if (!CheckParallelOutput(labelmap.GetPointer(), interpolator.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Interpolation of extended label failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (interpolator->GetNumberOfInterpolatedLabels() != 1 || interpolator->GetNumberOfCachedLabels() != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Extended label is not interpolated again: "
+      << interpolator->GetNumberOfInterpolatedLabels() << " interpolated, "
+      << interpolator->GetNumberOfCachedLabels() << " cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Cache: all labels are interpolated again when the parameters change
+  interpolator->SetHeuristicAlignment(false);
+  if (!CheckParallelOutput(labelmap.GetPointer(), interpolator.GetPointer()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Interpolation with other parameters failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (interpolator->GetNumberOfInterpolatedLabels() != 3 || interpolator->GetNumberOfCachedLabels() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Cached labels are used with other parameters" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
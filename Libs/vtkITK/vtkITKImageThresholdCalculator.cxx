@@ -46,16 +46,58 @@
 #include "itkVTKImageImport.h"
 #include "itkYenThresholdCalculator.h"
 
+// STD includes
+#include <map>
+
 vtkStandardNewMacro(vtkITKImageThresholdCalculator);
 
+//----------------------------------------------------------------------------
+// Histogram measurement type is the real type of the pixel type, which is double for all VTK scalar types
+typedef itk::Statistics::Histogram<double> CachedHistogramType;
+
+//----------------------------------------------------------------------------
+class vtkITKImageThresholdCalculator::vtkInternal
+{
+public:
+  vtkInternal()
+    : InputImage(NULL)
+    , InputImageMTime(0)
+    {
+    }
+
+  /// Returns true if cached histogram was computed from the current state of inputImage
+  bool IsHistogramValid(vtkImageData* inputImage)
+    {
+    return this->Histogram.IsNotNull()
+      && this->InputImage == inputImage
+      && this->InputImageMTime == inputImage->GetMTime();
+    }
+
+  void SetHistogram(const CachedHistogramType* histogram, vtkImageData* inputImage)
+    {
+    this->Histogram = histogram;
+    this->InputImage = inputImage;
+    this->InputImageMTime = (inputImage ? inputImage->GetMTime() : 0);
+    this->ComputedThresholds.clear();
+    }
+
+  /// Histogram of the input image. Computing the histogram requires traversal of the
+  /// whole input image, while threshold calculators only process the histogram.
+  CachedHistogramType::ConstPointer Histogram;
+  /// Image that the histogram was computed from (only used for comparison, not dereferenced)
+  vtkImageData* InputImage;
+  vtkMTimeType InputImageMTime;
+  /// Thresholds already computed from the cached histogram, by method
+  std::map<int, double> ComputedThresholds;
+};
+
 // helper function
 template <class TPixelType>
-void ITKComputeThresholdFromVTKImage(vtkITKImageThresholdCalculator *self, vtkImageData *inputImage, double& computedThreshold)
+void ITKComputeHistogramFromVTKImage(vtkITKImageThresholdCalculator *self, vtkImageData *inputImage,
+  vtkITKImageThresholdCalculator::vtkInternal* internal)
 {
   typedef itk::Image<TPixelType, 3> ImageType;
   typedef itk::Statistics::ImageToHistogramFilter<ImageType> HistogramGeneratorType;
-  typedef typename HistogramGeneratorType::HistogramType HistogramType;
-  typedef itk::HistogramThresholdCalculator<HistogramType, double> CalculatorType;
 
   // itk import for input itk images
   typedef typename itk::VTKImageImport<ImageType> ImageImportType;
@@ -75,8 +117,29 @@ void ITKComputeThresholdFromVTKImage(vtkITKImageThresholdCalculator *self, vtkIm
   histGenerator->SetHistogramSize( hsize );
   histGenerator->SetAutoMinimumMaximum( true );
 
+  try
+    {
+    histGenerator->Update();
+    }
+  catch (itk::ExceptionObject &err)
+    {
+    vtkErrorWithObjectMacro(self, "Failed to compute histogram. Details: " << err);
+    internal->SetHistogram(NULL, NULL);
+    return;
+    }
+
+  // The histogram remains valid after the generator is deleted
+  internal->SetHistogram(histGenerator->GetOutput(), inputImage);
+}
+
+//----------------------------------------------------------------------------
+void ITKComputeThresholdFromHistogram(vtkITKImageThresholdCalculator *self, const CachedHistogramType* histogram, double& computedThreshold)
+{
+  typedef CachedHistogramType HistogramType;
+  typedef itk::HistogramThresholdCalculator<HistogramType, double> CalculatorType;
+
   // Create and initialize the calculator
-  typename CalculatorType::Pointer calculator;
+  CalculatorType::Pointer calculator;
   switch (self->GetMethod())
     {
     case vtkITKImageThresholdCalculator::METHOD_HUANG: calculator = itk::HuangThresholdCalculator<HistogramType>::New(); break;
@@ -92,11 +155,11 @@ void ITKComputeThresholdFromVTKImage(vtkITKImageThresholdCalculator *self, vtkIm
     case vtkITKImageThresholdCalculator::METHOD_TRIANGLE: calculator = itk::TriangleThresholdCalculator<HistogramType>::New(); break;
     case vtkITKImageThresholdCalculator::METHOD_YEN: calculator = itk::YenThresholdCalculator<HistogramType>::New(); break;
     default:
-      vtkErrorWithObjectMacro(self, "ITKComputeThresholdFromVTKImage failed: invalid method: " << self->GetMethod());
+      vtkErrorWithObjectMacro(self, "ITKComputeThresholdFromHistogram failed: invalid method: " << self->GetMethod());
       return;
     }
 
-  calculator->SetInput( histGenerator->GetOutput() );
+  calculator->SetInput( histogram );
 
   try
     {
@@ -116,11 +179,19 @@ vtkITKImageThresholdCalculator::vtkITKImageThresholdCalculator()
 {
   this->Method = METHOD_OTSU;
   this->Threshold = 0.0;
+  this->Internal = new vtkInternal;
 }
 
 //----------------------------------------------------------------------------
 vtkITKImageThresholdCalculator::~vtkITKImageThresholdCalculator()
 {
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkITKImageThresholdCalculator::ClearCache()
+{
+  this->Internal->SetHistogram(NULL, NULL);
 }
 
 //----------------------------------------------------------------------------
@@ -166,14 +237,32 @@ void vtkITKImageThresholdCalculator::Update()
     return;
     }
 
-  int inputDataType = pointData->GetScalars()->GetDataType();
-  switch (inputDataType)
+  // Histogram computation is the expensive part (traverses the whole image),
+  // so it is only performed if the input image has changed since the last update.
+  if (!this->Internal->IsHistogramValid(inputImage))
     {
-    vtkTemplateMacro(ITKComputeThresholdFromVTKImage<VTK_TT>(this, inputImage, this->Threshold));
-    default:
-      vtkErrorMacro("Execute: Unknown ScalarType" << inputDataType);
+    int inputDataType = pointData->GetScalars()->GetDataType();
+    switch (inputDataType)
+      {
+      vtkTemplateMacro(ITKComputeHistogramFromVTKImage<VTK_TT>(this, inputImage, this->Internal));
+      default:
+        vtkErrorMacro("Execute: Unknown ScalarType" << inputDataType);
+        return;
+      }
+    if (this->Internal->Histogram.IsNull())
+      {
       return;
+      }
+    }
+
+  std::map<int, double>::iterator computedThresholdIt = this->Internal->ComputedThresholds.find(this->Method);
+  if (computedThresholdIt != this->Internal->ComputedThresholds.end())
+    {
+    this->Threshold = computedThresholdIt->second;
+    return;
     }
+  ITKComputeThresholdFromHistogram(this, this->Internal->Histogram, this->Threshold);
+  this->Internal->ComputedThresholds[this->Method] = this->Threshold;
 }
 
 //----------------------------------------------------------------------------
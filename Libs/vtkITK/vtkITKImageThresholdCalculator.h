@@ -81,6 +81,14 @@ public:
   /// The main interface which triggers the writer to start.
   virtual void Update() VTK_OVERRIDE;
 
+  /// Delete cached histogram and computed thresholds.
+  /// The cache is automatically invalidated when the input image is modified,
+  /// therefore calling this method is only needed for releasing memory.
+  void ClearCache();
+
+  /// Internal class for caching the input histogram
+  class vtkInternal;
+
 protected:
   vtkITKImageThresholdCalculator();
   ~vtkITKImageThresholdCalculator();
@@ -88,6 +96,8 @@ protected:
   int Method;
   double Threshold;
 
+  vtkInternal* Internal;
+
 private:
   vtkITKImageThresholdCalculator(const vtkITKImageThresholdCalculator&);  /// Not implemented.
   void operator=(const vtkITKImageThresholdCalculator&);  /// Not implemented.
@@ -15,25 +15,297 @@
 #include "vtkITKMorphologicalContourInterpolator.h"
 #include "vtkObjectFactory.h"
 
+#include "vtkCriticalSection.h"
 #include "vtkDataArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkPointData.h"
 #include "vtkImageData.h"
 
 #include "itkMorphologicalContourInterpolator.h"
+#include "itkMultiThreader.h"
+
+// STD includes
+#include <algorithm>
+#include <map>
+#include <vector>
 
 vtkStandardNewMacro(vtkITKMorphologicalContourInterpolator);
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+/// Interpolation parameters that affect the result of a label
+struct InterpolationParameters
+{
+  int Axis;
+  bool HeuristicAlignment;
+  bool UseDistanceTransform;
+  bool UseBallStructuringElement;
+
+  bool operator==(const InterpolationParameters& other) const
+    {
+    return this->Axis == other.Axis
+      && this->HeuristicAlignment == other.HeuristicAlignment
+      && this->UseDistanceTransform == other.UseDistanceTransform
+      && this->UseBallStructuringElement == other.UseBallStructuringElement;
+    }
+};
+
+/// Binary mask of one label within its bounding box and its interpolation result
+struct LabelRegion
+{
+  long Label;
+  int Extent[6]; // in voxel index (0-based) of the input image
+  std::vector<unsigned char> Mask;
+  std::vector<unsigned char> Result;
+
+  int GetSize(int axis) const
+    {
+    return this->Extent[axis * 2 + 1] - this->Extent[axis * 2] + 1;
+    }
+
+  bool HasSameInput(const LabelRegion& other) const
+    {
+    for (int i = 0; i < 6; i++)
+      {
+      if (this->Extent[i] != other.Extent[i])
+        {
+        return false;
+        }
+      }
+    return this->Mask == other.Mask;
+    }
+};
+
+/// Labels that are processed by the worker threads
+struct LabelInterpolationWork
+{
+  std::vector<LabelRegion*> Regions;
+  size_t NextRegionIndex;
+  vtkSimpleCriticalSection Lock;
+  InterpolationParameters Parameters;
+  int NumberOfITKThreadsPerLabel;
+};
+
+//----------------------------------------------------------------------------
+void InterpolateLabelRegion(LabelRegion* region, const InterpolationParameters& parameters, int numberOfITKThreads)
+{
+  typedef itk::Image<unsigned char, 3> MaskImageType;
+  MaskImageType::Pointer maskImage = MaskImageType::New();
+  MaskImageType::RegionType itkRegion;
+  MaskImageType::IndexType index;
+  MaskImageType::SizeType size;
+  for (int i = 0; i < 3; i++)
+    {
+    index[i] = 0;
+    size[i] = region->GetSize(i);
+    }
+  itkRegion.SetIndex(index);
+  itkRegion.SetSize(size);
+  maskImage->GetPixelContainer()->SetImportPointer(&(region->Mask[0]), region->Mask.size(), false);
+  maskImage->SetLargestPossibleRegion(itkRegion);
+  maskImage->SetBufferedRegion(itkRegion);
+
+  typedef itk::MorphologicalContourInterpolator<MaskImageType> ContourInterpolatorType;
+  ContourInterpolatorType::Pointer interpolatorFilter = ContourInterpolatorType::New();
+  interpolatorFilter->SetLabel(1);
+  interpolatorFilter->SetAxis(parameters.Axis);
+  interpolatorFilter->SetHeuristicAlignment(parameters.HeuristicAlignment);
+  interpolatorFilter->SetUseDistanceTransform(parameters.UseDistanceTransform);
+  interpolatorFilter->SetUseBallStructuringElement(parameters.UseBallStructuringElement);
+  interpolatorFilter->SetNumberOfThreads(numberOfITKThreads);
+  interpolatorFilter->SetInput(maskImage);
+  try
+    {
+    interpolatorFilter->Update();
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    vtkGenericWarningMacro("vtkITKMorphologicalContourInterpolator: failed to interpolate label "
+      << region->Label << ". Details: " << err);
+    region->Result = region->Mask;
+    return;
+    }
+  const unsigned char* resultPtr = interpolatorFilter->GetOutput()->GetBufferPointer();
+  region->Result.assign(resultPtr, resultPtr + region->Mask.size());
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE InterpolateLabelRegionsThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  LabelInterpolationWork* work = static_cast<LabelInterpolationWork*>(threadInfo->UserData);
+  while (true)
+    {
+    work->Lock.Lock();
+    if (work->NextRegionIndex >= work->Regions.size())
+      {
+      work->Lock.Unlock();
+      break;
+      }
+    LabelRegion* region = work->Regions[work->NextRegionIndex];
+    work->NextRegionIndex++;
+    work->Lock.Unlock();
+    InterpolateLabelRegion(region, work->Parameters, work->NumberOfITKThreadsPerLabel);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+/// Compute bounding box of each non-zero label (padded by one voxel) and extract the binary mask
+template <class T>
+void ExtractLabelRegions(T* inPtr, const int dims[3], std::map<long, LabelRegion>& regions)
+{
+  // Bounding boxes
+  T* voxelPtr = inPtr;
+  long lastLabel = 0;
+  LabelRegion* lastRegion = NULL;
+  for (int k = 0; k < dims[2]; k++)
+    {
+    for (int j = 0; j < dims[1]; j++)
+      {
+      for (int i = 0; i < dims[0]; i++, voxelPtr++)
+        {
+        if (*voxelPtr == 0)
+          {
+          continue;
+          }
+        long label = static_cast<long>(*voxelPtr);
+        if (label != lastLabel || !lastRegion)
+          {
+          std::map<long, LabelRegion>::iterator regionIt = regions.find(label);
+          if (regionIt == regions.end())
+            {
+            LabelRegion& newRegion = regions[label];
+            newRegion.Label = label;
+            newRegion.Extent[0] = newRegion.Extent[1] = i;
+            newRegion.Extent[2] = newRegion.Extent[3] = j;
+            newRegion.Extent[4] = newRegion.Extent[5] = k;
+            lastRegion = &newRegion;
+            }
+          else
+            {
+            lastRegion = &(regionIt->second);
+            }
+          lastLabel = label;
+          }
+        int* extent = lastRegion->Extent;
+        if (i < extent[0]) { extent[0] = i; }
+        if (i > extent[1]) { extent[1] = i; }
+        if (j < extent[2]) { extent[2] = j; }
+        if (j > extent[3]) { extent[3] = j; }
+        if (k < extent[4]) { extent[4] = k; }
+        if (k > extent[5]) { extent[5] = k; }
+        }
+      }
+    }
+
+  // Masks
+  for (std::map<long, LabelRegion>::iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt)
+    {
+    LabelRegion& region = regionIt->second;
+    // Pad by one voxel so that the label does not touch the boundary of the cropped region
+    for (int axis = 0; axis < 3; axis++)
+      {
+      region.Extent[axis * 2] = std::max(0, region.Extent[axis * 2] - 1);
+      region.Extent[axis * 2 + 1] = std::min(dims[axis] - 1, region.Extent[axis * 2 + 1] + 1);
+      }
+    region.Mask.resize(static_cast<size_t>(region.GetSize(0)) * region.GetSize(1) * region.GetSize(2));
+    unsigned char* maskPtr = &(region.Mask[0]);
+    T label = static_cast<T>(region.Label);
+    for (int k = region.Extent[4]; k <= region.Extent[5]; k++)
+      {
+      for (int j = region.Extent[2]; j <= region.Extent[3]; j++)
+        {
+        T* rowPtr = inPtr + (static_cast<size_t>(k) * dims[1] + j) * dims[0];
+        for (int i = region.Extent[0]; i <= region.Extent[1]; i++)
+          {
+          *(maskPtr++) = (rowPtr[i] == label ? 1 : 0);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Write interpolated label regions into the output. Voxels that are already
+/// labeled (in the input or by a lower label) are not overwritten.
+template <class T>
+void CompositeLabelRegions(T* outPtr, const int dims[3], std::map<long, LabelRegion>& regions)
+{
+  for (std::map<long, LabelRegion>::iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt)
+    {
+    LabelRegion& region = regionIt->second;
+    const unsigned char* resultPtr = &(region.Result[0]);
+    T label = static_cast<T>(region.Label);
+    for (int k = region.Extent[4]; k <= region.Extent[5]; k++)
+      {
+      for (int j = region.Extent[2]; j <= region.Extent[3]; j++)
+        {
+        T* rowPtr = outPtr + (static_cast<size_t>(k) * dims[1] + j) * dims[0];
+        for (int i = region.Extent[0]; i <= region.Extent[1]; i++, resultPtr++)
+          {
+          if (*resultPtr && rowPtr[i] == 0)
+            {
+            rowPtr[i] = label;
+            }
+          }
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkITKMorphologicalContourInterpolator::vtkInternal
+{
+public:
+  vtkInternal()
+    {
+    for (int i = 0; i < 6; i++)
+      {
+      this->CachedExtent[i] = 0;
+      }
+    this->CachedParameters.Axis = -1;
+    this->CachedParameters.HeuristicAlignment = true;
+    this->CachedParameters.UseDistanceTransform = false;
+    this->CachedParameters.UseBallStructuringElement = false;
+    }
+
+  /// Label regions of the last update, with interpolation results
+  std::map<long, LabelRegion> CachedRegions;
+  int CachedExtent[6];
+  InterpolationParameters CachedParameters;
+};
+
+//----------------------------------------------------------------------------
 vtkITKMorphologicalContourInterpolator::vtkITKMorphologicalContourInterpolator()
   : Label(0)
   , Axis(-1)
   , HeuristicAlignment(true)
   , UseDistanceTransform(false)
   , UseBallStructuringElement(false)
+  , InterpolateLabelsInParallel(false)
+  , UseLabelCache(false)
+  , NumberOfInterpolatedLabels(0)
+  , NumberOfCachedLabels(0)
 {
+  this->Internal = new vtkInternal;
 }
 
+//----------------------------------------------------------------------------
 vtkITKMorphologicalContourInterpolator::~vtkITKMorphologicalContourInterpolator()
 {
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkITKMorphologicalContourInterpolator::ClearLabelCache()
+{
+  this->Internal->CachedRegions.clear();
 }
 
 
@@ -113,7 +385,11 @@ void vtkITKMorphologicalContourInterpolator::SimpleExecute(vtkImageData *input,
     return;
     }
 
-  if (inScalars->GetNumberOfComponents() == 1 )
+  if (inScalars->GetNumberOfComponents() == 1 && this->InterpolateLabelsInParallel && this->Label == 0)
+    {
+    this->ExecuteLabelsInParallel(input, output);
+    }
+  else if (inScalars->GetNumberOfComponents() == 1 )
     {
 
 ////////// These types are not defined in itk ////////////
@@ -144,6 +420,100 @@ void vtkITKMorphologicalContourInterpolator::SimpleExecute(vtkImageData *input,
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkITKMorphologicalContourInterpolator::ExecuteLabelsInParallel(vtkImageData *input, vtkImageData *output)
+{
+  int dims[3] = { 0, 0, 0 };
+  input->GetDimensions(dims);
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  input->GetExtent(extent);
+  void* inPtr = input->GetScalarPointer();
+  void* outPtr = output->GetScalarPointer();
+  if (!inPtr || !outPtr || dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0)
+    {
+    return;
+    }
+
+  // Input labels are kept in the output
+  memcpy(outPtr, inPtr, input->GetPointData()->GetScalars()->GetDataSize() * input->GetScalarSize());
+
+  std::map<long, LabelRegion> regions;
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(ExtractLabelRegions<VTK_TT>(static_cast<VTK_TT*>(inPtr), dims, regions));
+    default:
+      vtkErrorMacro(<< "ExecuteLabelsInParallel: Unknown scalar type");
+      return;
+    }
+
+  InterpolationParameters parameters;
+  parameters.Axis = this->Axis;
+  parameters.HeuristicAlignment = this->HeuristicAlignment;
+  parameters.UseDistanceTransform = this->UseDistanceTransform;
+  parameters.UseBallStructuringElement = this->UseBallStructuringElement;
+
+  bool cacheValid = this->UseLabelCache
+    && this->Internal->CachedParameters == parameters
+    && std::equal(extent, extent + 6, this->Internal->CachedExtent);
+
+  // Reuse cached results for labels that have not changed
+  LabelInterpolationWork work;
+  work.NextRegionIndex = 0;
+  work.Parameters = parameters;
+  this->NumberOfCachedLabels = 0;
+  for (std::map<long, LabelRegion>::iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt)
+    {
+    if (cacheValid)
+      {
+      std::map<long, LabelRegion>::iterator cachedRegionIt = this->Internal->CachedRegions.find(regionIt->first);
+      if (cachedRegionIt != this->Internal->CachedRegions.end() && cachedRegionIt->second.HasSameInput(regionIt->second))
+        {
+        regionIt->second.Result.swap(cachedRegionIt->second.Result);
+        this->NumberOfCachedLabels++;
+        continue;
+        }
+      }
+    work.Regions.push_back(&(regionIt->second));
+    }
+  this->NumberOfInterpolatedLabels = static_cast<int>(work.Regions.size());
+
+  // Interpolate modified labels in parallel. ITK filters are multi-threaded as well,
+  // therefore the available threads are distributed between the labels.
+  if (!work.Regions.empty())
+    {
+    int numberOfThreads = std::min(static_cast<int>(work.Regions.size()),
+      vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+    numberOfThreads = std::max(1, numberOfThreads);
+    work.NumberOfITKThreadsPerLabel = std::max(1,
+      static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()) / numberOfThreads);
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(InterpolateLabelRegionsThreadFunction, &work);
+    threader->SingleMethodExecute();
+    }
+
+  switch (output->GetScalarType())
+    {
+    vtkTemplateMacro(CompositeLabelRegions<VTK_TT>(static_cast<VTK_TT*>(outPtr), dims, regions));
+    default:
+      vtkErrorMacro(<< "ExecuteLabelsInParallel: Unknown scalar type");
+      return;
+    }
+
+  if (this->UseLabelCache)
+    {
+    // Store current results (labels that are no longer present are removed from the cache)
+    this->Internal->CachedRegions.swap(regions);
+    this->Internal->CachedParameters = parameters;
+    std::copy(extent, extent + 6, this->Internal->CachedExtent);
+    }
+  else
+    {
+    this->Internal->CachedRegions.clear();
+    }
+}
+
+//----------------------------------------------------------------------------
 void vtkITKMorphologicalContourInterpolator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
@@ -152,4 +522,8 @@ void vtkITKMorphologicalContourInterpolator::PrintSelf(ostream& os, vtkIndent in
   os << indent << "HeuristicAlignment: " << HeuristicAlignment << std::endl;
   os << indent << "UseDistanceTransform: " << UseDistanceTransform << std::endl;
   os << indent << "UseBallStructuringElement: " << UseBallStructuringElement << std::endl;
+  os << indent << "InterpolateLabelsInParallel: " << InterpolateLabelsInParallel << std::endl;
+  os << indent << "UseLabelCache: " << UseLabelCache << std::endl;
+  os << indent << "NumberOfInterpolatedLabels: " << NumberOfInterpolatedLabels << std::endl;
+  os << indent << "NumberOfCachedLabels: " << NumberOfCachedLabels << std::endl;
 }
@@ -44,17 +44,54 @@ public:
   vtkGetMacro(UseBallStructuringElement, bool);
   vtkSetMacro(UseBallStructuringElement, bool);
 
+  /// Interpolate each label independently, restricted to the bounding box of the label,
+  /// with multiple labels processed in parallel. Only used if Label is 0 (all labels are interpolated).
+  /// Where interpolated regions of different labels overlap, the lower label value has priority.
+  /// Default is OFF.
+  vtkGetMacro(InterpolateLabelsInParallel, bool);
+  vtkSetMacro(InterpolateLabelsInParallel, bool);
+  vtkBooleanMacro(InterpolateLabelsInParallel, bool);
+
+  /// Keep the interpolation result of each label and reuse it in subsequent updates
+  /// if neither the label nor the interpolation parameters have changed. This makes repeated
+  /// updates (such as auto-update while editing a segmentation) only recompute labels
+  /// that were modified. Only used if InterpolateLabelsInParallel is enabled. Default is OFF.
+  vtkGetMacro(UseLabelCache, bool);
+  vtkSetMacro(UseLabelCache, bool);
+  vtkBooleanMacro(UseLabelCache, bool);
+
+  /// Delete all cached label interpolation results
+  void ClearLabelCache();
+
+  /// Number of labels that were interpolated in the last update
+  vtkGetMacro(NumberOfInterpolatedLabels, int);
+  /// Number of labels whose interpolation result was reused from the cache in the last update
+  vtkGetMacro(NumberOfCachedLabels, int);
+
+  /// Internal class for storing cached label interpolation results
+  class vtkInternal;
+
 protected:
   vtkITKMorphologicalContourInterpolator();
   ~vtkITKMorphologicalContourInterpolator();
 
   virtual void SimpleExecute(vtkImageData* input, vtkImageData* output) VTK_OVERRIDE;
 
+  /// Interpolate each label independently (see InterpolateLabelsInParallel)
+  void ExecuteLabelsInParallel(vtkImageData* input, vtkImageData* output);
+
   long Label;
   int Axis;
   bool HeuristicAlignment;
   bool UseDistanceTransform;
   bool UseBallStructuringElement;
+  bool InterpolateLabelsInParallel;
+  bool UseLabelCache;
+
+  int NumberOfInterpolatedLabels;
+  int NumberOfCachedLabels;
+
+  vtkInternal* Internal;
 
 private:
   vtkITKMorphologicalContourInterpolator(const vtkITKMorphologicalContourInterpolator&);  /// Not implemented.
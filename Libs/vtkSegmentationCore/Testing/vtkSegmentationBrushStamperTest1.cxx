@@ -0,0 +1,241 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkSphereSource.h>
+
+// SegmentationCore includes
+#include "vtkSegmentationBrushStamper.h"
+
+// STD includes
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CreateSphereBrushStencil(double radius, vtkPolyDataToImageStencil* polyDataToStencil)
+{
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(radius);
+  sphereSource->SetPhiResolution(32);
+  sphereSource->SetThetaResolution(32);
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputConnection(sphereSource->GetOutputPort());
+  normals->AutoOrientNormalsOn();
+  polyDataToStencil->SetInputConnection(normals->GetOutputPort());
+  polyDataToStencil->SetOutputSpacing(1.0, 1.0, 1.0);
+  int r = static_cast<int>(ceil(radius)) + 1;
+  polyDataToStencil->SetOutputWholeExtent(-r, r, -r, r, -r, r);
+  polyDataToStencil->Update();
+}
+
+//----------------------------------------------------------------------------
+void CreateImage(vtkImageData* image, int size)
+{
+  image->SetExtent(0, size - 1, 0, size - 1, 0, size - 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  memset(image->GetScalarPointer(), 0, size * size * size);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType CountNonZeroVoxels(vtkImageData* image)
+{
+  unsigned char* voxels = static_cast<unsigned char*>(image->GetScalarPointer());
+  vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+  vtkIdType count = 0;
+  for (vtkIdType i = 0; i < numberOfVoxels; i++)
+    {
+    if (voxels[i])
+      {
+      count++;
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+/// Read recorded strokes: one stroke per line, each stroke is a list of "i j k" brush positions
+bool ReadStrokes(const char* fileName, std::vector< std::vector<double> >& strokes)
+{
+  std::ifstream file(fileName);
+  if (!file.is_open())
+    {
+    return false;
+    }
+  std::string line;
+  while (std::getline(file, line))
+    {
+    std::istringstream lineStream(line);
+    std::vector<double> stroke;
+    double coordinate = 0.0;
+    while (lineStream >> coordinate)
+      {
+      stroke.push_back(coordinate);
+      }
+    if (stroke.size() >= 3)
+      {
+      strokes.push_back(stroke);
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSegmentationBrushStamperTest1(int argc, char* argv[])
+{
+  vtkNew<vtkPolyDataToImageStencil> polyDataToStencil;
+  CreateSphereBrushStencil(5.0, polyDataToStencil.GetPointer());
+
+  vtkNew<vtkSegmentationBrushStamper> stamper;
+  stamper->SetBrushStencil(polyDataToStencil->GetOutput());
+  stamper->SetFillValue(1);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Single stamp
+
+  vtkNew<vtkImageData> image;
+  CreateImage(image.GetPointer(), 64);
+
+  vtkNew<vtkPoints> positions;
+  positions->InsertNextPoint(32.0, 32.0, 32.0);
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!stamper->StampStroke(image.GetPointer(), positions.GetPointer(), modifiedExtent))
+    {
+    std::cerr << __LINE__ << ": StampStroke failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkIdType singleStampVoxels = CountNonZeroVoxels(image.GetPointer());
+  // Volume of a sphere with radius 5 is 523.6
+  if (singleStampVoxels < 400 || singleStampVoxels > 650)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of painted voxels: " << singleStampVoxels << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (modifiedExtent[0] < 26 || modifiedExtent[1] > 38 || modifiedExtent[0] > 32 || modifiedExtent[1] < 32)
+    {
+    std::cerr << __LINE__ << ": Unexpected modified extent: " << modifiedExtent[0] << ", " << modifiedExtent[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Stroke with gap between positions is filled by interpolation
+
+  CreateImage(image.GetPointer(), 64);
+  positions->Reset();
+  positions->InsertNextPoint(10.0, 32.0, 32.0);
+  positions->InsertNextPoint(50.0, 32.0, 32.0);
+  stamper->StampStroke(image.GetPointer(), positions.GetPointer(), modifiedExtent);
+  for (int i = 10; i <= 50; i++)
+    {
+    if (image->GetScalarComponentAsDouble(i, 32, 32, 0) != 1)
+      {
+      std::cerr << __LINE__ << ": Gap in painted stroke at voxel " << i << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (stamper->GetLastStrokeNumberOfStamps() < 3)
+    {
+    std::cerr << __LINE__ << ": Stroke positions were not interpolated" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Brush partially outside of the image is clipped
+
+  CreateImage(image.GetPointer(), 64);
+  positions->Reset();
+  positions->InsertNextPoint(0.0, 0.0, 0.0);
+  stamper->StampStroke(image.GetPointer(), positions.GetPointer(), modifiedExtent);
+  if (modifiedExtent[0] != 0 || modifiedExtent[2] != 0 || modifiedExtent[4] != 0)
+    {
+    std::cerr << __LINE__ << ": Modified extent is not clipped to the image" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkIdType clippedVoxels = CountNonZeroVoxels(image.GetPointer());
+  if (clippedVoxels <= 0 || clippedVoxels >= singleStampVoxels)
+    {
+    std::cerr << __LINE__ << ": Unexpected number of painted voxels in clipped brush: " << clippedVoxels << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Benchmark: replay recorded strokes (file given as first argument) or synthetic strokes
+
+  std::vector< std::vector<double> > strokes;
+  if (argc > 1)
+    {
+    if (!ReadStrokes(argv[1], strokes))
+      {
+      std::cerr << __LINE__ << ": Failed to read strokes from " << argv[1] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  else
+    {
+    for (int strokeIndex = 0; strokeIndex < 20; strokeIndex++)
+      {
+      std::vector<double> stroke;
+      for (int pointIndex = 0; pointIndex < 50; pointIndex++)
+        {
+        stroke.push_back(20.0 + pointIndex * 4.0);
+        stroke.push_back(20.0 + strokeIndex * 10.0);
+        stroke.push_back(128.0);
+        }
+      strokes.push_back(stroke);
+      }
+    }
+
+  vtkNew<vtkPolyDataToImageStencil> largeBrushToStencil;
+  CreateSphereBrushStencil(15.0, largeBrushToStencil.GetPointer());
+  stamper->SetBrushStencil(largeBrushToStencil->GetOutput());
+  CreateImage(image.GetPointer(), 256);
+  stamper->ResetStatistics();
+  for (size_t strokeIndex = 0; strokeIndex < strokes.size(); strokeIndex++)
+    {
+    positions->Reset();
+    for (size_t i = 0; i + 2 < strokes[strokeIndex].size(); i += 3)
+      {
+      positions->InsertNextPoint(strokes[strokeIndex][i], strokes[strokeIndex][i + 1], strokes[strokeIndex][i + 2]);
+      }
+    stamper->StampStroke(image.GetPointer(), positions.GetPointer(), modifiedExtent);
+    std::cout << "Stroke " << strokeIndex << ": " << stamper->GetLastStrokeNumberOfStamps() << " stamps, "
+      << stamper->GetLastStrokeTime() * 1000.0 << " ms" << std::endl;
+    }
+  if (stamper->GetNumberOfStrokes() != static_cast<int>(strokes.size()))
+    {
+    std::cerr << __LINE__ << ": Unexpected number of strokes in statistics" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Strokes: " << stamper->GetNumberOfStrokes()
+    << ", total time: " << stamper->GetTotalStrokeTime() * 1000.0 << " ms"
+    << ", maximum stroke time: " << stamper->GetMaximumStrokeTime() * 1000.0 << " ms" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+
+// SegmentationCore includes
+#include "vtkSegmentationPolygonExtrusionRasterizer.h"
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void SetPolygon(vtkPoints* points, const double* coordinates, int numberOfPoints)
+{
+  points->Reset();
+  for (int i = 0; i < numberOfPoints; i++)
+    {
+    points->InsertNextPoint(coordinates[2 * i], coordinates[2 * i + 1], 0.0);
+    }
+  points->Modified();
+}
+
+//----------------------------------------------------------------------------
+/// Independent even-odd point in polygon test. The polygon is closed
+/// implicitly from the last point to the first one, as in the rasterizer.
+bool IsInsidePolygon(vtkPoints* polygon, double x, double y)
+{
+  bool inside = false;
+  vtkIdType numberOfPoints = polygon->GetNumberOfPoints();
+  for (vtkIdType i = 0, j = numberOfPoints - 1; i < numberOfPoints; j = i++)
+    {
+    double pi[3] = { 0.0, 0.0, 0.0 };
+    double pj[3] = { 0.0, 0.0, 0.0 };
+    polygon->GetPoint(i, pi);
+    polygon->GetPoint(j, pj);
+    if ((pi[1] > y) != (pj[1] > y)
+      && x < (pj[0] - pi[0]) * (y - pi[1]) / (pj[1] - pi[1]) + pi[0])
+      {
+      inside = !inside;
+      }
+    }
+  return inside;
+}
+
+//----------------------------------------------------------------------------
+/// Rasterize the polygon into a cleared image of the given extent and compare
+/// every voxel with the extruded polygon evaluated at the voxel center.
+/// Polygon coordinates must be chosen so that no voxel center lies on an edge.
+bool RasterizeAndCompare(vtkSegmentationPolygonExtrusionRasterizer* rasterizer, vtkImageData* image,
+  const int extent[6], vtkIdType& numberOfFilledVoxels, int line)
+{
+  image->SetExtent(const_cast<int*>(extent));
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  memset(image->GetScalarPointer(), 0, image->GetNumberOfPoints());
+
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!rasterizer->Rasterize(image, modifiedExtent))
+    {
+    std::cerr << line << ": Rasterize failed" << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkMatrix4x4> imageIjkToPolygon;
+  vtkMatrix4x4::Invert(rasterizer->GetPolygonToImageIjkMatrix(), imageIjkToPolygon.GetPointer());
+  double range[2] =
+    {
+    std::min(rasterizer->GetExtrusionRange()[0], rasterizer->GetExtrusionRange()[1]),
+    std::max(rasterizer->GetExtrusionRange()[0], rasterizer->GetExtrusionRange()[1])
+    };
+  numberOfFilledVoxels = 0;
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++)
+        {
+        double ijk[4] = { double(i), double(j), double(k), 1.0 };
+        double polygonPoint[4] = { 0.0, 0.0, 0.0, 1.0 };
+        imageIjkToPolygon->MultiplyPoint(ijk, polygonPoint);
+        bool inExtrusionRange = (polygonPoint[2] >= range[0] && polygonPoint[2] <= range[1]);
+        bool inside = inExtrusionRange && IsInsidePolygon(rasterizer->GetPolygonPoints(), polygonPoint[0], polygonPoint[1]);
+        bool expectedFilled = inside;
+        if (!rasterizer->GetFillInside())
+          {
+          expectedFilled = rasterizer->GetOutsideLimitedToExtrusionRange() ? (inExtrusionRange && !inside) : !inside;
+          }
+        bool filled = (*static_cast<unsigned char*>(image->GetScalarPointer(i, j, k)) != 0);
+        if (filled != expectedFilled)
+          {
+          std::cerr << line << ": Voxel (" << i << ", " << j << ", " << k << ") is "
+            << (filled ? "filled" : "not filled") << ", expected the opposite" << std::endl;
+          return false;
+          }
+        if (filled)
+          {
+          numberOfFilledVoxels++;
+          bool inModifiedExtent = (i >= modifiedExtent[0] && i <= modifiedExtent[1]
+            && j >= modifiedExtent[2] && j <= modifiedExtent[3]
+            && k >= modifiedExtent[4] && k <= modifiedExtent[5]);
+          if (!inModifiedExtent)
+            {
+            std::cerr << line << ": Filled voxel (" << i << ", " << j << ", " << k
+              << ") is outside of the modified extent" << std::endl;
+            return false;
+            }
+          }
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSegmentationPolygonExtrusionRasterizerTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  const int extent[6] = { 0, 31, 0, 31, 0, 31 };
+  vtkNew<vtkImageData> image;
+  vtkNew<vtkPoints> polygon;
+  vtkNew<vtkMatrix4x4> polygonToImageIjk;
+  vtkNew<vtkSegmentationPolygonExtrusionRasterizer> rasterizer;
+  rasterizer->SetPolygonPoints(polygon.GetPointer());
+  rasterizer->SetPolygonToImageIjkMatrix(polygonToImageIjk.GetPointer());
+  vtkIdType numberOfFilledVoxels = 0;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Square with voxel centers 10..19 inside, extruded through slices 5..14
+
+  const double square[] = { 9.5, 9.5, 19.5, 9.5, 19.5, 19.5, 9.5, 19.5 };
+  SetPolygon(polygon.GetPointer(), square, 4);
+  rasterizer->SetExtrusionRange(4.5, 14.5);
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->SetExtent(const_cast<int*>(extent));
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  rasterizer->Rasterize(image.GetPointer(), modifiedExtent);
+  int expectedModifiedExtent[6] = { 10, 19, 10, 19, 5, 14 };
+  for (int i = 0; i < 6; i++)
+    {
+    if (modifiedExtent[i] != expectedModifiedExtent[i])
+      {
+      std::cerr << __LINE__ << ": Unexpected modified extent[" << i << "]: " << modifiedExtent[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), extent, numberOfFilledVoxels, __LINE__)
+    || numberOfFilledVoxels != 10 * 10 * 10)
+    {
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Concave polygon (C shape): rows cross the polygon boundary four times
+
+  const double cShape[] = { 4.5, 4.5, 25.5, 4.5, 25.5, 10.5, 12.5, 10.5, 12.5, 20.5, 25.5, 20.5, 25.5, 26.5, 4.5, 26.5 };
+  SetPolygon(polygon.GetPointer(), cShape, 8);
+  rasterizer->SetExtrusionRange(2.5, 20.5);
+  for (int fillMode = 0; fillMode < 3; fillMode++)
+    {
+    rasterizer->SetFillInside(fillMode == 0);
+    rasterizer->SetOutsideLimitedToExtrusionRange(fillMode == 2);
+    if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), extent, numberOfFilledVoxels, __LINE__))
+      {
+      std::cerr << "  fill mode: " << fillMode << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  rasterizer->FillInsideOn();
+  rasterizer->OutsideLimitedToExtrusionRangeOff();
+
+  //////////////////////////////////////////////////////////////////////////
+  // Open, self-intersecting contour as drawn by a quick stroke: it is closed
+  // from the last point to the first one and filled with the even-odd rule
+
+  const double stroke[] = { 3.37, 5.63, 27.63, 24.37, 27.37, 6.37, 4.63, 26.63, 15.37, 16.63 };
+  SetPolygon(polygon.GetPointer(), stroke, 5);
+  if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), extent, numberOfFilledVoxels, __LINE__)
+    || numberOfFilledVoxels == 0)
+    {
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Extrusion along image rows (polygon x, y, z axes are image J, K, I axes)
+
+  SetPolygon(polygon.GetPointer(), cShape, 8);
+  polygonToImageIjk->Zero();
+  polygonToImageIjk->SetElement(1, 0, 1.0);
+  polygonToImageIjk->SetElement(2, 1, 1.0);
+  polygonToImageIjk->SetElement(0, 2, 1.0);
+  polygonToImageIjk->SetElement(3, 3, 1.0);
+  polygonToImageIjk->Modified();
+  if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), extent, numberOfFilledVoxels, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Oblique extrusion of the concave polygon, clipped by the image extent
+
+  const double obliqueCShape[] = { 4.37, 4.63, 25.63, 4.37, 25.37, 10.63, 12.63, 10.37,
+    12.37, 20.63, 25.63, 20.37, 25.37, 26.63, 4.63, 26.37 };
+  SetPolygon(polygon.GetPointer(), obliqueCShape, 8);
+  polygonToImageIjk->Identity();
+  polygonToImageIjk->SetElement(0, 2, 0.3);
+  polygonToImageIjk->SetElement(1, 2, 0.2);
+  polygonToImageIjk->Modified();
+  rasterizer->SetExtrusionRange(-0.5, 31.5);
+  for (int fillMode = 0; fillMode < 3; fillMode++)
+    {
+    rasterizer->SetFillInside(fillMode == 0);
+    rasterizer->SetOutsideLimitedToExtrusionRange(fillMode == 2);
+    if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), extent, numberOfFilledVoxels, __LINE__))
+      {
+      std::cerr << "  fill mode: " << fillMode << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  rasterizer->FillInsideOn();
+  rasterizer->OutsideLimitedToExtrusionRangeOff();
+
+  //////////////////////////////////////////////////////////////////////////
+  // More threads than the multi-threader can run: every slice must still be
+  // rasterized
+
+  const int manySlicesExtent[6] = { 0, 7, 0, 7, 0, 2 * VTK_MAX_THREADS + 5 };
+  const double smallSquare[] = { 1.5, 1.5, 5.5, 1.5, 5.5, 5.5, 1.5, 5.5 };
+  SetPolygon(polygon.GetPointer(), smallSquare, 4);
+  polygonToImageIjk->Identity();
+  polygonToImageIjk->Modified();
+  rasterizer->SetExtrusionRange(-0.5, manySlicesExtent[5] + 0.5);
+  rasterizer->SetNumberOfThreads(VTK_MAX_THREADS + 3);
+  if (!RasterizeAndCompare(rasterizer.GetPointer(), image.GetPointer(), manySlicesExtent, numberOfFilledVoxels, __LINE__)
+    || numberOfFilledVoxels != 4 * 4 * (manySlicesExtent[5] + 1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
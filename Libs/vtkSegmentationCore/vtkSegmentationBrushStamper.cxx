@@ -0,0 +1,283 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSegmentationBrushStamper.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSegmentationBrushStamper);
+vtkCxxSetObjectMacro(vtkSegmentationBrushStamper, BrushStencil, vtkImageStencilData);
+
+namespace
+{
+//----------------------------------------------------------------------------
+/// Fill stencil runs of the brush shifted by offset, clipped to clipExtent.
+/// Extent of the brush stamp that intersects clipExtent is merged into modifiedExtent.
+template <class T>
+void StampBrushGeneric(vtkImageData* image, vtkImageStencilData* stencil, const int offset[3],
+  const int clipExtent[6], T fillValue, int modifiedExtent[6])
+{
+  int stencilExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  stencil->GetExtent(stencilExtent);
+
+  vtkIdType increments[3] = { 0, 0, 0 };
+  image->GetIncrements(increments);
+  T* imageOrigin = static_cast<T*>(image->GetScalarPointer(clipExtent[0], clipExtent[2], clipExtent[4]));
+
+  for (int z = stencilExtent[4]; z <= stencilExtent[5]; z++)
+    {
+    int imageZ = z + offset[2];
+    if (imageZ < clipExtent[4] || imageZ > clipExtent[5])
+      {
+      continue;
+      }
+    for (int y = stencilExtent[2]; y <= stencilExtent[3]; y++)
+      {
+      int imageY = y + offset[1];
+      if (imageY < clipExtent[2] || imageY > clipExtent[3])
+        {
+        continue;
+        }
+      T* rowPtr = imageOrigin
+        + (imageY - clipExtent[2]) * increments[1]
+        + (imageZ - clipExtent[4]) * increments[2];
+      int iter = 0;
+      int moreSubExtents = 1;
+      while (moreSubExtents)
+        {
+        int r1 = 0;
+        int r2 = -1;
+        moreSubExtents = stencil->GetNextExtent(r1, r2, stencilExtent[0], stencilExtent[1], y, z, iter);
+        if (r1 > r2)
+          {
+          continue;
+          }
+        int imageX1 = std::max(r1 + offset[0], clipExtent[0]);
+        int imageX2 = std::min(r2 + offset[0], clipExtent[1]);
+        if (imageX1 > imageX2)
+          {
+          continue;
+          }
+        std::fill(rowPtr + (imageX1 - clipExtent[0]), rowPtr + (imageX2 - clipExtent[0]) + 1, fillValue);
+
+        if (modifiedExtent[0] > modifiedExtent[1])
+          {
+          modifiedExtent[0] = imageX1;
+          modifiedExtent[1] = imageX2;
+          modifiedExtent[2] = modifiedExtent[3] = imageY;
+          modifiedExtent[4] = modifiedExtent[5] = imageZ;
+          }
+        else
+          {
+          modifiedExtent[0] = std::min(modifiedExtent[0], imageX1);
+          modifiedExtent[1] = std::max(modifiedExtent[1], imageX2);
+          modifiedExtent[2] = std::min(modifiedExtent[2], imageY);
+          modifiedExtent[3] = std::max(modifiedExtent[3], imageY);
+          modifiedExtent[4] = std::min(modifiedExtent[4], imageZ);
+          modifiedExtent[5] = std::max(modifiedExtent[5], imageZ);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int RoundToVoxel(double position)
+{
+  return static_cast<int>(floor(position + 0.5));
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkSegmentationBrushStamper::vtkSegmentationBrushStamper()
+{
+  this->BrushStencil = NULL;
+  this->FillValue = 1.0;
+  this->MaximumStepSize = 0.0;
+  this->ResetStatistics();
+}
+
+//----------------------------------------------------------------------------
+vtkSegmentationBrushStamper::~vtkSegmentationBrushStamper()
+{
+  this->SetBrushStencil(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationBrushStamper::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "BrushStencil: " << this->BrushStencil << "\n";
+  os << indent << "FillValue: " << this->FillValue << "\n";
+  os << indent << "MaximumStepSize: " << this->MaximumStepSize << "\n";
+  os << indent << "LastStrokeTime: " << this->LastStrokeTime << "\n";
+  os << indent << "LastStrokeNumberOfStamps: " << this->LastStrokeNumberOfStamps << "\n";
+  os << indent << "NumberOfStrokes: " << this->NumberOfStrokes << "\n";
+  os << indent << "TotalStrokeTime: " << this->TotalStrokeTime << "\n";
+  os << indent << "MaximumStrokeTime: " << this->MaximumStrokeTime << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationBrushStamper::ResetStatistics()
+{
+  this->LastStrokeTime = 0.0;
+  this->LastStrokeNumberOfStamps = 0;
+  this->NumberOfStrokes = 0;
+  this->TotalStrokeTime = 0.0;
+  this->MaximumStrokeTime = 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkSegmentationBrushStamper::GetEffectiveStepSize()
+{
+  if (this->MaximumStepSize != 0.0)
+    {
+    return this->MaximumStepSize;
+    }
+  if (!this->BrushStencil)
+    {
+    return 1.0;
+    }
+  // Half of the brush radius along the axes where the brush is not flat.
+  // A flat axis (brush thickness of a few voxels) is the slice normal of a 2D brush.
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->BrushStencil->GetExtent(extent);
+  double stepSize = -1.0;
+  for (int i = 0; i < 3; i++)
+    {
+    int size = extent[i * 2 + 1] - extent[i * 2] + 1;
+    if (size <= 3)
+      {
+      continue;
+      }
+    double halfRadius = size / 4.0;
+    if (stepSize < 0 || halfRadius < stepSize)
+      {
+      stepSize = halfRadius;
+      }
+    }
+  return std::max(stepSize, 1.0);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSegmentationBrushStamper::StampStroke(vtkImageData* image, vtkPoints* strokePositions_Ijk, int modifiedExtent[6])
+{
+  modifiedExtent[0] = modifiedExtent[2] = modifiedExtent[4] = 0;
+  modifiedExtent[1] = modifiedExtent[3] = modifiedExtent[5] = -1;
+  this->LastStrokeTime = 0.0;
+  this->LastStrokeNumberOfStamps = 0;
+
+  if (!image || !strokePositions_Ijk)
+    {
+    vtkErrorMacro("StampStroke: Invalid input image or stroke positions");
+    return false;
+    }
+  if (!this->BrushStencil)
+    {
+    vtkErrorMacro("StampStroke: Invalid brush stencil");
+    return false;
+    }
+  if (image->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("StampStroke: Only single-component images are supported");
+    return false;
+    }
+  int clipExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(clipExtent);
+  if (clipExtent[0] > clipExtent[1] || clipExtent[2] > clipExtent[3] || clipExtent[4] > clipExtent[5]
+    || !image->GetScalarPointer())
+    {
+    // Empty image, nothing to do
+    return true;
+    }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  double stepSize = this->GetEffectiveStepSize();
+  int lastOffset[3] = { 0, 0, 0 };
+  bool lastOffsetValid = false;
+  double previousPosition[3] = { 0.0, 0.0, 0.0 };
+  vtkIdType numberOfPoints = strokePositions_Ijk->GetNumberOfPoints();
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+    {
+    double position[3] = { 0.0, 0.0, 0.0 };
+    strokePositions_Ijk->GetPoint(pointIndex, position);
+
+    int numberOfSteps = 1;
+    if (pointIndex > 0 && stepSize > 0)
+      {
+      double distance = sqrt(vtkMath::Distance2BetweenPoints(previousPosition, position));
+      numberOfSteps = std::max(1, static_cast<int>(ceil(distance / stepSize)));
+      }
+
+    for (int step = 1; step <= numberOfSteps; step++)
+      {
+      double t = (pointIndex > 0) ? double(step) / numberOfSteps : 1.0;
+      int offset[3] =
+        {
+        RoundToVoxel(previousPosition[0] + t * (position[0] - previousPosition[0])),
+        RoundToVoxel(previousPosition[1] + t * (position[1] - previousPosition[1])),
+        RoundToVoxel(previousPosition[2] + t * (position[2] - previousPosition[2]))
+        };
+      if (lastOffsetValid && offset[0] == lastOffset[0] && offset[1] == lastOffset[1] && offset[2] == lastOffset[2])
+        {
+        // Same voxel as the previous stamp, it would not change anything
+        continue;
+        }
+      switch (image->GetScalarType())
+        {
+        vtkTemplateMacro(StampBrushGeneric<VTK_TT>(image, this->BrushStencil, offset, clipExtent,
+          static_cast<VTK_TT>(this->FillValue), modifiedExtent));
+        default:
+          vtkErrorMacro("StampStroke: Unknown scalar type");
+          return false;
+        }
+      lastOffset[0] = offset[0];
+      lastOffset[1] = offset[1];
+      lastOffset[2] = offset[2];
+      lastOffsetValid = true;
+      this->LastStrokeNumberOfStamps++;
+      }
+
+    previousPosition[0] = position[0];
+    previousPosition[1] = position[1];
+    previousPosition[2] = position[2];
+    }
+
+  if (modifiedExtent[0] <= modifiedExtent[1])
+    {
+    image->Modified();
+    }
+
+  this->LastStrokeTime = vtkTimerLog::GetUniversalTime() - startTime;
+  this->NumberOfStrokes++;
+  this->TotalStrokeTime += this->LastStrokeTime;
+  this->MaximumStrokeTime = std::max(this->MaximumStrokeTime, this->LastStrokeTime);
+  return true;
+}
@@ -0,0 +1,108 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSegmentationBrushStamper_h
+#define __vtkSegmentationBrushStamper_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkImageStencilData;
+class vtkPoints;
+
+/// \ingroup SegmentationCore
+/// \brief Rasterized brush that can be stamped along a paint stroke directly into a labelmap.
+///
+/// The brush shape is given as a stencil in the IJK coordinate system of the image to be modified,
+/// with the brush center at the IJK origin. The stencil is computed once for a given brush
+/// size, image spacing and orientation and then it is copied into the image at each brush
+/// position by filling stencil runs, without any further allocation or polydata processing.
+///
+/// Positions of a stroke are interpolated so that fast mouse movements do not leave gaps
+/// between consecutive brush stamps. Timing of the last stroke and cumulative statistics
+/// are recorded so that paint performance can be measured by replaying recorded strokes.
+class vtkSegmentationCore_EXPORT vtkSegmentationBrushStamper : public vtkObject
+{
+public:
+  static vtkSegmentationBrushStamper *New();
+  vtkTypeMacro(vtkSegmentationBrushStamper, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Brush shape in image IJK coordinate system, centered at the IJK origin
+  virtual void SetBrushStencil(vtkImageStencilData* brushStencil);
+  vtkGetObjectMacro(BrushStencil, vtkImageStencilData);
+
+  /// Value that is written into voxels covered by the brush. Default is 1.
+  vtkSetMacro(FillValue, double);
+  vtkGetMacro(FillValue, double);
+
+  /// Maximum distance (in voxels) between consecutive brush stamps.
+  /// If consecutive stroke positions are farther from each other then intermediate
+  /// positions are inserted by linear interpolation.
+  /// If 0 (default) then half of the brush radius is used.
+  /// If negative then no interpolation is performed.
+  vtkSetMacro(MaximumStepSize, double);
+  vtkGetMacro(MaximumStepSize, double);
+
+  /// Stamp the brush at each stroke position into the image.
+  /// \param image Image to modify. Must have a single scalar component.
+  /// \param strokePositions_Ijk Brush center positions in the IJK coordinate system of the image.
+  /// \param modifiedExtent Extent of the image region that was written to (empty if nothing was modified).
+  /// \return Success flag
+  bool StampStroke(vtkImageData* image, vtkPoints* strokePositions_Ijk, int modifiedExtent[6]);
+
+  /// Compute automatic maximum step size (in voxels) from the brush stencil extent
+  double GetEffectiveStepSize();
+
+  /// Time (in seconds) spent in the last \sa StampStroke call
+  vtkGetMacro(LastStrokeTime, double);
+  /// Number of brush stamps (including interpolated positions) in the last stroke
+  vtkGetMacro(LastStrokeNumberOfStamps, int);
+  /// Number of strokes since the last \sa ResetStatistics call
+  vtkGetMacro(NumberOfStrokes, int);
+  /// Total time (in seconds) of strokes since the last \sa ResetStatistics call
+  vtkGetMacro(TotalStrokeTime, double);
+  /// Longest stroke time (in seconds) since the last \sa ResetStatistics call
+  vtkGetMacro(MaximumStrokeTime, double);
+
+  /// Reset stroke timing statistics
+  void ResetStatistics();
+
+protected:
+  vtkImageStencilData* BrushStencil;
+  double FillValue;
+  double MaximumStepSize;
+
+  double LastStrokeTime;
+  int LastStrokeNumberOfStamps;
+  int NumberOfStrokes;
+  double TotalStrokeTime;
+  double MaximumStrokeTime;
+
+protected:
+  vtkSegmentationBrushStamper();
+  ~vtkSegmentationBrushStamper();
+
+private:
+  vtkSegmentationBrushStamper(const vtkSegmentationBrushStamper&); // Not implemented
+  void operator=(const vtkSegmentationBrushStamper&);              // Not implemented
+};
+
+#endif
@@ -0,0 +1,464 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSegmentationPolygonExtrusionRasterizer.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSegmentationPolygonExtrusionRasterizer);
+vtkCxxSetObjectMacro(vtkSegmentationPolygonExtrusionRasterizer, PolygonPoints, vtkPoints);
+vtkCxxSetObjectMacro(vtkSegmentationPolygonExtrusionRasterizer, PolygonToImageIjkMatrix, vtkMatrix4x4);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct PolygonEdge
+{
+  double Start[2];
+  double End[2];
+};
+
+//----------------------------------------------------------------------------
+/// Data shared by all threads of a rasterization
+struct RasterizationWork
+{
+  vtkImageData* Image;
+  int ImageExtent[6];
+  vtkIdType Increments[3];
+  // Pointer to the first voxel of the image extent
+  void* ScalarPointer;
+  // Range of image rows (j, k) that may contain filled voxels
+  int RowExtent[4];
+  double ImageIjkToPolygon[4][4];
+  std::vector<PolygonEdge> Edges;
+  double ExtrusionRange[2];
+  bool FillInside;
+  bool OutsideLimitedToExtrusionRange;
+  double FillValue;
+  int NumberOfThreads;
+  // Modified extent of each thread (6 values per thread)
+  std::vector<int> ModifiedExtents;
+};
+
+//----------------------------------------------------------------------------
+void MergeExtent(int extent[6], int i1, int i2, int j, int k)
+{
+  if (extent[0] > extent[1])
+    {
+    extent[0] = i1;
+    extent[1] = i2;
+    extent[2] = extent[3] = j;
+    extent[4] = extent[5] = k;
+    return;
+    }
+  extent[0] = std::min(extent[0], i1);
+  extent[1] = std::max(extent[1], i2);
+  extent[2] = std::min(extent[2], j);
+  extent[3] = std::max(extent[3], j);
+  extent[4] = std::min(extent[4], k);
+  extent[5] = std::max(extent[5], k);
+}
+
+//----------------------------------------------------------------------------
+/// Compute parameters of the crossings of the line (origin + t * direction) with polygon edges.
+/// Crossing is detected by the side of the line the edge endpoints are, using a half-open
+/// rule so that a line going through a vertex is counted exactly once.
+void ComputeCrossings(const std::vector<PolygonEdge>& edges, const double origin[2], const double direction[2],
+  std::vector<double>& crossings)
+{
+  crossings.clear();
+  double directionLength2 = direction[0] * direction[0] + direction[1] * direction[1];
+  for (std::vector<PolygonEdge>::const_iterator edgeIt = edges.begin(); edgeIt != edges.end(); ++edgeIt)
+    {
+    double startDistance = -direction[1] * (edgeIt->Start[0] - origin[0]) + direction[0] * (edgeIt->Start[1] - origin[1]);
+    double endDistance = -direction[1] * (edgeIt->End[0] - origin[0]) + direction[0] * (edgeIt->End[1] - origin[1]);
+    if ((startDistance > 0) == (endDistance > 0))
+      {
+      continue;
+      }
+    double edgeFraction = startDistance / (startDistance - endDistance);
+    double crossing[2] =
+      {
+      edgeIt->Start[0] + edgeFraction * (edgeIt->End[0] - edgeIt->Start[0]),
+      edgeIt->Start[1] + edgeFraction * (edgeIt->End[1] - edgeIt->Start[1])
+      };
+    crossings.push_back((direction[0] * (crossing[0] - origin[0]) + direction[1] * (crossing[1] - origin[1])) / directionLength2);
+    }
+  std::sort(crossings.begin(), crossings.end());
+}
+
+//----------------------------------------------------------------------------
+/// Compute voxel runs of image row (j, k) that are inside the extruded polygon.
+/// Returns false if the row does not intersect the extrusion range at all.
+/// extrusionRun is set to the voxel range of the row that is within the extrusion range.
+bool ComputeRowRuns(const RasterizationWork& work, int j, int k, std::vector<double>& crossings,
+  std::vector<int>& runs, int extrusionRun[2])
+{
+  runs.clear();
+  const double (*m)[4] = work.ImageIjkToPolygon;
+  // Polygon coordinates of voxel (0, j, k) and change of polygon coordinates per voxel along the row
+  double rowOrigin[3] = { 0.0, 0.0, 0.0 };
+  double rowDirection[3] = { 0.0, 0.0, 0.0 };
+  for (int r = 0; r < 3; r++)
+    {
+    rowOrigin[r] = m[r][1] * j + m[r][2] * k + m[r][3];
+    rowDirection[r] = m[r][0];
+    }
+
+  // Voxel range within the extrusion range
+  double extrusionStart = work.ImageExtent[0];
+  double extrusionEnd = work.ImageExtent[1];
+  if (fabs(rowDirection[2]) < 1e-12)
+    {
+    if (rowOrigin[2] < work.ExtrusionRange[0] || rowOrigin[2] > work.ExtrusionRange[1])
+      {
+      return false;
+      }
+    }
+  else
+    {
+    double t0 = (work.ExtrusionRange[0] - rowOrigin[2]) / rowDirection[2];
+    double t1 = (work.ExtrusionRange[1] - rowOrigin[2]) / rowDirection[2];
+    extrusionStart = std::max(extrusionStart, std::min(t0, t1));
+    extrusionEnd = std::min(extrusionEnd, std::max(t0, t1));
+    }
+  extrusionRun[0] = static_cast<int>(ceil(extrusionStart));
+  extrusionRun[1] = static_cast<int>(floor(extrusionEnd));
+  if (extrusionRun[0] > extrusionRun[1])
+    {
+    return false;
+    }
+
+  if (rowDirection[0] * rowDirection[0] + rowDirection[1] * rowDirection[1] < 1e-24)
+    {
+    // Row is parallel to the extrusion direction: all voxels project to the same polygon point.
+    // The point is inside if a ray from it crosses the polygon boundary an odd number of times.
+    double rayDirection[2] = { 1.0, 0.0 };
+    ComputeCrossings(work.Edges, rowOrigin, rayDirection, crossings);
+    int numberOfCrossingsAlongRay = static_cast<int>(crossings.end() - std::lower_bound(crossings.begin(), crossings.end(), 0.0));
+    if (numberOfCrossingsAlongRay % 2 == 1)
+      {
+      runs.push_back(extrusionRun[0]);
+      runs.push_back(extrusionRun[1]);
+      }
+    return true;
+    }
+
+  ComputeCrossings(work.Edges, rowOrigin, rowDirection, crossings);
+  for (size_t crossingIndex = 0; crossingIndex + 1 < crossings.size(); crossingIndex += 2)
+    {
+    int runStart = std::max(extrusionRun[0], static_cast<int>(ceil(crossings[crossingIndex])));
+    int runEnd = std::min(extrusionRun[1], static_cast<int>(floor(crossings[crossingIndex + 1])));
+    if (runStart <= runEnd)
+      {
+      runs.push_back(runStart);
+      runs.push_back(runEnd);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void RasterizeSlices(T*, RasterizationWork* work, int threadId, int numberOfThreads)
+{
+  const int* imageExtent = work->ImageExtent;
+  const vtkIdType* increments = work->Increments;
+  T* imageOrigin = static_cast<T*>(work->ScalarPointer);
+  T fillValue = static_cast<T>(work->FillValue);
+  int* modifiedExtent = &(work->ModifiedExtents[threadId * 6]);
+
+  std::vector<double> crossings;
+  std::vector<int> runs;
+  for (int k = work->RowExtent[2] + threadId; k <= work->RowExtent[3]; k += numberOfThreads)
+    {
+    for (int j = work->RowExtent[0]; j <= work->RowExtent[1]; j++)
+      {
+      int extrusionRun[2] = { 0, -1 };
+      bool rowInExtrusionRange = ComputeRowRuns(*work, j, k, crossings, runs, extrusionRun);
+      // Row pointer is indexed by voxel index relative to the start of the image extent
+      T* rowPtr = imageOrigin
+        + (j - imageExtent[2]) * increments[1]
+        + (k - imageExtent[4]) * increments[2];
+      if (work->FillInside)
+        {
+        for (size_t runIndex = 0; runIndex < runs.size(); runIndex += 2)
+          {
+          std::fill(rowPtr + (runs[runIndex] - imageExtent[0]), rowPtr + (runs[runIndex + 1] - imageExtent[0]) + 1, fillValue);
+          MergeExtent(modifiedExtent, runs[runIndex], runs[runIndex + 1], j, k);
+          }
+        continue;
+        }
+
+      // Fill outside: the complement of the runs within the row (or within the extrusion range)
+      int rowStart = imageExtent[0];
+      int rowEnd = imageExtent[1];
+      if (work->OutsideLimitedToExtrusionRange)
+        {
+        if (!rowInExtrusionRange)
+          {
+          continue;
+          }
+        rowStart = extrusionRun[0];
+        rowEnd = extrusionRun[1];
+        }
+      int gapStart = rowStart;
+      for (size_t runIndex = 0; runIndex <= runs.size(); runIndex += 2)
+        {
+        int gapEnd = (runIndex < runs.size()) ? runs[runIndex] - 1 : rowEnd;
+        if (gapStart <= gapEnd)
+          {
+          std::fill(rowPtr + (gapStart - imageExtent[0]), rowPtr + (gapEnd - imageExtent[0]) + 1, fillValue);
+          MergeExtent(modifiedExtent, gapStart, gapEnd, j, k);
+          }
+        if (runIndex < runs.size())
+          {
+          gapStart = std::max(gapStart, runs[runIndex + 1] + 1);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE RasterizeSlicesThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  RasterizationWork* work = static_cast<RasterizationWork*>(threadInfo->UserData);
+  // The threader may run fewer threads than requested (it is limited to VTK_MAX_THREADS),
+  // so slices are distributed among the threads that actually run.
+  switch (work->Image->GetScalarType())
+    {
+    vtkTemplateMacro(RasterizeSlices(static_cast<VTK_TT*>(NULL), work, threadInfo->ThreadID, threadInfo->NumberOfThreads));
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkSegmentationPolygonExtrusionRasterizer::vtkSegmentationPolygonExtrusionRasterizer()
+{
+  this->PolygonPoints = NULL;
+  this->PolygonToImageIjkMatrix = NULL;
+  this->ExtrusionRange[0] = -0.5;
+  this->ExtrusionRange[1] = 0.5;
+  this->FillInside = true;
+  this->OutsideLimitedToExtrusionRange = false;
+  this->FillValue = 1.0;
+  this->NumberOfThreads = 0;
+  this->LastRasterizationTime = 0.0;
+}
+
+//----------------------------------------------------------------------------
+vtkSegmentationPolygonExtrusionRasterizer::~vtkSegmentationPolygonExtrusionRasterizer()
+{
+  this->SetPolygonPoints(NULL);
+  this->SetPolygonToImageIjkMatrix(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationPolygonExtrusionRasterizer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "PolygonPoints: " << this->PolygonPoints << "\n";
+  os << indent << "PolygonToImageIjkMatrix: " << this->PolygonToImageIjkMatrix << "\n";
+  os << indent << "ExtrusionRange: " << this->ExtrusionRange[0] << ", " << this->ExtrusionRange[1] << "\n";
+  os << indent << "FillInside: " << (this->FillInside ? "true" : "false") << "\n";
+  os << indent << "OutsideLimitedToExtrusionRange: " << (this->OutsideLimitedToExtrusionRange ? "true" : "false") << "\n";
+  os << indent << "FillValue: " << this->FillValue << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "LastRasterizationTime: " << this->LastRasterizationTime << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkSegmentationPolygonExtrusionRasterizer::Rasterize(vtkImageData* image, int modifiedExtent[6])
+{
+  modifiedExtent[0] = modifiedExtent[2] = modifiedExtent[4] = 0;
+  modifiedExtent[1] = modifiedExtent[3] = modifiedExtent[5] = -1;
+  this->LastRasterizationTime = 0.0;
+
+  if (!image)
+    {
+    vtkErrorMacro("Rasterize: Invalid input image");
+    return false;
+    }
+  if (!this->PolygonPoints || !this->PolygonToImageIjkMatrix)
+    {
+    vtkErrorMacro("Rasterize: Polygon points and polygon to image IJK matrix must be set");
+    return false;
+    }
+  if (image->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("Rasterize: Only single-component images are supported");
+    return false;
+    }
+
+  RasterizationWork work;
+  image->GetExtent(work.ImageExtent);
+  if (work.ImageExtent[0] > work.ImageExtent[1] || work.ImageExtent[2] > work.ImageExtent[3]
+    || work.ImageExtent[4] > work.ImageExtent[5] || !image->GetScalarPointer())
+    {
+    // Empty image, nothing to do
+    return true;
+    }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  // Scan-convert the polygon once: store its edges and bounds in polygon coordinate system
+  vtkIdType numberOfPoints = this->PolygonPoints->GetNumberOfPoints();
+  double polygonBounds[4] = { 0.0, -1.0, 0.0, -1.0 };
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+    {
+    double start[3] = { 0.0, 0.0, 0.0 };
+    double end[3] = { 0.0, 0.0, 0.0 };
+    this->PolygonPoints->GetPoint(pointIndex, start);
+    this->PolygonPoints->GetPoint((pointIndex + 1) % numberOfPoints, end);
+    PolygonEdge edge;
+    edge.Start[0] = start[0];
+    edge.Start[1] = start[1];
+    edge.End[0] = end[0];
+    edge.End[1] = end[1];
+    work.Edges.push_back(edge);
+    if (pointIndex == 0)
+      {
+      polygonBounds[0] = polygonBounds[1] = start[0];
+      polygonBounds[2] = polygonBounds[3] = start[1];
+      }
+    polygonBounds[0] = std::min(polygonBounds[0], start[0]);
+    polygonBounds[1] = std::max(polygonBounds[1], start[0]);
+    polygonBounds[2] = std::min(polygonBounds[2], start[1]);
+    polygonBounds[3] = std::max(polygonBounds[3], start[1]);
+    }
+  if (numberOfPoints < 3 && this->FillInside)
+    {
+    // Degenerate polygon, nothing to fill
+    this->LastRasterizationTime = vtkTimerLog::GetUniversalTime() - startTime;
+    return true;
+    }
+
+  vtkNew<vtkMatrix4x4> imageIjkToPolygonMatrix;
+  vtkMatrix4x4::Invert(this->PolygonToImageIjkMatrix, imageIjkToPolygonMatrix.GetPointer());
+  for (int r = 0; r < 4; r++)
+    {
+    for (int c = 0; c < 4; c++)
+      {
+      work.ImageIjkToPolygon[r][c] = imageIjkToPolygonMatrix->GetElement(r, c);
+      }
+    }
+
+  work.RowExtent[0] = work.ImageExtent[2];
+  work.RowExtent[1] = work.ImageExtent[3];
+  work.RowExtent[2] = work.ImageExtent[4];
+  work.RowExtent[3] = work.ImageExtent[5];
+  if (this->FillInside)
+    {
+    // Only rows that intersect the bounding box of the extruded polygon can contain filled voxels
+    double boundsIjk[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+    for (int corner = 0; corner < 8; corner++)
+      {
+      double cornerPolygon[4] =
+        {
+        polygonBounds[corner & 1 ? 1 : 0],
+        polygonBounds[corner & 2 ? 3 : 2],
+        this->ExtrusionRange[corner & 4 ? 1 : 0],
+        1.0
+        };
+      double cornerIjk[4] = { 0.0, 0.0, 0.0, 1.0 };
+      this->PolygonToImageIjkMatrix->MultiplyPoint(cornerPolygon, cornerIjk);
+      for (int axis = 0; axis < 3; axis++)
+        {
+        if (corner == 0 || cornerIjk[axis] < boundsIjk[axis * 2])
+          {
+          boundsIjk[axis * 2] = cornerIjk[axis];
+          }
+        if (corner == 0 || cornerIjk[axis] > boundsIjk[axis * 2 + 1])
+          {
+          boundsIjk[axis * 2 + 1] = cornerIjk[axis];
+          }
+        }
+      }
+    work.RowExtent[0] = std::max(work.RowExtent[0], static_cast<int>(floor(boundsIjk[2])));
+    work.RowExtent[1] = std::min(work.RowExtent[1], static_cast<int>(ceil(boundsIjk[3])));
+    work.RowExtent[2] = std::max(work.RowExtent[2], static_cast<int>(floor(boundsIjk[4])));
+    work.RowExtent[3] = std::min(work.RowExtent[3], static_cast<int>(ceil(boundsIjk[5])));
+    }
+  if (work.RowExtent[0] > work.RowExtent[1] || work.RowExtent[2] > work.RowExtent[3])
+    {
+    // Extruded polygon is outside of the image
+    this->LastRasterizationTime = vtkTimerLog::GetUniversalTime() - startTime;
+    return true;
+    }
+
+  work.Image = image;
+  image->GetIncrements(work.Increments);
+  work.ScalarPointer = image->GetScalarPointer(work.ImageExtent[0], work.ImageExtent[2], work.ImageExtent[4]);
+  work.ExtrusionRange[0] = std::min(this->ExtrusionRange[0], this->ExtrusionRange[1]);
+  work.ExtrusionRange[1] = std::max(this->ExtrusionRange[0], this->ExtrusionRange[1]);
+  work.FillInside = this->FillInside;
+  work.OutsideLimitedToExtrusionRange = this->OutsideLimitedToExtrusionRange;
+  work.FillValue = this->FillValue;
+
+  int numberOfThreads = (this->NumberOfThreads > 0 ? this->NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  numberOfThreads = std::max(1, std::min(numberOfThreads, work.RowExtent[3] - work.RowExtent[2] + 1));
+  work.NumberOfThreads = numberOfThreads;
+  work.ModifiedExtents.resize(numberOfThreads * 6);
+  for (int threadId = 0; threadId < numberOfThreads; threadId++)
+    {
+    int* threadModifiedExtent = &(work.ModifiedExtents[threadId * 6]);
+    threadModifiedExtent[0] = threadModifiedExtent[2] = threadModifiedExtent[4] = 0;
+    threadModifiedExtent[1] = threadModifiedExtent[3] = threadModifiedExtent[5] = -1;
+    }
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(RasterizeSlicesThreadFunction, &work);
+  threader->SingleMethodExecute();
+
+  for (int threadId = 0; threadId < numberOfThreads; threadId++)
+    {
+    int* threadModifiedExtent = &(work.ModifiedExtents[threadId * 6]);
+    if (threadModifiedExtent[0] > threadModifiedExtent[1])
+      {
+      continue;
+      }
+    MergeExtent(modifiedExtent, threadModifiedExtent[0], threadModifiedExtent[1], threadModifiedExtent[2], threadModifiedExtent[4]);
+    MergeExtent(modifiedExtent, threadModifiedExtent[0], threadModifiedExtent[1], threadModifiedExtent[3], threadModifiedExtent[5]);
+    }
+
+  if (modifiedExtent[0] <= modifiedExtent[1])
+    {
+    image->Modified();
+    }
+
+  this->LastRasterizationTime = vtkTimerLog::GetUniversalTime() - startTime;
+  return true;
+}
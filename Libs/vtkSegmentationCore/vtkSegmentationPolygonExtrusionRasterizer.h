@@ -0,0 +1,112 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSegmentationPolygonExtrusionRasterizer_h
+#define __vtkSegmentationPolygonExtrusionRasterizer_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkPoints;
+
+/// \ingroup SegmentationCore
+/// \brief Fill the voxels of an extruded 2D polygon directly into a labelmap.
+///
+/// The polygon is specified by its (x, y) coordinates in a polygon coordinate system
+/// and it is extruded along the z axis of that coordinate system between the minimum
+/// and maximum extrusion depth (for example the polygon is drawn in slice view XY coordinates
+/// and extruded along the slice normal). The polygon coordinate system is mapped to the IJK
+/// coordinate system of the image by an affine matrix.
+///
+/// Instead of building a closed surface and converting it to an image stencil, each image row
+/// is intersected with the polygon edges analytically, therefore the cost is proportional to
+/// the number of image rows times the number of polygon edges, regardless of the extrusion length.
+/// Image slices are processed in parallel.
+class vtkSegmentationCore_EXPORT vtkSegmentationPolygonExtrusionRasterizer : public vtkObject
+{
+public:
+  static vtkSegmentationPolygonExtrusionRasterizer *New();
+  vtkTypeMacro(vtkSegmentationPolygonExtrusionRasterizer, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /// Polygon vertices. Only x and y coordinates are used. The polygon is closed implicitly.
+  /// Self-intersecting polygons are filled using the even-odd rule.
+  virtual void SetPolygonPoints(vtkPoints* points);
+  vtkGetObjectMacro(PolygonPoints, vtkPoints);
+
+  /// Affine transform from polygon coordinate system to image IJK coordinate system
+  virtual void SetPolygonToImageIjkMatrix(vtkMatrix4x4* matrix);
+  vtkGetObjectMacro(PolygonToImageIjkMatrix, vtkMatrix4x4);
+
+  /// Range of the extrusion along the z axis of the polygon coordinate system
+  vtkSetVector2Macro(ExtrusionRange, double);
+  vtkGetVector2Macro(ExtrusionRange, double);
+
+  /// If enabled (default) then voxels inside the extruded polygon are filled,
+  /// otherwise voxels outside of it.
+  vtkSetMacro(FillInside, bool);
+  vtkGetMacro(FillInside, bool);
+  vtkBooleanMacro(FillInside, bool);
+
+  /// If enabled then only voxels within the extrusion range are filled when filling outside.
+  /// This allows keeping one side of the slice plane unmodified. Disabled by default.
+  vtkSetMacro(OutsideLimitedToExtrusionRange, bool);
+  vtkGetMacro(OutsideLimitedToExtrusionRange, bool);
+  vtkBooleanMacro(OutsideLimitedToExtrusionRange, bool);
+
+  /// Value that is written into filled voxels. Default is 1.
+  vtkSetMacro(FillValue, double);
+  vtkGetMacro(FillValue, double);
+
+  /// Number of threads used for processing image slices.
+  /// If 0 (default) then the global default number of threads is used.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Fill voxels of the image.
+  /// \param image Image to modify. Must have a single scalar component.
+  /// \param modifiedExtent Extent of the image region that was written to (empty if nothing was modified).
+  /// \return Success flag
+  bool Rasterize(vtkImageData* image, int modifiedExtent[6]);
+
+  /// Time (in seconds) spent in the last \sa Rasterize call
+  vtkGetMacro(LastRasterizationTime, double);
+
+protected:
+  vtkPoints* PolygonPoints;
+  vtkMatrix4x4* PolygonToImageIjkMatrix;
+  double ExtrusionRange[2];
+  bool FillInside;
+  bool OutsideLimitedToExtrusionRange;
+  double FillValue;
+  int NumberOfThreads;
+  double LastRasterizationTime;
+
+protected:
+  vtkSegmentationPolygonExtrusionRasterizer();
+  ~vtkSegmentationPolygonExtrusionRasterizer();
+
+private:
+  vtkSegmentationPolygonExtrusionRasterizer(const vtkSegmentationPolygonExtrusionRasterizer&); // Not implemented
+  void operator=(const vtkSegmentationPolygonExtrusionRasterizer&);                            // Not implemented
+};
+
+#endif
@@ -33,18 +33,27 @@
 #include <vtkMRMLInteractionNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLSliceNode.h>
 
 // VTK includes
 #include <vtkAbstractWidget.h>
+#include <vtkActor2D.h>
 #include <vtkFollower.h>
+#include <vtkGlyph2D.h>
 #include <vtkHandleRepresentation.h>
 #include <vtkInteractorStyle.h>
+#include <vtkLabeledDataMapper.h>
 #include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkOrientedPolygonalHandleRepresentation3D.h>
 #include <vtkPickingManager.h>
+#include <vtkPointData.h>
 #include <vtkPointHandleRepresentation2D.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
@@ -53,10 +62,17 @@
 #include <vtkSeedRepresentation.h>
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
+#include <vtkStringArray.h>
+#include <vtkTextProperty.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
+#include <algorithm>
+#include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLMarkupsFiducialDisplayableManager2D);
@@ -246,14 +262,434 @@ public:
   bool PointMovedSinceStartInteraction;
 };
 
+//---------------------------------------------------------------------------
+class vtkMarkupsFiducialRendererUpdateObserver : public vtkCommand
+{
+public:
+  static vtkMarkupsFiducialRendererUpdateObserver *New()
+    {
+    return new vtkMarkupsFiducialRendererUpdateObserver;
+    }
+  vtkMarkupsFiducialRendererUpdateObserver()
+    {
+    this->DisplayableManager = 0;
+    }
+  virtual void Execute(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(calldata))
+    {
+    if (this->DisplayableManager)
+      {
+      this->DisplayableManager->UpdateFromRenderer();
+      }
+    }
+  vtkWeakPointer<vtkMRMLMarkupsFiducialDisplayableManager2D> DisplayableManager;
+};
+
+//---------------------------------------------------------------------------
+class vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal
+{
+public:
+  vtkInternal(vtkMRMLMarkupsFiducialDisplayableManager2D* external);
+  ~vtkInternal();
+
+  /// Display of all markups of a fiducial list that are close to the slice,
+  /// using a single glyph actor and a single label actor.
+  /// Visible markups are indexed by their position along the slice normal,
+  /// so that moving the slice only needs a binary search to find the markups
+  /// in the slice slab.
+  struct PointSetPipeline
+    {
+    PointSetPipeline();
+
+    /// Markups need to be read again from the node before the next render
+    bool MarkupsModified;
+
+    /// World position, selection and label of each markup
+    std::vector<double> WorldPositions;
+    std::vector<bool> Selected;
+    std::vector<std::string> Labels;
+
+    /// Visible markups sorted by SortKeys, the position of the markup
+    /// along SortDirection
+    std::vector<int> SortedMarkupIndices;
+    std::vector<double> SortKeys;
+    double SortDirection[3];
+
+    /// RAS to XY matrix and slice dimensions the points are displayed for
+    std::vector<double> DisplayedSliceGeometry;
+
+    vtkSmartPointer<vtkPolyData> GlyphPoints;
+    vtkSmartPointer<vtkMarkupsGlyphSource2D> GlyphSource;
+    vtkSmartPointer<vtkGlyph2D> Glypher;
+    vtkSmartPointer<vtkActor2D> GlyphActor;
+    vtkSmartPointer<vtkPolyData> LabelPoints;
+    vtkSmartPointer<vtkLabeledDataMapper> LabelMapper;
+    vtkSmartPointer<vtkActor2D> LabelActor;
+    };
+
+  PointSetPipeline* GetPointSetPipeline(vtkMRMLMarkupsNode* node);
+  PointSetPipeline* CreatePointSetPipeline(vtkMRMLMarkupsNode* node);
+  void RemovePointSetPipeline(vtkMRMLMarkupsNode* node);
+  void RemoveAllPointSetPipelines();
+
+  /// Read markups from the node and sort the visible ones along the direction
+  void UpdatePointSetMarkups(vtkMRMLMarkupsFiducialNode* node, PointSetPipeline* pipeline, const double direction[3]);
+  /// Sort visible markups along the direction
+  void SortPointSetMarkups(PointSetPipeline* pipeline, const double direction[3]);
+  /// Display the markups in the slice slab
+  void UpdatePointSetDisplay(vtkMRMLMarkupsFiducialNode* node, PointSetPipeline* pipeline);
+
+  void AddRendererUpdateObserver(vtkRenderer* renderer);
+  void RemoveRendererUpdateObserver();
+
+  std::map<vtkMRMLMarkupsNode*, PointSetPipeline> PointSetPipelines;
+
+  vtkSmartPointer<vtkMarkupsFiducialRendererUpdateObserver> RendererUpdateObserver;
+  unsigned long RendererUpdateObservationId;
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
+
+  vtkMRMLMarkupsFiducialDisplayableManager2D* External;
+};
+
+//---------------------------------------------------------------------------
+// vtkInternal methods
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::PointSetPipeline::PointSetPipeline()
+{
+  this->MarkupsModified = true;
+  this->SortDirection[0] = 0.0;
+  this->SortDirection[1] = 0.0;
+  this->SortDirection[2] = 0.0;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::vtkInternal(vtkMRMLMarkupsFiducialDisplayableManager2D* external)
+{
+  this->External = external;
+  this->RendererUpdateObserver = vtkSmartPointer<vtkMarkupsFiducialRendererUpdateObserver>::New();
+  this->RendererUpdateObserver->DisplayableManager = external;
+  this->RendererUpdateObservationId = 0;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::~vtkInternal()
+{
+  this->RemoveAllPointSetPipelines();
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::PointSetPipeline*
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::GetPointSetPipeline(vtkMRMLMarkupsNode* node)
+{
+  std::map<vtkMRMLMarkupsNode*, PointSetPipeline>::iterator it = this->PointSetPipelines.find(node);
+  return (it != this->PointSetPipelines.end() ? &it->second : NULL);
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::PointSetPipeline*
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::CreatePointSetPipeline(vtkMRMLMarkupsNode* node)
+{
+  PointSetPipeline* pipeline = &this->PointSetPipelines[node];
+
+  pipeline->GlyphPoints = vtkSmartPointer<vtkPolyData>::New();
+  pipeline->GlyphSource = vtkSmartPointer<vtkMarkupsGlyphSource2D>::New();
+  pipeline->Glypher = vtkSmartPointer<vtkGlyph2D>::New();
+  pipeline->Glypher->SetInputData(pipeline->GlyphPoints);
+  pipeline->Glypher->SetSourceConnection(pipeline->GlyphSource->GetOutputPort());
+  pipeline->Glypher->SetScaleModeToDataScalingOff();
+  pipeline->Glypher->SetColorModeToColorByScalar();
+  vtkNew<vtkPolyDataMapper2D> glyphMapper;
+  glyphMapper->SetInputConnection(pipeline->Glypher->GetOutputPort());
+  pipeline->GlyphActor = vtkSmartPointer<vtkActor2D>::New();
+  pipeline->GlyphActor->SetMapper(glyphMapper.GetPointer());
+
+  pipeline->LabelPoints = vtkSmartPointer<vtkPolyData>::New();
+  pipeline->LabelMapper = vtkSmartPointer<vtkLabeledDataMapper>::New();
+  pipeline->LabelMapper->SetInputData(pipeline->LabelPoints);
+  pipeline->LabelMapper->SetLabelModeToLabelFieldData();
+  pipeline->LabelMapper->SetFieldDataName("Labels");
+  pipeline->LabelMapper->SetCoordinateSystem(vtkLabeledDataMapper::DISPLAY);
+  pipeline->LabelMapper->GetLabelTextProperty()->SetJustificationToLeft();
+  pipeline->LabelMapper->GetLabelTextProperty()->SetVerticalJustificationToCentered();
+  pipeline->LabelMapper->GetLabelTextProperty()->ShadowOff();
+  pipeline->LabelActor = vtkSmartPointer<vtkActor2D>::New();
+  pipeline->LabelActor->SetMapper(pipeline->LabelMapper);
+
+  vtkRenderer* renderer = this->External->GetRenderer();
+  if (renderer)
+    {
+    renderer->AddViewProp(pipeline->GlyphActor);
+    renderer->AddViewProp(pipeline->LabelActor);
+    if (this->ObservedRenderer != renderer)
+      {
+      this->AddRendererUpdateObserver(renderer);
+      }
+    }
+  return pipeline;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::RemovePointSetPipeline(vtkMRMLMarkupsNode* node)
+{
+  std::map<vtkMRMLMarkupsNode*, PointSetPipeline>::iterator it = this->PointSetPipelines.find(node);
+  if (it == this->PointSetPipelines.end())
+    {
+    return;
+    }
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveViewProp(it->second.GlyphActor);
+    this->ObservedRenderer->RemoveViewProp(it->second.LabelActor);
+    }
+  this->PointSetPipelines.erase(it);
+  if (this->PointSetPipelines.empty())
+    {
+    this->RemoveRendererUpdateObserver();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::RemoveAllPointSetPipelines()
+{
+  while (!this->PointSetPipelines.empty())
+    {
+    this->RemovePointSetPipeline(this->PointSetPipelines.begin()->first);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::AddRendererUpdateObserver(vtkRenderer* renderer)
+{
+  this->RemoveRendererUpdateObserver();
+  if (renderer)
+    {
+    this->ObservedRenderer = renderer;
+    this->RendererUpdateObservationId = renderer->AddObserver(vtkCommand::StartEvent, this->RendererUpdateObserver);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::RemoveRendererUpdateObserver()
+{
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RendererUpdateObservationId);
+    this->RendererUpdateObservationId = 0;
+    this->ObservedRenderer = NULL;
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::UpdatePointSetMarkups(
+  vtkMRMLMarkupsFiducialNode* node, PointSetPipeline* pipeline, const double direction[3])
+{
+  int numberOfMarkups = node->GetNumberOfMarkups();
+  pipeline->WorldPositions.resize(3 * numberOfMarkups);
+  pipeline->Selected.resize(numberOfMarkups);
+  pipeline->Labels.resize(numberOfMarkups);
+  pipeline->SortedMarkupIndices.clear();
+  for (int n = 0; n < numberOfMarkups; n++)
+    {
+    double worldCoordinates[4] = { 0.0, 0.0, 0.0, 1.0 };
+    node->GetNthFiducialWorldCoordinates(n, worldCoordinates);
+    pipeline->WorldPositions[3 * n] = worldCoordinates[0];
+    pipeline->WorldPositions[3 * n + 1] = worldCoordinates[1];
+    pipeline->WorldPositions[3 * n + 2] = worldCoordinates[2];
+    pipeline->Selected[n] = node->GetNthFiducialSelected(n);
+    pipeline->Labels[n] = node->GetNthFiducialLabel(n);
+    if (node->GetNthFiducialVisibility(n))
+      {
+      pipeline->SortedMarkupIndices.push_back(n);
+      }
+    }
+  this->SortPointSetMarkups(pipeline, direction);
+  pipeline->MarkupsModified = false;
+}
+
+namespace
+{
+//---------------------------------------------------------------------------
+/// Order markup indices by their sort key
+struct MarkupSortKeyLess
+{
+  MarkupSortKeyLess(const std::vector<double>& keys) : Keys(keys) {}
+  bool operator()(int a, int b) const { return this->Keys[a] < this->Keys[b]; }
+  const std::vector<double>& Keys;
+};
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::SortPointSetMarkups(
+  PointSetPipeline* pipeline, const double direction[3])
+{
+  std::vector<double> markupKeys(pipeline->Selected.size());
+  for (size_t n = 0; n < markupKeys.size(); n++)
+    {
+    markupKeys[n] = vtkMath::Dot(direction, &pipeline->WorldPositions[3 * n]);
+    }
+  std::sort(pipeline->SortedMarkupIndices.begin(), pipeline->SortedMarkupIndices.end(),
+    MarkupSortKeyLess(markupKeys));
+  pipeline->SortKeys.resize(pipeline->SortedMarkupIndices.size());
+  for (size_t i = 0; i < pipeline->SortedMarkupIndices.size(); i++)
+    {
+    pipeline->SortKeys[i] = markupKeys[pipeline->SortedMarkupIndices[i]];
+    }
+  pipeline->SortDirection[0] = direction[0];
+  pipeline->SortDirection[1] = direction[1];
+  pipeline->SortDirection[2] = direction[2];
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::vtkInternal::UpdatePointSetDisplay(
+  vtkMRMLMarkupsFiducialNode* node, PointSetPipeline* pipeline)
+{
+  vtkMRMLSliceNode* sliceNode = this->External->GetMRMLSliceNode();
+  vtkMRMLMarkupsDisplayNode* displayNode = node->GetMarkupsDisplayNode();
+  if (!sliceNode || !displayNode
+    || !displayNode->GetVisibility(sliceNode->GetID())
+    || !displayNode->IsDisplayableInView(sliceNode->GetID())
+    || this->External->IsInLightboxMode())
+    {
+    // fiducials are not displayed in light box mode, see issue #1690
+    pipeline->GlyphActor->SetVisibility(false);
+    pipeline->LabelActor->SetVisibility(false);
+    pipeline->DisplayedSliceGeometry.clear();
+    return;
+    }
+
+  vtkNew<vtkMatrix4x4> rasToXY;
+  vtkMatrix4x4::Invert(sliceNode->GetXYToRAS(), rasToXY.GetPointer());
+  int* dimensions = sliceNode->GetDimensions();
+
+  bool markupsModified = pipeline->MarkupsModified;
+  double sliceNormal[3] = { rasToXY->GetElement(2, 0), rasToXY->GetElement(2, 1), rasToXY->GetElement(2, 2) };
+  if (markupsModified)
+    {
+    this->UpdatePointSetMarkups(node, pipeline, sliceNormal);
+    }
+  else if (sliceNormal[0] != pipeline->SortDirection[0]
+    || sliceNormal[1] != pipeline->SortDirection[1]
+    || sliceNormal[2] != pipeline->SortDirection[2])
+    {
+    // slice is rotated
+    this->SortPointSetMarkups(pipeline, sliceNormal);
+    }
+
+  std::vector<double> sliceGeometry(&rasToXY->Element[0][0], &rasToXY->Element[0][0] + 16);
+  sliceGeometry.insert(sliceGeometry.end(), dimensions, dimensions + 3);
+  if (!markupsModified && sliceGeometry == pipeline->DisplayedSliceGeometry)
+    {
+    // the displayed points are up-to-date
+    return;
+    }
+  pipeline->DisplayedSliceGeometry = sliceGeometry;
+
+  // same glyph and text as for the seeds
+  int glyphType = displayNode->GetGlyphType();
+  if (glyphType == vtkMRMLMarkupsDisplayNode::Sphere3D)
+    {
+    glyphType = vtkMRMLMarkupsDisplayNode::Circle2D;
+    }
+  else if (glyphType == vtkMRMLMarkupsDisplayNode::Diamond3D)
+    {
+    glyphType = vtkMRMLMarkupsDisplayNode::Diamond2D;
+    }
+  else if (displayNode->GlyphTypeIs3D())
+    {
+    glyphType = vtkMRMLMarkupsDisplayNode::StarBurst2D;
+    }
+  double glyphSize = displayNode->GetGlyphScale() * 2.0;
+  pipeline->GlyphSource->SetGlyphType(glyphType);
+  pipeline->GlyphSource->SetScale(glyphSize);
+  pipeline->GlyphSource->SetScale2(glyphSize);
+  pipeline->GlyphActor->GetProperty()->SetOpacity(displayNode->GetOpacity());
+  vtkTextProperty* labelTextProperty = pipeline->LabelMapper->GetLabelTextProperty();
+  labelTextProperty->SetColor(displayNode->GetColor());
+  labelTextProperty->SetOpacity(displayNode->GetOpacity());
+  labelTextProperty->SetFontSize(std::max(1, vtkMath::Round(displayNode->GetTextScale() * 4.0)));
+
+  unsigned char color[3];
+  unsigned char selectedColor[3];
+  for (int i = 0; i < 3; i++)
+    {
+    color[i] = static_cast<unsigned char>(vtkMath::ClampValue(displayNode->GetColor()[i], 0.0, 1.0) * 255.0);
+    selectedColor[i] = static_cast<unsigned char>(vtkMath::ClampValue(displayNode->GetSelectedColor()[i], 0.0, 1.0) * 255.0);
+    }
+
+  // the third XY coordinate of markups in the slice slab is in [-0.5, dimensions[2] - 0.5),
+  // same as in IsWidgetDisplayableOnSlice
+  double sliceOffset = rasToXY->GetElement(2, 3);
+  std::vector<double>::iterator first = std::lower_bound(
+    pipeline->SortKeys.begin(), pipeline->SortKeys.end(), -0.5 - sliceOffset);
+  std::vector<double>::iterator last = std::lower_bound(
+    first, pipeline->SortKeys.end(), dimensions[2] - 0.5 - sliceOffset);
+
+  vtkNew<vtkPoints> glyphPoints;
+  vtkNew<vtkUnsignedCharArray> glyphColors;
+  glyphColors->SetName("Colors");
+  glyphColors->SetNumberOfComponents(3);
+  vtkNew<vtkPoints> labelPoints;
+  vtkNew<vtkStringArray> labels;
+  labels->SetName("Labels");
+  for (std::vector<double>::iterator it = first; it != last; ++it)
+    {
+    int n = pipeline->SortedMarkupIndices[it - pipeline->SortKeys.begin()];
+    double worldCoordinates[4] =
+      {
+      pipeline->WorldPositions[3 * n],
+      pipeline->WorldPositions[3 * n + 1],
+      pipeline->WorldPositions[3 * n + 2],
+      1.0
+      };
+    double xy[4] = { 0.0, 0.0, 0.0, 1.0 };
+    rasToXY->MultiplyPoint(worldCoordinates, xy);
+    if (xy[0] < -glyphSize || xy[0] > dimensions[0] + glyphSize
+      || xy[1] < -glyphSize || xy[1] > dimensions[1] + glyphSize)
+      {
+      // outside the view
+      continue;
+      }
+    glyphPoints->InsertNextPoint(xy[0], xy[1], 0.0);
+    glyphColors->InsertNextTypedTuple(pipeline->Selected[n] ? selectedColor : color);
+    if (!pipeline->Labels[n].empty())
+      {
+      labelPoints->InsertNextPoint(xy[0] + glyphSize, xy[1], 0.0);
+      labels->InsertNextValue(pipeline->Labels[n]);
+      }
+    }
+
+  pipeline->GlyphPoints->SetPoints(glyphPoints.GetPointer());
+  pipeline->GlyphPoints->GetPointData()->SetScalars(glyphColors.GetPointer());
+  pipeline->LabelPoints->SetPoints(labelPoints.GetPointer());
+  pipeline->LabelPoints->GetPointData()->AddArray(labels.GetPointer());
+  pipeline->GlyphActor->SetVisibility(glyphPoints->GetNumberOfPoints() > 0);
+  pipeline->LabelActor->SetVisibility(labelPoints->GetNumberOfPoints() > 0);
+}
+
 //---------------------------------------------------------------------------
 // vtkMRMLMarkupsFiducialDisplayableManager2D methods
 
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::vtkMRMLMarkupsFiducialDisplayableManager2D()
+{
+  this->Focus = "vtkMRMLMarkupsFiducialNode";
+  this->MaximumNumberOfSeeds = 0;
+  this->Internal = new vtkInternal(this);
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLMarkupsFiducialDisplayableManager2D::~vtkMRMLMarkupsFiducialDisplayableManager2D()
+{
+  delete this->Internal;
+  this->Internal = NULL;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsFiducialDisplayableManager2D::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   this->Helper->PrintSelf(os, indent);
+  os << indent << "MaximumNumberOfSeeds: " << this->MaximumNumberOfSeeds << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -459,6 +895,11 @@ bool vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateNthSeedPositionFromMRML(i
     {
     return false;
     }
+  if (n >= seedRepresentation->GetNumberOfSeeds())
+    {
+    // no seed for this markup, it may be displayed as a point set
+    return false;
+    }
   bool positionChanged = false;
 
 //  std::cout << "UpdateNthSeedPositionFromMRML: n = " << n << std::endl;
@@ -1110,10 +1551,19 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::PropagateMRMLToWidget(vtkMRMLMa
   // XXX
 #endif
 
-  for (int n = 0; n < numberOfFiducials; n++)
+  if (this->UsePointSetDisplay(numberOfFiducials))
     {
-    // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
-    this->SetNthSeed(n, fiducialNode, seedWidget);
+    // too many markups to interact with, only display those near the slice
+    this->SetPointSetDisplay(fiducialNode, seedWidget);
+    }
+  else
+    {
+    this->RemovePointSetDisplay(fiducialNode);
+    for (int n = 0; n < numberOfFiducials; n++)
+      {
+      // std::cout << "Fids PropagateMRMLToWidget: n = " << n << std::endl;
+      this->SetNthSeed(n, fiducialNode, seedWidget);
+      }
     }
 
 
@@ -1450,6 +1900,14 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::UpdatePosition(vtkAbstractWidge
    return;
    }
 
+  vtkInternal::PointSetPipeline* pipeline = this->Internal->GetPointSetPipeline(pointsNode);
+  if (pipeline)
+    {
+    // markups are displayed as a point set, update them before next render
+    pipeline->MarkupsModified = true;
+    return;
+    }
+
   // now get the widget properties (coordinates, measurement etc.) and if the mrml node has changed, propagate the changes
 
 
@@ -1485,6 +1943,108 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLSceneEndClose()
 
   // clear out the map of glyph types
   this->Helper->ClearNodeGlyphTypes();
+
+  this->Internal->RemoveAllPointSetPipelines();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
+{
+  this->Superclass::OnMRMLSceneNodeRemoved(node);
+  this->RemovePointSetDisplay(vtkMRMLMarkupsNode::SafeDownCast(node));
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLSliceNodeModifiedEvent()
+{
+  bool pointSetDisplayed = false;
+  vtkMRMLMarkupsDisplayableManagerHelper::MarkupsNodeListIt it;
+  for (it = this->Helper->MarkupsNodeList.begin(); it != this->Helper->MarkupsNodeList.end(); ++it)
+    {
+    vtkMRMLMarkupsNode * markupsNode = *it;
+    if (this->Internal->GetPointSetPipeline(markupsNode))
+      {
+      // markups near the new slice position are found at next render
+      pointSetDisplayed = true;
+      continue;
+      }
+    vtkAbstractWidget* widget = this->Helper->GetWidget(markupsNode);
+    this->PropagateMRMLToWidget(markupsNode, widget);
+    }
+  if (pointSetDisplayed)
+    {
+    this->RequestRender();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsFiducialDisplayableManager2D::UsePointSetDisplay(int numberOfMarkups)
+{
+  return this->MaximumNumberOfSeeds > 0 && numberOfMarkups > this->MaximumNumberOfSeeds;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsFiducialDisplayableManager2D::IsPointSetDisplayed(vtkMRMLMarkupsNode* node)
+{
+  return node != NULL && this->Internal->GetPointSetPipeline(node) != NULL;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::SetPointSetDisplay(vtkMRMLMarkupsFiducialNode* fiducialNode, vtkSeedWidget* seedWidget)
+{
+  vtkInternal::PointSetPipeline* pipeline = this->Internal->GetPointSetPipeline(fiducialNode);
+  if (!pipeline)
+    {
+    vtkDebugMacro("SetPointSetDisplay: displaying " << fiducialNode->GetNumberOfMarkups()
+                  << " markups of " << (fiducialNode->GetID() ? fiducialNode->GetID() : "null id")
+                  << " as a point set");
+    pipeline = this->Internal->CreatePointSetPipeline(fiducialNode);
+    }
+
+  // seeds and their projections are replaced by the point set
+  vtkSeedRepresentation * seedRepresentation = vtkSeedRepresentation::SafeDownCast(seedWidget->GetRepresentation());
+  if (seedRepresentation && seedRepresentation->GetNumberOfSeeds() > 0)
+    {
+    for (int n = seedRepresentation->GetNumberOfSeeds() - 1; n >= 0; --n)
+      {
+      seedWidget->DeleteSeed(n);
+      }
+    for (int n = 0; n < fiducialNode->GetNumberOfMarkups(); n++)
+      {
+      vtkSeedWidget* projectionSeed =
+        vtkSeedWidget::SafeDownCast(this->Helper->GetPointProjectionWidget(fiducialNode->GetNthMarkupID(n)));
+      if (projectionSeed && projectionSeed->GetSeed(0))
+        {
+        projectionSeed->GetSeed(0)->Off();
+        }
+      }
+    }
+
+  pipeline->MarkupsModified = true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::RemovePointSetDisplay(vtkMRMLMarkupsNode* node)
+{
+  if (!node)
+    {
+    return;
+    }
+  this->Internal->RemovePointSetPipeline(node);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsFiducialDisplayableManager2D::UpdateFromRenderer()
+{
+  std::map<vtkMRMLMarkupsNode*, vtkInternal::PointSetPipeline>::iterator it;
+  for (it = this->Internal->PointSetPipelines.begin(); it != this->Internal->PointSetPipelines.end(); ++it)
+    {
+    vtkMRMLMarkupsFiducialNode* fiducialNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(it->first);
+    if (fiducialNode)
+      {
+      this->Internal->UpdatePointSetDisplay(fiducialNode, &it->second);
+      }
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -1510,6 +2070,11 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLMarkupsNodeNthMarkupModif
    vtkErrorMacro("OnMRMLMarkupsNodeNthMarkupModifiedEvent: Could not get seed widget!")
    return;
    }
+  if (this->UsePointSetDisplay(numberOfMarkups))
+    {
+    this->PropagateMRMLToWidget(node, widget);
+    return;
+    }
   this->SetNthSeed(n, vtkMRMLMarkupsFiducialNode::SafeDownCast(node), seedWidget);
 }
 
@@ -1545,6 +2110,13 @@ void vtkMRMLMarkupsFiducialDisplayableManager2D::OnMRMLMarkupsNodeMarkupAddedEve
    return;
    }
 
+  if (this->UsePointSetDisplay(markupsNode->GetNumberOfMarkups()))
+    {
+    // switch to (or update) point set display
+    this->PropagateMRMLToWidget(markupsNode, widget);
+    return;
+    }
+
   // this call will create a new handle and set it
   // std::cout << "OnMRMLMarkupsNodeMarkupAddedEvent: adding to markups node that currently has " << markupsNode->GetNumberOfMarkups() << std::endl;
   this->SetNthSeed(n, vtkMRMLMarkupsFiducialNode::SafeDownCast(markupsNode), seedWidget);
@@ -45,10 +45,26 @@ public:
   /// Update a single markup position from the seed widget, return true if the position changed
   virtual bool UpdateNthMarkupPositionFromWidget(int n, vtkMRMLMarkupsNode* pointsNode, vtkAbstractWidget * widget) VTK_OVERRIDE;
 
+  /// If positive, fiducial lists with more markups than this are not displayed
+  /// with a seed per markup, but all markups close to the slice are rendered by
+  /// a single glyph actor and a single label actor. These markups cannot be
+  /// moved in the slice view and have no slice projection. Takes effect at the
+  /// next update of the fiducial list.
+  /// Default is 0, all fiducial lists are displayed with seeds.
+  vtkSetMacro(MaximumNumberOfSeeds, int);
+  vtkGetMacro(MaximumNumberOfSeeds, int);
+
+  /// Return true if the markups of the node are displayed as a point set
+  /// \sa SetMaximumNumberOfSeeds
+  bool IsPointSetDisplayed(vtkMRMLMarkupsNode* node);
+
+  /// Update the point set display of large fiducial lists before rendering
+  void UpdateFromRenderer();
+
 protected:
 
-  vtkMRMLMarkupsFiducialDisplayableManager2D(){this->Focus="vtkMRMLMarkupsFiducialNode";}
-  virtual ~vtkMRMLMarkupsFiducialDisplayableManager2D(){}
+  vtkMRMLMarkupsFiducialDisplayableManager2D();
+  virtual ~vtkMRMLMarkupsFiducialDisplayableManager2D();
 
   /// Callback for click in RenderWindow
   virtual void OnClickInRenderWindow(double x, double y, const char *associatedNodeID) VTK_OVERRIDE;
@@ -82,6 +98,23 @@ protected:
 
   // Clean up when scene closes
   virtual void OnMRMLSceneEndClose() VTK_OVERRIDE;
+  virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node) VTK_OVERRIDE;
+
+  /// Update the widgets of small fiducial lists, point sets of large lists
+  /// are updated from the renderer
+  virtual void OnMRMLSliceNodeModifiedEvent() VTK_OVERRIDE;
+
+  /// Return true if a fiducial list with this number of markups is displayed as a point set
+  bool UsePointSetDisplay(int numberOfMarkups);
+  /// Display all markups of the fiducial list as a point set, removing the seeds
+  void SetPointSetDisplay(vtkMRMLMarkupsFiducialNode* fiducialNode, vtkSeedWidget *seedWidget);
+  /// Remove the point set display of the fiducial list
+  void RemovePointSetDisplay(vtkMRMLMarkupsNode* node);
+
+  int MaximumNumberOfSeeds;
+
+  class vtkInternal;
+  vtkInternal* Internal;
 
 private:
 
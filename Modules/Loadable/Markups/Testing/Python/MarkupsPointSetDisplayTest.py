@@ -0,0 +1,93 @@
+import unittest
+import vtk, slicer
+import logging
+
+class MarkupsPointSetDisplayTest(unittest.TestCase):
+  """Fiducial lists are displayed with interactive seeds in slice views unless
+  point set display is requested by setting the maximum number of seeds.
+  """
+  def setUp(self):
+    """ Do whatever is needed to reset the state - typically a scene clear will be enough.
+    """
+    slicer.mrmlScene.Clear(0)
+
+  def runTest(self):
+    """Run as few or as many tests as needed here.
+    """
+    self.setUp()
+    self.test_MarkupsPointSetDisplayTest()
+
+  #------------------------------------------------------------------------------
+  def test_MarkupsPointSetDisplayTest(self):
+    layoutManager = slicer.app.layoutManager()
+    self.assertIsNotNone(layoutManager)
+    layoutManager.setLayout(slicer.vtkMRMLLayoutNode.SlicerLayoutOneUpRedSliceView)
+    self.sliceView = layoutManager.sliceWidget('Red').sliceView()
+    self.displayableManager = self.getFiducialDisplayableManager(self.sliceView)
+    self.assertIsNotNone(self.displayableManager)
+
+    # markups are in the axial plane of the Red slice view
+    self.fiducialNode = slicer.vtkMRMLMarkupsFiducialNode()
+    slicer.mrmlScene.AddNode(self.fiducialNode)
+    for n in range(1001):
+      self.fiducialNode.AddFiducial((n % 40) - 20.0, (n // 40) - 12.0, 0.0)
+
+    try:
+      self.TestSection_SeedsByDefault()
+      self.TestSection_SwitchToPointSet()
+      self.TestSection_SwitchBackToSeeds()
+    finally:
+      self.displayableManager.SetMaximumNumberOfSeeds(0)
+    logging.info('Test finished')
+
+  #------------------------------------------------------------------------------
+  def getFiducialDisplayableManager(self, sliceView):
+    displayableManagers = vtk.vtkCollection()
+    sliceView.getDisplayableManagers(displayableManagers)
+    for i in range(displayableManagers.GetNumberOfItems()):
+      displayableManager = displayableManagers.GetItemAsObject(i)
+      if displayableManager.GetClassName() == 'vtkMRMLMarkupsFiducialDisplayableManager2D':
+        return displayableManager
+    return None
+
+  #------------------------------------------------------------------------------
+  def assertDisplay(self, pointSetDisplayed, message):
+    self.sliceView.forceRender()
+    seedWidget = self.displayableManager.GetHelper().GetWidget(self.fiducialNode)
+    self.assertIsNotNone(seedWidget, message)
+    numberOfSeeds = seedWidget.GetRepresentation().GetNumberOfSeeds()
+    self.assertEqual(self.displayableManager.IsPointSetDisplayed(self.fiducialNode), pointSetDisplayed, message)
+    if pointSetDisplayed:
+      self.assertEqual(numberOfSeeds, 0, message)
+    else:
+      # each markup can be picked and dragged
+      self.assertEqual(numberOfSeeds, self.fiducialNode.GetNumberOfMarkups(), message)
+      self.assertTrue(seedWidget.GetEnabled(), message)
+      self.assertTrue(seedWidget.GetProcessEvents(), message)
+
+  #------------------------------------------------------------------------------
+  def TestSection_SeedsByDefault(self):
+    # large lists keep their seeds unless point set display is requested
+    self.assertEqual(self.displayableManager.GetMaximumNumberOfSeeds(), 0)
+    self.assertDisplay(False, 'Large list with default settings')
+    self.fiducialNode.AddFiducial(0.0, 20.0, 0.0)
+    self.assertDisplay(False, 'Markup added with default settings')
+
+  #------------------------------------------------------------------------------
+  def TestSection_SwitchToPointSet(self):
+    self.displayableManager.SetMaximumNumberOfSeeds(1000)
+    # the setting takes effect at the next update of the list
+    self.fiducialNode.AddFiducial(1.0, 20.0, 0.0)
+    self.assertDisplay(True, 'List above the maximum number of seeds')
+    self.fiducialNode.SetNthFiducialPosition(0, 5.0, 5.0, 0.0)
+    self.assertDisplay(True, 'Markup moved in point set display')
+
+  #------------------------------------------------------------------------------
+  def TestSection_SwitchBackToSeeds(self):
+    while self.fiducialNode.GetNumberOfMarkups() > 1000:
+      self.fiducialNode.RemoveMarkup(0)
+    self.assertDisplay(False, 'List at the maximum number of seeds')
+
+    self.displayableManager.SetMaximumNumberOfSeeds(0)
+    self.fiducialNode.AddFiducial(2.0, 20.0, 0.0)
+    self.assertDisplay(False, 'Point set display disabled again')
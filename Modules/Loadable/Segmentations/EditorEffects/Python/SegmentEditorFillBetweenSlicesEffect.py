@@ -13,6 +13,13 @@ class SegmentEditorFillBetweenSlicesEffect(AbstractScriptedSegmentEditorAutoComp
     AbstractScriptedSegmentEditorAutoCompleteEffect.__init__(self, scriptedEffect)
     scriptedEffect.name = 'Fill between slices'
 
+    # Labels are interpolated in parallel and results are cached, so that during auto-update
+    # only the segments that have been modified since the last update are interpolated again.
+    import vtkITK
+    self.interpolator = vtkITK.vtkITKMorphologicalContourInterpolator()
+    self.interpolator.SetInterpolateLabelsInParallel(True)
+    self.interpolator.SetUseLabelCache(True)
+
   def clone(self):
     import qSlicerSegmentationsEditorEffectsPythonQt as effects
     clonedEffect = effects.qSlicerSegmentEditorScriptedEffect(None)
@@ -38,9 +45,13 @@ Masking settings are ignored. If segments overlap, segment higher in the segment
 The effect uses  <a href="http://insight-journal.org/browse/publication/977">morphological contour interpolation method</a>.
 <p></html>"""
 
+  def reset(self):
+    AbstractScriptedSegmentEditorAutoCompleteEffect.reset(self)
+    # Segment to label value mapping may change, therefore cached results are not reusable
+    self.interpolator.ClearLabelCache()
+
   def computePreviewLabelmap(self, mergedImage, outputLabelmap):
-    import vtkITK
-    interpolator = vtkITK.vtkITKMorphologicalContourInterpolator()
-    interpolator.SetInputData(mergedImage)
-    interpolator.Update()
-    outputLabelmap.DeepCopy(interpolator.GetOutput())
+    self.interpolator.SetInputData(mergedImage)
+    self.interpolator.Update()
+    outputLabelmap.DeepCopy(self.interpolator.GetOutput())
+    self.interpolator.SetInputData(None)
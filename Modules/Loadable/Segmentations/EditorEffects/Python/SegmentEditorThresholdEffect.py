@@ -18,6 +18,8 @@ class SegmentEditorThresholdEffect(AbstractScriptedSegmentEditorEffect):
 
     # Effect-specific members
     import vtkITK
+    # Histogram of the master volume is cached in the calculator, therefore switching between
+    # auto-threshold methods does not require traversing the master volume again
     self.autoThresholdCalculator = vtkITK.vtkITKImageThresholdCalculator()
 
     self.timer = qt.QTimer()
@@ -388,6 +390,11 @@ class SegmentEditorThresholdEffect(AbstractScriptedSegmentEditorEffect):
     # Set values to pipelines
     for sliceWidget in self.previewPipelines:
       pipeline = self.previewPipelines[sliceWidget]
+      if not sliceWidget.isVisible():
+        # Views that are not shown in the current layout do not need preview,
+        # skip them to not threshold slices that are not displayed
+        pipeline.actor.VisibilityOff()
+        continue
       pipeline.lookupTable.SetTableValue(1,  r, g, b,  opacity)
       sliceLogic = sliceWidget.sliceLogic()
       backgroundLogic = sliceLogic.GetBackgroundLayer()
@@ -26,6 +26,7 @@
 #include "vtkMRMLSegmentationsDisplayableManager2D.h"
 #include "vtkMRMLSegmentEditorNode.h"
 #include "vtkOrientedImageData.h"
+#include "vtkSegmentationBrushStamper.h"
 
 // Qt includes
 #include <QDebug>
@@ -260,6 +261,7 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   this->BrushPolyDataToStencil = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
   this->BrushPolyDataToStencil->SetOutputSpacing(1.0,1.0,1.0);
   this->BrushPolyDataToStencil->SetInputConnection(this->WorldOriginToModifierLabelmapIjkTransformer->GetOutputPort());
+  this->BrushStamper = vtkSmartPointer<vtkSegmentationBrushStamper>::New();
 
   this->FeedbackGlyphFilter = vtkSmartPointer<vtkGlyph3D>::New();
   this->FeedbackGlyphFilter->SetInputData(this->FeedbackPointsPolyData);
@@ -366,8 +368,6 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintApply(qMRMLWidget* viewWidget)
 
     this->BrushPolyDataToStencil->Update();
     vtkImageStencilData* stencilData = this->BrushPolyDataToStencil->GetOutput();
-    int stencilExtent[6]={0,-1,0,-1,0,-1};
-    stencilData->GetExtent(stencilExtent);
 
     vtkNew<vtkTransform> worldToModifierLabelmapIjkTransform;
 
@@ -384,50 +384,22 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintApply(qMRMLWidget* viewWidget)
     vtkNew<vtkPoints> paintCoordinates_Ijk;
     worldToModifierLabelmapIjkTransform->TransformPoints(this->PaintCoordinates_World, paintCoordinates_Ijk.GetPointer());
 
-    vtkNew<vtkImageStencilToImage> stencilToImage;
-    stencilToImage->SetInputConnection(this->BrushPolyDataToStencil->GetOutputPort());
-    stencilToImage->SetInsideValue(q->m_FillValue);
-    stencilToImage->SetOutsideValue(q->m_EraseValue);
-    stencilToImage->SetOutputScalarType(modifierLabelmap->GetScalarType());
-
-    vtkNew<vtkImageChangeInformation> brushPositioner;
-    brushPositioner->SetInputConnection(stencilToImage->GetOutputPort());
-    brushPositioner->SetOutputSpacing(modifierLabelmap->GetSpacing());
-    brushPositioner->SetOutputOrigin(modifierLabelmap->GetOrigin());
-
-    vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
+    // Stamp the rasterized brush at each (interpolated) stroke position directly into the modifier labelmap.
+    // The modifier labelmap is reset to erase value before each stroke, so writing fill value
+    // is equivalent to combining with maximum operation.
+    this->BrushStamper->SetBrushStencil(stencilData);
+    this->BrushStamper->SetFillValue(q->m_FillValue);
     int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
-    for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+    if (!this->BrushStamper->StampStroke(modifierLabelmap, paintCoordinates_Ijk.GetPointer(), updateExtent))
       {
-      double* shiftDouble = paintCoordinates_Ijk->GetPoint(pointIndex);
-      int shift[3] = {int(shiftDouble[0]+0.5), int(shiftDouble[1]+0.5), int(shiftDouble[2]+0.5)};
-      brushPositioner->SetExtentTranslation(shift);
-      brushPositioner->Update();
-      vtkNew<vtkOrientedImageData> orientedBrushPositionerOutput;
-      orientedBrushPositionerOutput->ShallowCopy(brushPositioner->GetOutput());
-      orientedBrushPositionerOutput->CopyDirections(modifierLabelmap);
-      if (pointIndex == 0)
-        {
-        orientedBrushPositionerOutput->GetExtent(updateExtent);
-        }
-      else
-        {
-        int* brushExtent = orientedBrushPositionerOutput->GetExtent();
-        for (int i = 0; i < 3; i++)
-          {
-          if (brushExtent[i * 2] < updateExtent[i * 2])
-            {
-            updateExtent[i * 2] = brushExtent[i * 2];
-            }
-          if (brushExtent[i * 2 + 1] > updateExtent[i * 2 + 1])
-            {
-            updateExtent[i * 2 + 1] = brushExtent[i * 2 + 1];
-            }
-          }
-        }
-      vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, orientedBrushPositionerOutput.GetPointer(), vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+      qCritical() << Q_FUNC_INFO << ": Failed to paint brush stroke";
+      }
+    if (updateExtent[0] > updateExtent[1] || updateExtent[2] > updateExtent[3] || updateExtent[4] > updateExtent[5])
+      {
+      // Brush did not intersect the labelmap, nothing to update
+      this->PaintCoordinates_World->Reset();
+      return;
       }
-    modifierLabelmap->Modified();
     for (int i = 0; i < 6; i++)
       {
       updateExtentList << updateExtent[i];
@@ -477,7 +449,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* vie
 
   // Brush stencil transform
 
-  this->WorldOriginToModifierLabelmapIjkTransform->Identity();
+  vtkNew<vtkTransform> worldOriginToModifierLabelmapIjkTransform;
 
   vtkNew<vtkMatrix4x4> segmentationToSegmentationIjkTransformMatrix;
   modifierLabelmap->GetImageToWorldMatrix(segmentationToSegmentationIjkTransformMatrix.GetPointer());
@@ -485,7 +457,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* vie
   segmentationToSegmentationIjkTransformMatrix->SetElement(0,3, 0);
   segmentationToSegmentationIjkTransformMatrix->SetElement(1,3, 0);
   segmentationToSegmentationIjkTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(segmentationToSegmentationIjkTransformMatrix.GetPointer());
+  worldOriginToModifierLabelmapIjkTransform->Concatenate(segmentationToSegmentationIjkTransformMatrix.GetPointer());
 
   vtkNew<vtkMatrix4x4> worldToSegmentationTransformMatrix;
   // We don't support painting in non-linearly transformed node (it could be implemented, but would probably slow down things too much)
@@ -494,7 +466,15 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* vie
   worldToSegmentationTransformMatrix->SetElement(0,3, 0);
   worldToSegmentationTransformMatrix->SetElement(1,3, 0);
   worldToSegmentationTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationTransformMatrix.GetPointer());
+  worldOriginToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationTransformMatrix.GetPointer());
+
+  // Only modify the transform if the labelmap geometry has changed, so that the brush is not
+  // rasterized again for each stroke when only the brush position changes.
+  if (!vtkOrientedImageDataResample::IsEqual(worldOriginToModifierLabelmapIjkTransform->GetMatrix(),
+    this->WorldOriginToModifierLabelmapIjkTransform->GetMatrix()))
+    {
+    this->WorldOriginToModifierLabelmapIjkTransform->SetMatrix(worldOriginToModifierLabelmapIjkTransform->GetMatrix());
+    }
 
   this->WorldOriginToModifierLabelmapIjkTransformer->Update();
   vtkPolyData* brushModel_ModifierLabelmapIjk = this->WorldOriginToModifierLabelmapIjkTransformer->GetOutput();
@@ -65,6 +65,7 @@ class vtkGlyph3D;
 class vtkPoints;
 class vtkPolyDataNormals;
 class vtkPolyDataToImageStencil;
+class vtkSegmentationBrushStamper;
 
 /// \ingroup SlicerRt_QtModules_Segmentations
 /// \brief Private implementation of the segment editor paint effect
@@ -139,6 +140,7 @@ public:
   vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToModifierLabelmapIjkTransformer;
   vtkSmartPointer<vtkTransform> WorldOriginToModifierLabelmapIjkTransform; // transforms from polydata source to modifierLabelmap's IJK coordinate system (brush origin in IJK origin)
   vtkSmartPointer<vtkPolyDataToImageStencil> BrushPolyDataToStencil;
+  vtkSmartPointer<vtkSegmentationBrushStamper> BrushStamper; // stamps the rasterized brush along the stroke into modifierLabelmap
 
   vtkSmartPointer<vtkGlyph3D> FeedbackGlyphFilter;
 
@@ -23,6 +23,7 @@
 
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
+#include "vtkSegmentationPolygonExtrusionRasterizer.h"
 #include "vtkMRMLSegmentEditorNode.h"
 
 // Qt includes
@@ -162,6 +163,12 @@ public:
   bool updateBrushModel(qMRMLWidget* viewWidget);
   /// Update image stencil from mesh
   bool updateBrushStencil(qMRMLWidget* viewWidget);
+  /// Fill the drawn polygon swept along the slice normal directly into the modifier labelmap
+  bool rasterizeBrushInSliceView(qMRMLSliceWidget* sliceWidget, vtkOrientedImageData* modifierLabelmap, int modifiedExtent[6]);
+  /// Compute bounds of the modifier labelmap in slice XY coordinate system.
+  /// Z range of segmentationBounds_SliceXY is restricted according to the slice cut mode.
+  bool computeSliceCutBounds(vtkMRMLSliceNode* sliceNode, vtkMatrix4x4* segmentationToWorldMatrix,
+    vtkOrientedImageData* modifierLabelmap, double segmentationBounds_SliceXY[6], double originalSegmentationBounds_SliceXY[6]);
   /// Paint brush into segment
   void paintApply(qMRMLWidget* viewWidget);
 
@@ -194,6 +201,8 @@ public:
   // transforms from polydata source to modifierLabelmap's IJK coordinate system (brush origin in IJK origin)
   vtkSmartPointer<vtkTransform> WorldToModifierLabelmapIjkTransform;
   vtkSmartPointer<vtkPolyDataToImageStencil> BrushPolyDataToStencil;
+  // fills the brush polygon directly into the modifier labelmap in slice views
+  vtkSmartPointer<vtkSegmentationPolygonExtrusionRasterizer> BrushRasterizer;
 
   QMap<qMRMLWidget*, ScissorsPipeline*> ScissorsPipelines;
 
@@ -237,6 +246,7 @@ qSlicerSegmentEditorScissorsEffectPrivate::qSlicerSegmentEditorScissorsEffectPri
   this->BrushPolyDataToStencil = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
   this->BrushPolyDataToStencil->SetOutputSpacing(1.0, 1.0, 1.0);
   this->BrushPolyDataToStencil->SetInputConnection(this->WorldToModifierLabelmapIjkTransformer->GetOutputPort());
+  this->BrushRasterizer = vtkSmartPointer<vtkSegmentationPolygonExtrusionRasterizer>::New();
 }
 
 //-----------------------------------------------------------------------------
@@ -454,6 +464,77 @@ void qSlicerSegmentEditorScissorsEffectPrivate::updateGlyphWithNewPosition(Sciss
     }
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerSegmentEditorScissorsEffectPrivate::computeSliceCutBounds(vtkMRMLSliceNode* sliceNode,
+  vtkMatrix4x4* segmentationToWorldMatrix, vtkOrientedImageData* modifierLabelmap,
+  double segmentationBounds_SliceXY[6], double originalSegmentationBounds_SliceXY[6])
+{
+  Q_Q(qSlicerSegmentEditorScissorsEffect);
+  if (!sliceNode || !segmentationToWorldMatrix || !modifierLabelmap)
+    {
+    qCritical() << Q_FUNC_INFO << ": Invalid inputs";
+    return false;
+    }
+
+  // Get modifier labelmap extent in slice coordinate system to know how much we
+  // have to cut through
+  vtkNew<vtkTransform> segmentationToSliceXYTransform;
+  vtkNew<vtkMatrix4x4> worldToSliceXYMatrix;
+  vtkMatrix4x4::Invert(sliceNode->GetXYToRAS(), worldToSliceXYMatrix.GetPointer());
+  segmentationToSliceXYTransform->Concatenate(worldToSliceXYMatrix.GetPointer());
+  segmentationToSliceXYTransform->Concatenate(segmentationToWorldMatrix);
+  vtkOrientedImageDataResample::TransformOrientedImageDataBounds(modifierLabelmap, segmentationToSliceXYTransform.GetPointer(), segmentationBounds_SliceXY);
+  vtkOrientedImageDataResample::TransformOrientedImageDataBounds(modifierLabelmap, segmentationToSliceXYTransform.GetPointer(), originalSegmentationBounds_SliceXY);
+  // Extend bounds by half slice to make sure the boundaries are included
+  int sliceCutMode = this->ConvertSliceCutModeFromString(q->parameter("SliceCutMode"));
+  switch (sliceCutMode)
+    {
+    case SliceCutModePositive:
+      segmentationBounds_SliceXY[4] = 0;
+      break;
+    case SliceCutModeNegative:
+      segmentationBounds_SliceXY[5] = 0;
+      break;
+    case SliceCutModeSymmetric:
+      {
+      vtkNew<vtkMatrix4x4> sliceXYToSegmentationTransform;
+      vtkMatrix4x4::Invert(segmentationToSliceXYTransform->GetMatrix(), sliceXYToSegmentationTransform.GetPointer());
+      double sliceNormalVector_SliceXY[4] = { 0, 0, 1, 0};
+      double sliceNormalVector_World[4] = { 0, 0, 1, 0 };
+      sliceXYToSegmentationTransform->MultiplyPoint(sliceNormalVector_SliceXY, sliceNormalVector_World);
+      double sliceThicknessMmPerPixel = vtkMath::Norm(sliceNormalVector_World);
+      double sliceCutDepthMm = q->doubleParameter("SliceCutDepthMm");
+      double halfSliceCutDepthPixel = sliceCutDepthMm / sliceThicknessMmPerPixel / 2.0;
+      if (halfSliceCutDepthPixel < 0.5)
+        {
+        // include at least the current slice
+        halfSliceCutDepthPixel = 0.5;
+        }
+      segmentationBounds_SliceXY[4] = -halfSliceCutDepthPixel;
+      segmentationBounds_SliceXY[5] = halfSliceCutDepthPixel;
+      }
+      break;
+    default:
+      // unlimited
+      break;
+    }
+  if (sliceCutMode != SliceCutModeSymmetric)
+    {
+    // Add half slice to make sure the current slice and the last slice are fully included
+    if (segmentationBounds_SliceXY[4] < segmentationBounds_SliceXY[5])
+      {
+      segmentationBounds_SliceXY[4] -= 0.5;
+      segmentationBounds_SliceXY[5] += 0.5;
+      }
+    else
+      {
+      segmentationBounds_SliceXY[4] += 0.5;
+      segmentationBounds_SliceXY[5] -= 0.5;
+      }
+    }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerSegmentEditorScissorsEffectPrivate::updateBrushModel(qMRMLWidget* viewWidget)
 {
@@ -514,66 +595,18 @@ bool qSlicerSegmentEditorScissorsEffectPrivate::updateBrushModel(qMRMLWidget* vi
       return false;
       }
 
-    // Get modifier labelmap extent in slice coordinate system to know how much we
-    // have to cut through
-    vtkNew<vtkTransform> segmentationToSliceXYTransform;
-    vtkNew<vtkMatrix4x4> worldToSliceXYMatrix;
-    vtkMatrix4x4::Invert(sliceNode->GetXYToRAS(), worldToSliceXYMatrix.GetPointer());
-    segmentationToSliceXYTransform->Concatenate(worldToSliceXYMatrix.GetPointer());
-    segmentationToSliceXYTransform->Concatenate(segmentationToWorldMatrix.GetPointer());
     double segmentationBounds_SliceXY[6] = { 0, -1, 0, -1, 0, -1 };
     double originalSegmentationBounds_SliceXY[6] = { 0, -1, 0, -1, 0, -1 };
-    vtkOrientedImageDataResample::TransformOrientedImageDataBounds(modifierLabelmap, segmentationToSliceXYTransform.GetPointer(), segmentationBounds_SliceXY);
-    vtkOrientedImageDataResample::TransformOrientedImageDataBounds(modifierLabelmap, segmentationToSliceXYTransform.GetPointer(), originalSegmentationBounds_SliceXY);
-    // Extend bounds by half slice to make sure the boundaries are included
-    int sliceCutMode = this->ConvertSliceCutModeFromString(q->parameter("SliceCutMode"));
-    switch (sliceCutMode)
+    if (!this->computeSliceCutBounds(sliceNode, segmentationToWorldMatrix.GetPointer(), modifierLabelmap,
+      segmentationBounds_SliceXY, originalSegmentationBounds_SliceXY))
       {
-      case SliceCutModePositive:
-        segmentationBounds_SliceXY[4] = 0;
-        break;
-      case SliceCutModeNegative:
-        segmentationBounds_SliceXY[5] = 0;
-        break;
-      case SliceCutModeSymmetric:
-        {
-        vtkNew<vtkMatrix4x4> sliceXYToSegmentationTransform;
-        vtkMatrix4x4::Invert(segmentationToSliceXYTransform->GetMatrix(), sliceXYToSegmentationTransform.GetPointer());
-        double sliceNormalVector_SliceXY[4] = { 0, 0, 1, 0};
-        double sliceNormalVector_World[4] = { 0, 0, 1, 0 };
-        sliceXYToSegmentationTransform->MultiplyPoint(sliceNormalVector_SliceXY, sliceNormalVector_World);
-        double sliceThicknessMmPerPixel = vtkMath::Norm(sliceNormalVector_World);
-        double sliceCutDepthMm = q->doubleParameter("SliceCutDepthMm");
-        double halfSliceCutDepthPixel = sliceCutDepthMm / sliceThicknessMmPerPixel / 2.0;
-        if (halfSliceCutDepthPixel < 0.5)
-          {
-          // include at least the current slice
-          halfSliceCutDepthPixel = 0.5;
-          }
-        segmentationBounds_SliceXY[4] = -halfSliceCutDepthPixel;
-        segmentationBounds_SliceXY[5] = halfSliceCutDepthPixel;
-        }
-        break;
-      default:
-        // unlimited
-        break;
+      return false;
       }
+    int sliceCutMode = this->ConvertSliceCutModeFromString(q->parameter("SliceCutMode"));
     if (sliceCutMode != SliceCutModeSymmetric)
       {
-      // Add half slice to make sure the current slice and the last slice are fully included
-      double brushZEpsilon = 0.0; // small offset to make have main and additional brush planes very close but not coincident
-      if (segmentationBounds_SliceXY[4] < segmentationBounds_SliceXY[5])
-        {
-        segmentationBounds_SliceXY[4] -= 0.5;
-        segmentationBounds_SliceXY[5] += 0.5;
-        brushZEpsilon = 0.001;
-        }
-      else
-        {
-        segmentationBounds_SliceXY[4] += 0.5;
-        segmentationBounds_SliceXY[5] -= 0.5;
-        brushZEpsilon = -0.001;
-        }
+      // small offset to make have main and additional brush planes very close but not coincident
+      double brushZEpsilon = (segmentationBounds_SliceXY[4] < segmentationBounds_SliceXY[5]) ? 0.001 : -0.001;
       if (!this->operationInside())
         {
         // Make sure the non-selected side of the plane is unaffected
@@ -863,6 +896,73 @@ bool qSlicerSegmentEditorScissorsEffectPrivate::updateBrushStencil(qMRMLWidget*
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerSegmentEditorScissorsEffectPrivate::rasterizeBrushInSliceView(qMRMLSliceWidget* sliceWidget,
+  vtkOrientedImageData* modifierLabelmap, int modifiedExtent[6])
+{
+  Q_Q(qSlicerSegmentEditorScissorsEffect);
+  ScissorsPipeline* pipeline = this->scissorsPipelineForWidget(sliceWidget);
+  if (!pipeline)
+    {
+    qCritical() << Q_FUNC_INFO << ": Failed to get pipeline";
+    return false;
+    }
+  vtkPoints* pointsXY = pipeline->PolyData->GetPoints();
+  if (!pointsXY || pointsXY->GetNumberOfPoints() <= 1)
+    {
+    return false;
+    }
+  vtkMRMLSegmentationNode* segmentationNode = q->parameterSetNode()->GetSegmentationNode();
+  if (!segmentationNode)
+    {
+    qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
+    return false;
+    }
+  vtkMRMLSliceNode* sliceNode = vtkMRMLSliceNode::SafeDownCast(qSlicerSegmentEditorAbstractEffect::viewNode(sliceWidget));
+  if (!sliceNode)
+    {
+    qCritical() << Q_FUNC_INFO << ": Failed to get slice node";
+    return false;
+    }
+
+  vtkNew<vtkMatrix4x4> segmentationToWorldMatrix;
+  // We don't support painting in non-linearly transformed node (it could be implemented, but would probably slow down things too much)
+  // TODO: show a meaningful error message to the user if attempted
+  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(segmentationNode->GetParentTransformNode(), NULL, segmentationToWorldMatrix.GetPointer());
+  double segmentationBounds_SliceXY[6] = { 0, -1, 0, -1, 0, -1 };
+  double originalSegmentationBounds_SliceXY[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!this->computeSliceCutBounds(sliceNode, segmentationToWorldMatrix.GetPointer(), modifierLabelmap,
+    segmentationBounds_SliceXY, originalSegmentationBounds_SliceXY))
+    {
+    return false;
+    }
+
+  vtkNew<vtkTransform> sliceXYToModifierLabelmapIjkTransform;
+  vtkNew<vtkMatrix4x4> segmentationToModifierLabelmapIjkMatrix;
+  modifierLabelmap->GetWorldToImageMatrix(segmentationToModifierLabelmapIjkMatrix.GetPointer());
+  sliceXYToModifierLabelmapIjkTransform->Concatenate(segmentationToModifierLabelmapIjkMatrix.GetPointer());
+  vtkNew<vtkMatrix4x4> worldToSegmentationMatrix;
+  vtkMatrix4x4::Invert(segmentationToWorldMatrix.GetPointer(), worldToSegmentationMatrix.GetPointer());
+  sliceXYToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationMatrix.GetPointer());
+  sliceXYToModifierLabelmapIjkTransform->Concatenate(sliceNode->GetXYToRAS());
+
+  // When working "outside" in positive or negative cut mode, the non-selected side
+  // of the slice plane must not be modified.
+  int sliceCutMode = this->ConvertSliceCutModeFromString(q->parameter("SliceCutMode"));
+  bool limitOutsideToCutRange = (sliceCutMode == SliceCutModePositive || sliceCutMode == SliceCutModeNegative);
+
+  this->BrushRasterizer->SetPolygonPoints(pointsXY);
+  this->BrushRasterizer->SetPolygonToImageIjkMatrix(sliceXYToModifierLabelmapIjkTransform->GetMatrix());
+  this->BrushRasterizer->SetExtrusionRange(segmentationBounds_SliceXY[4], segmentationBounds_SliceXY[5]);
+  this->BrushRasterizer->SetFillInside(this->operationInside());
+  this->BrushRasterizer->SetOutsideLimitedToExtrusionRange(limitOutsideToCutRange);
+  this->BrushRasterizer->SetFillValue(q->m_FillValue);
+  bool success = this->BrushRasterizer->Rasterize(modifierLabelmap, modifiedExtent);
+  // Do not keep references to the drawn polygon
+  this->BrushRasterizer->SetPolygonPoints(NULL);
+  return success;
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerSegmentEditorScissorsEffectPrivate::paintApply(qMRMLWidget* viewWidget)
 {
@@ -886,6 +986,29 @@ void qSlicerSegmentEditorScissorsEffectPrivate::paintApply(qMRMLWidget* viewWidg
     return;
     }
 
+  qSlicerSegmentEditorAbstractEffect::ModificationMode modificationMode = qSlicerSegmentEditorAbstractEffect::ModificationModeAdd;
+  if (this->operationErase())
+    {
+    modificationMode = qSlicerSegmentEditorAbstractEffect::ModificationModeRemove;
+    }
+
+  qMRMLSliceWidget* sliceWidget = qobject_cast<qMRMLSliceWidget*>(viewWidget);
+  if (sliceWidget)
+    {
+    // In slice views the brush is a polygon swept along the slice normal,
+    // which is filled directly into the modifier labelmap.
+    QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
+    int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (this->rasterizeBrushInSliceView(sliceWidget, modifierLabelmap, modifiedExtent)
+      && modifiedExtent[0] <= modifiedExtent[1])
+      {
+      q->saveStateForUndo();
+      q->modifySelectedSegmentByLabelmap(modifierLabelmap, modificationMode, modifiedExtent);
+      }
+    QApplication::restoreOverrideCursor();
+    return;
+    }
+
   if (!this->updateBrushModel(viewWidget))
     {
     return;
@@ -945,11 +1068,6 @@ void qSlicerSegmentEditorScissorsEffectPrivate::paintApply(qMRMLWidget* viewWidg
   vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, orientedBrushPositionerOutput.GetPointer(), vtkOrientedImageDataResample::OPERATION_MAXIMUM);
 
   // Notify editor about changes
-  qSlicerSegmentEditorAbstractEffect::ModificationMode modificationMode = qSlicerSegmentEditorAbstractEffect::ModificationModeAdd;
-  if (this->operationErase())
-    {
-    modificationMode = qSlicerSegmentEditorAbstractEffect::ModificationModeRemove;
-    }
   q->modifySelectedSegmentByLabelmap(modifierLabelmap, modificationMode);
 
   QApplication::restoreOverrideCursor();
@@ -288,6 +288,80 @@ public:
     vtkMTimeType SliceIntersectionUpdatedTime;
     };
 
+  /// Display pipeline that shows all binary labelmap segments of a display node
+  /// by reslicing a single merged labelmap. Colors, visibility and opacity of
+  /// the segments are applied by the lookup tables, so the cost of updating the
+  /// slice does not depend on the number of segments.
+  struct MergedLabelmapPipeline
+    {
+    MergedLabelmapPipeline()
+      {
+      this->NodeToWorldTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->WorldToNodeTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->MergedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+      this->MergedLabelmapUpdatedTime = 0;
+
+      this->OutlineActor = vtkSmartPointer<vtkActor2D>::New();
+      this->FillActor = vtkSmartPointer<vtkActor2D>::New();
+      this->Reslice = vtkSmartPointer<vtkImageReslice>::New();
+      this->SliceToImageTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+      this->LabelOutline = vtkSmartPointer<vtkImageLabelOutline>::New();
+      this->LookupTableOutline = vtkSmartPointer<vtkLookupTable>::New();
+      this->LookupTableFill = vtkSmartPointer<vtkLookupTable>::New();
+
+      this->Reslice->SetBackgroundColor(0.0, 0.0, 0.0, 0.0);
+      this->Reslice->AutoCropOutputOff();
+      this->Reslice->SetOptimization(1);
+      this->Reslice->SetOutputOrigin(0.0, 0.0, 0.0);
+      this->Reslice->SetOutputSpacing(1.0, 1.0, 1.0);
+      this->Reslice->SetOutputDimensionality(3);
+      this->Reslice->SetInterpolationModeToNearestNeighbor();
+
+      this->SliceToImageTransform->PostMultiply();
+
+      // Outline of all segments
+      this->LabelOutline->SetInputConnection(this->Reslice->GetOutputPort());
+      vtkSmartPointer<vtkImageMapToRGBA> outlineColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+      outlineColorMapper->SetInputConnection(this->LabelOutline->GetOutputPort());
+      outlineColorMapper->SetOutputFormatToRGBA();
+      outlineColorMapper->SetLookupTable(this->LookupTableOutline);
+      vtkSmartPointer<vtkImageMapper> imageOutlineMapper = vtkSmartPointer<vtkImageMapper>::New();
+      imageOutlineMapper->SetInputConnection(outlineColorMapper->GetOutputPort());
+      imageOutlineMapper->SetColorWindow(255);
+      imageOutlineMapper->SetColorLevel(127.5);
+      this->OutlineActor->SetMapper(imageOutlineMapper);
+      this->OutlineActor->SetVisibility(0);
+
+      // Fill of all segments
+      vtkSmartPointer<vtkImageMapToRGBA> fillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+      fillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
+      fillColorMapper->SetOutputFormatToRGBA();
+      fillColorMapper->SetLookupTable(this->LookupTableFill);
+      vtkSmartPointer<vtkImageMapper> imageFillMapper = vtkSmartPointer<vtkImageMapper>::New();
+      imageFillMapper->SetInputConnection(fillColorMapper->GetOutputPort());
+      imageFillMapper->SetColorWindow(255);
+      imageFillMapper->SetColorLevel(127.5);
+      this->FillActor->SetMapper(imageFillMapper);
+      this->FillActor->SetVisibility(0);
+      }
+
+    vtkSmartPointer<vtkGeneralTransform> NodeToWorldTransform;
+    vtkSmartPointer<vtkGeneralTransform> WorldToNodeTransform;
+
+    /// Label value of the n-th segment in MergedSegmentIDs is (n + 1)
+    vtkSmartPointer<vtkOrientedImageData> MergedLabelmap;
+    std::vector<std::string> MergedSegmentIDs;
+    vtkMTimeType MergedLabelmapUpdatedTime;
+
+    vtkSmartPointer<vtkActor2D> OutlineActor;
+    vtkSmartPointer<vtkActor2D> FillActor;
+    vtkSmartPointer<vtkImageReslice> Reslice;
+    vtkSmartPointer<vtkGeneralTransform> SliceToImageTransform;
+    vtkSmartPointer<vtkImageLabelOutline> LabelOutline;
+    vtkSmartPointer<vtkLookupTable> LookupTableOutline;
+    vtkSmartPointer<vtkLookupTable> LookupTableFill;
+    };
+
   typedef std::map<std::string, Pipeline*> PipelineMapType; // first: segment ID; second: display pipeline
   typedef std::map < vtkMRMLSegmentationDisplayNode*, PipelineMapType > PipelinesCacheType;
   PipelinesCacheType DisplayPipelines;
@@ -295,6 +369,12 @@ public:
   typedef std::map < vtkMRMLSegmentationNode*, std::set< vtkMRMLSegmentationDisplayNode* > > SegmentationToDisplayCacheType;
   SegmentationToDisplayCacheType SegmentationToDisplayNodes;
 
+  typedef std::map < vtkMRMLSegmentationDisplayNode*, MergedLabelmapPipeline* > MergedLabelmapPipelinesType;
+  MergedLabelmapPipelinesType MergedLabelmapPipelines;
+
+  /// Show binary labelmap representations using a merged labelmap per display node
+  bool MergedLabelmapDisplay;
+
   // Segmentations
   void AddSegmentationNode(vtkMRMLSegmentationNode* displayableNode);
   void RemoveSegmentationNode(vtkMRMLSegmentationNode* displayableNode);
@@ -317,6 +397,11 @@ public:
   void UpdateDisplayNodePipeline(vtkMRMLSegmentationDisplayNode*, PipelineMapType);
   void RemoveDisplayNode(vtkMRMLSegmentationDisplayNode* displayNode);
 
+  // Merged labelmap display
+  void UpdateMergedLabelmapPipeline(vtkMRMLSegmentationDisplayNode* displayNode, bool displayNodeVisible);
+  void HideMergedLabelmapPipeline(vtkMRMLSegmentationDisplayNode* displayNode);
+  void RemoveMergedLabelmapPipeline(vtkMRMLSegmentationDisplayNode* displayNode);
+
   // Observations
   void AddObservations(vtkMRMLSegmentationNode* node);
   void RemoveObservations(vtkMRMLSegmentationNode* node);
@@ -347,6 +432,7 @@ vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::vtkInternal(vtkMRMLSegmen
 : External(external)
 , AddingSegmentationNode(false)
 {
+  this->MergedLabelmapDisplay = false;
   this->SliceXYToRAS = vtkSmartPointer<vtkMatrix4x4>::New();
   this->SliceXYToRAS->Identity();
 
@@ -517,6 +603,11 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayableTra
         currentPipeline->SliceIntersectionUpdatedTime = 0; // Trigger slice intersection recomputation
         this->GetNodeTransformToWorld(mNode, currentPipeline->NodeToWorldTransform, currentPipeline->WorldToNodeTransform);
         }
+      MergedLabelmapPipelinesType::iterator mergedPipelineIt = this->MergedLabelmapPipelines.find(pipelinesIter->first);
+      if (mergedPipelineIt != this->MergedLabelmapPipelines.end())
+        {
+        this->GetNodeTransformToWorld(mNode, mergedPipelineIt->second->NodeToWorldTransform, mergedPipelineIt->second->WorldToNodeTransform);
+        }
       this->UpdateDisplayNodePipeline(pipelinesIter->first, pipelinesIter->second);
       }
     }
@@ -541,6 +632,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::RemoveDisplayNode(vt
     delete pipeline;
     }
   this->DisplayPipelines.erase(pipelinesIter);
+  this->RemoveMergedLabelmapPipeline(displayNode);
 }
 
 //---------------------------------------------------------------------------
@@ -712,6 +804,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       pipelineIt->second->ImageOutlineActor->SetVisibility(false);
       pipelineIt->second->ImageFillActor->SetVisibility(false);
       }
+    this->HideMergedLabelmapPipeline(displayNode);
     return;
     }
 
@@ -733,6 +826,22 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     return;
     }
 
+  // Show all segments with a single merged labelmap instead of the per-segment pipelines
+  if (this->MergedLabelmapDisplay
+    && shownRepresenatationName == vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName())
+    {
+    for (PipelineMapType::iterator pipelineIt=pipelines.begin(); pipelineIt!=pipelines.end(); ++pipelineIt)
+      {
+      pipelineIt->second->PolyDataOutlineActor->SetVisibility(false);
+      pipelineIt->second->PolyDataFillActor->SetVisibility(false);
+      pipelineIt->second->ImageOutlineActor->SetVisibility(false);
+      pipelineIt->second->ImageFillActor->SetVisibility(false);
+      }
+    this->UpdateMergedLabelmapPipeline(displayNode, displayNodeVisible);
+    return;
+    }
+  this->HideMergedLabelmapPipeline(displayNode);
+
   // For all pipelines (pipeline per segment)
   for (PipelineMapType::iterator pipelineIt=pipelines.begin(); pipelineIt!=pipelines.end(); ++pipelineIt)
     {
@@ -994,6 +1103,176 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateMergedLabelmapPipeline(
+  vtkMRMLSegmentationDisplayNode* displayNode, bool displayNodeVisible)
+{
+  vtkMRMLSegmentationNode* segmentationNode = vtkMRMLSegmentationNode::SafeDownCast(displayNode->GetDisplayableNode());
+  vtkSegmentation* segmentation = (segmentationNode ? segmentationNode->GetSegmentation() : NULL);
+  if (!segmentation)
+    {
+    this->HideMergedLabelmapPipeline(displayNode);
+    return;
+    }
+
+  MergedLabelmapPipeline* pipeline = NULL;
+  MergedLabelmapPipelinesType::iterator pipelineIt = this->MergedLabelmapPipelines.find(displayNode);
+  if (pipelineIt != this->MergedLabelmapPipelines.end())
+    {
+    pipeline = pipelineIt->second;
+    }
+  else
+    {
+    pipeline = new MergedLabelmapPipeline();
+    this->GetNodeTransformToWorld(segmentationNode, pipeline->NodeToWorldTransform, pipeline->WorldToNodeTransform);
+    this->External->GetRenderer()->AddActor(pipeline->FillActor);
+    this->External->GetRenderer()->AddActor(pipeline->OutlineActor);
+    this->MergedLabelmapPipelines[displayNode] = pipeline;
+    }
+
+  bool outlineVisible = displayNodeVisible && displayNode->GetVisibility2DOutline();
+  bool fillVisible = displayNodeVisible && displayNode->GetVisibility2DFill();
+
+  // Only visible segments are merged, so that hidden segments do not cover visible ones
+  // where they overlap (the last segment is shown in overlapping regions).
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  std::vector<std::string> visibleSegmentIDs;
+  vtkMTimeType latestModifiedTime = segmentation->GetMTime();
+  for (std::vector<std::string>::iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    vtkMRMLSegmentationDisplayNode::SegmentDisplayProperties properties;
+    displayNode->GetSegmentDisplayProperties(*segmentIdIt, properties);
+    if (!properties.Visible || !(properties.Visible2DOutline || properties.Visible2DFill))
+      {
+      continue;
+      }
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segmentation->GetSegmentRepresentation(
+      *segmentIdIt, vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+    if (!labelmap || labelmap->IsEmpty())
+      {
+      continue;
+      }
+    visibleSegmentIDs.push_back(*segmentIdIt);
+    latestModifiedTime = std::max(latestModifiedTime, labelmap->GetMTime());
+    }
+
+  if (visibleSegmentIDs.empty() || (!outlineVisible && !fillVisible))
+    {
+    pipeline->OutlineActor->SetVisibility(false);
+    pipeline->FillActor->SetVisibility(false);
+    return;
+    }
+
+  // Merge segments only if they changed since the last update, not when the slice changes
+  if (visibleSegmentIDs != pipeline->MergedSegmentIDs || latestModifiedTime > pipeline->MergedLabelmapUpdatedTime)
+    {
+    if (!segmentationNode->GenerateMergedLabelmap(pipeline->MergedLabelmap,
+      vtkSegmentation::EXTENT_UNION_OF_SEGMENTS, NULL, visibleSegmentIDs))
+      {
+      pipeline->OutlineActor->SetVisibility(false);
+      pipeline->FillActor->SetVisibility(false);
+      return;
+      }
+    pipeline->MergedSegmentIDs = visibleSegmentIDs;
+    pipeline->MergedLabelmapUpdatedTime = latestModifiedTime;
+    }
+  if (pipeline->MergedLabelmap->IsEmpty())
+    {
+    pipeline->OutlineActor->SetVisibility(false);
+    pipeline->FillActor->SetVisibility(false);
+    return;
+    }
+
+  // Segment colors, visibility and opacity: table value (n + 1) belongs to the n-th merged segment
+  const int numberOfTableValues = static_cast<int>(pipeline->MergedSegmentIDs.size()) + 1;
+  vtkLookupTable* lookupTables[2] = { pipeline->LookupTableOutline, pipeline->LookupTableFill };
+  for (int i = 0; i < 2; i++)
+    {
+    lookupTables[i]->SetNumberOfTableValues(numberOfTableValues);
+    lookupTables[i]->SetTableRange(0, numberOfTableValues - 1);
+    lookupTables[i]->SetTableValue(0, 0, 0, 0, 0);
+    }
+  for (int labelValue = 1; labelValue < numberOfTableValues; labelValue++)
+    {
+    const std::string& segmentID = pipeline->MergedSegmentIDs[labelValue - 1];
+    vtkMRMLSegmentationDisplayNode::SegmentDisplayProperties properties;
+    displayNode->GetSegmentDisplayProperties(segmentID, properties);
+    double color[3] = {vtkSegment::SEGMENT_COLOR_INVALID[0], vtkSegment::SEGMENT_COLOR_INVALID[1], vtkSegment::SEGMENT_COLOR_INVALID[2]};
+    displayNode->GetSegmentColor(segmentID, color);
+    double outlineOpacity = properties.Visible2DOutline ?
+      properties.Opacity2DOutline * displayNode->GetOpacity2DOutline() * displayNode->GetOpacity() : 0.0;
+    double fillOpacity = properties.Visible2DFill ?
+      properties.Opacity2DFill * displayNode->GetOpacity2DFill() * displayNode->GetOpacity() : 0.0;
+    pipeline->LookupTableOutline->SetTableValue(labelValue, color[0], color[1], color[2], outlineOpacity);
+    pipeline->LookupTableFill->SetTableValue(labelValue, color[0], color[1], color[2], fillOpacity);
+    }
+
+  // Calculate image IJK to world RAS transform
+  pipeline->SliceToImageTransform->Identity();
+  pipeline->SliceToImageTransform->Concatenate(this->SliceXYToRAS);
+  pipeline->SliceToImageTransform->Concatenate(pipeline->WorldToNodeTransform);
+  vtkSmartPointer<vtkMatrix4x4> worldToImageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  pipeline->MergedLabelmap->GetWorldToImageMatrix(worldToImageMatrix);
+  pipeline->SliceToImageTransform->Concatenate(worldToImageMatrix);
+
+  vtkSmartPointer<vtkImageData> identityImageData = vtkSmartPointer<vtkImageData>::New();
+  identityImageData->ShallowCopy(pipeline->MergedLabelmap);
+  identityImageData->SetOrigin(0.0, 0.0, 0.0);
+  identityImageData->SetSpacing(1.0, 1.0, 1.0);
+  pipeline->Reslice->SetInputData(identityImageData);
+
+  vtkSmartPointer<vtkTransform> linearSliceToImageTransform = vtkSmartPointer<vtkTransform>::New();
+  if (vtkMRMLTransformNode::IsGeneralTransformLinear(pipeline->SliceToImageTransform, linearSliceToImageTransform))
+    {
+    SnapToPermuteMatrix(linearSliceToImageTransform);
+    pipeline->Reslice->SetResliceTransform(linearSliceToImageTransform);
+    }
+  else
+    {
+    pipeline->Reslice->SetResliceTransform(pipeline->SliceToImageTransform);
+    }
+
+  int dimensions[3] = { 0, 0, 0 };
+  this->SliceNode->GetDimensions(dimensions);
+  int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
+  pipeline->Reslice->SetOutputExtent(sliceOutputExtent);
+
+  pipeline->LabelOutline->SetOutline(displayNode->GetSliceIntersectionThickness());
+
+  pipeline->OutlineActor->SetVisibility(outlineVisible);
+  pipeline->OutlineActor->SetPosition(0,0);
+  pipeline->FillActor->SetVisibility(fillVisible);
+  pipeline->FillActor->SetPosition(0,0);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::HideMergedLabelmapPipeline(vtkMRMLSegmentationDisplayNode* displayNode)
+{
+  MergedLabelmapPipelinesType::iterator pipelineIt = this->MergedLabelmapPipelines.find(displayNode);
+  if (pipelineIt == this->MergedLabelmapPipelines.end())
+    {
+    return;
+    }
+  pipelineIt->second->OutlineActor->SetVisibility(false);
+  pipelineIt->second->FillActor->SetVisibility(false);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::RemoveMergedLabelmapPipeline(vtkMRMLSegmentationDisplayNode* displayNode)
+{
+  MergedLabelmapPipelinesType::iterator pipelineIt = this->MergedLabelmapPipelines.find(displayNode);
+  if (pipelineIt == this->MergedLabelmapPipelines.end())
+    {
+    return;
+    }
+  MergedLabelmapPipeline* pipeline = pipelineIt->second;
+  this->External->GetRenderer()->RemoveActor(pipeline->OutlineActor);
+  this->External->GetRenderer()->RemoveActor(pipeline->FillActor);
+  delete pipeline;
+  this->MergedLabelmapPipelines.erase(pipelineIt);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::AddObservations(vtkMRMLSegmentationNode* node)
 {
@@ -1170,6 +1449,30 @@ void vtkMRMLSegmentationsDisplayableManager2D::PrintSelf(ostream& os, vtkIndent
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "vtkMRMLSegmentationsDisplayableManager2D: " << this->GetClassName() << "\n";
+  os << indent << "MergedLabelmapDisplay: " << (this->Internal->MergedLabelmapDisplay ? "On" : "Off") << "\n";
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationsDisplayableManager2D::SetMergedLabelmapDisplay(bool enable)
+{
+  if (this->Internal->MergedLabelmapDisplay == enable)
+    {
+    return;
+    }
+  this->Internal->MergedLabelmapDisplay = enable;
+  vtkInternal::PipelinesCacheType::iterator displayNodeIt;
+  for (displayNodeIt = this->Internal->DisplayPipelines.begin(); displayNodeIt != this->Internal->DisplayPipelines.end(); ++displayNodeIt)
+    {
+    this->Internal->UpdateDisplayNodePipeline(displayNodeIt->first, displayNodeIt->second);
+    }
+  this->Modified();
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLSegmentationsDisplayableManager2D::GetMergedLabelmapDisplay()
+{
+  return this->Internal->MergedLabelmapDisplay;
 }
 
 //---------------------------------------------------------------------------
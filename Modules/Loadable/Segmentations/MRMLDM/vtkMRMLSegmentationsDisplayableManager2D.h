@@ -52,6 +52,16 @@ public:
   virtual void GetVisibleSegmentsForPosition(double ras[3], vtkMRMLSegmentationDisplayNode* displayNode,
     vtkStringArray* segmentIDs, vtkDoubleArray* segmentValues = NULL);
 
+  /// Show binary labelmap representations by reslicing a single merged labelmap per
+  /// segmentation display node instead of one labelmap per segment. Fill and outline of
+  /// all segments are computed from the same slice and segment colors, visibility and
+  /// opacity are applied using lookup tables, therefore the cost of changing the slice
+  /// does not depend on the number of segments. Where visible segments overlap, only the
+  /// last segment is shown. Disabled by default.
+  void SetMergedLabelmapDisplay(bool enable);
+  bool GetMergedLabelmapDisplay();
+  vtkBooleanMacro(MergedLabelmapDisplay, bool);
+
 protected:
   virtual void UnobserveMRMLScene() VTK_OVERRIDE;
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node) VTK_OVERRIDE;
@@ -0,0 +1,176 @@
+import unittest
+import vtk, slicer
+import logging
+import vtkSegmentationCore
+from vtk.util import numpy_support
+
+class SegmentationsMergedLabelmapDisplayTest1(unittest.TestCase):
+  """Merged labelmap display of the 2D segmentations displayable manager must
+  render the same slice view as the per-segment display pipelines.
+  """
+  def setUp(self):
+    """ Do whatever is needed to reset the state - typically a scene clear will be enough.
+    """
+    slicer.mrmlScene.Clear(0)
+
+  def runTest(self):
+    """Run as few or as many tests as needed here.
+    """
+    self.setUp()
+    self.test_SegmentationsMergedLabelmapDisplayTest1()
+
+  #------------------------------------------------------------------------------
+  def test_SegmentationsMergedLabelmapDisplayTest1(self):
+    layoutManager = slicer.app.layoutManager()
+    self.assertIsNotNone(layoutManager)
+    layoutManager.setLayout(slicer.vtkMRMLLayoutNode.SlicerLayoutOneUpRedSliceView)
+    self.sliceWidget = layoutManager.sliceWidget('Red')
+    self.displayableManager = self.getSegmentationsDisplayableManager(self.sliceWidget.sliceView())
+    self.assertIsNotNone(self.displayableManager)
+
+    self.TestSection_CreateSegmentation()
+    self.TestSection_CompareDisplayModes()
+    self.TestSection_SegmentVisibility()
+    self.TestSection_SegmentColorAndOpacity()
+    self.TestSection_SegmentModified()
+
+    self.displayableManager.SetMergedLabelmapDisplay(False)
+    logging.info('Test finished')
+
+  #------------------------------------------------------------------------------
+  def getSegmentationsDisplayableManager(self, sliceView):
+    displayableManagers = vtk.vtkCollection()
+    sliceView.getDisplayableManagers(displayableManagers)
+    for i in range(displayableManagers.GetNumberOfItems()):
+      displayableManager = displayableManagers.GetItemAsObject(i)
+      if displayableManager.GetClassName() == 'vtkMRMLSegmentationsDisplayableManager2D':
+        return displayableManager
+    return None
+
+  #------------------------------------------------------------------------------
+  def createLabelmapImage(self, boxes):
+    """Labelmap with one box per label, boxes are (label, xMin, xMax, yMin, yMax)"""
+    imageData = vtk.vtkImageData()
+    imageData.SetDimensions(60, 60, 5)
+    imageData.AllocateScalars(vtk.VTK_UNSIGNED_CHAR, 1)
+    imageData.GetPointData().GetScalars().Fill(0)
+    for label, xMin, xMax, yMin, yMax in boxes:
+      for z in range(5):
+        for y in range(yMin, yMax + 1):
+          for x in range(xMin, xMax + 1):
+            imageData.SetScalarComponentFromDouble(x, y, z, 0, label)
+    return imageData
+
+  #------------------------------------------------------------------------------
+  def TestSection_CreateSegmentation(self):
+    # Separated boxes, so that the merged labelmap has no overlap
+    self.boxes = [(1, 5, 20, 5, 25), (2, 30, 50, 10, 20), (3, 10, 40, 35, 50)]
+    labelmapNode = slicer.mrmlScene.AddNewNodeByClass('vtkMRMLLabelMapVolumeNode')
+    labelmapNode.SetAndObserveImageData(self.createLabelmapImage(self.boxes))
+    labelmapNode.CreateDefaultDisplayNodes()
+
+    # Background volume with the same geometry is used for fitting the slice view
+    backgroundNode = slicer.mrmlScene.AddNewNodeByClass('vtkMRMLScalarVolumeNode')
+    backgroundImage = vtk.vtkImageData()
+    backgroundImage.SetDimensions(60, 60, 5)
+    backgroundImage.AllocateScalars(vtk.VTK_SHORT, 1)
+    backgroundImage.GetPointData().GetScalars().Fill(0)
+    backgroundNode.SetAndObserveImageData(backgroundImage)
+    backgroundNode.CreateDefaultDisplayNodes()
+
+    self.segmentationNode = slicer.mrmlScene.AddNewNodeByClass('vtkMRMLSegmentationNode')
+    self.segmentationNode.CreateDefaultDisplayNodes()
+    self.assertTrue(slicer.modules.segmentations.logic().ImportLabelmapToSegmentationNode(labelmapNode, self.segmentationNode))
+    slicer.mrmlScene.RemoveNode(labelmapNode)
+    self.assertEqual(self.segmentationNode.GetSegmentation().GetNumberOfSegments(), 3)
+    self.segmentIDs = [self.segmentationNode.GetSegmentation().GetNthSegmentID(i) for i in range(3)]
+
+    self.displayNode = self.segmentationNode.GetDisplayNode()
+    self.displayNode.SetPreferredDisplayRepresentationName2D(
+      vtkSegmentationCore.vtkSegmentationConverter.GetSegmentationBinaryLabelmapRepresentationName())
+
+    sliceLogic = self.sliceWidget.sliceLogic()
+    sliceLogic.GetSliceCompositeNode().SetBackgroundVolumeID(backgroundNode.GetID())
+    sliceLogic.GetSliceCompositeNode().SetLabelVolumeID(None)
+    sliceLogic.FitSliceToAll()
+    sliceLogic.SetSliceOffset(2.0)
+
+  #------------------------------------------------------------------------------
+  def captureView(self, mergedLabelmapDisplay):
+    self.displayableManager.SetMergedLabelmapDisplay(mergedLabelmapDisplay)
+    self.assertEqual(self.displayableManager.GetMergedLabelmapDisplay(), mergedLabelmapDisplay)
+    sliceView = self.sliceWidget.sliceView()
+    sliceView.forceRender()
+    windowToImage = vtk.vtkWindowToImageFilter()
+    windowToImage.SetInput(sliceView.renderWindow())
+    windowToImage.ReadFrontBufferOff()
+    windowToImage.Update()
+    return numpy_support.vtk_to_numpy(windowToImage.GetOutput().GetPointData().GetScalars()).astype(int)
+
+  #------------------------------------------------------------------------------
+  def assertSameView(self, message):
+    """Render the view with both display modes, check that they match and return the merged image"""
+    perSegmentImage = self.captureView(False)
+    mergedImage = self.captureView(True)
+    self.assertEqual(perSegmentImage.shape, mergedImage.shape)
+    numberOfDifferentPixels = (abs(perSegmentImage - mergedImage).max(axis=1) > 1).sum()
+    self.assertEqual(numberOfDifferentPixels, 0, message)
+    return mergedImage
+
+  #------------------------------------------------------------------------------
+  def TestSection_CompareDisplayModes(self):
+    self.displayNode.SetVisibility(False)
+    backgroundOnlyImage = self.assertSameView('Hidden segmentation')
+    self.displayNode.SetVisibility(True)
+    self.allVisibleImage = self.assertSameView('All segments visible')
+    self.assertTrue((self.allVisibleImage != backgroundOnlyImage).any(), 'Segments are not displayed')
+
+    self.displayNode.SetVisibility2DFill(False)
+    self.assertSameView('Outline only')
+    self.displayNode.SetVisibility2DFill(True)
+    self.displayNode.SetVisibility2DOutline(False)
+    self.assertSameView('Fill only')
+    self.displayNode.SetVisibility2DOutline(True)
+
+  #------------------------------------------------------------------------------
+  def TestSection_SegmentVisibility(self):
+    self.displayNode.SetSegmentVisibility(self.segmentIDs[1], False)
+    hiddenSegmentImage = self.assertSameView('Second segment hidden')
+    self.assertTrue((hiddenSegmentImage != self.allVisibleImage).any(), 'Segment visibility is not applied')
+
+    self.displayNode.SetSegmentVisibility2DFill(self.segmentIDs[0], False)
+    self.assertSameView('First segment fill hidden')
+    self.displayNode.SetSegmentVisibility2DFill(self.segmentIDs[0], True)
+
+    self.displayNode.SetSegmentVisibility(self.segmentIDs[1], True)
+    visibleAgainImage = self.assertSameView('Second segment shown again')
+    self.assertEqual(abs(visibleAgainImage - self.allVisibleImage).max(), 0)
+
+  #------------------------------------------------------------------------------
+  def TestSection_SegmentColorAndOpacity(self):
+    self.displayNode.SetSegmentOverrideColor(self.segmentIDs[2], 0.1, 0.9, 0.2)
+    recoloredImage = self.assertSameView('Override color')
+    self.assertTrue((recoloredImage != self.allVisibleImage).any(), 'Segment color is not applied')
+
+    self.displayNode.SetSegmentOpacity2DFill(self.segmentIDs[0], 0.2)
+    self.assertSameView('Segment fill opacity')
+    self.displayNode.SetOpacity(0.6)
+    self.assertSameView('Display node opacity')
+    self.displayNode.SetSliceIntersectionThickness(3)
+    self.assertSameView('Outline thickness')
+
+  #------------------------------------------------------------------------------
+  def TestSection_SegmentModified(self):
+    # Replace the labelmap of the first segment, merged labelmap must be regenerated
+    updatedImage = self.createLabelmapImage([(1, 5, 12, 5, 40)])
+    labelmapNode = slicer.mrmlScene.AddNewNodeByClass('vtkMRMLLabelMapVolumeNode')
+    labelmapNode.SetAndObserveImageData(updatedImage)
+    updatedSegmentIDs = vtk.vtkStringArray()
+    updatedSegmentIDs.InsertNextValue(self.segmentIDs[0])
+    self.assertTrue(slicer.vtkSlicerSegmentationsModuleLogic.ImportLabelmapToSegmentationNode(
+      labelmapNode, self.segmentationNode, updatedSegmentIDs))
+    slicer.mrmlScene.RemoveNode(labelmapNode)
+    self.assertSameView('Segment labelmap modified')
+
+    self.segmentationNode.GetSegmentation().RemoveSegment(self.segmentIDs[1])
+    self.assertSameView('Segment removed')
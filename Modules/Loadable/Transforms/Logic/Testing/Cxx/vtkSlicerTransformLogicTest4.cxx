@@ -0,0 +1,374 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkSlicerTransformLogic.h"
+#include "vtkTransformVisualizerGlyph3D.h"
+
+// MRML includes
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTransformDisplayNode.h"
+#include "vtkOrientedGridTransform.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkGeneralTransform.h>
+#include <vtkGlyphSource2D.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Points with random displacement vectors, including vectors along the x axis
+void CreateDisplacementSamples(vtkPolyData* samples, int numberOfSamples)
+{
+  vtkMath::RandomSeed(42);
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("DisplacementVector");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> magnitudes;
+  magnitudes->SetName(vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  for (int i = 0; i < numberOfSamples; i++)
+    {
+    points->InsertNextPoint(vtkMath::Random(-50, 50), vtkMath::Random(-50, 50), vtkMath::Random(-50, 50));
+    double vector[3] = { vtkMath::Random(-5, 5), vtkMath::Random(-5, 5), vtkMath::Random(-5, 5) };
+    if (i % 7 == 1)
+      {
+      vector[1] = vector[2] = 0.0;
+      }
+    if (i % 11 == 2)
+      {
+      vector[0] = vector[1] = vector[2] = 0.0;
+      }
+    vectors->InsertNextTuple(vector);
+    magnitudes->InsertNextValue(vtkMath::Norm(vector));
+    }
+  samples->SetPoints(points.GetPointer());
+  samples->GetPointData()->SetVectors(vectors.GetPointer());
+  int idx = samples->GetPointData()->AddArray(magnitudes.GetPointer());
+  samples->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+}
+
+//----------------------------------------------------------------------------
+/// Compare glyph points to glyphs generated by transforming the source points one by one
+bool CheckGlyphs(vtkTransformVisualizerGlyph3D* glyphFilter, vtkPolyData* samples,
+  vtkPolyData* source, vtkTransform* sourceTransform, double thresholdLower, int line)
+{
+  glyphFilter->Update();
+  vtkPolyData* glyphs = glyphFilter->GetOutput();
+  vtkDataArray* vectors = samples->GetPointData()->GetVectors();
+  vtkDataArray* magnitudes = samples->GetPointData()->GetScalars();
+  vtkDataArray* glyphMagnitudes = glyphs->GetPointData()->GetScalars();
+  vtkIdType numSourcePts = source->GetNumberOfPoints();
+  vtkIdType glyphPtId = 0;
+  for (vtkIdType sampleId = 0; sampleId < samples->GetNumberOfPoints(); sampleId++)
+    {
+    double magnitude = magnitudes->GetTuple1(sampleId);
+    if (magnitude < thresholdLower)
+      {
+      continue;
+      }
+    double v[3] = { 0.0, 0.0, 0.0 };
+    vectors->GetTuple(sampleId, v);
+    double vMag = vtkMath::Norm(v);
+    vtkNew<vtkTransform> trans;
+    trans->Translate(samples->GetPoint(sampleId));
+    if (vMag > 0.0)
+      {
+      if (v[1] == 0.0 && v[2] == 0.0)
+        {
+        if (v[0] < 0)
+          {
+          trans->RotateWXYZ(180.0, 0, 1, 0);
+          }
+        }
+      else
+        {
+        trans->RotateWXYZ(180.0, (v[0] + vMag) / 2.0, v[1] / 2.0, v[2] / 2.0);
+        }
+      }
+    double scale = vMag * glyphFilter->GetScaleFactor();
+    if (scale == 0.0)
+      {
+      scale = 1.0e-10;
+      }
+    trans->Scale(scale, glyphFilter->GetScaleDirectional() ? 1.0 : scale, glyphFilter->GetScaleDirectional() ? 1.0 : scale);
+    trans->Concatenate(sourceTransform);
+    for (vtkIdType i = 0; i < numSourcePts; i++, glyphPtId++)
+      {
+      if (glyphPtId >= glyphs->GetNumberOfPoints())
+        {
+        std::cerr << line << ": Too few glyph points: " << glyphs->GetNumberOfPoints() << std::endl;
+        return false;
+        }
+      double expected[3] = { 0.0, 0.0, 0.0 };
+      trans->TransformPoint(source->GetPoint(i), expected);
+      double* actual = glyphs->GetPoint(glyphPtId);
+      if (sqrt(vtkMath::Distance2BetweenPoints(expected, actual)) > 1e-3
+        || fabs(glyphMagnitudes->GetTuple1(glyphPtId) - magnitude) > 1e-6)
+        {
+        std::cerr << line << ": Glyph mismatch at sample " << sampleId << " point " << i << ": ("
+          << actual[0] << ", " << actual[1] << ", " << actual[2] << ") expected ("
+          << expected[0] << ", " << expected[1] << ", " << expected[2] << ")" << std::endl;
+        return false;
+        }
+      }
+    }
+  if (glyphPtId != glyphs->GetNumberOfPoints()
+    || glyphs->GetNumberOfCells() != source->GetNumberOfCells() * (glyphPtId / numSourcePts))
+    {
+    std::cerr << line << ": Unexpected number of glyph points or cells: " << glyphs->GetNumberOfPoints()
+      << ", " << glyphs->GetNumberOfCells() << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CheckDisplacementMagnitudes(vtkPolyData* visualization, double expectedMagnitude, int line)
+{
+  vtkDataArray* magnitudes = visualization->GetPointData()->GetArray(
+    vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  if (visualization->GetNumberOfPoints() == 0 || magnitudes == NULL)
+    {
+    std::cerr << line << ": Empty visualization" << std::endl;
+    return false;
+    }
+  for (vtkIdType i = 0; i < magnitudes->GetNumberOfTuples(); i++)
+    {
+    if (fabs(magnitudes->GetTuple1(i) - expectedMagnitude) > 1e-4)
+      {
+      std::cerr << line << ": Displacement magnitude mismatch at point " << i << ": "
+        << magnitudes->GetTuple1(i) << " (expected " << expectedMagnitude << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerTransformLogicTest4(int , char * [])
+{
+  //////////////////////////////////////////////////////////////////////////
+  // Glyphs generated in parallel match glyphs generated one by one
+
+  vtkNew<vtkPolyData> samples;
+  CreateDisplacementSamples(samples.GetPointer(), 2000);
+  vtkNew<vtkGlyphSource2D> glyphSource;
+  glyphSource->SetGlyphTypeToArrow();
+  glyphSource->SetFilled(0);
+  glyphSource->Update();
+  vtkNew<vtkTransform> sourceTransform;
+  sourceTransform->Translate(0.5, 0, 0);
+  sourceTransform->RotateX(30.0);
+
+  vtkNew<vtkTransformVisualizerGlyph3D> glyphFilter;
+  glyphFilter->SetInputData(samples.GetPointer());
+  glyphFilter->SetSourceConnection(glyphSource->GetOutputPort());
+  glyphFilter->SetSourceTransform(sourceTransform.GetPointer());
+  glyphFilter->SetScaleModeToScaleByVector();
+  glyphFilter->SetScaleFactor(2.0);
+  glyphFilter->SetColorModeToColorByScalar();
+  glyphFilter->SetColorArray(vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  for (int scaleDirectional = 0; scaleDirectional < 2; scaleDirectional++)
+    {
+    glyphFilter->SetScaleDirectional(scaleDirectional != 0);
+    glyphFilter->SetMagnitudeThresholding(false);
+    if (!CheckGlyphs(glyphFilter.GetPointer(), samples.GetPointer(), glyphSource->GetOutput(),
+      sourceTransform.GetPointer(), -1.0, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    glyphFilter->SetMagnitudeThresholding(true);
+    glyphFilter->SetMagnitudeThresholdLower(3.0);
+    glyphFilter->SetMagnitudeThresholdUpper(100.0);
+    if (!CheckGlyphs(glyphFilter.GetPointer(), samples.GetPointer(), glyphSource->GetOutput(),
+      sourceTransform.GetPointer(), 3.0, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Sampled displacements are updated when the transform is modified
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  scene->AddNode(transformNode.GetPointer());
+  vtkNew<vtkMRMLTransformDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+  transformNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+  vtkNew<vtkMatrix4x4> translation;
+  translation->SetElement(0, 3, 3.0);
+  translation->SetElement(1, 3, 4.0);
+  transformNode->SetMatrixTransformToParent(translation.GetPointer());
+
+  vtkNew<vtkMatrix4x4> sliceToRAS;
+  double fieldOfViewOrigin[3] = { 0.0, 0.0, 0.0 };
+  double fieldOfViewSize[3] = { 200.0, 150.0, 1.0 };
+
+  const int visualizationModes[2] = { vtkMRMLTransformDisplayNode::VIS_MODE_GLYPH, vtkMRMLTransformDisplayNode::VIS_MODE_GRID };
+  for (int modeIndex = 0; modeIndex < 2; modeIndex++)
+    {
+    displayNode->SetVisualizationMode(visualizationModes[modeIndex]);
+    translation->SetElement(0, 3, 3.0);
+    translation->SetElement(1, 3, 4.0);
+    transformNode->SetMatrixTransformToParent(translation.GetPointer());
+
+    vtkNew<vtkPolyData> visualization;
+    vtkSlicerTransformLogic::GetVisualization2d(visualization.GetPointer(), displayNode.GetPointer(),
+      sliceToRAS.GetPointer(), fieldOfViewOrigin, fieldOfViewSize);
+    if (!CheckDisplacementMagnitudes(visualization.GetPointer(), 5.0, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+
+    // display option change reuses the cached samples
+    displayNode->SetGlyphScalePercent(displayNode->GetGlyphScalePercent() * 2.0);
+    vtkNew<vtkPolyData> cachedVisualization;
+    vtkSlicerTransformLogic::GetVisualization2d(cachedVisualization.GetPointer(), displayNode.GetPointer(),
+      sliceToRAS.GetPointer(), fieldOfViewOrigin, fieldOfViewSize);
+    if (!CheckDisplacementMagnitudes(cachedVisualization.GetPointer(), 5.0, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+
+    // transform change invalidates the cached samples
+    translation->SetElement(0, 3, 6.0);
+    translation->SetElement(1, 3, 8.0);
+    transformNode->SetMatrixTransformToParent(translation.GetPointer());
+    vtkNew<vtkPolyData> updatedVisualization;
+    vtkSlicerTransformLogic::GetVisualization2d(updatedVisualization.GetPointer(), displayNode.GetPointer(),
+      sliceToRAS.GetPointer(), fieldOfViewOrigin, fieldOfViewSize);
+    if (!CheckDisplacementMagnitudes(updatedVisualization.GetPointer(), 10.0, __LINE__))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  vtkSlicerTransformLogic::ClearTransformedPointSamplesCache();
+
+  //////////////////////////////////////////////////////////////////////////
+  // Displacement images
+
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  ijkToRAS->SetElement(0, 0, 2.0);
+  ijkToRAS->SetElement(0, 3, -20.0);
+  vtkNew<vtkImageData> magnitudeImage;
+  magnitudeImage->SetExtent(0, 19, 0, 14, 0, 9);
+  vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(magnitudeImage.GetPointer(),
+    transformNode.GetPointer(), ijkToRAS.GetPointer());
+  vtkNew<vtkImageData> vectorImage;
+  vectorImage->SetExtent(0, 19, 0, 14, 0, 9);
+  vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vectorImage.GetPointer(),
+    transformNode.GetPointer(), ijkToRAS.GetPointer());
+  for (int k = 0; k < 10; k++)
+    {
+    for (int j = 0; j < 15; j++)
+      {
+      for (int i = 0; i < 20; i++)
+        {
+        if (fabs(magnitudeImage->GetScalarComponentAsDouble(i, j, k, 0) - 10.0) > 1e-4
+          || fabs(vectorImage->GetScalarComponentAsDouble(i, j, k, 0) - 6.0) > 1e-4
+          || fabs(vectorImage->GetScalarComponentAsDouble(i, j, k, 1) - 8.0) > 1e-4
+          || fabs(vectorImage->GetScalarComponentAsDouble(i, j, k, 2)) > 1e-4)
+          {
+          std::cerr << __LINE__ << ": Displacement image mismatch at (" << i << ", " << j << ", " << k << ")" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Iterative inverse of a grid transform sampled in parallel matches
+  // the inverse evaluated point by point
+
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(0, 19, 0, 19, 0, 19);
+  displacementGrid->SetOrigin(-100.0, -100.0, -100.0);
+  displacementGrid->SetSpacing(10.0, 10.0, 10.0);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  for (int k = 0; k < 20; k++)
+    {
+    for (int j = 0; j < 20; j++)
+      {
+      for (int i = 0; i < 20; i++)
+        {
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 0, 5.0 * sin(j * 0.3));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 1, 5.0 * cos(k * 0.2));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 2, 5.0 * sin(i * 0.25));
+        }
+      }
+    }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementGrid.GetPointer());
+  vtkNew<vtkMRMLGridTransformNode> gridTransformNode;
+  scene->AddNode(gridTransformNode.GetPointer());
+  // transform to world is the inverse of the grid
+  gridTransformNode->SetAndObserveTransformFromParent(gridTransform.GetPointer());
+
+  vtkNew<vtkGeneralTransform> gridTransformToWorld;
+  gridTransformNode->GetTransformToWorld(gridTransformToWorld.GetPointer());
+  vtkNew<vtkMatrix4x4> gridIJKToRAS;
+  gridIJKToRAS->SetElement(0, 0, 6.0);
+  gridIJKToRAS->SetElement(1, 1, 6.0);
+  gridIJKToRAS->SetElement(2, 2, 6.0);
+  gridIJKToRAS->SetElement(0, 3, -60.0);
+  gridIJKToRAS->SetElement(1, 3, -60.0);
+  gridIJKToRAS->SetElement(2, 3, -60.0);
+  vtkNew<vtkImageData> inverseMagnitudeImage;
+  inverseMagnitudeImage->SetExtent(0, 19, 0, 19, 0, 19);
+  vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(inverseMagnitudeImage.GetPointer(),
+    gridTransformNode.GetPointer(), gridIJKToRAS.GetPointer());
+  for (int k = 0; k < 20; k++)
+    {
+    for (int j = 0; j < 20; j++)
+      {
+      for (int i = 0; i < 20; i++)
+        {
+        double point_IJK[4] = { double(i), double(j), double(k), 1.0 };
+        double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+        gridIJKToRAS->MultiplyPoint(point_IJK, point_RAS);
+        double transformedPoint_RAS[3] = { 0.0, 0.0, 0.0 };
+        gridTransformToWorld->TransformPoint(point_RAS, transformedPoint_RAS);
+        double expectedMagnitude = sqrt(vtkMath::Distance2BetweenPoints(point_RAS, transformedPoint_RAS));
+        if (fabs(inverseMagnitudeImage->GetScalarComponentAsDouble(i, j, k, 0) - expectedMagnitude) > 1e-4)
+          {
+          std::cerr << __LINE__ << ": Inverse displacement mismatch at (" << i << ", " << j << ", " << k << "): "
+            << inverseMagnitudeImage->GetScalarComponentAsDouble(i, j, k, 0)
+            << " (expected " << expectedMagnitude << ")" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
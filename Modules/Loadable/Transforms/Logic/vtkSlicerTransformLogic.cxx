@@ -38,12 +38,14 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkContourFilter.h>
 #include <vtkCellArray.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkGlyphSource2D.h>
 #include <vtkImageData.h>
 #include <vtkLine.h>
 #include <vtkLookupTable.h>
 #include <vtkMath.h>
+#include <vtkMutexLock.h>
 #include <vtkTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -52,14 +54,22 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkPoints.h>
 #include <vtkPointSet.h>
 #include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkTubeFilter.h>
 #include <vtkUnstructuredGrid.h>
-#include <vtkVectorNorm.h>
 #include <vtkWarpVector.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <list>
+#include <vector>
 
 // ITK includes
 #include "itkBSplineDeformableTransform.h"
@@ -79,6 +89,326 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 
 vtkStandardNewMacro(vtkSlicerTransformLogic);
 
+namespace
+{
+
+/// Maximum number of sampled grids that are kept in the cache
+/// (each view displaying a transform typically uses one grid)
+const size_t TRANSFORMED_POINT_SAMPLES_CACHE_SIZE = 8;
+
+/// Grids with more points are not cached to limit memory usage
+const vtkIdType TRANSFORMED_POINT_SAMPLES_CACHE_MAX_NUMBER_OF_SAMPLES = 1000000;
+
+//----------------------------------------------------------------------------
+/// Copy of a transform for one sampling thread. Iterative inverses of warp
+/// transforms record convergence warnings in the transform object, therefore
+/// each thread must evaluate its own copy. Transform components are copied one
+/// at a time under \a lock, as copying and updating modifies the pipeline
+/// information of the shared grids.
+vtkSmartPointer<vtkGeneralTransform> CreateThreadLocalTransform(vtkAbstractTransform* transform, vtkMutexLock* lock)
+{
+  vtkSmartPointer<vtkGeneralTransform> localTransform = vtkSmartPointer<vtkGeneralTransform>::New();
+  localTransform->PostMultiply();
+  lock->Lock();
+  vtkNew<vtkCollection> transformComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformComponents.GetPointer(), transform);
+  for (int i = 0; i < transformComponents->GetNumberOfItems(); i++)
+    {
+    vtkAbstractTransform* component = vtkAbstractTransform::SafeDownCast(transformComponents->GetItemAsObject(i));
+    vtkSmartPointer<vtkAbstractTransform> componentCopy = vtkSmartPointer<vtkAbstractTransform>::Take(component->MakeTransform());
+    // the copy shares the grid or coefficients with the component, they are only read
+    componentCopy->DeepCopy(component);
+    localTransform->Concatenate(componentCopy);
+    }
+  localTransform->Update();
+  lock->Unlock();
+  return localTransform;
+}
+
+//----------------------------------------------------------------------------
+/// Computes displacement vectors and their magnitudes at sample positions.
+/// If a grid is specified then the sample positions are computed from the grid
+/// and written to the sample points, otherwise the sample points are read.
+/// Each sample has its own position in the preallocated output arrays,
+/// therefore samples can be computed in parallel. Each thread samples its own
+/// copy of the transform.
+class vtkTransformedPointSamplesWorker
+{
+public:
+  vtkTransformedPointSamplesWorker(vtkAbstractTransform* transform, vtkPoints* samplePositions,
+    vtkDoubleArray* vectors, vtkFloatArray* magnitudes, vtkMatrix4x4* gridToRAS = NULL, int* gridSize = NULL)
+    : Transform(transform)
+    , SamplePositions(samplePositions)
+    , Vectors(vectors)
+    , Magnitudes(magnitudes)
+    , UseGrid(gridToRAS != NULL && gridSize != NULL)
+  {
+    for (int i = 0; i < 3; i++)
+      {
+      this->GridSize[i] = (this->UseGrid ? gridSize[i] : 0);
+      }
+    if (this->UseGrid)
+      {
+      vtkMatrix4x4::DeepCopy(this->GridToRAS, gridToRAS);
+      }
+  }
+
+  void Initialize()
+  {
+    this->LocalTransform.Local() = CreateThreadLocalTransform(this->Transform, this->Lock.GetPointer());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkGeneralTransform* transform = this->LocalTransform.Local();
+    double point_Grid[4] = { 0, 0, 0, 1 };
+    double point_RAS[4] = { 0, 0, 0, 1 };
+    double transformedPoint_RAS[3] = { 0, 0, 0 };
+    double* vectors = this->Vectors->GetPointer(0);
+    float* magnitudes = this->Magnitudes->GetPointer(0);
+    for (vtkIdType sampleIndex = begin; sampleIndex < end; sampleIndex++)
+      {
+      if (this->UseGrid)
+        {
+        point_Grid[0] = sampleIndex % this->GridSize[0];
+        point_Grid[1] = (sampleIndex / this->GridSize[0]) % this->GridSize[1];
+        point_Grid[2] = sampleIndex / (static_cast<vtkIdType>(this->GridSize[0]) * this->GridSize[1]);
+        vtkMatrix4x4::MultiplyPoint(this->GridToRAS, point_Grid, point_RAS);
+        this->SamplePositions->SetPoint(sampleIndex, point_RAS);
+        }
+      else
+        {
+        this->SamplePositions->GetPoint(sampleIndex, point_RAS);
+        }
+
+      transform->InternalTransformPoint(point_RAS, transformedPoint_RAS);
+
+      double* pointDislocationVector_RAS = vectors + 3 * sampleIndex;
+      pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
+      pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
+      pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
+      magnitudes[sampleIndex] = static_cast<float>(vtkMath::Norm(pointDislocationVector_RAS));
+      }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  vtkSMPThreadLocal<vtkSmartPointer<vtkGeneralTransform> > LocalTransform;
+  vtkNew<vtkMutexLock> Lock;
+  vtkPoints* SamplePositions;
+  vtkDoubleArray* Vectors;
+  vtkFloatArray* Magnitudes;
+  bool UseGrid;
+  double GridToRAS[16];
+  int GridSize[3];
+};
+
+//----------------------------------------------------------------------------
+/// Computes displacements at each voxel of a float image, one image row at a time.
+/// Single-component images store the displacement magnitude, 3-component
+/// images store the displacement vector.
+class vtkTransformedPointSamplesImageWorker
+{
+public:
+  vtkTransformedPointSamplesImageWorker(vtkAbstractTransform* transform, vtkMatrix4x4* ijkToRAS, vtkImageData* image)
+    : Transform(transform)
+    , Image(image)
+  {
+    vtkMatrix4x4::DeepCopy(this->IJKToRAS, ijkToRAS);
+  }
+
+  void Initialize()
+  {
+    this->LocalTransform.Local() = CreateThreadLocalTransform(this->Transform, this->Lock.GetPointer());
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow)
+  {
+    vtkGeneralTransform* transform = this->LocalTransform.Local();
+    int* extent = this->Image->GetExtent();
+    int numberOfComponents = this->Image->GetNumberOfScalarComponents();
+    vtkIdType rowLength = extent[1] - extent[0] + 1;
+    vtkIdType rowsPerSlice = extent[3] - extent[2] + 1;
+    float* voxelPtr = static_cast<float*>(this->Image->GetScalarPointer()) + beginRow * rowLength * numberOfComponents;
+
+    double point_IJK[4] = { 0, 0, 0, 1 };
+    double point_RAS[4] = { 0, 0, 0, 1 };
+    double transformedPoint_RAS[3] = { 0, 0, 0 };
+    double pointDislocationVector_RAS[3] = { 0, 0, 0 };
+    for (vtkIdType row = beginRow; row < endRow; row++)
+      {
+      point_IJK[1] = extent[2] + row % rowsPerSlice;
+      point_IJK[2] = extent[4] + row / rowsPerSlice;
+      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
+        {
+        vtkMatrix4x4::MultiplyPoint(this->IJKToRAS, point_IJK, point_RAS);
+
+        transform->InternalTransformPoint(point_RAS, transformedPoint_RAS);
+
+        pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
+        pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
+        pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
+        if (numberOfComponents == 1)
+          {
+          *(voxelPtr++) = static_cast<float>(vtkMath::Norm(pointDislocationVector_RAS));
+          }
+        else
+          {
+          *(voxelPtr++) = static_cast<float>(pointDislocationVector_RAS[0]);
+          *(voxelPtr++) = static_cast<float>(pointDislocationVector_RAS[1]);
+          *(voxelPtr++) = static_cast<float>(pointDislocationVector_RAS[2]);
+          }
+        }
+      }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  vtkSMPThreadLocal<vtkSmartPointer<vtkGeneralTransform> > LocalTransform;
+  vtkNew<vtkMutexLock> Lock;
+  vtkImageData* Image;
+  double IJKToRAS[16];
+};
+
+//----------------------------------------------------------------------------
+/// Displacements sampled on a grid. Samples are identified by the sampling transform
+/// object, its modification time, and the grid geometry. Only plain arrays are stored
+/// (no VTK objects are kept alive by the cache).
+struct TransformedPointSamplesCacheEntry
+{
+  vtkWeakPointer<vtkAbstractTransform> Transform;
+  vtkMTimeType TransformMTime;
+  double GridToRAS[16];
+  int GridSize[3];
+  std::vector<float> SamplePositions;
+  std::vector<double> Vectors;
+  std::vector<float> Magnitudes;
+};
+
+//----------------------------------------------------------------------------
+/// Most recently used entries are at the front
+std::list<TransformedPointSamplesCacheEntry>& GetTransformedPointSamplesCache()
+{
+  static std::list<TransformedPointSamplesCacheEntry> cache;
+  return cache;
+}
+
+//----------------------------------------------------------------------------
+bool IsSameTransformedPointSamplesGrid(const TransformedPointSamplesCacheEntry& entry,
+  vtkMatrix4x4* gridToRAS, int* gridSize)
+{
+  for (int i = 0; i < 3; i++)
+    {
+    if (entry.GridSize[i] != gridSize[i])
+      {
+      return false;
+      }
+    }
+  for (int i = 0; i < 16; i++)
+    {
+    if (entry.GridToRAS[i] != gridToRAS->GetElement(i / 4, i % 4))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Copy samples from the cache to the output arrays (allocated by the caller).
+/// Returns false if the samples are not found in the cache.
+bool GetCachedTransformedPointSamples(vtkAbstractTransform* transform, vtkMatrix4x4* gridToRAS, int* gridSize,
+  vtkPoints* samplePositions, vtkDoubleArray* vectors, vtkFloatArray* magnitudes)
+{
+  std::list<TransformedPointSamplesCacheEntry>& cache = GetTransformedPointSamplesCache();
+  vtkMTimeType transformMTime = transform->GetMTime();
+  for (std::list<TransformedPointSamplesCacheEntry>::iterator entryIt = cache.begin(); entryIt != cache.end(); ++entryIt)
+    {
+    if (entryIt->Transform.GetPointer() != transform || entryIt->TransformMTime != transformMTime
+      || !IsSameTransformedPointSamplesGrid(*entryIt, gridToRAS, gridSize))
+      {
+      continue;
+      }
+    std::copy(entryIt->SamplePositions.begin(), entryIt->SamplePositions.end(),
+      static_cast<float*>(samplePositions->GetVoidPointer(0)));
+    std::copy(entryIt->Vectors.begin(), entryIt->Vectors.end(), vectors->GetPointer(0));
+    std::copy(entryIt->Magnitudes.begin(), entryIt->Magnitudes.end(), magnitudes->GetPointer(0));
+    samplePositions->Modified();
+    vectors->Modified();
+    magnitudes->Modified();
+    cache.splice(cache.begin(), cache, entryIt);
+    return true;
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+/// Store samples in the cache, removing the least recently used entries
+void SetCachedTransformedPointSamples(vtkAbstractTransform* transform, vtkMatrix4x4* gridToRAS, int* gridSize,
+  vtkPoints* samplePositions, vtkDoubleArray* vectors, vtkFloatArray* magnitudes)
+{
+  vtkIdType numOfSamples = samplePositions->GetNumberOfPoints();
+  if (numOfSamples > TRANSFORMED_POINT_SAMPLES_CACHE_MAX_NUMBER_OF_SAMPLES)
+    {
+    return;
+    }
+  std::list<TransformedPointSamplesCacheEntry>& cache = GetTransformedPointSamplesCache();
+  cache.push_front(TransformedPointSamplesCacheEntry());
+  TransformedPointSamplesCacheEntry& entry = cache.front();
+  entry.Transform = transform;
+  entry.TransformMTime = transform->GetMTime();
+  vtkMatrix4x4::DeepCopy(entry.GridToRAS, gridToRAS);
+  for (int i = 0; i < 3; i++)
+    {
+    entry.GridSize[i] = gridSize[i];
+    }
+  const float* positionsPtr = static_cast<float*>(samplePositions->GetVoidPointer(0));
+  entry.SamplePositions.assign(positionsPtr, positionsPtr + 3 * numOfSamples);
+  entry.Vectors.assign(vectors->GetPointer(0), vectors->GetPointer(0) + 3 * numOfSamples);
+  entry.Magnitudes.assign(magnitudes->GetPointer(0), magnitudes->GetPointer(0) + numOfSamples);
+
+  // Remove entries of deleted transforms and the least recently used entries
+  for (std::list<TransformedPointSamplesCacheEntry>::iterator entryIt = cache.begin(); entryIt != cache.end();)
+    {
+    if (entryIt->Transform.GetPointer() == NULL)
+      {
+      entryIt = cache.erase(entryIt);
+      }
+    else
+      {
+      ++entryIt;
+      }
+    }
+  while (cache.size() > TRANSFORMED_POINT_SAMPLES_CACHE_SIZE)
+    {
+    cache.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+void SetTransformedPointSamplesOutput(vtkPointSet* outputPointSet, vtkPoints* samplePositions_RAS,
+  vtkDoubleArray* sampleVectors_RAS, vtkFloatArray* sampleMagnitudes)
+{
+  outputPointSet->SetPoints(samplePositions_RAS);
+  vtkPointData* pointData = outputPointSet->GetPointData();
+  pointData->SetVectors(sampleVectors_RAS);
+
+  // Add vector magnitude to the data set
+  sampleMagnitudes->SetName(vtkSlicerTransformLogic::GetVisualizationDisplacementMagnitudeScalarName());
+  int idx = pointData->AddArray(sampleMagnitudes);
+  pointData->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSlicerTransformLogic::vtkSlicerTransformLogic()
 {
@@ -210,38 +540,43 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
   vtkMRMLTransformNode* inputTransformNode, vtkMatrix4x4* gridToRAS, int* gridSize,
   bool transformToWorld /* = true */)
 {
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
-  // Generate sample point set on a grid
+  if (!inputTransformNode)
+    {
+    return;
+    }
+
+  // The collapsed transform object is kept by the transform node, therefore it can
+  // be used for identifying samples of the same transform in the cache
+  vtkAbstractTransform* samplingTransform = inputTransformNode->GetCollapsedTransformToWorld();
+  if (!transformToWorld)
+    {
+    samplingTransform = samplingTransform->GetInverse();
+    }
+  samplingTransform->Update();
+
+  vtkIdType numOfSamples = static_cast<vtkIdType>(gridSize[0]) * gridSize[1] * gridSize[2];
   vtkNew<vtkPoints> samplePositions_RAS;
-  int numOfSamples = gridSize[0] * gridSize[1] * gridSize[2];
+  samplePositions_RAS->SetDataTypeToFloat();
   samplePositions_RAS->SetNumberOfPoints(numOfSamples);
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double point_Grid[4] = { 0, 0, 0, 1 };
-  int sampleIndex = 0;
-  for (point_Grid[2] = 0; point_Grid[2]<gridSize[2]; point_Grid[2]++)
+  vtkNew<vtkDoubleArray> sampleVectors_RAS;
+  sampleVectors_RAS->SetNumberOfComponents(3);
+  sampleVectors_RAS->SetNumberOfTuples(numOfSamples);
+  sampleVectors_RAS->SetName("DisplacementVector");
+  vtkNew<vtkFloatArray> sampleMagnitudes;
+  sampleMagnitudes->SetNumberOfTuples(numOfSamples);
+
+  if (!GetCachedTransformedPointSamples(samplingTransform, gridToRAS, gridSize,
+    samplePositions_RAS.GetPointer(), sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer()))
     {
-    for (point_Grid[1] = 0; point_Grid[1]<gridSize[1]; point_Grid[1]++)
-      {
-      for (point_Grid[0] = 0; point_Grid[0]<gridSize[0]; point_Grid[0]++)
-        {
-        gridToRAS->MultiplyPoint(point_Grid, point_RAS);
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-        samplePositions_RAS->SetPoint(sampleIndex, point_RAS[0], point_RAS[1], point_RAS[2]);
-        sampleIndex++;
-        }
-      }
-   }
+    vtkTransformedPointSamplesWorker worker(samplingTransform, samplePositions_RAS.GetPointer(),
+      sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer(), gridToRAS, gridSize);
+    vtkSMPTools::For(0, numOfSamples, worker);
+    SetCachedTransformedPointSamples(samplingTransform, gridToRAS, gridSize,
+      samplePositions_RAS.GetPointer(), sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer());
+    }
 
-  vtkSlicerTransformLogic::GetTransformedPointSamples(outputPointSet, inputTransformNode, samplePositions_RAS.GetPointer(), transformToWorld);
+  SetTransformedPointSamplesOutput(outputPointSet, samplePositions_RAS.GetPointer(),
+    sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer());
 }
 
 //----------------------------------------------------------------------------
@@ -255,12 +590,13 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
     }
 
   //Will contain the corresponding vectors for outputPointSet
-  int numOfSamples = samplePositions_RAS->GetNumberOfPoints();
+  vtkIdType numOfSamples = samplePositions_RAS->GetNumberOfPoints();
   vtkNew<vtkDoubleArray> sampleVectors_RAS;
-  sampleVectors_RAS->Initialize();
   sampleVectors_RAS->SetNumberOfComponents(3);
   sampleVectors_RAS->SetNumberOfTuples(numOfSamples);
   sampleVectors_RAS->SetName("DisplacementVector");
+  vtkNew<vtkFloatArray> sampleMagnitudes;
+  sampleMagnitudes->SetNumberOfTuples(numOfSamples);
 
   vtkNew<vtkGeneralTransform> inputTransform;
   if (transformToWorld)
@@ -271,34 +607,20 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
     {
     inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
     }
+  inputTransform->Update();
 
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++)
-    {
-    double* point_RAS = samplePositions_RAS->GetPoint(sampleIndex);
-
-    inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
+  vtkTransformedPointSamplesWorker worker(inputTransform.GetPointer(), samplePositions_RAS,
+    sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer());
+  vtkSMPTools::For(0, numOfSamples, worker);
 
-    pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-    pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-    pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-    sampleVectors_RAS->SetTuple3(sampleIndex, pointDislocationVector_RAS[0], pointDislocationVector_RAS[1], pointDislocationVector_RAS[2]);
-    }
+  SetTransformedPointSamplesOutput(outputPointSet, samplePositions_RAS,
+    sampleVectors_RAS.GetPointer(), sampleMagnitudes.GetPointer());
+}
 
-  outputPointSet->SetPoints(samplePositions_RAS);
-  vtkPointData* pointData = outputPointSet->GetPointData();
-  pointData->SetVectors(sampleVectors_RAS.GetPointer());
-
-  // Compute vector magnitude and add to the data set
-  vtkNew<vtkVectorNorm> norm;
-  norm->SetInputData(outputPointSet);
-  norm->Update();
-  vtkDataArray* vectorMagnitude = norm->GetOutput()->GetPointData()->GetScalars();
-  vectorMagnitude->SetName(GetVisualizationDisplacementMagnitudeScalarName());
-  int idx = pointData->AddArray(vectorMagnitude);
-  pointData->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+//----------------------------------------------------------------------------
+void vtkSlicerTransformLogic::ClearTransformedPointSamplesCache()
+{
+  GetTransformedPointSamplesCache().clear();
 }
 
 /// Takes samples from the displacement field specified by the transformation on a slice
@@ -409,35 +731,12 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(vtkImag
   // if the direction matrix is not identity.
   magnitudeImage->AllocateScalars(VTK_FLOAT, 1);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(magnitudeImage->GetScalarPointer());
+  // Each image row is computed independently
+  inputTransform->Update();
   int* extent = magnitudeImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
-  {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-        pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-        pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-        float mag = sqrt(
-          pointDislocationVector_RAS[0] * pointDislocationVector_RAS[0] +
-          pointDislocationVector_RAS[1] * pointDislocationVector_RAS[1] +
-          pointDislocationVector_RAS[2] * pointDislocationVector_RAS[2]);
-
-        *(voxelPtr++) = mag;
-      }
-    }
-  }
+  vtkIdType numberOfRows = static_cast<vtkIdType>(extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+  vtkTransformedPointSamplesImageWorker worker(inputTransform.GetPointer(), ijkToRAS, magnitudeImage);
+  vtkSMPTools::For(0, numberOfRows, worker);
 
   return true;
 }
@@ -703,29 +1002,28 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageDa
   // if the direction matrix is not identity.
   vectorImage->AllocateScalars(VTK_FLOAT, 3);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(vectorImage->GetScalarPointer());
-  int* extent = vectorImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
+  // B-spline transforms (typical registration results) are evaluated on the whole grid at once,
+  // which is much faster than transforming each point
+  vtkNew<vtkCollection> inputTransformComponents;
+  vtkMRMLTransformNode::FlattenGeneralTransform(inputTransformComponents.GetPointer(), inputTransform.GetPointer());
+  if (inputTransformComponents->GetNumberOfItems() == 1)
   {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
+    vtkOrientedBSplineTransform* bsplineTransform = vtkOrientedBSplineTransform::SafeDownCast(
+      inputTransformComponents->GetItemAsObject(0));
+    if (bsplineTransform)
     {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        // store the pointDislocationVector_RAS components in the image
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[0] - point_RAS[0]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[1] - point_RAS[1]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[2] - point_RAS[2]);
-      }
+      bsplineTransform->ComputeDisplacementsOnGrid(ijkToRAS, vectorImage);
+      return true;
     }
   }
 
+  // Each image row is computed independently
+  inputTransform->Update();
+  int* extent = vectorImage->GetExtent();
+  vtkIdType numberOfRows = static_cast<vtkIdType>(extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+  vtkTransformedPointSamplesImageWorker worker(inputTransform.GetPointer(), ijkToRAS, vectorImage);
+  vtkSMPTools::For(0, numberOfRows, worker);
+
   return true;
 }
 
@@ -98,6 +98,11 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// in polydata returned by GetVisualization2d and GetVisualization3d.
   static const char* GetVisualizationDisplacementMagnitudeScalarName();
 
+  /// Displacements sampled for visualization are cached until the transform is modified,
+  /// therefore changing display options does not require sampling the transform again.
+  /// This method removes all cached samples.
+  static void ClearTransformedPointSamplesCache();
+
   /// Create a volume node that contains the transform displacement in each voxel.
   /// If magnitude is true then a scalar volume is created, each voxel containing the magnitude of the displacement.
   /// If magnitude is false then a 3-component scalar volume is created, each voxel containing the displacement vector.
@@ -222,6 +227,8 @@ protected:
   /// gridToRAS specifies the grid origin, direction, and spacing
   /// gridSize is a 3-component int array specifying the dimension of the grid
   /// If transformToWorld is true then transform to world is returned, otherwise transform from world is returned.
+  /// Samples of the most recently used grids are cached until the transform is modified,
+  /// therefore changing display options does not require sampling the transform again.
   static void GetTransformedPointSamples(vtkPointSet* outputPointSet_RAS, vtkMRMLTransformNode* inputTransformNode,
     vtkMatrix4x4* gridToRAS, int* gridSize, bool transformToWorld = true);
 
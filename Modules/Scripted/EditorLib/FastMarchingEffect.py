@@ -199,19 +199,39 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
 
   def __init__(self,sliceLogic):
     super(FastMarchingEffectLogic,self).__init__(sliceLogic)
+    self.fm = None
+    self.fmInputState = None
+    self.npoints = 0
+    # expected structure volume (in % of the image) from which the median and
+    # inhomogeneity of all voxels are computed in parallel when the filter is
+    # initialized, instead of on demand while the front evolves
+    self.precomputeFeaturesPercent = 10
+
+  def getInputState(self):
+    """Inputs that the arrival times stored in the filter were computed from"""
+    return (EditUtil.getBackgroundImage().GetMTime(), EditUtil.getLabelImage().GetMTime(), EditUtil.getLabel())
 
   def fastMarching(self,percentMax):
 
-    self.fm = None
-    # allocate a new filter each time March is hit
     bgImage = EditUtil.getBackgroundImage()
     labelImage = EditUtil.getLabelImage()
 
     # collect seeds
     dim = bgImage.GetDimensions()
     print dim
+    npoints = int(dim[0]*dim[1]*dim[2]*percentMax/100.)
+
+    # the filter stores arrival times, so if neither the images nor the label
+    # changed since the last march then only the target volume is updated
+    if self.fm and self.fmInputState == self.getInputState():
+      return self.updateTargetVolume(npoints)
+
+    # allocate a new filter if inputs changed
+    self.fm = None
     # initialize the filter
     self.fm = slicer.vtkPichonFastMarching()
+    self.fm.setStoreArrivalTimes(1)
+    self.fm.setPrecomputeMedianInhomo(1 if percentMax >= self.precomputeFeaturesPercent else 0)
     scalarRange = bgImage.GetScalarRange()
     depth = scalarRange[1]-scalarRange[0]
 
@@ -245,8 +265,6 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
 
     # self.fm.SetOutput(labelImage)
 
-    npoints = int(dim[0]*dim[1]*dim[2]*percentMax/100.)
-
     self.fm.setNPointsEvolution(npoints)
     print('Setting active label to '+str(EditUtil.getLabel()))
     self.fm.setActiveLabel(EditUtil.getLabel())
@@ -271,14 +289,49 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
 
     EditUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
     EditUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
+    self.fmInputState = self.getInputState()
+    self.npoints = npoints
     # print('FastMarching output image: '+str(output))
     print('FastMarching march update completed')
 
     return npoints
 
+  def updateTargetVolume(self,npoints):
+    """Show npoints voxels using the stored arrival times.
+    The front is only extended if more voxels are requested than already reached."""
+    knownPoints = self.fm.nKnownPoints()
+    if npoints > knownPoints:
+      self.fm.setNPointsEvolution(npoints - knownPoints)
+      self.fm.Modified()
+      self.fm.Update()
+      knownPoints = self.fm.nKnownPoints()
+    if knownPoints == 0:
+      return 0
+
+    # TODO: need to update twice for data to be updated (same as in fastMarching)
+    maxT = self.fm.arrivalTime(min(1., float(npoints)/knownPoints))
+    for i in range(2):
+      self.fm.showArrivalTime(maxT)
+      self.fm.Modified()
+      self.fm.Update()
+
+    self.undoRedo.saveState()
+
+    EditUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
+    EditUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
+    self.fmInputState = self.getInputState()
+    self.npoints = npoints
+    print('FastMarching target volume update completed')
+
+    return npoints
+
   def updateLabel(self,value):
     if not self.fm:
       return
+    # value is relative to the target volume, show() is relative to all the known points
+    knownPoints = self.fm.nKnownPoints()
+    if knownPoints > 0:
+      value = min(1., value*self.npoints/float(knownPoints))
     self.fm.show(value)
     self.fm.Modified()
     self.fm.Update()
@@ -287,6 +340,7 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
     EditUtil.getLabelImage().Modified()
 
     EditUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
+    self.fmInputState = self.getInputState()
 
   def getLabelNode(self):
     return self.sliceLogic.GetLabelLayer().GetVolumeNode()
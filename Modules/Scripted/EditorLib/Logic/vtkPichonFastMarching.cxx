@@ -30,6 +30,24 @@ int compareInt(const void *a, const void *b)
   return  (*(int*)a) - (*(int*)b);
 }
 
+namespace
+{
+enum SlabOperationType
+{
+  SlabInitialize,
+  SlabThreshold
+};
+
+struct SlabWork
+{
+  vtkPichonFastMarching* Self;
+  int Operation;
+  float MaxT;
+  int NumberOfThreads;
+  std::vector<int> Counts; // result of each thread
+};
+}
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
@@ -139,13 +157,9 @@ inline void vtkPichonFastMarching::getMedianInhomo( int index, int &med, int &in
     }
 
   // otherwise, just do it
-  for(int k=0;k<=26;k++)
-      tmpNeighborhood[k] = (int)indata[index + arrayShiftNeighbor[k]];
-
-  qsort( (void*)tmpNeighborhood, 27, sizeof(int), &compareInt );
-
-  inh = inhomo[ index ] = (tmpNeighborhood[21] - tmpNeighborhood[5]);
-  med = median[ index ] = tmpNeighborhood[13];
+  computeMedianInhomo(index, tmpNeighborhood);
+  inh = inhomo[ index ];
+  med = median[ index ];
 
   /*
     // same thing for 125-neighbors
@@ -166,6 +180,115 @@ inline void vtkPichonFastMarching::getMedianInhomo( int index, int &med, int &in
   */
 }
 
+void vtkPichonFastMarching::computeMedianInhomo( int index, int* neighborhood )
+{
+  for(int k=0;k<=26;k++)
+    neighborhood[k] = (int)indata[index + arrayShiftNeighbor[k]];
+
+  qsort( (void*)neighborhood, 27, sizeof(int), &compareInt );
+
+  inhomo[ index ] = (neighborhood[21] - neighborhood[5]);
+  median[ index ] = neighborhood[13];
+}
+
+void vtkPichonFastMarching::initializeSlab(int kStart, int kEnd)
+{
+  int neighborhood[27];
+  for(int k=kStart;k<kEnd;k++)
+    {
+    int index=k*dimXY;
+    for(int j=0;j<dimY;j++)
+      for(int i=0;i<dimX;i++)
+        {
+        node[index].T=(float)INF;
+
+        if(outdata[index]==0)
+          node[index].status=fmsFAR;
+        else
+          node[index].status=fmsDONE;
+
+        if( (i<BAND_OUT) || (j<BAND_OUT) ||  (k<BAND_OUT) ||
+          (i>=(dimX-BAND_OUT)) || (j>=(dimY-BAND_OUT)) || (k>=(dimZ-BAND_OUT)) )
+          {
+          node[index].status=fmsOUT;
+
+          // we should never have to look at these values anyway !
+          inhomo[ index ] = depth;
+          median[ index ] = 0;
+          }
+        else if( precomputeMedianInhomo )
+          {
+          computeMedianInhomo(index, neighborhood);
+          }
+        else
+          {
+          inhomo[index]=-1; // meaning inhomo and median have not been computed there
+          }
+
+        index++;
+        }
+    }
+}
+
+int vtkPichonFastMarching::thresholdSlab(int kStart, int kEnd, float maxT)
+{
+  int nBelowThreshold=0;
+  for(int index=kStart*dimXY;index<kEnd*dimXY;index++)
+    {
+    if( node[index].status!=fmsKNOWN )
+      continue;
+    if( node[index].T<=maxT )
+      {
+      nBelowThreshold++;
+      if(outdata[index]==0)
+        outdata[index]=label;
+      }
+    else if(outdata[index]==label)
+      {
+      outdata[index]=0;
+      }
+    }
+  return nBelowThreshold;
+}
+
+VTK_THREAD_RETURN_TYPE vtkPichonFastMarching::slabThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  SlabWork* work = static_cast<SlabWork*>(threadInfo->UserData);
+  vtkPichonFastMarching* self = work->Self;
+  int threadId = threadInfo->ThreadID;
+  // the threader may run fewer threads than requested (at most VTK_MAX_THREADS)
+  int numberOfThreads = threadInfo->NumberOfThreads;
+  int kStart = (int)((vtkIdType)self->dimZ*threadId/numberOfThreads);
+  int kEnd = (int)((vtkIdType)self->dimZ*(threadId+1)/numberOfThreads);
+  if( work->Operation==SlabInitialize )
+    self->initializeSlab(kStart, kEnd);
+  else
+    work->Counts[threadId] = self->thresholdSlab(kStart, kEnd, work->MaxT);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+int vtkPichonFastMarching::processSlabs(int operation, float maxT)
+{
+  SlabWork work;
+  work.Self = this;
+  work.Operation = operation;
+  work.MaxT = maxT;
+  work.NumberOfThreads = std::max(1, std::min(vtkMultiThreader::GetGlobalDefaultNumberOfThreads(), dimZ));
+  work.Counts.resize(work.NumberOfThreads, 0);
+
+  vtkMultiThreader* threader = vtkMultiThreader::New();
+  threader->SetNumberOfThreads(work.NumberOfThreads);
+  threader->SetSingleMethod(vtkPichonFastMarching::slabThreadFunction, &work);
+  threader->SingleMethodExecute();
+  threader->Delete();
+
+  int total=0;
+  for(int t=0;t<work.NumberOfThreads;t++)
+    total+=work.Counts[t];
+  return total;
+}
+
 void vtkPichonFastMarching::initNewExpansion( void )
 {
   if(somethingReallyWrong)
@@ -267,46 +390,10 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
     {
     self->initialized = true;
 
-    int index=0;
-    int lastPercentageProgressBarUpdated=-1;
-
-
-    for(k=0;k<self->dimZ;k++)
-      for(int j=0;j<self->dimY;j++)
-        for(int i=0;i<self->dimX;i++)
-          {
-
-          self->node[index].T=(float)INF;
-
-          if(self->outdata[index]==0)
-            self->node[index].status=fmsFAR;
-          else
-            self->node[index].status=fmsDONE;
-
-          self->inhomo[index]=-1; // meaning inhomo and median have not been computed there
-
-          if( (i<BAND_OUT) || (j<BAND_OUT) ||  (k<BAND_OUT) ||
-            (i>=(self->dimX-BAND_OUT)) || (j>=(self->dimY-BAND_OUT)) || (k>=(self->dimZ-BAND_OUT)) )
-            {
-
-            // update progress bar
-            int currentPercentage = GRANULARITY_PROGRESS*index / self->dimXYZ;
-
-            if( currentPercentage > lastPercentageProgressBarUpdated )
-              {
-              lastPercentageProgressBarUpdated = currentPercentage;
-              self->UpdateProgress(float(currentPercentage)/float(GRANULARITY_PROGRESS));
-              }
-
-            self->node[index].status=fmsOUT;
-
-            // we should never have to look at these values anyway !
-            self->inhomo[ index ] = self->depth;
-            self->median[ index ] = 0;
-            }
-
-          index++;
-          }
+    // slices are independent, initialize them in parallel
+    self->UpdateProgress(0.0);
+    self->processSlabs(SlabInitialize, 0.0);
+    self->UpdateProgress(1.0);
 
     return;
     }
@@ -335,7 +422,8 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
     return;
 
   // reinitialize the points that were removed by the user
-  if( self->nEvolutions>0 )
+  // (unless arrival times are stored, then the front continues from all known points)
+  if( (self->nEvolutions>0) && !self->storeArrivalTimes )
     if( (self->knownPoints.size()>1) &&
       ((signed)self->knownPoints.size()-1>self->nPointsBeforeLeakEvolution) )
       {
@@ -399,7 +487,10 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
   // start a new evolution
   self->nEvolutions++;
 
-  self->nPointsBeforeLeakEvolution=(int)(self->knownPoints.size()-1);
+  // with stored arrival times the known points that are not shown yet are kept,
+  // so the shown index is only reset at the first evolution
+  if( !self->storeArrivalTimes || self->nEvolutions==0 )
+    self->nPointsBeforeLeakEvolution=(int)(self->knownPoints.size()-1);
 
   // use the seeds
   while(self->seedPoints.size()>0)
@@ -484,6 +575,65 @@ void vtkPichonFastMarching::show(float r)
   firstPassThroughShow=false;
 }
 
+void vtkPichonFastMarching::setStoreArrivalTimes(int store)
+{
+  storeArrivalTimes=(store!=0);
+}
+
+int vtkPichonFastMarching::getStoreArrivalTimes(void)
+{
+  return storeArrivalTimes ? 1 : 0;
+}
+
+void vtkPichonFastMarching::setPrecomputeMedianInhomo(int precompute)
+{
+  precomputeMedianInhomo=(precompute!=0);
+}
+
+float vtkPichonFastMarching::arrivalTime(float r)
+{
+  if(somethingReallyWrong || knownPoints.size()<1)
+    return 0.0;
+  r=std::min(std::max(r,0.0f),1.0f);
+  int index = (int)((knownPoints.size()-1)*r);
+  return node[ knownPoints[index] ].T;
+}
+
+void vtkPichonFastMarching::showArrivalTime(float maxT)
+{
+  if(somethingReallyWrong || !initialized)
+    return;
+
+  if( nEvolutions<0 )
+    return;
+
+  if( knownPoints.size()<1 )
+    return;
+
+  int nBelowThreshold = processSlabs(SlabThreshold, maxT);
+
+  // keep show() consistent: known points are sorted by arrival time
+  nPointsBeforeLeakEvolution=std::max(0, nBelowThreshold-1);
+  firstPassThroughShow=false;
+}
+
+void vtkPichonFastMarching::getArrivalTimes(vtkImageData* arrivalTimes)
+{
+  if(somethingReallyWrong || !initialized || !arrivalTimes)
+    return;
+
+  arrivalTimes->SetDimensions(dimX, dimY, dimZ);
+  arrivalTimes->AllocateScalars(VTK_FLOAT, 1);
+  float* arrivalTimesPtr = static_cast<float*>(arrivalTimes->GetScalarPointer());
+  for(int index=0;index<dimXYZ;index++)
+    {
+    if( (node[index].status==fmsKNOWN) && (node[index].T<INF) )
+      arrivalTimesPtr[index]=node[index].T;
+    else
+      arrivalTimesPtr[index]=-1.0f;
+    }
+}
+
 void vtkPichonFastMarching::setActiveLabel(int _label)
 {
   this->label=_label;
@@ -544,6 +694,8 @@ void vtkPichonFastMarching::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "dimZ: " << this->dimZ << "\n";
   os << indent << "dimXY: " << this->dimXY << "\n";
   os << indent << "label: " << this->label << "\n";
+  os << indent << "storeArrivalTimes: " << this->storeArrivalTimes << "\n";
+  os << indent << "precomputeMedianInhomo: " << this->precomputeMedianInhomo << "\n";
 }
 
 bool vtkPichonFastMarching::emptyTree(void)
@@ -724,6 +876,8 @@ vtkPichonFastMarching::vtkPichonFastMarching()
 {
   initialized=false;
   somethingReallyWrong=true;
+  storeArrivalTimes=false;
+  precomputeMedianInhomo=false;
 }
 
 void vtkPichonFastMarching::init(int _dimX, int _dimY, int _dimZ, double _depth, double _dx, double _dy, double _dz)
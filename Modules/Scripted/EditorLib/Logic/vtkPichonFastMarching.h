@@ -15,6 +15,7 @@
 // VTK includes
 #include <vtkImageData.h>
 #include <vtkImageAlgorithm.h>
+#include <vtkMultiThreader.h>
 #include <vtkVersion.h>
 
 // STD includes
@@ -98,6 +99,28 @@ public:
 
   void show(float r);
 
+  /// If enabled, voxels that were reached by the front but are currently not
+  /// shown (because a smaller volume was selected) keep their arrival times
+  /// and the evolution continues from the full front instead of recomputing them.
+  /// Changing the target volume is then only a threshold on the stored arrival
+  /// times (see showArrivalTime). Disabled by default.
+  void setStoreArrivalTimes(int store);
+  int getStoreArrivalTimes(void);
+
+  /// If enabled, median intensity and inhomogeneity of all voxels are computed
+  /// in parallel during initialization instead of on demand during the evolution.
+  /// Disabled by default.
+  void setPrecomputeMedianInhomo(int precompute);
+
+  /// Arrival time of the known point at the given fraction (same scale as in show())
+  float arrivalTime(float r);
+  /// Label all known voxels that have arrival time <= maxT and remove the
+  /// label from the other known voxels. The volume is processed in parallel slabs.
+  void showArrivalTime(float maxT);
+  /// Copy arrival times into a float image of the input dimensions.
+  /// Voxels that are not reached by the front are set to -1.
+  void getArrivalTimes(vtkImageData* arrivalTimes);
+
   char * cxxVersionString(void);
   int cxxMajorVersion(void);
   void tweak(char *name, double value);
@@ -120,6 +143,9 @@ private:
 
   bool somethingReallyWrong;
 
+  bool storeArrivalTimes;
+  bool precomputeMedianInhomo;
+
   double powerSpeed;
 
   int nNeighbors; /// =6 pb wrap, cannot be defined as constant
@@ -205,6 +231,16 @@ private:
   int indexFather(int index );
 
   void getMedianInhomo(int index, int &median, int &inhomo );
+  /// Compute median and inhomogeneity at index. neighborhood is a buffer of 27 values.
+  void computeMedianInhomo(int index, int* neighborhood);
+
+  /// Initialize node status, arrival time and median/inhomogeneity in slices [kStart, kEnd)
+  void initializeSlab(int kStart, int kEnd);
+  /// Apply arrival time threshold in slices [kStart, kEnd), return number of known voxels below threshold
+  int thresholdSlab(int kStart, int kEnd, float maxT);
+  /// Process the volume in parallel slabs (operation is one of SlabOperationType)
+  int processSlabs(int operation, float maxT);
+  static VTK_THREAD_RETURN_TYPE slabThreadFunction(void* arg);
 
   int shiftNeighbor(int n);
   double distanceNeighbor(int n);
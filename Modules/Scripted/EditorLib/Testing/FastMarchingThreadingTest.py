@@ -0,0 +1,127 @@
+import numpy
+import unittest
+import vtk
+import slicer
+from vtk.util import numpy_support
+
+class FastMarchingThreading(unittest.TestCase):
+  """
+  Check that vtkPichonFastMarching gives the same result whether the
+  median and inhomogeneity features are precomputed or not, and whatever
+  the number of threads used to initialize the volume slabs, and that the
+  stored arrival times can be used to change the displayed volume.
+  """
+  def setUp(self):
+    self.defaultNumberOfThreads = vtk.vtkMultiThreader.GetGlobalDefaultNumberOfThreads()
+
+  def tearDown(self):
+    vtk.vtkMultiThreader.SetGlobalDefaultNumberOfThreads(self.defaultNumberOfThreads)
+
+  def runTest(self):
+    self.test_FastMarchingThreading()
+    self.test_FastMarchingArrivalTimes()
+
+  def march(self, precompute, numberOfThreads, storeArrivalTimes=0):
+    fm = self.createFilter(precompute, numberOfThreads, storeArrivalTimes)
+    return self.output(fm)
+
+  def output(self, fm):
+    return numpy_support.vtk_to_numpy(fm.GetOutput().GetPointData().GetScalars()).copy()
+
+  def createFilter(self, precompute, numberOfThreads, storeArrivalTimes):
+    vtk.vtkMultiThreader.SetGlobalDefaultNumberOfThreads(numberOfThreads)
+
+    # bright ellipsoid on a dark background, with more slices than
+    # vtkMultiThreader can run threads (VTK_MAX_THREADS)
+    dim = (20, 20, 100)
+    source = vtk.vtkImageEllipsoidSource()
+    source.SetWholeExtent(0, dim[0]-1, 0, dim[1]-1, 0, dim[2]-1)
+    source.SetCenter(10, 10, 50)
+    source.SetRadius(6, 6, 35)
+    source.SetInValue(200)
+    source.SetOutValue(20)
+    source.SetOutputScalarTypeToShort()
+    source.Update()
+
+    label = vtk.vtkImageData()
+    label.SetDimensions(dim)
+    label.AllocateScalars(vtk.VTK_SHORT, 1)
+    label.GetPointData().GetScalars().Fill(0)
+    for k in range(48, 53):
+      label.SetScalarComponentFromDouble(10, 10, k, 0, 1)
+
+    fm = slicer.vtkPichonFastMarching()
+    fm.setPrecomputeMedianInhomo(precompute)
+    fm.setStoreArrivalTimes(storeArrivalTimes)
+    fm.init(dim[0], dim[1], dim[2], 180, 1, 1, 1)
+    fm.SetInputData(source.GetOutput())
+    fm.setNPointsEvolution(3000)
+    fm.setActiveLabel(1)
+    self.assertEqual(fm.addSeedsFromImage(label), 5)
+    fm.Modified()
+    fm.Update()
+    # need to call show() twice for data to be updated (see FastMarchingEffect)
+    for i in range(2):
+      fm.show(1)
+      fm.Modified()
+      fm.Update()
+    return fm
+
+  def test_FastMarchingThreading(self):
+    reference = self.march(0, 1)
+    self.assertGreater((reference == 1).sum(), 1000)
+    # more threads than VTK_MAX_THREADS are requested to check that all the
+    # slabs are initialized when the threader runs fewer threads
+    for precompute, numberOfThreads in [(1, 1), (0, 1000), (1, 1000)]:
+      result = self.march(precompute, numberOfThreads)
+      self.assertEqual((result != reference).sum(), 0,
+        'precompute: %d, threads: %d' % (precompute, numberOfThreads))
+
+  def test_FastMarchingArrivalTimes(self):
+    reference = self.march(1, 1)
+    fm = self.createFilter(1, 4, 1)
+    self.assertEqual(fm.getStoreArrivalTimes(), 1)
+    full = self.output(fm)
+    self.assertEqual((full != reference).sum(), 0)
+
+    # arrival times are stored for all the known points
+    arrivalTimes = vtk.vtkImageData()
+    fm.getArrivalTimes(arrivalTimes)
+    self.assertEqual(arrivalTimes.GetDimensions(), (20, 20, 100))
+    times = numpy_support.vtk_to_numpy(arrivalTimes.GetPointData().GetScalars())
+    known = times >= 0
+    self.assertEqual(known.sum(), fm.nKnownPoints())
+    self.assertEqual((full[known] != 1).sum(), 0)
+
+    # arrival times increase away from the seeds, which are on the z axis
+    # of the ellipsoid from slice 48 to slice 52
+    k, j, i = numpy.unravel_index(numpy.arange(times.size), (100, 20, 20))
+    distance = numpy.maximum(numpy.maximum(abs(i - 10), abs(j - 10)),
+      numpy.maximum(abs(k - 50) - 2, 0))
+    seeds = known & (distance == 0)
+    self.assertEqual(seeds.sum(), 5)
+    self.assertLessEqual(times[seeds].max(), times[known].min())
+    self.assertEqual(times[seeds].max(), 0)
+    meanTimes = [times[known & (distance >= d) & (distance < d + 3)].mean() for d in (1, 4, 7)]
+    for d in range(len(meanTimes) - 1):
+      self.assertLess(meanTimes[d], meanTimes[d + 1], 'mean arrival times: %s' % meanTimes)
+    self.assertEqual(fm.arrivalTime(0), 0)
+
+    # showing the points reached before half of the front changes the label output
+    maxT = fm.arrivalTime(0.5)
+    for n in range(2):
+      fm.showArrivalTime(maxT)
+      fm.Modified()
+      fm.Update()
+    half = self.output(fm)
+    self.assertGreater((half == 1).sum(), 0)
+    self.assertLess((half == 1).sum(), (full == 1).sum())
+    self.assertEqual((half == 1).sum(), (known & (times <= maxT)).sum())
+    self.assertEqual((times[half == 1] > maxT).sum(), 0)
+
+    # all the stored points are shown again without a new evolution
+    for n in range(2):
+      fm.showArrivalTime(float(times[known].max()))
+      fm.Modified()
+      fm.Update()
+    self.assertEqual((self.output(fm) != full).sum(), 0)